@@ -24,6 +24,19 @@ PingmeshScheduler::PingmeshScheduler(Ptr<BasicSimulation> basicSimulation, Ptr<T
         m_enable_distributed = m_basicSimulation->IsDistributedEnabled();
         m_distributed_node_system_id_assignment = m_basicSimulation->GetDistributedNodeSystemIdAssignment();
 
+        // Log format: csv (all timestamps kept until the end) or binary (streamed during the run)
+        std::string log_format = m_basicSimulation->GetConfigParamOrDefault("pingmesh_log_format", "csv");
+        if (log_format != "csv" && log_format != "binary") {
+            throw std::invalid_argument("Unknown pingmesh_log_format: " + log_format);
+        }
+        m_binary_log = log_format == "binary";
+
+        // Fraction of the pairs which are pinged
+        m_pair_sample_fraction = parse_double(m_basicSimulation->GetConfigParamOrDefault("pingmesh_pair_sample_fraction", "1.0"));
+        if (m_pair_sample_fraction <= 0.0 || m_pair_sample_fraction > 1.0) {
+            throw std::invalid_argument(format_string("pingmesh_pair_sample_fraction must be in (0, 1]: %f", m_pair_sample_fraction));
+        }
+
         // Pairs
         if (pingmesh_endpoints_pair_str == "all") {
 
@@ -63,6 +76,18 @@ PingmeshScheduler::PingmeshScheduler(Ptr<BasicSimulation> basicSimulation, Ptr<T
 
         }
 
+        // Sample the pairs
+        if (m_pair_sample_fraction < 1.0) {
+            std::vector<std::pair<int64_t, int64_t>> sampled_pairs;
+            for (const std::pair<int64_t, int64_t>& p : m_pingmesh_endpoint_pairs) {
+                if (IsSampledPair(p.first, p.second, m_pair_sample_fraction)) {
+                    sampled_pairs.push_back(p);
+                }
+            }
+            printf("  > Sampled %lu of %lu pingmesh pairs\n", sampled_pairs.size(), m_pingmesh_endpoint_pairs.size());
+            m_pingmesh_endpoint_pairs = sampled_pairs;
+        }
+
         // Sort the pairs ascending such that we can do some spacing
         std::sort(m_pingmesh_endpoint_pairs.begin(), m_pingmesh_endpoint_pairs.end());
 
@@ -74,19 +99,34 @@ PingmeshScheduler::PingmeshScheduler(Ptr<BasicSimulation> basicSimulation, Ptr<T
         if (m_enable_distributed) {
             m_pingmesh_csv_filename = m_basicSimulation->GetLogsDir() + "/system_" + std::to_string(m_system_id) + "_pingmesh.csv";
             m_pingmesh_txt_filename = m_basicSimulation->GetLogsDir() + "/system_" + std::to_string(m_system_id) + "_pingmesh.txt";
+            m_pingmesh_bin_filename = m_basicSimulation->GetLogsDir() + "/system_" + std::to_string(m_system_id) + "_pingmesh.bin";
         } else {
             m_pingmesh_csv_filename = m_basicSimulation->GetLogsDir() + "/pingmesh.csv";
             m_pingmesh_txt_filename = m_basicSimulation->GetLogsDir() + "/pingmesh.txt";
+            m_pingmesh_bin_filename = m_basicSimulation->GetLogsDir() + "/pingmesh.bin";
         }
 
         // Remove files if they are there
         remove_file_if_exists(m_pingmesh_csv_filename);
         remove_file_if_exists(m_pingmesh_txt_filename);
+        remove_file_if_exists(m_pingmesh_bin_filename);
         printf("  > Removed previous pingmesh log files if present\n");
         m_basicSimulation->RegisterTimestamp("Remove previous pingmesh log files");
 
         // Info
         std::cout << "  > Ping interval: " << m_interval_ns << " ns" << std::endl;
+        std::cout << "  > Log format: " << log_format << std::endl;
+
+        // Binary log is written during the run (through a large buffer)
+        if (m_binary_log) {
+            m_pingmesh_bin_file = fopen(m_pingmesh_bin_filename.c_str(), "wb");
+            if (m_pingmesh_bin_file == nullptr) {
+                throw std::runtime_error("Could not open pingmesh binary log: " + m_pingmesh_bin_filename);
+            }
+            m_pingmesh_bin_buffer.resize(1 << 20);
+            setvbuf(m_pingmesh_bin_file, m_pingmesh_bin_buffer.data(), _IOFBF, m_pingmesh_bin_buffer.size());
+            std::cout << "  > Opened: " << m_pingmesh_bin_filename << std::endl;
+        }
 
         // Endpoints
         std::set<int64_t> endpoints = m_topology->GetEndpoints();
@@ -126,6 +166,9 @@ PingmeshScheduler::PingmeshScheduler(Ptr<BasicSimulation> basicSimulation, Ptr<T
             // Install it on the node and start it right now
             ApplicationContainer app = source.Install(m_nodes.Get(p.first));
             app.Start(NanoSeconds(counter * in_between_ns));
+            if (m_binary_log) {
+                app.Get(0)->GetObject<UdpRttClient>()->EnableStreaming(MakeCallback(&PingmeshScheduler::WritePing, this));
+            }
             m_apps.push_back(app);
 
             counter++;
@@ -137,6 +180,75 @@ PingmeshScheduler::PingmeshScheduler(Ptr<BasicSimulation> basicSimulation, Ptr<T
     std::cout << std::endl;
 }
 
+PingmeshScheduler::~PingmeshScheduler() {
+    if (m_pingmesh_bin_file != nullptr) {
+        fclose(m_pingmesh_bin_file);
+    }
+}
+
+bool PingmeshScheduler::IsSampledPair(int64_t from_node_id, int64_t to_node_id, double fraction) {
+    // Deterministic in the pair (the same subset on every run and every system): splitmix64 of the pair
+    uint64_t x = (((uint64_t) from_node_id) << 32) ^ ((uint64_t) to_node_id);
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    x = x ^ (x >> 31);
+    return (double) (x >> 11) / (double) (1ULL << 53) < fraction;
+}
+
+void PingmeshScheduler::WritePing(const UdpRttPing& ping) {
+    static_assert(sizeof(PingmeshRecord) == 40, "pingmesh.bin records are 40 bytes");
+    PingmeshRecord record;
+    record.from_node_id = ping.from_node_id;
+    record.to_node_id = ping.to_node_id;
+    record.i = ping.seq;
+    record.reply_arrived = ping.reply_timestamp != -1;
+    record.send_request_timestamp = ping.send_request_timestamp;
+    record.reply_timestamp = ping.reply_timestamp;
+    record.receive_reply_timestamp = ping.receive_reply_timestamp;
+    fwrite(&record, sizeof(PingmeshRecord), 1, m_pingmesh_bin_file);
+}
+
+void PingmeshScheduler::WritePairSummary(
+        FILE* file_txt, int64_t from_node_id, int64_t to_node_id, uint32_t sent, uint32_t total,
+        double sum_latency_to_there_ns, double sum_latency_from_there_ns, int64_t min_rtt_ns, int64_t max_rtt_ns,
+        double sample_std_rtt_ns
+) {
+    double mean_latency_to_there_ns;
+    double mean_latency_from_there_ns;
+    double mean_rtt_ns;
+    if (total == 0) { // If no measurements came through, it should all be -1
+        mean_latency_to_there_ns = -1;
+        mean_latency_from_there_ns = -1;
+        min_rtt_ns = -1;
+        max_rtt_ns = -1;
+        mean_rtt_ns = -1;
+        sample_std_rtt_ns = -1;
+    } else {
+        mean_latency_to_there_ns = sum_latency_to_there_ns / total;
+        mean_latency_from_there_ns = sum_latency_from_there_ns / total;
+        mean_rtt_ns = (sum_latency_to_there_ns + sum_latency_from_there_ns) / total;
+    }
+
+    // Write nicely formatted to the text
+    char str_latency_to_there_ms[100];
+    sprintf(str_latency_to_there_ms, "%.2f ms", nanosec_to_millisec(mean_latency_to_there_ns));
+    char str_latency_from_there_ms[100];
+    sprintf(str_latency_from_there_ms, "%.2f ms", nanosec_to_millisec(mean_latency_from_there_ns));
+    char str_min_rtt_ms[100];
+    sprintf(str_min_rtt_ms, "%.2f ms", nanosec_to_millisec(min_rtt_ns));
+    char str_mean_rtt_ms[100];
+    sprintf(str_mean_rtt_ms, "%.2f ms", nanosec_to_millisec(mean_rtt_ns));
+    char str_max_rtt_ms[100];
+    sprintf(str_max_rtt_ms, "%.2f ms", nanosec_to_millisec(max_rtt_ns));
+    char str_sample_std_rtt_ms[100];
+    sprintf(str_sample_std_rtt_ms, "%.2f ms", nanosec_to_millisec(sample_std_rtt_ns));
+    fprintf(
+            file_txt, "%-10" PRId64 "%-10" PRId64 "%-22s%-22s%-16s%-16s%-16s%-16s%d/%d (%d%%)\n",
+            from_node_id, to_node_id, str_latency_to_there_ms, str_latency_from_there_ms, str_min_rtt_ms, str_mean_rtt_ms, str_max_rtt_ms, str_sample_std_rtt_ms, total, sent, (int) std::round(((double) total / (double) sent) * 100.0)
+    );
+}
+
 void PingmeshScheduler::WriteResults() {
     std::cout << "STORE PINGMESH RESULTS" << std::endl;
 
@@ -148,8 +260,11 @@ void PingmeshScheduler::WriteResults() {
 
         // Open files
         std::cout << "  > Opening pingmesh log files:" << std::endl;
-        FILE* file_csv = fopen(m_pingmesh_csv_filename.c_str(), "w+");
-        std::cout << "    >> Opened: " << m_pingmesh_csv_filename << std::endl;
+        FILE* file_csv = nullptr;
+        if (!m_binary_log) {
+            file_csv = fopen(m_pingmesh_csv_filename.c_str(), "w+");
+            std::cout << "    >> Opened: " << m_pingmesh_csv_filename << std::endl;
+        }
         FILE* file_txt = fopen(m_pingmesh_txt_filename.c_str(), "w+");
         std::cout << "    >> Opened: " << m_pingmesh_txt_filename << std::endl;
 
@@ -167,6 +282,20 @@ void PingmeshScheduler::WriteResults() {
             int64_t from_node_id = client->GetFromNodeId();
             int64_t to_node_id = client->GetToNodeId();
             uint32_t sent = client->GetSent();
+
+            // Binary log: the pings are already written (except the lost ones), the statistics were kept during the run
+            if (m_binary_log) {
+                client->FinishStreaming();
+                const UdpRttStatistics& statistics = client->GetStatistics();
+                double sample_std_rtt_ns = statistics.num_replies > 1 ? std::sqrt(statistics.m2_rtt_ns / (statistics.num_replies - 1)) : 0.0;
+                WritePairSummary(
+                        file_txt, from_node_id, to_node_id, sent, statistics.num_replies,
+                        statistics.sum_latency_to_there_ns, statistics.sum_latency_from_there_ns,
+                        statistics.min_rtt_ns, statistics.max_rtt_ns, sample_std_rtt_ns
+                );
+                continue;
+            }
+
             std::vector<int64_t> sendRequestTimestamps = client->GetSendRequestTimestamps();
             std::vector<int64_t> replyTimestamps = client->GetReplyTimestamps();
             std::vector<int64_t> receiveReplyTimestamps = client->GetReceiveReplyTimestamps();
@@ -214,48 +343,27 @@ void PingmeshScheduler::WriteResults() {
                 max_rtt_ns = std::max(max_rtt_ns, rtts_ns[j]);
                 sum_sq += std::pow(rtts_ns[j] - mean_rtt_ns, 2);
             }
-            double sample_std_rtt_ns;
-            double mean_latency_to_there_ns;
-            double mean_latency_from_there_ns;
-            if (rtts_ns.size() == 0) { // If no measurements came through, it should all be -1
-                mean_latency_to_there_ns = -1;
-                mean_latency_from_there_ns = -1;
-                min_rtt_ns = -1;
-                max_rtt_ns = -1;
-                mean_rtt_ns = -1;
-                sample_std_rtt_ns = -1;
-            } else {
-                mean_latency_to_there_ns = sum_latency_to_there_ns / total;
-                mean_latency_from_there_ns = sum_latency_from_there_ns / total;
-                sample_std_rtt_ns = rtts_ns.size() > 1 ? std::sqrt((1.0 / (rtts_ns.size() - 1)) * sum_sq) : 0.0;
-            }
-
-            // Write nicely formatted to the text
-            char str_latency_to_there_ms[100];
-            sprintf(str_latency_to_there_ms, "%.2f ms", nanosec_to_millisec(mean_latency_to_there_ns));
-            char str_latency_from_there_ms[100];
-            sprintf(str_latency_from_there_ms, "%.2f ms", nanosec_to_millisec(mean_latency_from_there_ns));
-            char str_min_rtt_ms[100];
-            sprintf(str_min_rtt_ms, "%.2f ms", nanosec_to_millisec(min_rtt_ns));
-            char str_mean_rtt_ms[100];
-            sprintf(str_mean_rtt_ms, "%.2f ms", nanosec_to_millisec(mean_rtt_ns));
-            char str_max_rtt_ms[100];
-            sprintf(str_max_rtt_ms, "%.2f ms", nanosec_to_millisec(max_rtt_ns));
-            char str_sample_std_rtt_ms[100];
-            sprintf(str_sample_std_rtt_ms, "%.2f ms", nanosec_to_millisec(sample_std_rtt_ns));
-            fprintf(
-                    file_txt, "%-10" PRId64 "%-10" PRId64 "%-22s%-22s%-16s%-16s%-16s%-16s%d/%d (%d%%)\n",
-                    from_node_id, to_node_id, str_latency_to_there_ms, str_latency_from_there_ms, str_min_rtt_ms, str_mean_rtt_ms, str_max_rtt_ms, str_sample_std_rtt_ms, total, sent, (int) std::round(((double) total / (double) sent) * 100.0)
+            double sample_std_rtt_ns = rtts_ns.size() > 1 ? std::sqrt((1.0 / (rtts_ns.size() - 1)) * sum_sq) : 0.0;
+            WritePairSummary(
+                    file_txt, from_node_id, to_node_id, sent, total,
+                    sum_latency_to_there_ns, sum_latency_from_there_ns, min_rtt_ns, max_rtt_ns, sample_std_rtt_ns
             );
 
         }
 
         // Close files
         std::cout << "  > Closing pingmesh log files:" << std::endl;
-        fclose(file_csv);
-        std::cout << "    >> Closed: " << m_pingmesh_csv_filename << std::endl;
+        if (file_csv != nullptr) {
+            fclose(file_csv);
+            std::cout << "    >> Closed: " << m_pingmesh_csv_filename << std::endl;
+        }
         fclose(file_txt);
         std::cout << "    >> Closed: " << m_pingmesh_txt_filename << std::endl;
+        if (m_pingmesh_bin_file != nullptr) {
+            fclose(m_pingmesh_bin_file);
+            m_pingmesh_bin_file = nullptr;
+            std::cout << "    >> Closed: " << m_pingmesh_bin_filename << std::endl;
+        }
 
         // Register completion
         std::cout << "  > Pingmesh log files have been written" << std::endl;
@@ -40,9 +40,29 @@ class PingmeshScheduler
 
 public:
     PingmeshScheduler(Ptr<BasicSimulation> basicSimulation, Ptr<Topology> topology);
+    ~PingmeshScheduler();
     void WriteResults();
 
 protected:
+    // Record of a ping in pingmesh.bin (pingmesh_log_format=binary)
+    struct PingmeshRecord {
+        uint32_t from_node_id;
+        uint32_t to_node_id;
+        uint32_t i;
+        uint32_t reply_arrived;
+        int64_t send_request_timestamp;
+        int64_t reply_timestamp;
+        int64_t receive_reply_timestamp;
+    };
+
+    static bool IsSampledPair(int64_t from_node_id, int64_t to_node_id, double fraction);
+    void WritePing(const UdpRttPing& ping);
+    void WritePairSummary(
+            FILE* file_txt, int64_t from_node_id, int64_t to_node_id, uint32_t sent, uint32_t total,
+            double sum_latency_to_there_ns, double sum_latency_from_there_ns, int64_t min_rtt_ns, int64_t max_rtt_ns,
+            double sample_std_rtt_ns
+    );
+
     Ptr<BasicSimulation> m_basicSimulation;
     int64_t m_simulation_end_time_ns;
     Ptr<Topology> m_topology = nullptr;
@@ -57,6 +77,13 @@ protected:
     std::vector<int64_t> m_distributed_node_system_id_assignment;
     std::string m_pingmesh_csv_filename;
     std::string m_pingmesh_txt_filename;
+
+    // Binary log: each ping is written (buffered) once it completes, the clients only keep statistics
+    bool m_binary_log;
+    double m_pair_sample_fraction;
+    std::string m_pingmesh_bin_filename;
+    FILE* m_pingmesh_bin_file = nullptr;
+    std::vector<char> m_pingmesh_bin_buffer;
 };
 
 }
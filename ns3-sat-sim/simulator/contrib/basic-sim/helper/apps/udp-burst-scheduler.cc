@@ -41,6 +41,7 @@ namespace ns3 {
             m_nodes = m_topology->GetNodes();
             m_simulation_end_time_ns = m_basicSimulation->GetSimulationEndTimeNs();
             m_enable_logging_for_udp_burst_ids = parse_set_positive_int64(m_basicSimulation->GetConfigParamOrDefault("udp_burst_enable_logging_for_udp_burst_ids", "set()"));
+            m_skip_fluid_bursts = m_basicSimulation->GetConfigParamOrDefault("simulation_mode", "packet") == "hybrid";
 
             // Distributed run information
             m_system_id = m_basicSimulation->GetSystemId();
@@ -63,6 +64,13 @@ namespace ns3 {
 
             // Schedule read
             printf("  > Read schedule (total UDP bursts: %lu)\n", m_schedule.size());
+            if (m_skip_fluid_bursts) {
+                size_t num_fluid_bursts = 0;
+                for (UdpBurstInfo& entry : m_schedule) {
+                    num_fluid_bursts += IsFluidBurst(entry) ? 1 : 0;
+                }
+                printf("  > Hybrid mode, %lu fluid UDP bursts are not sent as packets\n", num_fluid_bursts);
+            }
             m_basicSimulation->RegisterTimestamp("Read UDP burst schedule");
 
             // Determine filenames
@@ -115,6 +123,9 @@ namespace ns3 {
                     // Register all bursts being sent from there and being received
                     Ptr<UdpBurstApplication> udpBurstApp = app.Get(0)->GetObject<UdpBurstApplication>();
                     for (UdpBurstInfo entry : m_schedule) {
+                        if (m_skip_fluid_bursts && IsFluidBurst(entry)) {
+                            continue;
+                        }
                         if (entry.GetFromNodeId() == endpoint) {
                             udpBurstApp->RegisterOutgoingBurst(
                                     entry,
@@ -135,22 +146,70 @@ namespace ns3 {
                 }
             }
             m_basicSimulation->RegisterTimestamp("Setup UDP burst applications");
+            m_basicSimulation->AddMemoryReportEntry(
+                    "UDP bursts: packet delays (m_incoming_bursts_packet_delay)",
+                    MakeCallback(&UdpBurstScheduler::EstimatePacketDelayMemoryBytes, this)
+            );
 
         }
 
         std::cout << std::endl;
     }
 
+    uint64_t UdpBurstScheduler::EstimatePacketDelayMemoryBytes() {
+        uint64_t bytes = 0;
+        for (ApplicationContainer app : m_apps) {
+            bytes += app.Get(0)->GetObject<UdpBurstApplication>()->EstimatePacketDelayMemoryBytes();
+        }
+        return bytes;
+    }
+
+    bool UdpBurstScheduler::IsFluidBurst(UdpBurstInfo& info) {
+        return info.GetAdditionalParameters() == "fluid";
+    }
+
     void UdpBurstScheduler::WritePerformance(){
+        std::vector<UdpBurstInfo> schedule;
+        std::vector<std::map<TrafficClass, uint64_t>> sent_counters;
+        std::vector<std::map<TrafficClass, uint64_t>> received_counters;
+        std::vector<std::map<TrafficClass, int64_t>> received_delays_ns;
+        for(size_t i = 0; i < m_responsible_for_incoming_bursts.size(); ++i){
+            UdpBurstInfo info = m_responsible_for_incoming_bursts[i].first;
+            Ptr<UdpBurstApplication> app_out = m_responsible_for_outgoing_bursts[i].second;
+            Ptr<UdpBurstApplication> app_in = m_responsible_for_incoming_bursts[i].second;
+            schedule.push_back(info);
+            sent_counters.push_back(app_out->GetSendCounterTrafficOf(info.GetUdpBurstId()));
+            received_counters.push_back(app_in->GetReceivedCounterTrafficOf(info.GetUdpBurstId()));
+            received_delays_ns.push_back(app_in->GetReceivedDelayNS(info.GetUdpBurstId()));
+        }
+        WritePerformanceFiles(
+                m_basicSimulation->GetRunDir() + "/algorithm_performance",
+                schedule, sent_counters, received_counters, received_delays_ns, m_simulation_end_time_ns
+        );
+    }
+
+    void UdpBurstScheduler::WritePerformanceFiles(
+            std::string performance_dir,
+            const std::vector<UdpBurstInfo>& schedule,
+            const std::vector<std::map<TrafficClass, uint64_t>>& sent_counters,
+            const std::vector<std::map<TrafficClass, uint64_t>>& received_counters,
+            const std::vector<std::map<TrafficClass, int64_t>>& received_delays_ns,
+            int64_t simulation_end_time_ns
+    ){
+        std::string udp_bursts_performance_csv_filename = performance_dir + "/udp_bursts_performance.csv";
+        std::string udp_bursts_performance_txt_filename = performance_dir + "/udp_bursts_performance.txt";
+        std::string algorithm_performance_csv_filename = performance_dir + "/algorithm_performance.csv";
+        std::string algorithm_performance_txt_filename = performance_dir + "/algorithm_performance.txt";
+
         std::cout << "\n  > Opening algorithm performance files:" << std::endl;
-        FILE* file_udp_csv = fopen(m_udp_bursts_performance_csv_filename.c_str(), "w+");
-        std::cout << "    >> Opened: " << m_udp_bursts_performance_csv_filename << std::endl;
-        FILE* file_udp_txt = fopen(m_udp_bursts_performance_txt_filename.c_str(), "w+");
-        std::cout << "    >> Opened: " << m_udp_bursts_performance_txt_filename << std::endl;
-        FILE* file_csv = fopen(m_algorithm_performance_csv_filename.c_str(), "w+");
-        std::cout << "    >> Opened: " << m_algorithm_performance_csv_filename << std::endl;
-        FILE* file_txt = fopen(m_algorithm_performance_txt_filename.c_str(), "w+");
-        std::cout << "    >> Opened: " << m_algorithm_performance_txt_filename << std::endl;
+        FILE* file_udp_csv = fopen(udp_bursts_performance_csv_filename.c_str(), "w+");
+        std::cout << "    >> Opened: " << udp_bursts_performance_csv_filename << std::endl;
+        FILE* file_udp_txt = fopen(udp_bursts_performance_txt_filename.c_str(), "w+");
+        std::cout << "    >> Opened: " << udp_bursts_performance_txt_filename << std::endl;
+        FILE* file_csv = fopen(algorithm_performance_csv_filename.c_str(), "w+");
+        std::cout << "    >> Opened: " << algorithm_performance_csv_filename << std::endl;
+        FILE* file_txt = fopen(algorithm_performance_txt_filename.c_str(), "w+");
+        std::cout << "    >> Opened: " << algorithm_performance_txt_filename << std::endl;
 
         fprintf(
                 file_udp_txt, "%-16s%-10s%-10s%-20s%-16s%-24s%-24s%-24s%-24s%-28s%-28s%-28s%-28s%-28s%-28s%-28s%-28s\n",
@@ -175,13 +234,11 @@ namespace ns3 {
             total_drop_rate[pclass] = total_throughput[pclass] = total_endtoend_delay[pclass] = 0;
         }
 
-        for(size_t i = 0; i < m_schedule.size(); ++i){
-            UdpBurstInfo info = m_responsible_for_incoming_bursts[i].first;
-            Ptr<UdpBurstApplication> app_out = m_responsible_for_outgoing_bursts[i].second;
-            Ptr<UdpBurstApplication> app_in = m_responsible_for_incoming_bursts[i].second;
-            std::map<TrafficClass, uint64_t> send_conter = app_out->GetSendCounterTrafficOf(info.GetUdpBurstId());
-            std::map<TrafficClass, uint64_t> recieve_conter = app_in->GetReceivedCounterTrafficOf(info.GetUdpBurstId());
-            std::map<TrafficClass, int64_t> recieve_delay = app_in->GetReceivedDelayNS(info.GetUdpBurstId());
+        for(size_t i = 0; i < schedule.size(); ++i){
+            const UdpBurstInfo& info = schedule[i];
+            const std::map<TrafficClass, uint64_t>& send_conter = sent_counters[i];
+            const std::map<TrafficClass, uint64_t>& recieve_conter = received_counters[i];
+            const std::map<TrafficClass, int64_t>& recieve_delay = received_delays_ns[i];
 
             std::map<TrafficClass, double> tmp_drop_rate;
             std::map<TrafficClass, double> tmp_throughput;
@@ -195,20 +252,20 @@ namespace ns3 {
                 double rate1 = send_conter.at(pclass) == 0 ? 1 : (double)recieve_conter.at(pclass) / send_conter.at(pclass);
                 rate1 = (1 - rate1) * 100;
                 tmp_drop_rate.at(pclass) = rate1;
-                total_drop_rate.at(pclass) += rate1 / m_schedule.size();
+                total_drop_rate.at(pclass) += rate1 / schedule.size();
 
                 // throughput mbps(we use incoming rate)
                 uint32_t complete_packet_size = 1500;
-                int64_t effective_duration_ns = info.GetStartTimeNs() + info.GetDurationNs() >= m_simulation_end_time_ns ? 
-                                                m_simulation_end_time_ns - info.GetStartTimeNs() : info.GetDurationNs();
+                int64_t effective_duration_ns = info.GetStartTimeNs() + info.GetDurationNs() >= simulation_end_time_ns ? 
+                                                simulation_end_time_ns - info.GetStartTimeNs() : info.GetDurationNs();
                 double rate2 = byte_to_megabit(recieve_conter.at(pclass) * complete_packet_size) / nanosec_to_sec(effective_duration_ns);
                 tmp_throughput.at(pclass) = rate2;
-                total_throughput.at(pclass) += rate2 / m_schedule.size();
+                total_throughput.at(pclass) += rate2 / schedule.size();
 
                 // end-to-end delay
                 double delay = nanosec_to_millisec(recieve_delay.at(pclass));
                 tmp_endtoend_delay.at(pclass) = delay;
-                total_endtoend_delay.at(pclass) += delay / m_schedule.size();
+                total_endtoend_delay.at(pclass) += delay / schedule.size();
             }
 
             // Write to udp csv file
@@ -251,9 +308,9 @@ namespace ns3 {
         }
 
         // Write to csv file
-        size_t num_info = m_schedule.size();
-        double target_rate = m_schedule[0].GetTargetRateMegabitPerSec();
-        double duration_s = nanosec_to_sec(m_schedule[0].GetDurationNs());
+        size_t num_info = schedule.size();
+        double target_rate = schedule[0].GetTargetRateMegabitPerSec();
+        double duration_s = nanosec_to_sec(schedule[0].GetDurationNs());
         fprintf(
                 file_csv, "%ld,%.5f,%.5f", num_info, target_rate, duration_s
         );
@@ -292,13 +349,13 @@ namespace ns3 {
         // Close files
         std::cout << "  > Closing performance log files:" << std::endl;
         fclose(file_udp_csv);
-        std::cout << "    >> Closed: " << m_udp_bursts_performance_csv_filename << std::endl;
+        std::cout << "    >> Closed: " << udp_bursts_performance_csv_filename << std::endl;
         fclose(file_udp_txt);
-        std::cout << "    >> Closed: " << m_udp_bursts_performance_txt_filename << std::endl;
+        std::cout << "    >> Closed: " << udp_bursts_performance_txt_filename << std::endl;
         fclose(file_csv);
-        std::cout << "    >> Closed: " << m_algorithm_performance_csv_filename << std::endl;
+        std::cout << "    >> Closed: " << algorithm_performance_csv_filename << std::endl;
         fclose(file_txt);
-        std::cout << "    >> Closed: " << m_algorithm_performance_txt_filename << std::endl;
+        std::cout << "    >> Closed: " << algorithm_performance_txt_filename << std::endl;
 
 
     }
@@ -59,12 +59,29 @@ namespace ns3 {
         UdpBurstScheduler(Ptr<BasicSimulation> basicSimulation, Ptr<Topology> topology);
         void WriteResults();
         void WritePerformance();
+        uint64_t EstimatePacketDelayMemoryBytes();
+
+        // A UDP burst with additional parameters "fluid" is not sent as packets in the hybrid
+        // mode (simulation_mode=hybrid), it is a flow of the fluid background instead
+        static bool IsFluidBurst(UdpBurstInfo& info);
+
+        // Writes {udp_bursts, algorithm}_performance.{csv, txt} to performance_dir from the packets
+        // sent and received, and the mean delay of the received packets, of each UDP burst per traffic class
+        static void WritePerformanceFiles(
+                std::string performance_dir,
+                const std::vector<UdpBurstInfo>& schedule,
+                const std::vector<std::map<TrafficClass, uint64_t>>& sent_counters,
+                const std::vector<std::map<TrafficClass, uint64_t>>& received_counters,
+                const std::vector<std::map<TrafficClass, int64_t>>& received_delays_ns,
+                int64_t simulation_end_time_ns
+        );
 
     protected:
         Ptr<BasicSimulation> m_basicSimulation;
         int64_t m_simulation_end_time_ns;
         Ptr<Topology> m_topology = nullptr;
         bool m_enabled;
+        bool m_skip_fluid_bursts;
 
         uint32_t m_system_id;
         bool m_enable_distributed;
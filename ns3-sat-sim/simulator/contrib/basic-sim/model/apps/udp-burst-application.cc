@@ -83,6 +83,24 @@ namespace ns3 {
         NS_ABORT_MSG_IF(class_A_rate + class_B_rate + class_C_rate != 1, "the sum of 3 class rate not 1");
     }
 
+    double UdpBurstApplication::GetTrafficClassRate(TrafficClass pclass){
+        switch (pclass)
+        {
+            case TrafficClass::class_A:
+                return class_A_rate;
+            case TrafficClass::class_B:
+                return class_B_rate;
+            case TrafficClass::class_C:
+                return class_C_rate;
+            default:
+                return 0;
+        }
+    }
+
+    double UdpBurstApplication::GetMeanOnFraction(){
+        return (double) on_average_period_ms / (on_average_period_ms + off_average_period_ms);
+    }
+
     UdpBurstApplication::UdpBurstApplication(): 
         m_pareto_time(CreateObject<ParetoRandomVariable>())   
     {
@@ -389,6 +407,18 @@ namespace ns3 {
         return res;
     }
 
+    uint64_t
+    UdpBurstApplication::EstimatePacketDelayMemoryBytes(){
+        uint64_t bytes = estimate_heap_bytes(m_incoming_bursts_packet_delay);
+        for(const std::pair<const int64_t, std::map<TrafficClass, std::vector<int64_t>>>& burst : m_incoming_bursts_packet_delay){
+            bytes += estimate_heap_bytes(burst.second);
+            for(const std::pair<const TrafficClass, std::vector<int64_t>>& delays : burst.second){
+                bytes += estimate_heap_bytes(delays.second);
+            }
+        }
+        return bytes;
+    }
+
     TrafficClass 
     UdpBurstApplication::GenerateRandomTrafficClass()
     {
@@ -58,9 +58,15 @@ namespace ns3 {
         std::map<TrafficClass, uint64_t> GetSendCounterTrafficOf(int64_t udp_burst_id);
         std::map<TrafficClass, uint64_t> GetReceivedCounterTrafficOf(int64_t udp_burst_id);
         std::map<TrafficClass, int64_t> GetReceivedDelayNS(int64_t udp_burst_id);
+        uint64_t EstimatePacketDelayMemoryBytes();
 
         static void Initialize(Ptr<BasicSimulation> basicSimulation);
 
+        // Traffic model (after Initialize): the share of the packets of each traffic class,
+        // and the mean share of the time a burst is sending (on / (on + off) period)
+        static double GetTrafficClassRate(TrafficClass pclass);
+        static double GetMeanOnFraction();
+
     protected:
         virtual void DoDispose (void);
 
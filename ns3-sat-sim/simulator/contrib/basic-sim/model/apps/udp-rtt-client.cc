@@ -27,7 +27,9 @@
 #include "ns3/packet.h"
 #include "ns3/uinteger.h"
 #include "ns3/trace-source-accessor.h"
+#include "ns3/abort.h"
 #include "udp-rtt-client.h"
+#include <algorithm>
 
 namespace ns3 {
 
@@ -74,6 +76,7 @@ UdpRttClient::UdpRttClient() {
     m_socket = 0;
     m_sent = 0;
     m_sendEvent = EventId();
+    m_streaming = false;
 }
 
 UdpRttClient::~UdpRttClient() {
@@ -141,9 +144,13 @@ UdpRttClient::Send(void) {
     p->AddHeader(seqTs);
 
     // Timestamps
-    m_sendRequestTimestamps.push_back(Simulator::Now().GetNanoSeconds());
-    m_replyTimestamps.push_back(-1);
-    m_receiveReplyTimestamps.push_back(-1);
+    if (m_streaming) {
+        m_pendingSendRequestTimestamps[m_sent] = Simulator::Now().GetNanoSeconds();
+    } else {
+        m_sendRequestTimestamps.push_back(Simulator::Now().GetNanoSeconds());
+        m_replyTimestamps.push_back(-1);
+        m_receiveReplyTimestamps.push_back(-1);
+    }
     m_sent++;
 
     // Send out
@@ -167,6 +174,32 @@ UdpRttClient::HandleRead(Ptr <Socket> socket) {
         packet->RemoveHeader (incomingSeqTs);
         uint32_t seqNo = incomingSeqTs.GetSeq();
 
+        // Streaming: statistics and the ping to the callback
+        if (m_streaming) {
+            auto it = m_pendingSendRequestTimestamps.find(seqNo);
+            if (it == m_pendingSendRequestTimestamps.end()) {
+                continue; // Duplicate reply
+            }
+            UdpRttPing ping = {m_fromNodeId, m_toNodeId, seqNo, it->second,
+                               incomingSeqTs.GetTs().GetNanoSeconds(), Simulator::Now().GetNanoSeconds()};
+            m_pendingSendRequestTimestamps.erase(it);
+
+            int64_t latency_to_there_ns = ping.reply_timestamp - ping.send_request_timestamp;
+            int64_t latency_from_there_ns = ping.receive_reply_timestamp - ping.reply_timestamp;
+            int64_t rtt_ns = latency_to_there_ns + latency_from_there_ns;
+            m_statistics.num_replies++;
+            m_statistics.sum_latency_to_there_ns += latency_to_there_ns;
+            m_statistics.sum_latency_from_there_ns += latency_from_there_ns;
+            m_statistics.min_rtt_ns = m_statistics.num_replies == 1 ? rtt_ns : std::min(m_statistics.min_rtt_ns, rtt_ns);
+            m_statistics.max_rtt_ns = std::max(m_statistics.max_rtt_ns, rtt_ns);
+            double delta = rtt_ns - m_statistics.mean_rtt_ns;
+            m_statistics.mean_rtt_ns += delta / m_statistics.num_replies;
+            m_statistics.m2_rtt_ns += delta * (rtt_ns - m_statistics.mean_rtt_ns);
+
+            m_pingCallback(ping);
+            continue;
+        }
+
         // Update the local timestamps
         m_replyTimestamps[seqNo] = incomingSeqTs.GetTs().GetNanoSeconds();
         m_receiveReplyTimestamps[seqNo] = Simulator::Now().GetNanoSeconds();
@@ -199,4 +232,28 @@ std::vector<int64_t> UdpRttClient::GetReceiveReplyTimestamps() {
     return m_receiveReplyTimestamps;
 }
 
+void UdpRttClient::EnableStreaming(Callback<void, const UdpRttPing&> callback) {
+    NS_ABORT_MSG_IF(m_sent > 0, "Streaming must be enabled before the first ping is sent");
+    m_streaming = true;
+    m_pingCallback = callback;
+}
+
+void UdpRttClient::FinishStreaming() {
+    NS_ABORT_MSG_UNLESS(m_streaming, "Streaming is not enabled");
+
+    // The pings of which the reply did not arrive, in order of sending
+    std::vector<std::pair<uint32_t, int64_t>> lost(m_pendingSendRequestTimestamps.begin(), m_pendingSendRequestTimestamps.end());
+    std::sort(lost.begin(), lost.end());
+    for (const std::pair<uint32_t, int64_t>& p : lost) {
+        UdpRttPing ping = {m_fromNodeId, m_toNodeId, p.first, p.second, -1, -1};
+        m_pingCallback(ping);
+    }
+    m_pendingSendRequestTimestamps.clear();
+}
+
+const UdpRttStatistics& UdpRttClient::GetStatistics() {
+    NS_ABORT_MSG_UNLESS(m_streaming, "Statistics are only kept in streaming mode");
+    return m_statistics;
+}
+
 } // Namespace ns3
@@ -25,12 +25,35 @@
 #include "ns3/ipv4-address.h"
 #include "ns3/traced-callback.h"
 #include "ns3/seq-ts-header.h"
+#include "ns3/callback.h"
+#include <unordered_map>
 
 namespace ns3 {
 
 class Socket;
 class Packet;
 
+// Outcome of one ping (reply_timestamp and receive_reply_timestamp are -1 if the reply did not arrive)
+struct UdpRttPing {
+  uint32_t from_node_id;
+  uint32_t to_node_id;
+  uint32_t seq;
+  int64_t send_request_timestamp;
+  int64_t reply_timestamp;
+  int64_t receive_reply_timestamp;
+};
+
+// Streaming statistics of the replies of a client
+struct UdpRttStatistics {
+  uint32_t num_replies = 0;
+  double sum_latency_to_there_ns = 0;
+  double sum_latency_from_there_ns = 0;
+  int64_t min_rtt_ns = -1;
+  int64_t max_rtt_ns = -1;
+  double mean_rtt_ns = 0;               // running mean and sum of squared differences (Welford)
+  double m2_rtt_ns = 0;
+};
+
 class UdpRttClient : public Application 
 {
 public:
@@ -45,6 +68,13 @@ public:
   std::vector<int64_t> GetReplyTimestamps();
   std::vector<int64_t> GetReceiveReplyTimestamps();
 
+  // Streaming mode: instead of storing the timestamps of every ping, each ping is passed to the
+  // callback once its reply arrives (or at FinishStreaming() if it did not), and only the
+  // statistics of the replies and the pings still waiting for a reply are kept
+  void EnableStreaming(Callback<void, const UdpRttPing&> callback);
+  void FinishStreaming();
+  const UdpRttStatistics& GetStatistics();
+
 protected:
   virtual void DoDispose (void);
 
@@ -69,6 +99,12 @@ private:
   std::vector<int64_t> m_replyTimestamps;
   std::vector<int64_t> m_receiveReplyTimestamps;
 
+  // Streaming mode
+  bool m_streaming;
+  Callback<void, const UdpRttPing&> m_pingCallback;
+  std::unordered_map<uint32_t, int64_t> m_pendingSendRequestTimestamps;   //!< Sequence number -> send request timestamp
+  UdpRttStatistics m_statistics;
+
 };
 
 } // namespace ns3
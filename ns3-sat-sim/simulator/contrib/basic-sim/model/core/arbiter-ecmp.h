@@ -3,16 +3,10 @@
 
 #include "ns3/arbiter-ptop.h"
 #include "ns3/topology-ptop.h"
-#include "ns3/hash.h"
-#include "ns3/ipv4-header.h"
-#include "ns3/udp-header.h"
-#include "ns3/tcp-header.h"
+#include "ns3/five-tuple-hasher.h"
 
 namespace ns3 {
 
-const uint8_t TCP_PROT_NUMBER = 6;
-const uint8_t UDP_PROT_NUMBER = 17;
-
 class ArbiterEcmp : public ArbiterPtop
 {
 public:
@@ -44,8 +38,7 @@ public:
 
 private:
     std::vector<std::vector<uint32_t>> m_candidate_list;
-    char m_hash_input_buff[17];
-    ns3::Hasher m_hasher;
+    FiveTupleHasher m_hasher;
 
 };
 
@@ -64,6 +64,10 @@ uint32_t Arbiter::ResolveNodeIdFromIp(uint32_t ip) {
     }
 }
 
+uint64_t Arbiter::EstimateIpToNodeIdMemoryBytes() {
+    return estimate_heap_bytes(m_ip_to_node_id);
+}
+
 ArbiterResult Arbiter::BaseDecide(Ptr<const Packet> pkt, Ipv4Header const &ipHeader) {
 
     // Retrieve the source node id
@@ -53,6 +53,13 @@ public:
      */
     uint32_t ResolveNodeIdFromIp(uint32_t ip);
 
+    /**
+     * Estimate the heap memory of the IP to node identifier map (memory report).
+     *
+     * @return Estimated bytes
+     */
+    uint64_t EstimateIpToNodeIdMemoryBytes();
+
     /**
      * Base decide how to forward. Directly called by ipv4-arbiter-routing.
      * It does some nice pre-processing and checking and calls Decide() of the
@@ -20,6 +20,10 @@
  */
 
 #include "basic-simulation.h"
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <cstring>
 
 namespace ns3 {
 
@@ -52,6 +56,7 @@ BasicSimulation::BasicSimulation(std::string run_dir) {
     ReadConfig();
     ConfigureSimulation();
     PrepareBasicSimulationLogFiles();
+    ConfigureProgressStream();
     WriteFinished(false);
 }
 
@@ -167,6 +172,45 @@ void BasicSimulation::ConfigureSimulation() {
         m_systems_count = 1;
     }
 
+    // Event profiling wraps the (default) simulator implementation
+    m_enable_event_profiling = parse_boolean(GetConfigParamOrDefault("enable_event_profiling", "false"));
+    if (m_enable_event_profiling) {
+        if (m_enable_distributed) {
+            throw std::invalid_argument("Event profiling is not supported with distributed simulation");
+        }
+        GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::ProfilingSimulatorImpl"));
+        printf("  > Event profiling is enabled\n");
+    }
+
+    // Memory report of the structures the components register (written in Finalize)
+    m_enable_memory_report = parse_boolean(GetConfigParamOrDefault("enable_memory_report", "false"));
+    if (m_enable_memory_report) {
+        printf("  > Memory report is enabled\n");
+    }
+
+    // The progress stream reports the event queue size, which only a counting implementation knows
+    m_enable_progress_stream = parse_boolean(GetConfigParamOrDefault("enable_progress_stream", "false"));
+    if (m_enable_progress_stream && !m_enable_distributed && !m_enable_event_profiling) {
+        GlobalValue::Bind ("SimulatorImplementationType", StringValue ("ns3::CountingSimulatorImpl"));
+    }
+
+    // Event scheduler (the event queue of every simulator implementation)
+    std::string scheduler_type = GetConfigParamOrDefault("scheduler_type", "map");
+    if (scheduler_type == "map") {
+        GlobalValue::Bind ("SchedulerType", StringValue ("ns3::MapScheduler"));
+    } else if (scheduler_type == "heap") {
+        GlobalValue::Bind ("SchedulerType", StringValue ("ns3::HeapScheduler"));
+    } else if (scheduler_type == "list") {
+        GlobalValue::Bind ("SchedulerType", StringValue ("ns3::ListScheduler"));
+    } else if (scheduler_type == "calendar") {
+        GlobalValue::Bind ("SchedulerType", StringValue ("ns3::CalendarScheduler"));
+    } else if (scheduler_type == "ladder") {
+        GlobalValue::Bind ("SchedulerType", StringValue ("ns3::LadderScheduler"));
+    } else {
+        throw std::invalid_argument(format_string("Unknown scheduler type: %s", scheduler_type.c_str()));
+    }
+    printf("  > Scheduler type... %s\n", scheduler_type.c_str());
+
     // System information
     printf("  > System id........ %u\n", m_system_id);
     printf("  > No. of systems... %u\n", m_systems_count);
@@ -245,6 +289,133 @@ void BasicSimulation::ShowSimulationProgress() {
     Simulator::Schedule(Seconds(m_simulation_event_interval_s), &BasicSimulation::ShowSimulationProgress, this);
 }
 
+void BasicSimulation::ConfigureProgressStream() {
+    if (!m_enable_progress_stream) {
+        return;
+    }
+    std::cout << "CONFIGURE PROGRESS STREAM" << std::endl;
+
+    // Wallclock interval between two lines
+    m_progress_stream_interval_ns = parse_positive_int64(GetConfigParamOrDefault("progress_stream_interval_ns", "1000000000"));
+    if (m_progress_stream_interval_ns == 0) {
+        throw std::invalid_argument("Progress stream interval must be at least 1 ns");
+    }
+    printf("  > Interval......... %.2f s wallclock\n", m_progress_stream_interval_ns / 1e9);
+
+    // Target: a file in the logs directory, or "unix:<path>" for a (listening) UNIX stream socket
+    std::string target = GetConfigParamOrDefault("progress_stream_target", "file");
+    if (target == "file") {
+        std::string filename = m_logs_dir + (m_enable_distributed ? "/system_" + std::to_string(m_system_id) + "_progress.jsonl" : "/progress.jsonl");
+        m_progress_stream_file.open(filename);
+        if (!m_progress_stream_file) {
+            throw std::runtime_error(format_string("Could not open the progress stream file: %s", filename.c_str()));
+        }
+        printf("  > Target........... %s\n", filename.c_str());
+    } else if (target.rfind("unix:", 0) == 0) {
+        std::string path = target.substr(5);
+        struct sockaddr_un address;
+        if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+            throw std::invalid_argument(format_string("Invalid UNIX socket path of the progress stream: \"%s\"", path.c_str()));
+        }
+        memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+        m_progress_stream_socket = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (m_progress_stream_socket < 0 || connect(m_progress_stream_socket, (struct sockaddr*) &address, sizeof(address)) != 0) {
+            throw std::runtime_error(format_string("Could not connect to the progress stream socket: %s", path.c_str()));
+        }
+        printf("  > Target........... UNIX socket %s\n", path.c_str());
+    } else {
+        throw std::invalid_argument(format_string("Unknown progress stream target: %s", target.c_str()));
+    }
+    std::cout << std::endl;
+}
+
+void BasicSimulation::AddProgressStreamField(std::string name, Callback<double> getter) {
+    m_progress_stream_fields.push_back(std::make_pair(name, getter));
+}
+
+// Current resident set size (/proc/self/statm, in pages), -1 if unknown
+static double ResidentSetSizeMb() {
+    std::ifstream statm("/proc/self/statm");
+    int64_t size_pages, resident_pages;
+    if (statm >> size_pages >> resident_pages) {
+        return resident_pages * (sysconf(_SC_PAGESIZE) / 1048576.0);
+    }
+    return -1;
+}
+
+// Peak resident set size (ru_maxrss is in kilobytes on Linux)
+static double PeakResidentSetSizeMb() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss / 1024.0;
+}
+
+void BasicSimulation::WriteProgressStreamLine(bool finished) {
+    int64_t now = NowNsSinceEpoch();
+    double wallclock_s = (now - m_sim_start_time_ns_since_epoch) / 1e9;
+    double interval_wallclock_s = (now - m_last_progress_stream_time_ns_since_epoch) / 1e9;
+    uint64_t event_count = Simulator::GetEventCount();
+
+    // Only the counting simulator implementations know the size of their event queue
+    Ptr<CountingSimulatorImpl> counting_impl = DynamicCast<CountingSimulatorImpl>(Simulator::GetImplementation());
+
+    std::string line = format_string(
+            "{\"system_id\":%u,\"finished\":%s,\"simulation_time_s\":%.6f,\"progress\":%.6f,\"wallclock_time_s\":%.3f,"
+            "\"events\":%" PRIu64 ",\"events_per_s\":%.1f,\"event_queue_size\":%s,\"simulation_s_per_wallclock_s\":%.6f,"
+            "\"rss_mb\":%.1f,\"peak_rss_mb\":%.1f",
+            m_system_id,
+            finished ? "true" : "false",
+            Simulator::Now().GetSeconds(),
+            Simulator::Now().GetSeconds() / (m_simulation_end_time_ns / 1e9),
+            wallclock_s,
+            event_count,
+            interval_wallclock_s > 0 ? (event_count - m_last_progress_stream_event_count) / interval_wallclock_s : 0.0,
+            counting_impl != 0 ? std::to_string(counting_impl->GetEventQueueSize()).c_str() : "null",
+            interval_wallclock_s > 0 ? (Simulator::Now().GetSeconds() - m_last_progress_stream_simulation_s) / interval_wallclock_s : 0.0,
+            ResidentSetSizeMb(),
+            PeakResidentSetSizeMb()
+    );
+    for (std::pair<std::string, Callback<double>>& field : m_progress_stream_fields) {
+        line += format_string(",\"%s\":%.15g", field.first.c_str(), field.second());
+    }
+    line += "}\n";
+
+    // A closed socket (e.g., the orchestrator went away) ends the stream, not the simulation
+    if (m_progress_stream_socket >= 0) {
+        if (send(m_progress_stream_socket, line.c_str(), line.size(), MSG_NOSIGNAL) != (ssize_t) line.size()) {
+            std::cout << "Progress stream socket is closed, the progress stream is stopped" << std::endl;
+            close(m_progress_stream_socket);
+            m_progress_stream_socket = -1;
+            m_enable_progress_stream = false;
+        }
+    } else {
+        m_progress_stream_file << line << std::flush;
+    }
+
+    m_last_progress_stream_time_ns_since_epoch = now;
+    m_last_progress_stream_event_count = event_count;
+    m_last_progress_stream_simulation_s = Simulator::Now().GetSeconds();
+}
+
+void BasicSimulation::WriteProgressStream() {
+    if (!m_enable_progress_stream) {
+        return;
+    }
+    int64_t now = NowNsSinceEpoch();
+    if (now - m_last_progress_stream_time_ns_since_epoch >= m_progress_stream_interval_ns) {
+        WriteProgressStreamLine(false);
+    }
+
+    // As the progress, checked in simulation time such that the wallclock interval is met within +20%
+    // (no wallclock time elapsed yet: the rate is not known, the minimum interval is used)
+    double wallclock_s = (now - m_sim_start_time_ns_since_epoch) / 1e9;
+    double simulation_sec_per_wallclock_sec = wallclock_s > 0 ? Simulator::Now().GetSeconds() / wallclock_s : 0.0;
+    m_progress_stream_event_interval_s = std::max(1e-6, simulation_sec_per_wallclock_sec * (m_progress_stream_interval_ns / 1e9) / 5.0);
+    Simulator::Schedule(Seconds(m_progress_stream_event_interval_s), &BasicSimulation::WriteProgressStream, this);
+}
+
 void BasicSimulation::ConfirmAllConfigParamKeysRequested() {
     for (const std::pair<std::string, std::string>& key_val : m_config) {
         if (m_configRequestedKeys.find(key_val.first) == m_configRequestedKeys.end()) {
@@ -260,10 +431,22 @@ void BasicSimulation::Run() {
     // Before it starts to run, we need to have processed all the config
     ConfirmAllConfigParamKeysRequested();
 
+    // The setup is done, as such its structures are complete
+    if (m_enable_memory_report) {
+        m_memory_report_setup_bytes = EstimateMemoryReportEntries();
+        m_memory_report_setup_rss_mb = ResidentSetSizeMb();
+    }
+
     // Schedule progress printing
     m_sim_start_time_ns_since_epoch = NowNsSinceEpoch();
     m_last_log_time_ns_since_epoch = m_sim_start_time_ns_since_epoch;
     Simulator::Schedule(Seconds(m_simulation_event_interval_s), &BasicSimulation::ShowSimulationProgress, this);
+    if (m_enable_progress_stream) {
+        m_last_progress_stream_time_ns_since_epoch = m_sim_start_time_ns_since_epoch;
+        m_last_progress_stream_event_count = 0;
+        m_last_progress_stream_simulation_s = 0;
+        Simulator::Schedule(Seconds(m_progress_stream_event_interval_s), &BasicSimulation::WriteProgressStream, this);
+    }
 
     // Run
     printf("Running the simulation for %.2f simulation seconds...\n", (m_simulation_end_time_ns / 1e9));
@@ -271,12 +454,31 @@ void BasicSimulation::Run() {
     printf("Finished simulation.\n");
 
     // Print final duration
+    double wallclock_s = (NowNsSinceEpoch() - m_sim_start_time_ns_since_epoch) / 1e9;
     printf(
-            "Simulation of %.1f seconds took in wallclock time %.1f seconds.\n\n",
+            "Simulation of %.1f seconds took in wallclock time %.1f seconds.\n",
             m_simulation_end_time_ns / 1e9,
-            (NowNsSinceEpoch() - m_sim_start_time_ns_since_epoch) / 1e9
+            wallclock_s
+    );
+
+    // Event throughput and peak memory
+    printf(
+            "Executed %" PRIu64 " events (%.0f events per wallclock second), peak resident set size %.1f MB.\n\n",
+            Simulator::GetEventCount(),
+            wallclock_s > 0 ? Simulator::GetEventCount() / wallclock_s : 0.0,
+            PeakResidentSetSizeMb()
     );
 
+    // Last line of the progress stream
+    if (m_enable_progress_stream) {
+        WriteProgressStreamLine(true);
+        if (m_progress_stream_socket >= 0) {
+            close(m_progress_stream_socket);
+            m_progress_stream_socket = -1;
+        }
+        m_progress_stream_file.close();
+    }
+
     RegisterTimestamp("Run simulation");
 }
 
@@ -336,7 +538,76 @@ void BasicSimulation::StoreTimingResults() {
     std::cout << std::endl;
 }
 
+void BasicSimulation::WriteEventProfile() {
+    Ptr<ProfilingSimulatorImpl> profiling_impl = DynamicCast<ProfilingSimulatorImpl>(Simulator::GetImplementation());
+    if (profiling_impl == 0) {
+        throw std::runtime_error("Event profiling is enabled, but the simulator implementation is not ns3::ProfilingSimulatorImpl");
+    }
+    profiling_impl->WriteProfile(m_logs_dir + "/event_profile.csv", 10);
+    RegisterTimestamp("Write event profile");
+}
+
+void BasicSimulation::AddMemoryReportEntry(std::string name, Callback<uint64_t> estimate_bytes) {
+    m_memory_report_entries.push_back(std::make_pair(name, estimate_bytes));
+}
+
+std::vector<uint64_t> BasicSimulation::EstimateMemoryReportEntries() {
+    std::vector<uint64_t> bytes;
+    for (std::pair<std::string, Callback<uint64_t>>& entry : m_memory_report_entries) {
+        bytes.push_back(entry.second());
+    }
+    return bytes;
+}
+
+void BasicSimulation::WriteMemoryReport() {
+    std::cout << "MEMORY REPORT" << std::endl;
+    std::vector<uint64_t> finalize_bytes = EstimateMemoryReportEntries();
+    double finalize_rss_mb = ResidentSetSizeMb();
+
+    // Estimates of each structure, at the end of the setup and now
+    std::vector<std::string> lines;
+    lines.push_back(format_string("%-60s %14s %14s", "Structure (estimated heap memory)", "Setup end", "Finalize"));
+    lines.push_back(std::string(90, '-'));
+    uint64_t setup_total = 0;
+    uint64_t finalize_total = 0;
+    for (size_t i = 0; i < m_memory_report_entries.size(); i++) {
+        std::string setup = "-";    // added after the setup
+        if (i < m_memory_report_setup_bytes.size()) {
+            setup = format_string("%.3f MB", m_memory_report_setup_bytes[i] / 1048576.0);
+            setup_total += m_memory_report_setup_bytes[i];
+        }
+        finalize_total += finalize_bytes[i];
+        lines.push_back(format_string(
+                "%-60s %14s %11.3f MB", m_memory_report_entries[i].first.c_str(), setup.c_str(), finalize_bytes[i] / 1048576.0
+        ));
+    }
+    lines.push_back(std::string(90, '-'));
+    lines.push_back(format_string("%-60s %11.3f MB %11.3f MB", "Sum of the structures", setup_total / 1048576.0, finalize_total / 1048576.0));
+    lines.push_back(format_string("%-60s %11.3f MB %11.3f MB", "Other (ns-3 objects, packets in flight, code, allocator)",
+                                  m_memory_report_setup_rss_mb - setup_total / 1048576.0, finalize_rss_mb - finalize_total / 1048576.0));
+    lines.push_back(format_string("%-60s %11.3f MB %11.3f MB", "Resident set size", m_memory_report_setup_rss_mb, finalize_rss_mb));
+    lines.push_back(format_string("%-60s %14s %11.3f MB", "Peak resident set size", "", PeakResidentSetSizeMb()));
+
+    // memory_report.txt
+    std::string filename = m_logs_dir + (m_enable_distributed ? "/system_" + std::to_string(m_system_id) + "_memory_report.txt" : "/memory_report.txt");
+    std::ofstream file_txt(filename);
+    for (const std::string& line : lines) {
+        std::cout << "  " << line << std::endl;
+        file_txt << line << std::endl;
+    }
+    file_txt.close();
+    std::cout << "  > Written to: " << filename << std::endl;
+    std::cout << std::endl;
+    RegisterTimestamp("Write memory report");
+}
+
 void BasicSimulation::Finalize() {
+    if (m_enable_event_profiling) {
+        WriteEventProfile();
+    }
+    if (m_enable_memory_report) {
+        WriteMemoryReport();
+    }
     CleanUpSimulation();
     StoreTimingResults();
 
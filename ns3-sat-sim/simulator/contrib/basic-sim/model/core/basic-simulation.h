@@ -46,6 +46,8 @@
 #include "ns3/mpi-interface.h"
 
 #include "ns3/exp-util.h"
+#include "ns3/counting-simulator-impl.h"
+#include "ns3/profiling-simulator-impl.h"
 
 namespace ns3 {
 
@@ -74,6 +76,12 @@ public:
     std::string GetLogsDir();
     std::string GetRunDir();
 
+    // Additional field of the progress stream, e.g. the queued packets of a topology
+    void AddProgressStreamField(std::string name, Callback<double> getter);
+
+    // Estimated bytes held by a structure, reported at the end of the setup and in Finalize (enable_memory_report)
+    void AddMemoryReportEntry(std::string name, Callback<uint64_t> estimate_bytes);
+
 private:
 
     // Internal setup
@@ -83,10 +91,16 @@ private:
     void PrepareBasicSimulationLogFiles();
     void WriteFinished(bool finished);
     void ShowSimulationProgress();
+    void ConfigureProgressStream();
+    void WriteProgressStream();
+    void WriteProgressStreamLine(bool finished);
     void RunSimulation();
     void CleanUpSimulation();
     void ConfirmAllConfigParamKeysRequested();
     void StoreTimingResults();
+    void WriteEventProfile();
+    std::vector<uint64_t> EstimateMemoryReportEntries();
+    void WriteMemoryReport();
 
     // Timestamp to identify which parts take long
     int64_t NowNsSinceEpoch();
@@ -107,6 +121,9 @@ private:
     uint32_t m_system_id;
     uint32_t m_systems_count;
     bool m_enable_distributed;
+    bool m_enable_event_profiling;
+    bool m_enable_progress_stream;
+    bool m_enable_memory_report;
     std::vector<int64_t> m_distributed_node_system_id_assignment;
 
     // Progress show variables
@@ -116,6 +133,21 @@ private:
     double m_progress_interval_ns = 10000000000; // First one after 10s
     double m_simulation_event_interval_s = 0.1; // Start at 100ms for a reasonable estimate
 
+    // Progress stream variables (JSON lines to a file or a UNIX socket)
+    int64_t m_progress_stream_interval_ns;
+    std::ofstream m_progress_stream_file;
+    int m_progress_stream_socket = -1;
+    int64_t m_last_progress_stream_time_ns_since_epoch;
+    uint64_t m_last_progress_stream_event_count;
+    double m_last_progress_stream_simulation_s;
+    double m_progress_stream_event_interval_s = 0.1;
+    std::vector<std::pair<std::string, Callback<double>>> m_progress_stream_fields;
+
+    // Memory report variables
+    std::vector<std::pair<std::string, Callback<uint64_t>>> m_memory_report_entries;
+    std::vector<uint64_t> m_memory_report_setup_bytes;      // estimates at the end of the setup (start of Run)
+    double m_memory_report_setup_rss_mb;
+
 };
 
 }
@@ -0,0 +1,52 @@
+/**
+ * Author:  silent-rookie      2024
+*/
+
+#include "counting-simulator-impl.h"
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (CountingSimulatorImpl);
+
+TypeId CountingSimulatorImpl::GetTypeId (void)
+{
+    static TypeId tid = TypeId ("ns3::CountingSimulatorImpl")
+            .SetParent<DefaultSimulatorImpl> ()
+            .SetGroupName("BasicSim")
+            .AddConstructor<CountingSimulatorImpl> ()
+    ;
+    return tid;
+}
+
+CountingSimulatorImpl::CountingSimulatorImpl() : m_num_scheduled(0), m_num_removed(0) {
+
+}
+
+EventId CountingSimulatorImpl::Schedule (const Time &delay, EventImpl *event) {
+    m_num_scheduled++;
+    return DefaultSimulatorImpl::Schedule(delay, event);
+}
+
+void CountingSimulatorImpl::ScheduleWithContext (uint32_t context, const Time &delay, EventImpl *event) {
+    m_num_scheduled++;
+    DefaultSimulatorImpl::ScheduleWithContext(context, delay, event);
+}
+
+EventId CountingSimulatorImpl::ScheduleNow (EventImpl *event) {
+    m_num_scheduled++;
+    return DefaultSimulatorImpl::ScheduleNow(event);
+}
+
+void CountingSimulatorImpl::Remove (const EventId &id) {
+    // Destroy events are not in the event queue, and expired events already left it
+    if (id.GetUid () != EventId::UID::DESTROY && !IsExpired(id)) {
+        m_num_removed++;
+    }
+    DefaultSimulatorImpl::Remove(id);
+}
+
+uint64_t CountingSimulatorImpl::GetEventQueueSize (void) const {
+    return m_num_scheduled - m_num_removed - GetEventCount();
+}
+
+}
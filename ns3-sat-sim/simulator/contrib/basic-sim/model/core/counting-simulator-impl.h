@@ -0,0 +1,41 @@
+/**
+ * Author:  silent-rookie      2024
+*/
+
+#ifndef COUNTING_SIMULATOR_IMPL_H
+#define COUNTING_SIMULATOR_IMPL_H
+
+#include "ns3/default-simulator-impl.h"
+
+namespace ns3 {
+
+/**
+ * The default simulator implementation, which keeps track of the number of events in its
+ * event queue. Scheduled events are counted, executed (also cancelled) events are the
+ * event count of the simulator, and removed events are counted.
+ *
+ * Used by the progress stream of BasicSimulation (enable_progress_stream=true), not with
+ * distributed simulation.
+ */
+class CountingSimulatorImpl : public DefaultSimulatorImpl
+{
+public:
+    static TypeId GetTypeId (void);
+    CountingSimulatorImpl();
+
+    virtual EventId Schedule (const Time &delay, EventImpl *event);
+    virtual void ScheduleWithContext (uint32_t context, const Time &delay, EventImpl *event);
+    virtual EventId ScheduleNow (EventImpl *event);
+    virtual void Remove (const EventId &id);
+
+    // Number of events which are scheduled but not yet executed (destroy events excluded)
+    uint64_t GetEventQueueSize (void) const;
+
+private:
+    uint64_t m_num_scheduled;
+    uint64_t m_num_removed;
+};
+
+}
+
+#endif //COUNTING_SIMULATOR_IMPL_H
@@ -30,6 +30,8 @@
 #include <cinttypes>
 #include <vector>
 #include <set>
+#include <map>
+#include <unordered_map>
 #include <string>
 #include <regex>
 #include <cstring>
@@ -107,4 +109,19 @@ void remove_dir_if_exists(std::string dirname);
 void mkdir_if_not_exists(std::string dirname);
 std::vector<std::string> read_file_direct(const std::string& filename);
 
+// Memory estimates: heap bytes of a container itself, not those which its elements hold
+// (a tree node has a color and three pointers, a hash node a next pointer and the cached hash)
+template <typename T, typename A>
+uint64_t estimate_heap_bytes(const std::vector<T, A>& v) {
+    return v.capacity() * sizeof(T);
+}
+template <typename K, typename V, typename C, typename A>
+uint64_t estimate_heap_bytes(const std::map<K, V, C, A>& m) {
+    return m.size() * (sizeof(std::pair<const K, V>) + 4 * sizeof(void*));
+}
+template <typename K, typename V, typename H, typename E, typename A>
+uint64_t estimate_heap_bytes(const std::unordered_map<K, V, H, E, A>& m) {
+    return m.size() * (sizeof(std::pair<const K, V>) + 2 * sizeof(void*)) + m.bucket_count() * sizeof(void*);
+}
+
 #endif //EXP_UTIL_H
@@ -0,0 +1,69 @@
+#include "five-tuple-hasher.h"
+#include <cstring>
+
+namespace ns3 {
+
+/**
+ * Calculates a hash from the 5-tuple.
+ *
+ * Inspired by: https://github.com/mkheirkhah/ecmp (February 20th, 2020)
+ *
+ * @param header               IPv4 header
+ * @param p                    Packet
+ * @param node_id              Node identifier
+ * @param no_other_headers     True iff there are no other headers outside of the IPv4 one,
+ *                             irrespective of what the IP protocol field claims
+ *
+ * @return Hash value
+ */
+uint32_t
+FiveTupleHasher::Hash(const Ipv4Header &header, Ptr<const Packet> p, int32_t node_id, bool no_other_headers)
+{
+    uint8_t protocol = header.GetProtocol();
+    uint16_t src_port = 0;
+    uint16_t dst_port = 0;
+
+    // If we have been notified that whatever is in the protocol field,
+    // does not mean there is another header to peek at, we do not peek
+    if (!no_other_headers) {
+
+        // If there are ports we can use, add them to the input
+        switch (protocol) {
+            case UDP_PROT_NUMBER: {
+                UdpHeader udpHeader;
+                p->PeekHeader(udpHeader);
+                src_port = udpHeader.GetSourcePort();
+                dst_port = udpHeader.GetDestinationPort();
+                break;
+            }
+            case TCP_PROT_NUMBER: {
+                TcpHeader tcpHeader;
+                p->PeekHeader(tcpHeader);
+                src_port = tcpHeader.GetSourcePort();
+                dst_port = tcpHeader.GetDestinationPort();
+                break;
+            }
+            default: {
+                break;
+            }
+        }
+    }
+
+    return Hash(node_id, header.GetSource().Get(), header.GetDestination().Get(), protocol, src_port, dst_port);
+}
+
+uint32_t
+FiveTupleHasher::Hash(int32_t node_id, uint32_t src_ip, uint32_t dst_ip, uint8_t protocol, uint16_t src_port, uint16_t dst_port)
+{
+    std::memcpy(&m_hash_input_buff[0], &node_id, 4);
+    std::memcpy(&m_hash_input_buff[4], &src_ip, 4);
+    std::memcpy(&m_hash_input_buff[8], &dst_ip, 4);
+    std::memcpy(&m_hash_input_buff[12], &protocol, 1);
+    std::memcpy(&m_hash_input_buff[13], &src_port, 2);
+    std::memcpy(&m_hash_input_buff[15], &dst_port, 2);
+
+    m_hasher.clear();
+    return m_hasher.GetHash32(m_hash_input_buff, 17);
+}
+
+}
@@ -0,0 +1,38 @@
+#ifndef FIVE_TUPLE_HASHER_H
+#define FIVE_TUPLE_HASHER_H
+
+#include "ns3/hash.h"
+#include "ns3/packet.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/udp-header.h"
+#include "ns3/tcp-header.h"
+
+namespace ns3 {
+
+const uint8_t TCP_PROT_NUMBER = 6;
+const uint8_t UDP_PROT_NUMBER = 17;
+
+/**
+ * Hash of the 5-tuple of a packet (source and destination IP address, protocol, source and
+ * destination port), salted with a node identifier. Shared by the arbiters which pick the
+ * path of a packet per flow (e.g., ArbiterEcmp), such that all of them identify a flow the same way.
+ */
+class FiveTupleHasher
+{
+public:
+
+    // Hash of the 5-tuple of the packet (ports are 0 if there is no UDP or TCP header to peek at)
+    uint32_t Hash(const Ipv4Header &header, Ptr<const Packet> p, int32_t node_id, bool no_other_headers);
+
+    // Hash of a 5-tuple which is known without a packet
+    uint32_t Hash(int32_t node_id, uint32_t src_ip, uint32_t dst_ip, uint8_t protocol, uint16_t src_port, uint16_t dst_port);
+
+private:
+    char m_hash_input_buff[17];
+    ns3::Hasher m_hasher;
+
+};
+
+}
+
+#endif //FIVE_TUPLE_HASHER_H
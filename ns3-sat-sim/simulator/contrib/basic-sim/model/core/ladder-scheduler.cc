@@ -0,0 +1,207 @@
+/**
+ * Author:  silent-rookie      2024
+*/
+
+#include <algorithm>
+#include "ladder-scheduler.h"
+#include "ns3/abort.h"
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (LadderScheduler);
+
+TypeId LadderScheduler::GetTypeId (void)
+{
+    static TypeId tid = TypeId ("ns3::LadderScheduler")
+            .SetParent<Scheduler> ()
+            .SetGroupName("BasicSim")
+            .AddConstructor<LadderScheduler> ()
+    ;
+    return tid;
+}
+
+LadderScheduler::LadderScheduler () : m_top_start_ts(0), m_top_min_ts(0), m_top_max_ts(0), m_num_events(0) {
+
+}
+
+LadderScheduler::~LadderScheduler () {
+
+}
+
+void LadderScheduler::Insert (const Scheduler::Event &ev) {
+    m_num_events++;
+    uint64_t ts = ev.key.m_ts;
+
+    // Top
+    if (ts >= m_top_start_ts) {
+        if (m_top.empty()) {
+            m_top_min_ts = ts;
+            m_top_max_ts = ts;
+        } else {
+            m_top_min_ts = std::min(m_top_min_ts, ts);
+            m_top_max_ts = std::max(m_top_max_ts, ts);
+        }
+        m_top.push_back(ev);
+        return;
+    }
+
+    // Rungs, the first of which it is in the remaining buckets of
+    for (Rung& rung : m_rungs) {
+        if (ts >= rung.CurrentStartTs()) {
+            rung.buckets[(ts - rung.start_ts) / rung.bucket_width].push_back(ev);
+            rung.num_events++;
+            return;
+        }
+    }
+
+    // Bottom
+    InsertIntoBottom(ev);
+}
+
+bool LadderScheduler::IsEmpty (void) const {
+    return m_num_events == 0;
+}
+
+Scheduler::Event LadderScheduler::PeekNext (void) const {
+    NS_ABORT_MSG_IF(m_num_events == 0, "Cannot peek the next event of an empty scheduler");
+
+    // Filling the bottom does not change which events are in the scheduler
+    if (m_bottom.empty()) {
+        const_cast<LadderScheduler*>(this)->FillBottom();
+    }
+    return m_bottom.front();
+}
+
+Scheduler::Event LadderScheduler::RemoveNext (void) {
+    NS_ABORT_MSG_IF(m_num_events == 0, "Cannot remove the next event of an empty scheduler");
+    if (m_bottom.empty()) {
+        FillBottom();
+    }
+    Scheduler::Event ev = m_bottom.front();
+    m_bottom.pop_front();
+    m_num_events--;
+    return ev;
+}
+
+void LadderScheduler::Remove (const Scheduler::Event &ev) {
+    uint64_t ts = ev.key.m_ts;
+
+    // It is where Insert() would put it: events are only moved down together with
+    // the boundaries (top start, current buckets) they were placed by
+    bool removed = false;
+    if (ts >= m_top_start_ts) {
+        removed = RemoveFrom(m_top, ev);
+    } else {
+        bool in_rung = false;
+        for (Rung& rung : m_rungs) {
+            if (ts >= rung.CurrentStartTs()) {
+                removed = RemoveFrom(rung.buckets[(ts - rung.start_ts) / rung.bucket_width], ev);
+                if (removed) {
+                    rung.num_events--;
+                }
+                in_rung = true;
+                break;
+            }
+        }
+        if (!in_rung) {
+            std::deque<Scheduler::Event>::iterator it = std::lower_bound(m_bottom.begin(), m_bottom.end(), ev);
+            if (it != m_bottom.end() && it->key.m_uid == ev.key.m_uid) {
+                m_bottom.erase(it);
+                removed = true;
+            }
+        }
+    }
+    NS_ABORT_MSG_IF(!removed, "Event to remove is not in the ladder scheduler (uid " << ev.key.m_uid << ")");
+    m_num_events--;
+}
+
+void LadderScheduler::SpawnRung(std::vector<Scheduler::Event>& events, uint64_t start_ts, uint64_t range) {
+    uint64_t bucket_width = std::max((uint64_t) 1, (range + events.size() - 1) / events.size());
+    size_t num_buckets = (range + bucket_width - 1) / bucket_width;
+
+    Rung rung;
+    rung.start_ts = start_ts;
+    rung.bucket_width = bucket_width;
+    rung.current = 0;
+    rung.num_events = events.size();
+    rung.buckets.resize(num_buckets);
+    for (const Scheduler::Event& ev : events) {
+        rung.buckets[(ev.key.m_ts - start_ts) / bucket_width].push_back(ev);
+    }
+    m_rungs.push_back(std::move(rung));
+}
+
+void LadderScheduler::SortIntoBottom(std::vector<Scheduler::Event>& events) {
+    std::sort(events.begin(), events.end());
+    m_bottom.insert(m_bottom.end(), events.begin(), events.end());
+}
+
+void LadderScheduler::InsertIntoBottom(const Scheduler::Event &ev) {
+    m_bottom.insert(std::upper_bound(m_bottom.begin(), m_bottom.end(), ev), ev);
+}
+
+void LadderScheduler::FillBottom() {
+    while (true) {
+
+        // Without rungs, the next events are in the top
+        if (m_rungs.empty()) {
+            NS_ABORT_MSG_IF(m_top.empty(), "Ladder scheduler has no events left to fill the bottom with");
+            std::vector<Scheduler::Event> top;
+            top.swap(m_top);
+            m_top_start_ts = m_top_max_ts + 1;
+            if (top.size() <= BUCKET_THRESHOLD || m_top_min_ts == m_top_max_ts) {
+                SortIntoBottom(top);
+                return;
+            }
+            SpawnRung(top, m_top_min_ts, m_top_max_ts - m_top_min_ts + 1);
+        }
+
+        // Next non-empty bucket of the finest rung
+        Rung& rung = m_rungs.back();
+        if (rung.num_events == 0) {
+            m_rungs.pop_back();
+            continue;
+        }
+        while (rung.buckets[rung.current].empty()) {
+            rung.current++;
+        }
+        size_t bucket_index = rung.current;
+        rung.current++;
+        std::vector<Scheduler::Event> bucket;
+        bucket.swap(rung.buckets[bucket_index]);
+        rung.num_events -= bucket.size();
+
+        // A large bucket is spread over a finer rung, unless it cannot be split
+        if (bucket.size() > BUCKET_THRESHOLD && m_rungs.size() < MAX_RUNGS
+                && rung.bucket_width > 1 && !AllSameTimestamp(bucket)) {
+            uint64_t bucket_start_ts = rung.start_ts + bucket_index * rung.bucket_width;
+            SpawnRung(bucket, bucket_start_ts, rung.bucket_width);
+        } else {
+            SortIntoBottom(bucket);
+            return;
+        }
+
+    }
+}
+
+bool LadderScheduler::AllSameTimestamp(const std::vector<Scheduler::Event>& events) {
+    for (const Scheduler::Event& ev : events) {
+        if (ev.key.m_ts != events[0].key.m_ts) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool LadderScheduler::RemoveFrom(std::vector<Scheduler::Event>& events, const Scheduler::Event &ev) {
+    for (size_t i = 0; i < events.size(); i++) {
+        if (events[i].key.m_uid == ev.key.m_uid) {
+            events[i] = events.back();
+            events.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+}
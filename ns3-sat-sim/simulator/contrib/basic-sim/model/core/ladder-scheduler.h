@@ -0,0 +1,84 @@
+/**
+ * Author:  silent-rookie      2024
+*/
+
+#ifndef LADDER_SCHEDULER_H
+#define LADDER_SCHEDULER_H
+
+#include <vector>
+#include <deque>
+#include "ns3/scheduler.h"
+
+namespace ns3 {
+
+/**
+ * Ladder queue event scheduler (Tang, Goh and Thng, "Ladder queue: An O(1) priority
+ * queue structure for large-scale discrete event simulation", 2005).
+ *
+ * Newly scheduled events are appended to the unsorted top. When the sorted bottom runs
+ * empty, the top is spread over the buckets of a rung, and the first non-empty bucket of
+ * the lowest rung is either spread over a new, finer rung (if it has more than
+ * BUCKET_THRESHOLD events) or sorted into the bottom. Scheduling and removing the next
+ * event are as such amortized O(1) for the periodic workloads of the simulations.
+ *
+ * Periodic events cluster at equal timestamps (e.g., the same tick of every node), which
+ * no rung can split: a bucket (or top) of which all events have the same timestamp is
+ * sorted into the bottom directly, instead of spawning rungs until the maximum.
+ *
+ * Selected with scheduler_type=ladder (BasicSimulation).
+ */
+class LadderScheduler : public Scheduler
+{
+public:
+    static TypeId GetTypeId (void);
+    LadderScheduler ();
+    virtual ~LadderScheduler ();
+
+    virtual void Insert (const Scheduler::Event &ev);
+    virtual bool IsEmpty (void) const;
+    virtual Scheduler::Event PeekNext (void) const;
+    virtual Scheduler::Event RemoveNext (void);
+    virtual void Remove (const Scheduler::Event &ev);
+
+private:
+    static const size_t BUCKET_THRESHOLD = 50;      // more events in a bucket are spread over a new rung
+    static const size_t MAX_RUNGS = 8;              // at most that many rungs, else a bucket is sorted anyway
+
+    struct Rung {
+        uint64_t start_ts;                                  // timestamp of the start of the first bucket
+        uint64_t bucket_width;                              // timestamps per bucket (at least 1)
+        size_t current;                                     // buckets before it are already taken
+        size_t num_events;
+        std::vector<std::vector<Scheduler::Event>> buckets;
+
+        uint64_t CurrentStartTs() const {
+            return start_ts + current * bucket_width;
+        }
+    };
+
+    void SpawnRung(std::vector<Scheduler::Event>& events, uint64_t start_ts, uint64_t range);
+    void SortIntoBottom(std::vector<Scheduler::Event>& events);
+    void InsertIntoBottom(const Scheduler::Event &ev);
+    void FillBottom();
+    static bool AllSameTimestamp(const std::vector<Scheduler::Event>& events);
+    static bool RemoveFrom(std::vector<Scheduler::Event>& events, const Scheduler::Event &ev);
+
+    // Top: unsorted events at or after m_top_start_ts
+    std::vector<Scheduler::Event> m_top;
+    uint64_t m_top_start_ts;
+    uint64_t m_top_min_ts;
+    uint64_t m_top_max_ts;
+
+    // Rungs: the first is the coarsest, the last the finest. Each one spans the
+    // bucket of the rung before it which it was spawned from
+    std::vector<Rung> m_rungs;
+
+    // Bottom: sorted events, before the current bucket of the last rung
+    std::deque<Scheduler::Event> m_bottom;
+
+    size_t m_num_events;
+};
+
+}
+
+#endif //LADDER_SCHEDULER_H
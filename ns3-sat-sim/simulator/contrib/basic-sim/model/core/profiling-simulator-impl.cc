@@ -0,0 +1,156 @@
+/**
+ * Author:  silent-rookie      2024
+*/
+
+#include "profiling-simulator-impl.h"
+#include <chrono>
+#include <fstream>
+#include <algorithm>
+#include <map>
+#include <cxxabi.h>
+#include "ns3/exp-util.h"
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (ProfilingSimulatorImpl);
+
+/**
+ * Executes the wrapped event and reports its wall time. It owns the reference
+ * of the wrapped event which the scheduler would otherwise release.
+ */
+class ProfiledEventImpl : public EventImpl
+{
+public:
+    ProfiledEventImpl(EventImpl* event, const char* label, ProfilingSimulatorImpl* simulator) : m_event(event), m_label(label), m_simulator(simulator) {}
+    virtual ~ProfiledEventImpl() {
+        m_event->Unref();
+    }
+
+protected:
+    virtual void Notify (void) {
+        auto start = std::chrono::steady_clock::now();
+        m_event->Invoke();
+        int64_t wall_time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        m_simulator->RecordEvent(typeid(*m_event), m_label, wall_time_ns);
+    }
+
+private:
+    EventImpl* m_event;
+    const char* m_label;
+    ProfilingSimulatorImpl* m_simulator;
+};
+
+TypeId ProfilingSimulatorImpl::GetTypeId (void)
+{
+    static TypeId tid = TypeId ("ns3::ProfilingSimulatorImpl")
+            .SetParent<CountingSimulatorImpl> ()
+            .SetGroupName("BasicSim")
+            .AddConstructor<ProfilingSimulatorImpl> ()
+    ;
+    return tid;
+}
+
+ProfilingSimulatorImpl::ProfilingSimulatorImpl() {
+    m_next_label = nullptr;
+}
+
+void ProfilingSimulatorImpl::LabelNextEvent(const char* label) {
+    m_next_label = label;
+}
+
+EventImpl* ProfilingSimulatorImpl::Wrap(EventImpl* event) {
+    const char* label = m_next_label;
+    m_next_label = nullptr;
+    return new ProfiledEventImpl(event, label, this);
+}
+
+EventId ProfilingSimulatorImpl::Schedule (const Time &delay, EventImpl *event) {
+    return CountingSimulatorImpl::Schedule(delay, Wrap(event));
+}
+
+void ProfilingSimulatorImpl::ScheduleWithContext (uint32_t context, const Time &delay, EventImpl *event) {
+    CountingSimulatorImpl::ScheduleWithContext(context, delay, Wrap(event));
+}
+
+EventId ProfilingSimulatorImpl::ScheduleNow (EventImpl *event) {
+    return CountingSimulatorImpl::ScheduleNow(Wrap(event));
+}
+
+void ProfilingSimulatorImpl::RecordEvent(const std::type_info& type, const char* label, int64_t wall_time_ns) {
+    EventTypeProfile& profile = m_profile[std::make_pair(std::type_index(type), label)];
+    profile.count += 1;
+    profile.total_wall_time_ns += wall_time_ns;
+}
+
+std::string ProfilingSimulatorImpl::EventTypeName(const char* mangled_name) {
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(mangled_name, nullptr, nullptr, &status);
+    std::string name = status == 0 ? std::string(demangled) : std::string(mangled_name);
+    free(demangled);
+
+    // The events are local classes of MakeEvent<callback type, ...>(...), the callback type identifies them
+    size_t start = name.find("MakeEvent<");
+    if (start != std::string::npos) {
+        start += std::string("MakeEvent<").size();
+        int depth = 0;
+        size_t end = start;
+        for (; end < name.size(); end++) {
+            char c = name[end];
+            if (c == '<' || c == '(') {
+                depth++;
+            } else if (c == '>' || c == ')') {
+                if (depth == 0) break;
+                depth--;
+            } else if (c == ',' && depth == 0) {
+                break;
+            }
+        }
+        name = name.substr(start, end - start);
+    }
+    return name;
+}
+
+void ProfilingSimulatorImpl::WriteProfile(std::string filename, size_t num_console_lines) {
+
+    // Events made of the same callback type (with other argument types) are one event type,
+    // labeled events are one per label
+    std::map<std::string, EventTypeProfile> merged;
+    int64_t total_wall_time_ns = 0;
+    for (const auto& entry : m_profile) {
+        EventTypeProfile& profile = merged[entry.first.second != nullptr ? std::string(entry.first.second) : EventTypeName(entry.first.first.name())];
+        profile.count += entry.second.count;
+        profile.total_wall_time_ns += entry.second.total_wall_time_ns;
+        total_wall_time_ns += entry.second.total_wall_time_ns;
+    }
+
+    // Sort by cumulative wall time
+    std::vector<std::pair<std::string, EventTypeProfile>> profile(merged.begin(), merged.end());
+    std::sort(profile.begin(), profile.end(), [](const std::pair<std::string, EventTypeProfile>& a, const std::pair<std::string, EventTypeProfile>& b) {
+        return a.second.total_wall_time_ns > b.second.total_wall_time_ns;
+    });
+
+    // event_profile.csv
+    std::ofstream ofs(filename);
+    for (const auto& entry : profile) {
+        ofs << "\"" << entry.first << "\"," << entry.second.count << "," << entry.second.total_wall_time_ns << ","
+            << format_string("%.1f,%.6f", (double) entry.second.total_wall_time_ns / entry.second.count,
+                             total_wall_time_ns > 0 ? (double) entry.second.total_wall_time_ns / total_wall_time_ns : 0.0)
+            << std::endl;
+    }
+    ofs.close();
+
+    // Console summary
+    std::cout << "EVENT PROFILE" << std::endl;
+    printf("  > Event wall time........ %.1f s\n", total_wall_time_ns / 1e9);
+    for (size_t i = 0; i < std::min(num_console_lines, profile.size()); i++) {
+        printf("  > %5.1f%% %12" PRIu64 " x %8.0f ns :: %s\n",
+               total_wall_time_ns > 0 ? 100.0 * profile[i].second.total_wall_time_ns / total_wall_time_ns : 0.0,
+               profile[i].second.count,
+               (double) profile[i].second.total_wall_time_ns / profile[i].second.count,
+               profile[i].first.c_str());
+    }
+    printf("  > Full profile written to: %s\n", filename.c_str());
+    std::cout << std::endl;
+}
+
+}
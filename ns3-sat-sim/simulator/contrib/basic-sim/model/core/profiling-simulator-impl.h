@@ -0,0 +1,87 @@
+/**
+ * Author:  silent-rookie      2024
+*/
+
+#ifndef PROFILING_SIMULATOR_IMPL_H
+#define PROFILING_SIMULATOR_IMPL_H
+
+#include <string>
+#include <utility>
+#include <vector>
+#include <typeindex>
+#include <unordered_map>
+#include "ns3/counting-simulator-impl.h"
+#include "ns3/event-impl.h"
+#include "ns3/simulator.h"
+
+namespace ns3 {
+
+/**
+ * The (counting) default simulator implementation, which keeps for each type of scheduled event
+ * the number of executed events and their cumulative wall time.
+ *
+ * Each scheduled event is wrapped in an event which times its execution. The type of
+ * an event is the type of the callback it was made of (MakeEvent), e.g. the member function
+ * signature "void (ns3::GSLNetDevice::*)(ns3::Ptr<ns3::Packet>)": member functions of the
+ * same class with the same signature share a type, unless they are scheduled with a label
+ * (ScheduleLabeled).
+ *
+ * Enabled with enable_event_profiling=true (BasicSimulation), not with distributed simulation.
+ */
+class ProfilingSimulatorImpl : public CountingSimulatorImpl
+{
+public:
+    static TypeId GetTypeId (void);
+    ProfilingSimulatorImpl();
+
+    virtual EventId Schedule (const Time &delay, EventImpl *event);
+    virtual void ScheduleWithContext (uint32_t context, const Time &delay, EventImpl *event);
+    virtual EventId ScheduleNow (EventImpl *event);
+
+    // The next scheduled event is profiled under the label instead of its callback type,
+    // the label must be a string literal (it is kept as pointer)
+    void LabelNextEvent(const char* label);
+
+    // Called by the wrapping event after the execution of the event
+    void RecordEvent(const std::type_info& type, const char* label, int64_t wall_time_ns);
+
+    /**
+     * Writes the profile (sorted by cumulative wall time), with line format:
+     * [event type],[count],[total wall time (ns)],[mean wall time (ns)],[share of the event wall time]
+     */
+    void WriteProfile(std::string filename, size_t num_console_lines);
+
+private:
+    struct EventTypeProfile {
+        uint64_t count;
+        int64_t total_wall_time_ns;
+    };
+    typedef std::pair<std::type_index, const char*> EventTypeKey;     // callback type and label
+    struct EventTypeKeyHash {
+        size_t operator()(const EventTypeKey& key) const {
+            return std::hash<std::type_index>()(key.first) ^ std::hash<const char*>()(key.second);
+        }
+    };
+    EventImpl* Wrap(EventImpl* event);
+    static std::string EventTypeName(const char* mangled_name);
+
+    const char* m_next_label;
+    std::unordered_map<EventTypeKey, EventTypeProfile, EventTypeKeyHash> m_profile;
+};
+
+/**
+ * Simulator::Schedule() of a member function, profiled under the label (a string literal)
+ * if event profiling is enabled, e.g. for member functions of the same class with the same signature.
+ */
+template <typename MEM, typename OBJ, typename... Ts>
+EventId ScheduleLabeled(const char* label, const Time& delay, MEM mem_ptr, OBJ obj, Ts... args) {
+    Ptr<ProfilingSimulatorImpl> profiling_impl = DynamicCast<ProfilingSimulatorImpl>(Simulator::GetImplementation());
+    if (profiling_impl != 0) {
+        profiling_impl->LabelNextEvent(label);
+    }
+    return Simulator::Schedule(delay, mem_ptr, obj, args...);
+}
+
+}
+
+#endif //PROFILING_SIMULATOR_IMPL_H
@@ -9,6 +9,7 @@
 #include "ptop-link-queue-test.h"
 #include "tcp-optimizer-test.h"
 #include "log-update-helper-test.h"
+#include "ladder-scheduler-test.h"
 
 using namespace ns3;
 
@@ -54,6 +55,11 @@ public:
         AddTestCase(new TcpOptimizerBasicTestCase, TestCase::QUICK);
         AddTestCase(new TcpOptimizerWorstCaseRttTestCase, TestCase::QUICK);
 
+        // Ladder queue event scheduler
+        AddTestCase(new LadderSchedulerEqualTimestampsTestCase, TestCase::QUICK);
+        AddTestCase(new LadderSchedulerRungsTestCase, TestCase::QUICK);
+        AddTestCase(new LadderSchedulerRemoveTestCase, TestCase::QUICK);
+
     }
 };
 static BasicSimTestSuite basicSimTestSuite;
@@ -0,0 +1,213 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include <random>
+#include <vector>
+
+#include "ns3/basic-simulation.h"
+#include "ns3/ladder-scheduler.h"
+#include "ns3/map-scheduler.h"
+#include "ns3/test.h"
+#include "../test-helpers.h"
+
+using namespace ns3;
+
+////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Runs the same inserts and removes on a ladder and a map scheduler, the next event of
+ * both must always be the same (the same timestamp, and among equal timestamps the same uid).
+ */
+class LadderSchedulerTestCase : public TestCase
+{
+public:
+    LadderSchedulerTestCase (std::string name) : TestCase (name), m_next_uid(4), m_now_ts(0) {};
+
+    void Setup () {
+        m_ladder = CreateObject<LadderScheduler>();
+        m_map = CreateObject<MapScheduler>();
+        m_next_uid = 4;
+        m_now_ts = 0;
+        m_scheduled.clear();
+    }
+
+    Scheduler::Event Insert (uint64_t ts) {
+        Scheduler::Event ev;
+        ev.impl = nullptr;
+        ev.key.m_ts = ts;
+        ev.key.m_uid = m_next_uid++;
+        ev.key.m_context = 0;
+        m_ladder->Insert(ev);
+        m_map->Insert(ev);
+        m_scheduled.push_back(ev);
+        return ev;
+    }
+
+    void Remove (const Scheduler::Event& ev) {
+        m_ladder->Remove(ev);
+        m_map->Remove(ev);
+    }
+
+    void RemoveNext () {
+        ASSERT_EQUAL(m_ladder->IsEmpty(), m_map->IsEmpty());
+        Scheduler::Event peeked = m_ladder->PeekNext();
+        Scheduler::Event ev = m_ladder->RemoveNext();
+        Scheduler::Event expected = m_map->RemoveNext();
+        ASSERT_EQUAL(peeked.key.m_uid, ev.key.m_uid);
+        ASSERT_EQUAL(ev.key.m_ts, expected.key.m_ts);
+        ASSERT_EQUAL(ev.key.m_uid, expected.key.m_uid);
+        m_now_ts = ev.key.m_ts;
+    }
+
+    void RemoveAll () {
+        while (!m_map->IsEmpty()) {
+            RemoveNext();
+        }
+        ASSERT_TRUE(m_ladder->IsEmpty());
+    }
+
+protected:
+    Ptr<LadderScheduler> m_ladder;
+    Ptr<MapScheduler> m_map;
+    uint32_t m_next_uid;
+    uint64_t m_now_ts;
+    std::vector<Scheduler::Event> m_scheduled;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////
+
+class LadderSchedulerEqualTimestampsTestCase : public LadderSchedulerTestCase
+{
+public:
+    LadderSchedulerEqualTimestampsTestCase () : LadderSchedulerTestCase ("ladder-scheduler equal-timestamps") {};
+    void DoRun () {
+        std::mt19937_64 rng(123456789);
+
+        // All the same timestamp (the top is sorted directly), in the order of their uid
+        Setup();
+        for (int i = 0; i < 500; i++) {
+            Insert(1000);
+        }
+        RemoveAll();
+
+        // A few timestamps, each shared by many events (buckets which cannot be split),
+        // and events of the current timestamp scheduled while it is processed
+        Setup();
+        for (int i = 0; i < 2000; i++) {
+            Insert(1000 * (1 + rng() % 4));
+        }
+        while (!m_map->IsEmpty()) {
+            RemoveNext();
+            if (rng() % 4 == 0) {
+                Insert(m_now_ts);
+            }
+        }
+        ASSERT_TRUE(m_ladder->IsEmpty());
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////////////
+
+class LadderSchedulerRungsTestCase : public LadderSchedulerTestCase
+{
+public:
+    LadderSchedulerRungsTestCase () : LadderSchedulerTestCase ("ladder-scheduler rungs") {};
+    void DoRun () {
+        std::mt19937_64 rng(123456789);
+
+        // A far outlier makes the buckets of the first rung wide, the dense clusters in its first
+        // bucket then spawn finer rungs (each bucket of more than 50 events), down to the maximum
+        Setup();
+        Insert(0);
+        Insert(1000000000);
+        for (int i = 0; i < 5000; i++) {
+            Insert(1000 + rng() % 1000);
+        }
+        for (int i = 0; i < 5000; i++) {
+            Insert(500000 + rng() % 10);
+        }
+        for (int i = 0; i < 200; i++) {
+            Insert(700000);
+        }
+
+        // Events are scheduled in the future of the current one while the rungs are taken:
+        // into the bottom, the remaining buckets of each rung and the top
+        for (int i = 0; i < 20000; i++) {
+            RemoveNext();
+            if (i % 3 == 0) {
+                Insert(m_now_ts + rng() % 1000);
+            } else if (i % 3 == 1) {
+                Insert(m_now_ts + rng() % 2000000000);
+            }
+        }
+        RemoveAll();
+
+        // Periodic workload: every node schedules its next tick at a fixed interval
+        Setup();
+        for (int node = 0; node < 1000; node++) {
+            Insert(node);
+        }
+        for (int i = 0; i < 50000; i++) {
+            RemoveNext();
+            Insert(m_now_ts + 100000);
+        }
+        RemoveAll();
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////////////
+
+class LadderSchedulerRemoveTestCase : public LadderSchedulerTestCase
+{
+public:
+    LadderSchedulerRemoveTestCase () : LadderSchedulerTestCase ("ladder-scheduler remove") {};
+    void DoRun () {
+        std::mt19937_64 rng(123456789);
+        Setup();
+        for (int i = 0; i < 5000; i++) {
+            Insert(rng() % 10000000);
+        }
+
+        // Removed from wherever they are (top, rungs or bottom), the order of the rest stays the same
+        for (int i = 0; i < 20000 && !m_map->IsEmpty(); i++) {
+            if (rng() % 2 == 0) {
+                Scheduler::Event ev = m_ladder->PeekNext();
+                RemoveNext();
+                Mark(ev.key.m_uid);
+            } else {
+                Scheduler::Event ev = m_scheduled[rng() % m_scheduled.size()];
+                if (!IsMarked(ev.key.m_uid) && ev.key.m_ts >= m_now_ts) {
+                    Remove(ev);
+                    Mark(ev.key.m_uid);
+                }
+            }
+            if (rng() % 3 == 0) {
+                Insert(m_now_ts + rng() % 10000000);
+            }
+        }
+        RemoveAll();
+
+        // The only event
+        Setup();
+        Scheduler::Event ev = Insert(10);
+        Remove(ev);
+        ASSERT_TRUE(m_ladder->IsEmpty());
+        Insert(20);
+        RemoveAll();
+    }
+
+private:
+    void Mark (uint32_t uid) {
+        if (m_removed.size() <= uid) {
+            m_removed.resize(uid + 1, false);
+        }
+        m_removed[uid] = true;
+    }
+
+    bool IsMarked (uint32_t uid) {
+        return uid < m_removed.size() && m_removed[uid];
+    }
+
+    std::vector<bool> m_removed;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,558 @@
+/**
+ * Author:  silent-rookie      2024
+*/
+
+/**
+ * Microbenchmarks of the hot paths of the satellite network simulation:
+ * the routing decisions of the arbiters, the detour update tick, the satellite
+ * positions, the GSL channel, the forwarding state update, the UDP burst emission
+ * and the event schedulers.
+ *
+ * By default the topology is a synthetic Walker-delta constellation (plus-grid ISLs,
+ * ground stations spread over the covered latitudes, GEO satellites evenly spaced over
+ * the equator) of configurable size, of which the routes are calculated in the simulator.
+ * With --satellite_network_dir and --satellite_network_routes_dir (relative to the work
+ * directory) a generated satellite network and its precomputed routes are used instead.
+ *
+ * The results are written in the JSON format of Google Benchmark, such that they can be
+ * compared with its tools (e.g. compare.py).
+ */
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <ctime>
+#include <functional>
+#include <cinttypes>
+#include <unistd.h>
+
+#include "ns3/basic-simulation.h"
+#include "ns3/scheduler.h"
+#include "ns3/object-factory.h"
+#include "ns3/udp-burst-scheduler.h"
+#include "ns3/topology-satellite-network.h"
+#include "ns3/ipv4-arbiter-routing-helper.h"
+#include "ns3/arbiter-leo-gs-geo-helper.h"
+#include "ns3/arbiter-traffic-classify-helper.h"
+#include "ns3/gsl-channel.h"
+#include "ns3/gsl-net-device.h"
+#include "ns3/walker-constellation-helper.h"
+#include "ns3/from-tag.h"
+#include "ns3/flow-tos-tag.h"
+
+using namespace ns3;
+
+/**
+ * Exposes the forwarding state update of the helper to the benchmarks.
+ */
+class BenchArbiterLEOGSGEOHelper : public ArbiterLEOGSGEOHelper
+{
+public:
+    BenchArbiterLEOGSGEOHelper(Ptr<BasicSimulation> basicSimulation, Ptr<TopologySatelliteNetwork> topology)
+            : ArbiterLEOGSGEOHelper(basicSimulation, topology) {}
+
+    using ArbiterLEOGSGEOHelper::UpdateForwardingState;
+    using ArbiterLEOGSGEOHelper::UpdateForwardingStateFromRoutingEngine;
+};
+
+struct BenchmarkResult {
+    std::string name;
+    int64_t iterations;
+    double real_time_ns;        // per iteration
+    double cpu_time_ns;         // per iteration
+    double items_per_second;
+};
+
+/**
+ * Runs each benchmark with an increasing number of iterations until it takes at
+ * least min_time_s (like Google Benchmark). The body runs the given number of
+ * iterations and returns the number of items it processed.
+ */
+class BenchmarkRunner
+{
+public:
+    BenchmarkRunner(double min_time_s, std::string filter) : m_min_time_s(min_time_s), m_filter(filter) {}
+
+    void Run(std::string name, std::function<int64_t(int64_t)> body, int64_t max_iterations = 1000000000) {
+        if (m_filter != "" && name.find(m_filter) == std::string::npos) {
+            return;
+        }
+        int64_t iterations = 1;
+        while (true) {
+            auto real_start = std::chrono::steady_clock::now();
+            std::clock_t cpu_start = std::clock();
+            int64_t items = body(iterations);
+            double cpu_s = (double) (std::clock() - cpu_start) / CLOCKS_PER_SEC;
+            double real_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - real_start).count();
+            if (real_s >= m_min_time_s || iterations >= max_iterations) {
+                Add(name, iterations, real_s, cpu_s, items);
+                return;
+            }
+
+            // Aim for the minimum time with some margin, at most ten times as many
+            double multiplier = real_s > 0 ? 1.4 * m_min_time_s / real_s : 10.0;
+            int64_t next = (int64_t) (iterations * std::min(10.0, std::max(2.0, multiplier)));
+            iterations = std::min(max_iterations, next);
+        }
+    }
+
+    // A benchmark which can only be run once (e.g., it runs the simulation)
+    void RunOnce(std::string name, std::function<int64_t()> body) {
+        if (m_filter != "" && name.find(m_filter) == std::string::npos) {
+            return;
+        }
+        auto real_start = std::chrono::steady_clock::now();
+        std::clock_t cpu_start = std::clock();
+        int64_t items = body();
+        double cpu_s = (double) (std::clock() - cpu_start) / CLOCKS_PER_SEC;
+        double real_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - real_start).count();
+        Add(name, 1, real_s, cpu_s, items);
+    }
+
+    bool IsSelected(std::string prefix) {
+        return m_filter == "" || prefix.find(m_filter) != std::string::npos || m_filter.find(prefix) != std::string::npos;
+    }
+
+    void WriteJson(std::string filename, const std::vector<std::pair<std::string, std::string>>& context) {
+        std::ofstream ofs(filename);
+        if (!ofs) {
+            throw std::runtime_error("Could not open benchmark output file: " + filename);
+        }
+        ofs << "{" << std::endl;
+        ofs << "  \"context\": {" << std::endl;
+        for (size_t i = 0; i < context.size(); i++) {
+            ofs << "    \"" << context[i].first << "\": " << context[i].second << (i + 1 < context.size() ? "," : "") << std::endl;
+        }
+        ofs << "  }," << std::endl;
+        ofs << "  \"benchmarks\": [" << std::endl;
+        for (size_t i = 0; i < m_results.size(); i++) {
+            const BenchmarkResult& r = m_results[i];
+            ofs << "    {" << std::endl;
+            ofs << "      \"name\": \"" << r.name << "\"," << std::endl;
+            ofs << "      \"run_name\": \"" << r.name << "\"," << std::endl;
+            ofs << "      \"run_type\": \"iteration\"," << std::endl;
+            ofs << "      \"iterations\": " << r.iterations << "," << std::endl;
+            ofs << "      \"real_time\": " << format_string("%.3f", r.real_time_ns) << "," << std::endl;
+            ofs << "      \"cpu_time\": " << format_string("%.3f", r.cpu_time_ns) << "," << std::endl;
+            ofs << "      \"time_unit\": \"ns\"," << std::endl;
+            ofs << "      \"items_per_second\": " << format_string("%.3f", r.items_per_second) << std::endl;
+            ofs << "    }" << (i + 1 < m_results.size() ? "," : "") << std::endl;
+        }
+        ofs << "  ]" << std::endl;
+        ofs << "}" << std::endl;
+    }
+
+private:
+    void Add(std::string name, int64_t iterations, double real_s, double cpu_s, int64_t items) {
+        BenchmarkResult r;
+        r.name = name;
+        r.iterations = iterations;
+        r.real_time_ns = real_s * 1e9 / iterations;
+        r.cpu_time_ns = cpu_s * 1e9 / iterations;
+        r.items_per_second = real_s > 0 ? items / real_s : 0;
+        m_results.push_back(r);
+        printf("  > %-40s %12" PRId64 " it %14.1f ns/it %14.1f ns cpu/it %16.1f items/s\n",
+               name.c_str(), iterations, r.real_time_ns, r.cpu_time_ns, r.items_per_second);
+    }
+
+    double m_min_time_s;
+    std::string m_filter;
+    std::vector<BenchmarkResult> m_results;
+};
+
+// Keeps the compiler from optimizing away the result of a benchmarked call
+template <typename T>
+inline void DoNotOptimize(T const& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+// Run directory
+
+void WriteConfig(std::string work_dir, std::string satellite_network_dir, std::string satellite_network_routes_dir,
+                 std::string routing_engine, int64_t simulation_end_time_ns, int64_t dynamic_state_update_interval_ns) {
+    std::ofstream ofs(work_dir + "/config_ns3.properties");
+    ofs << "simulation_end_time_ns=" << simulation_end_time_ns << std::endl;
+    ofs << "simulation_seed=123456789" << std::endl;
+    ofs << std::endl;
+    ofs << "satellite_network_dir=\"" << satellite_network_dir << "\"" << std::endl;
+    ofs << "satellite_network_routes_dir=\"" << satellite_network_routes_dir << "\"" << std::endl;
+    ofs << "dynamic_state_update_interval_ns=" << dynamic_state_update_interval_ns << std::endl;
+    ofs << "routing_engine=" << routing_engine << std::endl;
+    ofs << std::endl;
+    ofs << "isl_data_rate_megabit_per_s=10.0" << std::endl;
+    ofs << "gsl_data_rate_megabit_per_s=10.0" << std::endl;
+    ofs << "ill_data_rate_megabit_per_s=10.0" << std::endl;
+    ofs << "isl_max_queue_size_pkt=100" << std::endl;
+    ofs << "gsl_max_queue_size_pkt=100" << std::endl;
+    ofs << "ill_max_queue_size_pkt=100" << std::endl;
+    ofs << std::endl;
+    ofs << "receive_datarate_update_interval_ns=20000000" << std::endl;
+    ofs << "trafic_judge_rate_non_jam=0.4" << std::endl;
+    ofs << "trafic_judge_rate_in_jam=0.3" << std::endl;
+    ofs << "trafic_judge_rate_jam_to_normal=0.6" << std::endl;
+    ofs << "trafic_jam_area_radius_m=1500000" << std::endl;
+    ofs << "trafic_jam_update_interval_ns=100000000" << std::endl;
+    ofs << std::endl;
+    ofs << "enable_isl_utilization_tracking=false" << std::endl;
+    ofs << std::endl;
+    ofs << "enable_udp_burst_scheduler=true" << std::endl;
+    ofs << "udp_burst_schedule_filename=\"udp_burst_schedule.csv\"" << std::endl;
+    ofs << "udp_burst_enable_logging_for_udp_burst_ids=set()" << std::endl;
+    ofs << std::endl;
+    ofs << "class_A_rate=0.03" << std::endl;
+    ofs << "class_B_rate=0.20" << std::endl;
+    ofs << "class_C_rate=0.77" << std::endl;
+}
+
+void WriteUdpBurstSchedule(std::string work_dir, Ptr<TopologySatelliteNetwork> topology, int64_t num_udp_bursts,
+                           double rate_megabit_per_s, int64_t duration_ns) {
+    int64_t first_gs = topology->GetNumSatellites();
+    int64_t num_gs = topology->GetNumGroundStations();
+    if (num_gs < 2) {
+        throw std::invalid_argument("UDP bursts need at least two ground stations");
+    }
+    std::mt19937 gen(123456789);
+    std::uniform_int_distribution<int64_t> gs_dist(0, num_gs - 1);
+    std::ofstream ofs(work_dir + "/udp_burst_schedule.csv");
+    for (int64_t i = 0; i < num_udp_bursts; i++) {
+        int64_t from = gs_dist(gen);
+        int64_t to = gs_dist(gen);
+        while (to == from) {
+            to = gs_dist(gen);
+        }
+        ofs << format_string("%" PRId64 ",%" PRId64 ",%" PRId64 ",%f,0,%" PRId64 ",,",
+                             i, first_gs + from, first_gs + to, rate_megabit_per_s, duration_ns) << std::endl;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+// Benchmarks
+
+static uint64_t g_num_mac_tx = 0;
+
+void CountMacTx(Ptr<const Packet> p) {
+    g_num_mac_tx++;
+}
+
+// Packets as they arrive at an arbiter: with a flow TOS tag and the LEO they came from
+std::vector<Ptr<Packet>> CreatePacketPool(size_t size, uint8_t tos, int64_t from) {
+    std::vector<Ptr<Packet>> pool;
+    for (size_t i = 0; i < size; i++) {
+        Ptr<Packet> p = Create<Packet>(1000);
+        FlowTosTag tos_tag;
+        tos_tag.SetTos(tos);
+        p->AddPacketTag(tos_tag);
+        if (from >= 0) {
+            FromTag from_tag;
+            from_tag.SetFrom(from);
+            p->AddPacketTag(from_tag);
+        }
+        pool.push_back(p);
+    }
+    return pool;
+}
+
+int main(int argc, char *argv[]) {
+
+    // No buffering of printf
+    setbuf(stdout, nullptr);
+
+    CommandLine cmd;
+    std::string work_dir = "bench_run";
+    std::string out = "satnet_bench.json";
+    std::string filter = "";
+    double min_time_s = 0.5;
+    int64_t num_orbits = 72;
+    int64_t num_sats_per_orbit = 22;
+    int64_t num_ground_stations = 100;
+    int64_t num_geo = 3;
+    double altitude_m = 550000;
+    double inclination_degree = 53;
+    double min_elevation_degree = 25;
+    std::string satellite_network_dir = "";
+    std::string satellite_network_routes_dir = "";
+    int64_t dynamic_state_update_interval_ns = 100000000;
+    int64_t num_udp_bursts = 100;
+    double udp_burst_rate_megabit_per_s = 1.0;
+    int64_t udp_duration_ns = 1000000000;
+    cmd.Usage("Usage: ./waf --run=\"satnet-bench [--num_orbits=<n>] [--num_sats_per_orbit=<n>] [--out=<file.json>] ...\"");
+    cmd.AddValue("work_dir", "Directory to write the run (and the synthetic satellite network) in", work_dir);
+    cmd.AddValue("out", "JSON output file (Google Benchmark format)", out);
+    cmd.AddValue("filter", "Only run the benchmarks of which the name contains this", filter);
+    cmd.AddValue("min_time_s", "Minimum time of each benchmark", min_time_s);
+    cmd.AddValue("num_orbits", "Synthetic constellation: number of orbits", num_orbits);
+    cmd.AddValue("num_sats_per_orbit", "Synthetic constellation: satellites per orbit", num_sats_per_orbit);
+    cmd.AddValue("num_ground_stations", "Synthetic constellation: number of ground stations", num_ground_stations);
+    cmd.AddValue("num_geo", "Synthetic constellation: number of GEO satellites", num_geo);
+    cmd.AddValue("altitude_m", "Synthetic constellation: altitude", altitude_m);
+    cmd.AddValue("inclination_degree", "Synthetic constellation: inclination", inclination_degree);
+    cmd.AddValue("min_elevation_degree", "Synthetic constellation: minimum GSL elevation", min_elevation_degree);
+    cmd.AddValue("satellite_network_dir", "Generated satellite network instead (relative to work_dir)", satellite_network_dir);
+    cmd.AddValue("satellite_network_routes_dir", "Its precomputed routes (relative to work_dir)", satellite_network_routes_dir);
+    cmd.AddValue("dynamic_state_update_interval_ns", "Forwarding state update interval", dynamic_state_update_interval_ns);
+    cmd.AddValue("num_udp_bursts", "Number of UDP bursts between random ground stations", num_udp_bursts);
+    cmd.AddValue("udp_burst_rate_megabit_per_s", "Rate of each UDP burst", udp_burst_rate_megabit_per_s);
+    cmd.AddValue("udp_duration_ns", "Duration of the UDP bursts (and of the simulation)", udp_duration_ns);
+    cmd.Parse(argc, argv);
+    if ((satellite_network_dir == "") != (satellite_network_routes_dir == "")) {
+        throw std::invalid_argument("Either both or neither of satellite_network_dir and satellite_network_routes_dir must be given");
+    }
+
+    // Run directory
+    mkdir_if_not_exists(work_dir);
+    bool synthetic = satellite_network_dir == "";
+    if (synthetic) {
+        satellite_network_dir = "satellite_network";
+        satellite_network_routes_dir = "satellite_network";
+        WalkerConstellationHelper walker(
+                num_orbits, num_sats_per_orbit, altitude_m, inclination_degree,
+                num_ground_stations, num_geo, min_elevation_degree
+        );
+        walker.Write(work_dir + "/" + satellite_network_dir);
+    }
+    WriteConfig(work_dir, satellite_network_dir, satellite_network_routes_dir, synthetic ? "in_simulator" : "precomputed",
+                udp_duration_ns, dynamic_state_update_interval_ns);
+
+    // Topology and arbiters
+    Ptr<BasicSimulation> basicSimulation = CreateObject<BasicSimulation>(work_dir);
+    Ptr<TopologySatelliteNetwork> topology = CreateObject<TopologySatelliteNetwork>(basicSimulation, Ipv4ArbiterRoutingHelper());
+    Ptr<BenchArbiterLEOGSGEOHelper> arbiter_helper = CreateObject<BenchArbiterLEOGSGEOHelper>(basicSimulation, topology);
+    arbiter_helper->Install();
+    WriteUdpBurstSchedule(work_dir, topology, num_udp_bursts, udp_burst_rate_megabit_per_s, udp_duration_ns);
+
+    NodeContainer nodes = topology->GetNodes();
+    int64_t num_sats = topology->GetNumSatellites();
+    int64_t num_gs = topology->GetNumGroundStations();
+    int64_t num_geos = topology->GetNumGEOSatellites();
+    BenchmarkRunner runner(min_time_s, filter);
+
+    std::cout << "BENCHMARKS" << std::endl;
+
+    // Satellite positions (SGP4)
+    {
+        Ptr<SatellitePositionMobilityModel> mobility = nodes.Get(0)->GetObject<SatellitePositionMobilityModel>();
+        JulianDate start = mobility != 0 ? mobility->GetStartTime() : JulianDate();
+        runner.Run("BM_SatelliteGetPosition", [&](int64_t iterations) {
+            for (int64_t i = 0; i < iterations; i++) {
+                Vector3D position = topology->GetSatellite(i % num_sats)->GetPosition(start + MilliSeconds(i % 1000));
+                DoNotOptimize(position);
+            }
+            return iterations;
+        });
+    }
+
+    // Routing decisions, each for random (current, target) pairs
+    {
+        std::mt19937 gen(123456789);
+        const size_t num_pairs = 4096;
+        std::vector<std::pair<int32_t, int32_t>> leo_pairs, gs_pairs, geo_pairs;
+        for (size_t i = 0; i < num_pairs; i++) {
+            int32_t leo = gen() % num_sats;
+            int32_t gs = num_sats + gen() % num_gs;
+            int32_t target_gs = num_sats + gen() % num_gs;
+            while (target_gs == gs) {
+                target_gs = num_sats + gen() % num_gs;
+            }
+            leo_pairs.push_back(std::make_pair(leo, target_gs));
+            gs_pairs.push_back(std::make_pair(gs, target_gs));
+            if (num_geos > 0) {
+                geo_pairs.push_back(std::make_pair(num_sats + num_gs + gen() % num_geos, target_gs));
+            }
+        }
+        std::vector<Ptr<Packet>> pool = CreatePacketPool(num_pairs, 0x0, -1);
+        std::vector<Ptr<Packet>> pool_from_leo = CreatePacketPool(num_pairs, 0x0, 0);
+        Ipv4Header ip_header;
+
+        // The LEO arbiter can add a from tag (when it forwards to a GEO), so it gets a copy
+        runner.Run("BM_ArbiterLEODecide", [&](int64_t iterations) {
+            for (int64_t i = 0; i < iterations; i++) {
+                const std::pair<int32_t, int32_t>& pair = leo_pairs[i % num_pairs];
+                Ptr<Packet> p = pool[i % num_pairs]->Copy();
+                DoNotOptimize(arbiter_helper->GetArbiterLEO(pair.first)->TopologySatelliteNetworkDecide(
+                        num_sats, pair.second, p, ip_header, false));
+            }
+            return iterations;
+        });
+        runner.Run("BM_ArbiterGSDecide", [&](int64_t iterations) {
+            for (int64_t i = 0; i < iterations; i++) {
+                const std::pair<int32_t, int32_t>& pair = gs_pairs[i % num_pairs];
+                DoNotOptimize(arbiter_helper->GetArbiterGS(pair.first - num_sats)->TopologySatelliteNetworkDecide(
+                        pair.first, pair.second, pool[i % num_pairs], ip_header, false));
+            }
+            return iterations;
+        });
+        if (num_geos > 0) {
+            runner.Run("BM_ArbiterGEODecide", [&](int64_t iterations) {
+                for (int64_t i = 0; i < iterations; i++) {
+                    const std::pair<int32_t, int32_t>& pair = geo_pairs[i % num_pairs];
+                    DoNotOptimize(arbiter_helper->GetArbiterGEO(pair.first - num_sats - num_gs)->TopologySatelliteNetworkDecide(
+                            num_sats, pair.second, pool_from_leo[i % num_pairs], ip_header, false));
+                }
+                return iterations;
+            });
+        }
+    }
+
+    // One detour update tick: the receive data rates and the detour state of all LEOs
+    runner.Run("BM_UpdateDetourTick", [&](int64_t iterations) {
+        for (int64_t i = 0; i < iterations; i++) {
+            for (int64_t sat = 0; sat < num_sats; sat++) {
+                arbiter_helper->GetArbiterLEO(sat)->UpdateReceiveDatarate();
+            }
+            for (int64_t sat = 0; sat < num_sats; sat++) {
+                arbiter_helper->GetArbiterLEO(sat)->UpdateState();
+            }
+        }
+        return iterations * num_sats;
+    });
+
+    // Forwarding state update: the fstate file at t=0, or the in-simulator routing engine
+    if (synthetic) {
+        runner.Run("BM_UpdateForwardingStateFromRoutingEngine", [&](int64_t iterations) {
+            for (int64_t i = 0; i < iterations; i++) {
+                arbiter_helper->UpdateForwardingStateFromRoutingEngine();
+            }
+            return iterations * (num_sats + num_gs) * num_gs;
+        });
+    } else {
+        runner.Run("BM_UpdateForwardingState", [&](int64_t iterations) {
+            for (int64_t i = 0; i < iterations; i++) {
+                arbiter_helper->UpdateForwardingState(0);
+            }
+            return iterations * (num_sats + num_gs) * num_gs;
+        });
+    }
+
+    // UDP burst emission: the whole simulation, per packet put on the GSL of a ground station
+    if (runner.IsSelected("BM_UdpBurstEmission")) {
+        for (int64_t gid = 0; gid < num_gs; gid++) {
+            nodes.Get(num_sats + gid)->GetDevice(1)->TraceConnectWithoutContext("MacTx", MakeCallback(&CountMacTx));
+        }
+        UdpBurstScheduler udpBurstScheduler(basicSimulation, topology);
+        runner.RunOnce("BM_UdpBurstEmission", [&]() {
+            Simulator::Run();
+            return (int64_t) g_num_mac_tx;
+        });
+    }
+
+    // GSL channel transmission of a ground station to a satellite. The receptions are
+    // scheduled, but never run, so the number of iterations is limited (memory).
+    {
+        Ptr<GSLNetDevice> src = nodes.Get(num_sats)->GetDevice(1)->GetObject<GSLNetDevice>();
+        Ptr<GSLChannel> channel = src->GetChannel()->GetObject<GSLChannel>();
+        Address dst_address = nodes.Get(0)->GetDevice(5)->GetAddress();
+        Ptr<const Packet> p = Create<Packet>(1000);
+        runner.Run("BM_GSLChannelTransmitStart", [&](int64_t iterations) {
+            for (int64_t i = 0; i < iterations; i++) {
+                DoNotOptimize(channel->TransmitStart(p, src, dst_address, MicroSeconds(800)));
+            }
+            return iterations;
+        }, 1000000);
+    }
+
+    // Event schedulers (scheduler_type), hold model of the periodic events of the simulation:
+    // a 20 ms detour tick and a forwarding state update per node (all at the same timestamps)
+    // and the fixed-gap packet sends of the UDP bursts (random phase). Each iteration removes
+    // the next event and inserts its next period.
+    if (runner.IsSelected("BM_SchedulerHold")) {
+        std::mt19937 gen(123456789);
+        int64_t udp_gap_ns = (int64_t) (1500 * 8 * 1000 / udp_burst_rate_megabit_per_s);
+        std::vector<int64_t> periods_ns;
+        std::vector<int64_t> phases_ns;
+        for (uint32_t i = 0; i < nodes.GetN(); i++) {
+            periods_ns.push_back(20000000);
+            phases_ns.push_back(0);
+            periods_ns.push_back(dynamic_state_update_interval_ns);
+            phases_ns.push_back(0);
+        }
+        for (int64_t i = 0; i < num_udp_bursts; i++) {
+            periods_ns.push_back(udp_gap_ns);
+            phases_ns.push_back(gen() % udp_gap_ns);
+        }
+        for (std::pair<std::string, std::string> scheduler_type : std::vector<std::pair<std::string, std::string>>{
+                {"map", "ns3::MapScheduler"}, {"heap", "ns3::HeapScheduler"},
+                {"calendar", "ns3::CalendarScheduler"}, {"ladder", "ns3::LadderScheduler"}}) {
+            ObjectFactory factory;
+            factory.SetTypeId(scheduler_type.second);
+            Ptr<Scheduler> scheduler = factory.Create<Scheduler>();
+            uint32_t uid = 4; // Below are reserved by ns-3 (EventId::UID)
+            for (size_t j = 0; j < periods_ns.size(); j++) {
+                Scheduler::Event ev;
+                ev.impl = nullptr;
+                ev.key.m_ts = phases_ns[j];
+                ev.key.m_uid = uid++;
+                ev.key.m_context = j;
+                scheduler->Insert(ev);
+            }
+            runner.Run("BM_SchedulerHold/" + scheduler_type.first, [&](int64_t iterations) {
+                for (int64_t i = 0; i < iterations; i++) {
+                    Scheduler::Event ev = scheduler->RemoveNext();
+                    ev.key.m_ts += periods_ns[ev.key.m_context];
+                    ev.key.m_uid = uid++;
+                    scheduler->Insert(ev);
+                }
+                return iterations;
+            });
+        }
+    }
+
+    // Traffic classifying LEO arbiter, for each traffic class (replaces the LEO arbiters)
+    if (runner.IsSelected("BM_ArbiterTrafficLEODecide")) {
+        Ptr<ArbiterTrafficClassifyHelper> traffic_helper = CreateObject<ArbiterTrafficClassifyHelper>(basicSimulation, topology);
+        traffic_helper->Install();
+        std::mt19937 gen(123456789);
+        const size_t num_pairs = 4096;
+        std::vector<std::pair<int32_t, int32_t>> leo_pairs;
+        for (size_t i = 0; i < num_pairs; i++) {
+            leo_pairs.push_back(std::make_pair(gen() % num_sats, num_sats + gen() % num_gs));
+        }
+        Ipv4Header ip_header;
+        for (std::pair<std::string, uint8_t> traffic_class : std::vector<std::pair<std::string, uint8_t>>{
+                {"A", 0x10}, {"B", 0x08}, {"C", 0x04}}) {
+            std::vector<Ptr<Packet>> pool = CreatePacketPool(num_pairs, traffic_class.second, -1);
+            runner.Run("BM_ArbiterTrafficLEODecide/class_" + traffic_class.first, [&](int64_t iterations) {
+                for (int64_t i = 0; i < iterations; i++) {
+                    const std::pair<int32_t, int32_t>& pair = leo_pairs[i % num_pairs];
+                    Ptr<Packet> p = pool[i % num_pairs]->Copy();
+                    DoNotOptimize(traffic_helper->GetArbiterLEO(pair.first)->TopologySatelliteNetworkDecide(
+                            num_sats, pair.second, p, ip_header, false));
+                }
+                return iterations;
+            });
+        }
+    }
+    std::cout << std::endl;
+
+    // Results
+    char host_name[256] = "";
+    gethostname(host_name, sizeof(host_name) - 1);
+    std::time_t now = std::time(nullptr);
+    char date[64];
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S%z", std::localtime(&now));
+#ifdef NS3_BUILD_PROFILE_DEBUG
+    std::string build_type = "debug";
+#else
+    std::string build_type = "release";
+#endif
+    runner.WriteJson(out, {
+            {"date", "\"" + std::string(date) + "\""},
+            {"host_name", "\"" + std::string(host_name) + "\""},
+            {"executable", "\"satnet-bench\""},
+            {"num_cpus", std::to_string(sysconf(_SC_NPROCESSORS_ONLN))},
+            {"library_build_type", "\"" + build_type + "\""},
+            {"satellite_network_dir", "\"" + satellite_network_dir + "\""},
+            {"synthetic", synthetic ? "true" : "false"},
+            {"num_satellites", std::to_string(num_sats)},
+            {"num_ground_stations", std::to_string(num_gs)},
+            {"num_geo_satellites", std::to_string(num_geos)},
+            {"num_udp_bursts", std::to_string(num_udp_bursts)}
+    });
+    std::cout << "Wrote benchmark results to " << out << std::endl;
+
+    Simulator::Destroy();
+    return 0;
+}
@@ -0,0 +1,64 @@
+/**
+ * Author:  silent-rookie      2024
+*/
+
+/**
+ * Writes a synthetic Walker-delta satellite network directory (see WalkerConstellationHelper),
+ * as input of scaling experiments without running satgenpy. Its routes are calculated in the
+ * simulator (routing_engine=in_simulator).
+ */
+
+#include <iostream>
+#include <chrono>
+
+#include "ns3/core-module.h"
+#include "ns3/walker-constellation-helper.h"
+
+using namespace ns3;
+
+int main(int argc, char *argv[]) {
+
+    CommandLine cmd;
+    std::string satellite_network_dir = "";
+    int64_t num_orbits = 72;
+    int64_t num_sats_per_orbit = 22;
+    double altitude_m = 550000;
+    double inclination_degree = 53;
+    int64_t num_ground_stations = 100;
+    int64_t num_geo = 3;
+    double min_elevation_degree = 25;
+    cmd.Usage("Usage: ./waf --run=\"satnet-generate --satellite_network_dir='<path/to/output/directory>' [--num_orbits=<n>] [--num_sats_per_orbit=<n>] ...\"");
+    cmd.AddValue("satellite_network_dir", "Output directory", satellite_network_dir);
+    cmd.AddValue("num_orbits", "Number of orbital planes", num_orbits);
+    cmd.AddValue("num_sats_per_orbit", "Number of satellites per plane", num_sats_per_orbit);
+    cmd.AddValue("altitude_m", "Altitude of the shell", altitude_m);
+    cmd.AddValue("inclination_degree", "Inclination of the planes", inclination_degree);
+    cmd.AddValue("num_ground_stations", "Number of ground stations", num_ground_stations);
+    cmd.AddValue("num_geo", "Number of GEO satellites", num_geo);
+    cmd.AddValue("min_elevation_degree", "Minimum elevation angle of a GSL", min_elevation_degree);
+    cmd.Parse(argc, argv);
+    if (satellite_network_dir == "") {
+        printf("Usage: ./waf --run=\"satnet-generate --satellite_network_dir='<path/to/output/directory>'\"\n");
+        return 0;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    WalkerConstellationHelper walker(
+            num_orbits, num_sats_per_orbit, altitude_m, inclination_degree,
+            num_ground_stations, num_geo, min_elevation_degree
+    );
+    walker.Write(satellite_network_dir);
+
+    std::cout << "GENERATED SATELLITE NETWORK" << std::endl;
+    std::cout << "  > Directory.............. " << satellite_network_dir << std::endl;
+    std::cout << "  > Satellites............. " << walker.GetNumSatellites() << " (" << num_orbits << " x " << num_sats_per_orbit << ")" << std::endl;
+    std::cout << "  > Ground stations........ " << num_ground_stations << std::endl;
+    std::cout << "  > GEO satellites......... " << num_geo << std::endl;
+    std::cout << "  > Max. ISL length........ " << walker.GetMaxIslLengthM() << " m" << std::endl;
+    std::cout << "  > Max. GSL length........ " << walker.GetMaxGslLengthM() << " m" << std::endl;
+    std::cout << "  > Max. ILL length........ " << walker.GetMaxIllLengthM() << " m" << std::endl;
+    std::cout << "  > Took................... "
+              << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << " s" << std::endl;
+
+    return 0;
+}
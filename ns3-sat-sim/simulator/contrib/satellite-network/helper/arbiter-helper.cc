@@ -23,5 +23,9 @@ ArbiterHelper::ArbiterHelper(Ptr<BasicSimulation> basicSimulation, Ptr<TopologyS
 
 }
 
+void ArbiterHelper::WriteResults(){
+    // By default there is nothing to write
+}
+
 
 }
\ No newline at end of file
@@ -21,6 +21,9 @@ public:
     // Install arbiter for all nodes in topology
     virtual void Install() = 0;
 
+    // Write the statistics collected by the arbiters (called after the simulation has run)
+    virtual void WriteResults();
+
 protected:
     Ptr<BasicSimulation> m_basicSimulation;
     Ptr<TopologySatelliteNetwork> m_topology;
@@ -2,7 +2,13 @@
  * Author:  silent-rookie      2024
 */
 
+#include <algorithm>
 #include "arbiter-leo-gs-geo-helper.h"
+#include "ns3/mpi-interface.h"
+#include "ns3/profiling-simulator-impl.h"
+#ifdef NS3_MPI
+#include <mpi.h>
+#endif
 
 namespace ns3{
 
@@ -18,7 +24,7 @@ TypeId ArbiterLEOGSGEOHelper::GetTypeId (void){
 
 ArbiterLEOGSGEOHelper::ArbiterLEOGSGEOHelper(Ptr<BasicSimulation> basicSimulation, 
                                         Ptr<TopologySatelliteNetwork> topology)
-: ArbiterHelper(basicSimulation, topology)
+: ArbiterHelper(basicSimulation, topology), m_measure_receive_datarates(true)
 {
 
 }
@@ -29,23 +35,31 @@ void ArbiterLEOGSGEOHelper::Install(){
     NodeContainer m_nodes = m_topology->GetNodes();
 
     // Read in initial forwarding state
-    std::vector<std::vector<std::vector<std::tuple<int32_t, int32_t, int32_t>>>> initial_forwarding_state = InitialEmptyForwardingState();
+    ValidateInterfaceLayouts();
+    NextHopCandidates initial_forwarding_state = InitialEmptyForwardingState();
+    m_detour_subscribers.resize(m_topology->GetNumSatellites());
 
-    // Initialize
+    // Initialize (the flowlet config is shared by the LEO and GS arbiters)
+    FlowletTable::Initialize(m_basicSimulation);
     ArbiterLEO::InitializeArbiter(m_basicSimulation, m_topology->GetNumSatellites(), m_topology->GetNumGroundStations(), m_topology->GetNumGEOSatellites());
     ArbiterGS::InitializeArbiter(m_basicSimulation, m_topology->GetNumSatellites(), m_topology->GetNumGroundStations(), m_topology->GetNumGEOSatellites());
     ArbiterGEO::InitializeArbiter(m_basicSimulation, m_topology->GetNumSatellites(), m_topology->GetNumGroundStations(), m_topology->GetNumGEOSatellites());
+    InitializeJamAreaPredictor();
+    InitializeRoutingDecisionCounters();
+    InitializeMemoryReport();
     // Set the routing arbiters
     std::cout << "  > Setting the routing arbiter on LEO node" << std::endl;
     for (size_t i = 0; i < m_topology->GetNumSatellites(); i++) {
-        Ptr<ArbiterLEO> arbiter = CreateObject<ArbiterLEO>(m_nodes.Get(i), m_nodes, -2, initial_forwarding_state[i], this);
+        Ptr<ArbiterLEO> arbiter = CreateObject<ArbiterLEO>(m_nodes.Get(i), m_nodes, -2, initial_forwarding_state, this);
         m_arbiters_leo.push_back(arbiter);
         m_nodes.Get(i)->GetObject<Ipv4>()->GetRoutingProtocol()->GetObject<Ipv4ArbiterRouting>()->SetArbiter(arbiter);
     }
+    m_receive_datarate_update_interval_ns = parse_positive_int64(m_basicSimulation->GetConfigParamOrFail("receive_datarate_update_interval_ns"));
+    UpdateDetourState();
     std::cout << "  > Setting the routing arbiter on GS node" << std::endl;
     for (size_t i = 0; i < m_topology->GetNumGroundStations(); i++) {
         size_t gs_id = i + m_topology->GetNumSatellites();
-        Ptr<ArbiterGS> arbiter = CreateObject<ArbiterGS>(m_nodes.Get(gs_id), m_nodes, initial_forwarding_state[gs_id], this);
+        Ptr<ArbiterGS> arbiter = CreateObject<ArbiterGS>(m_nodes.Get(gs_id), m_nodes, initial_forwarding_state, this);
         m_arbiters_gs.push_back(arbiter);
         m_nodes.Get(gs_id)->GetObject<Ipv4>()->GetRoutingProtocol()->GetObject<Ipv4ArbiterRouting>()->SetArbiter(arbiter);
     }
@@ -61,6 +75,7 @@ void ArbiterLEOGSGEOHelper::Install(){
     // Load first forwarding state
     m_dynamicStateUpdateIntervalNs = parse_positive_int64(m_basicSimulation->GetConfigParamOrFail("dynamic_state_update_interval_ns"));
     std::cout << "  > Dynamic update interval: " << m_dynamicStateUpdateIntervalNs << "ns" << std::endl;
+    InitializeRoutingEngine();
     std::cout << "  > Perform first update state load for t=0" << std::endl;
     UpdateState(0);
     m_basicSimulation->RegisterTimestamp("Initialize LEOGSGEO dynamic state");
@@ -83,31 +98,436 @@ Ptr<ArbiterGEO> ArbiterLEOGSGEOHelper::GetArbiterGEO(size_t index){
     return m_arbiters_geo[index];
 }
 
+void ArbiterLEOGSGEOHelper::DisableReceiveDatarateMeasurement(){
+    m_measure_receive_datarates = false;
+}
+
 Ptr<BasicSimulation> ArbiterLEOGSGEOHelper::GetBasicSimulation(){
     return m_basicSimulation;
 }
 
-std::vector<std::vector<std::vector<std::tuple<int32_t, int32_t, int32_t>>>> 
-ArbiterLEOGSGEOHelper::InitialEmptyForwardingState(){
+Ptr<JamAreaPredictor> ArbiterLEOGSGEOHelper::GetJamAreaPredictor(){
+    return m_jam_area_predictor;
+}
+
+Ptr<JamAreaMembership> ArbiterLEOGSGEOHelper::GetJamAreaMembership(){
+    return m_jam_area_membership;
+}
+
+void ArbiterLEOGSGEOHelper::InitializeJamAreaPredictor(){
+    m_jam_area_detection = m_basicSimulation->GetConfigParamOrDefault("trafic_jam_area_detection", "polling");
+    std::cout << "  > Jam area detection: " << m_jam_area_detection << std::endl;
+    if(m_jam_area_detection == "predicted"){
+        m_jam_area_predictor = CreateObject<JamAreaPredictor>(m_basicSimulation, m_topology);
+    }
+    else if(m_jam_area_detection == "polling"){
+        m_jam_area_membership = CreateObject<JamAreaMembership>(m_basicSimulation, m_topology);
+    }
+    else{
+        throw std::runtime_error("Unknown jam area detection: " + m_jam_area_detection);
+    }
+}
+
+void ArbiterLEOGSGEOHelper::InitializeRoutingDecisionCounters(){
+    m_enable_routing_decision_counters = parse_boolean(m_basicSimulation->GetConfigParamOrDefault("enable_routing_decision_counters", "false"));
+    m_routing_decision_counters_sample_interval_ns = 0;
+    if(m_enable_routing_decision_counters){
+        m_routing_decision_counters_sample_interval_ns = parse_positive_int64(
+                m_basicSimulation->GetConfigParamOrDefault("routing_decision_counters_sample_interval_ns", "0"));
+        std::cout << "  > Routing decision counters: enabled";
+        if(m_routing_decision_counters_sample_interval_ns > 0){
+            std::cout << ", sampled each " << m_routing_decision_counters_sample_interval_ns << "ns";
+            ScheduleLabeled("ArbiterLEOGSGEOHelper::SampleRoutingDecisionCounters", NanoSeconds(m_routing_decision_counters_sample_interval_ns), &ArbiterLEOGSGEOHelper::SampleRoutingDecisionCounters, this);
+        }
+        std::cout << std::endl;
+    }
+}
+
+void ArbiterLEOGSGEOHelper::InitializeMemoryReport(){
+    m_basicSimulation->AddMemoryReportEntry("Arbiters: forwarding state (m_next_hop_lists)",
+                                            MakeCallback(&ArbiterLEOGSGEOHelper::EstimateForwardingStateMemoryBytes, this));
+    m_basicSimulation->AddMemoryReportEntry("Arbiters: IP to node id maps (m_ip_to_node_id)",
+                                            MakeCallback(&ArbiterLEOGSGEOHelper::EstimateIpToNodeIdMemoryBytes, this));
+    m_basicSimulation->AddMemoryReportEntry("Arbiters: GEO decision caches",
+                                            MakeCallback(&ArbiterLEOGSGEOHelper::EstimateGEODecisionCacheMemoryBytes, this));
+    m_basicSimulation->AddMemoryReportEntry("Jam areas (trafic_jam_areas, trafic_areas_time)",
+                                            MakeCallback(&ArbiterLEO::EstimateTraficJamAreasMemoryBytes));
+    if(m_jam_area_membership != 0){
+        m_basicSimulation->AddMemoryReportEntry("Jam area membership (positions, masks)",
+                                                MakeCallback(&JamAreaMembership::EstimateMemoryBytes, m_jam_area_membership));
+    }
+    m_basicSimulation->AddMemoryReportEntry("Detour subscriptions (m_detour_subscribers)",
+                                            MakeCallback(&ArbiterLEOGSGEOHelper::EstimateDetourSubscribersMemoryBytes, this));
+}
+
+uint64_t ArbiterLEOGSGEOHelper::EstimateForwardingStateMemoryBytes(){
+    uint64_t bytes = 0;
+    for(Ptr<ArbiterLEO> arbiter : m_arbiters_leo){
+        bytes += arbiter->EstimateForwardingStateMemoryBytes();
+    }
+    for(Ptr<ArbiterGS> arbiter : m_arbiters_gs){
+        bytes += arbiter->EstimateForwardingStateMemoryBytes();
+    }
+    return bytes;
+}
+
+uint64_t ArbiterLEOGSGEOHelper::EstimateIpToNodeIdMemoryBytes(){
+    uint64_t bytes = 0;
+    for(Ptr<ArbiterLEO> arbiter : m_arbiters_leo){
+        bytes += arbiter->EstimateIpToNodeIdMemoryBytes();
+    }
+    for(Ptr<ArbiterGS> arbiter : m_arbiters_gs){
+        bytes += arbiter->EstimateIpToNodeIdMemoryBytes();
+    }
+    for(Ptr<ArbiterGEO> arbiter : m_arbiters_geo){
+        bytes += arbiter->EstimateIpToNodeIdMemoryBytes();
+    }
+    return bytes;
+}
+
+uint64_t ArbiterLEOGSGEOHelper::EstimateGEODecisionCacheMemoryBytes(){
+    uint64_t bytes = 0;
+    for(Ptr<ArbiterGEO> arbiter : m_arbiters_geo){
+        bytes += arbiter->EstimateDecisionCacheMemoryBytes();
+    }
+    return bytes;
+}
+
+uint64_t ArbiterLEOGSGEOHelper::EstimateDetourSubscribersMemoryBytes(){
+    uint64_t bytes = estimate_heap_bytes(m_detour_subscribers);
+    for(const std::unordered_map<int32_t, std::vector<int32_t>>& subscribers : m_detour_subscribers){
+        bytes += estimate_heap_bytes(subscribers);
+        for(const std::pair<const int32_t, std::vector<int32_t>>& subscriber : subscribers){
+            bytes += estimate_heap_bytes(subscriber.second);
+        }
+    }
+    return bytes;
+}
+
+RoutingDecisionCounters ArbiterLEOGSGEOHelper::GetTotalRoutingDecisionCounters(){
+    RoutingDecisionCounters total;
+    for(Ptr<ArbiterLEO> arbiter : m_arbiters_leo){
+        total.Add(arbiter->GetRoutingDecisionCounters());
+    }
+    for(Ptr<ArbiterGS> arbiter : m_arbiters_gs){
+        total.Add(arbiter->GetRoutingDecisionCounters());
+    }
+    for(Ptr<ArbiterGEO> arbiter : m_arbiters_geo){
+        total.Add(arbiter->GetRoutingDecisionCounters());
+    }
+    return total;
+}
+
+void ArbiterLEOGSGEOHelper::SampleRoutingDecisionCounters(){
+    m_routing_decision_counters_samples.push_back(std::make_pair(Simulator::Now().GetNanoSeconds(), GetTotalRoutingDecisionCounters()));
+
+    // Plan next sample
+    ScheduleLabeled("ArbiterLEOGSGEOHelper::SampleRoutingDecisionCounters", NanoSeconds(m_routing_decision_counters_sample_interval_ns), &ArbiterLEOGSGEOHelper::SampleRoutingDecisionCounters, this);
+}
+
+void ArbiterLEOGSGEOHelper::NotifyDetourStateChanged(int32_t leo_node_id, bool detour_flipped, bool jam_flipped){
+    // The arbiters are constructed one by one, and each of them performs a first update,
+    // so a notification can arrive before every subscriber exists
+    if((size_t) leo_node_id >= m_detour_subscribers.size() || m_arbiters_geo.size() != m_topology->GetNumGEOSatellites())
+        return;
+
+    // Count the flips of each simulated second
+    size_t second = (size_t) Simulator::Now().GetSeconds();
+    if(m_detour_flips_per_second.size() <= second){
+        m_detour_flips_per_second.resize(second + 1, 0);
+        m_jam_flips_per_second.resize(second + 1, 0);
+    }
+
+    // LEO and GS arbiters only look at the detour flags of their candidates,
+    // as such only their decisions of the targets with that LEO as candidate change
+    if(detour_flipped){
+        m_detour_flips_per_second[second] += 1;
+        for(const std::pair<const int32_t, std::vector<int32_t>>& subscriber : m_detour_subscribers[leo_node_id]){
+            if(subscriber.first < (int32_t) m_topology->GetNumSatellites()){
+                m_arbiters_leo[subscriber.first]->NotifyNeighborStateChanged(subscriber.second);
+            }
+            else{
+                m_arbiters_gs[subscriber.first - m_topology->GetNumSatellites()]->NotifyNeighborStateChanged(subscriber.second);
+            }
+        }
+    }
+
+    // GEO arbiters walk the shortest path of any LEO which detours to them,
+    // as such they are interested in the jam area status of every LEO
+    if(jam_flipped){
+        m_jam_flips_per_second[second] += 1;
+        for(Ptr<ArbiterGEO> arbiter : m_arbiters_geo){
+            arbiter->NotifyNeighborStateChanged(leo_node_id);
+        }
+    }
+}
+
+void ArbiterLEOGSGEOHelper::UpdateDetourSubscriptions(
+        int32_t subscriber_node_id,
+        int32_t target_node_id,
+        const std::vector<std::tuple<int32_t, int32_t, int32_t>>& previous_next_hop_list,
+        const std::vector<std::tuple<int32_t, int32_t, int32_t>>& next_hop_list
+){
+    int32_t num_satellites = m_topology->GetNumSatellites();
+
+    // Unsubscribe from the previous candidates (the target once per candidate it is in)
+    for(const std::tuple<int32_t, int32_t, int32_t>& hop : previous_next_hop_list){
+        int32_t next_node_id = std::get<0>(hop);
+        if(next_node_id >= 0 && next_node_id < num_satellites){
+            std::unordered_map<int32_t, std::vector<int32_t>>::iterator it = m_detour_subscribers[next_node_id].find(subscriber_node_id);
+            NS_ABORT_MSG_IF(it == m_detour_subscribers[next_node_id].end(), "Subscription of a candidate is missing");
+            std::vector<int32_t>& targets = it->second;
+            std::vector<int32_t>::iterator target_it = std::find(targets.begin(), targets.end(), target_node_id);
+            NS_ABORT_MSG_IF(target_it == targets.end(), "Subscription of a candidate target is missing");
+            *target_it = targets.back();
+            targets.pop_back();
+            if(targets.empty()){
+                m_detour_subscribers[next_node_id].erase(it);
+            }
+        }
+    }
+
+    // Subscribe to the new candidates
+    for(const std::tuple<int32_t, int32_t, int32_t>& hop : next_hop_list){
+        int32_t next_node_id = std::get<0>(hop);
+        if(next_node_id >= 0 && next_node_id < num_satellites){
+            m_detour_subscribers[next_node_id][subscriber_node_id].push_back(target_node_id);
+        }
+    }
+}
+
+void ArbiterLEOGSGEOHelper::WriteResults(){
+    std::cout << "STORE DETOUR STATE FLIPS" << std::endl;
+
+    // Distributed: the state is the same on every system, but each writes its own file
+    std::string prefix = m_basicSimulation->GetLogsDir() + "/";
+    if(m_basicSimulation->IsDistributedEnabled()){
+        prefix += "system_" + std::to_string(m_basicSimulation->GetSystemId()) + "_";
+    }
+
+    // detour_state_flips.csv (line format: <second>,<detour flag flips>,<jam area flips>)
+    std::string filename = prefix + "detour_state_flips.csv";
+    std::ofstream file_csv(filename);
+    uint64_t total_detour_flips = 0;
+    uint64_t total_jam_flips = 0;
+    for(size_t i = 0; i < m_detour_flips_per_second.size(); ++i){
+        file_csv << i << "," << m_detour_flips_per_second[i] << "," << m_jam_flips_per_second[i] << std::endl;
+        total_detour_flips += m_detour_flips_per_second[i];
+        total_jam_flips += m_jam_flips_per_second[i];
+    }
+    file_csv.close();
+    std::cout << "  > Detour flag flips....... " << total_detour_flips << std::endl;
+    std::cout << "  > Jam area flips.......... " << total_jam_flips << std::endl;
+    if(m_jam_area_predictor != 0){
+        std::cout << "  > Jam area crossings...... " << m_jam_area_predictor->GetNumCrossings() << " (predicted)" << std::endl;
+    }
+    std::cout << "  > Written to: " << filename << std::endl;
+    std::cout << std::endl;
+
+    if(m_enable_routing_decision_counters){
+        WriteRoutingDecisionCounters(prefix);
+    }
+
+    if(m_routing_engine_mode == "validate"){
+        std::cout << "STORE ROUTING ENGINE VALIDATION" << std::endl;
+
+        // routing_engine_validation.csv (line format: <t>,<entries>,<first hop diffs>,<candidate diffs>,<ills diffs>)
+        std::string validation_filename = prefix + "routing_engine_validation.csv";
+        std::ofstream validation_csv(validation_filename);
+        int64_t total_entries = 0;
+        int64_t total_first_hop_diffs = 0;
+        int64_t total_candidate_diffs = 0;
+        int64_t total_ills_diffs = 0;
+        for(const std::vector<int64_t>& update : m_routing_engine_validation){
+            validation_csv << update[0] << "," << update[1] << "," << update[2] << "," << update[3] << "," << update[4] << std::endl;
+            total_entries += update[1];
+            total_first_hop_diffs += update[2];
+            total_candidate_diffs += update[3];
+            total_ills_diffs += update[4];
+        }
+        validation_csv.close();
+        std::cout << "  > Compared fstate entries.. " << total_entries << std::endl;
+        std::cout << "  > First hop differences.... " << total_first_hop_diffs << std::endl;
+        std::cout << "  > Candidate differences.... " << total_candidate_diffs << std::endl;
+        std::cout << "  > ILL differences.......... " << total_ills_diffs << std::endl;
+        std::cout << "  > Written to: " << validation_filename << std::endl;
+        std::cout << std::endl;
+    }
+
+    if(m_ills_source == "in_simulator"){
+        std::cout << "ILL HANDOVERS" << std::endl;
+        std::cout << "  > Total handovers.......... " << m_geo_coverage_engine->GetNumHandovers() << std::endl;
+        std::cout << std::endl;
+    }
+}
+
+// Line format of the counters: <decisions>,<recomputed>,<candidate 0>,<candidate 1>,<candidate 2>,<candidate 3>,
+// <to GEO>,<class_C to GEO>,<class_A>,<class_B>,<class_B loop avoided>,<class_B fallback>,<GS all detour>,
+// <GEO out of ill>,<GEO all in jam>,<ICMP time exceeded>,<flowlet kept>,<weighted>,
+// <GEO spilled bytes>,<class_C GEO spilled bytes>
+static std::string RoutingDecisionCountersCsv(const RoutingDecisionCounters& counters){
+    std::string line = std::to_string(counters.decisions) + "," + std::to_string(counters.recomputed);
+    for(size_t i = 0; i < RoutingDecisionCounters::NUM_CANDIDATES; ++i){
+        line += "," + std::to_string(counters.candidate[i]);
+    }
+    for(uint64_t value : {counters.to_geo, counters.to_geo_class_c, counters.class_a, counters.class_b,
+                          counters.class_b_loop_avoided, counters.class_b_fallback, counters.gs_all_detour,
+                          counters.geo_out_of_ill, counters.geo_all_in_jam, counters.icmp_ttl_exceeded,
+                          counters.flowlet_kept, counters.weighted, counters.geo_spilled_bytes, counters.geo_spilled_bytes_class_c}){
+        line += "," + std::to_string(value);
+    }
+    return line;
+}
+
+void ArbiterLEOGSGEOHelper::WriteRoutingDecisionCounters(std::string prefix){
+    std::cout << "STORE ROUTING DECISION COUNTERS" << std::endl;
+
+    // routing_decision_counters.csv (line format: <node id>,<LEO/GS/GEO>,<counters>)
+    std::string filename = prefix + "routing_decision_counters.csv";
+    std::ofstream file_csv(filename);
+    size_t num_leo_gs = m_arbiters_leo.size() + m_arbiters_gs.size();
+    for(size_t i = 0; i < m_arbiters_leo.size(); ++i){
+        file_csv << i << ",LEO," << RoutingDecisionCountersCsv(m_arbiters_leo[i]->GetRoutingDecisionCounters()) << std::endl;
+    }
+    for(size_t i = 0; i < m_arbiters_gs.size(); ++i){
+        file_csv << (m_arbiters_leo.size() + i) << ",GS," << RoutingDecisionCountersCsv(m_arbiters_gs[i]->GetRoutingDecisionCounters()) << std::endl;
+    }
+    for(size_t i = 0; i < m_arbiters_geo.size(); ++i){
+        file_csv << (num_leo_gs + i) << ",GEO," << RoutingDecisionCountersCsv(m_arbiters_geo[i]->GetRoutingDecisionCounters()) << std::endl;
+    }
+    file_csv.close();
+
+    // routing_decision_counters_over_time.csv (line format: <t>,<counters of all nodes since the start>)
+    if(m_routing_decision_counters_sample_interval_ns > 0){
+        std::ofstream samples_csv(prefix + "routing_decision_counters_over_time.csv");
+        for(const std::pair<int64_t, RoutingDecisionCounters>& sample : m_routing_decision_counters_samples){
+            samples_csv << sample.first << "," << RoutingDecisionCountersCsv(sample.second) << std::endl;
+        }
+        samples_csv.close();
+    }
+
+    // jam_areas_over_time.csv (line format: <t>,<number of jam areas from t on>)
+    std::ofstream jam_areas_csv(prefix + "jam_areas_over_time.csv");
+    size_t max_num_jam_areas = 0;
+    for(const std::pair<int64_t, size_t>& change : m_num_jam_areas_changes){
+        jam_areas_csv << change.first << "," << change.second << std::endl;
+        max_num_jam_areas = std::max(max_num_jam_areas, change.second);
+    }
+    jam_areas_csv.close();
+
+    RoutingDecisionCounters total = GetTotalRoutingDecisionCounters();
+    std::cout << "  > Decisions................ " << total.decisions << " (" << total.recomputed << " not cached)" << std::endl;
+    std::cout << "  > Candidate 0 / 1 / 2 / 3.. " << total.candidate[0];
+    for(size_t i = 1; i < RoutingDecisionCounters::NUM_CANDIDATES; ++i){
+        std::cout << " / " << total.candidate[i];
+    }
+    std::cout << std::endl;
+    std::cout << "  > To GEO (class_C)......... " << total.to_geo + total.to_geo_class_c << " (" << total.to_geo_class_c << ")" << std::endl;
+    std::cout << "  > class_B fallbacks........ " << total.class_b_fallback << " (" << total.class_b_loop_avoided << " loops avoided)" << std::endl;
+    std::cout << "  > GEO out of ill........... " << total.geo_out_of_ill << std::endl;
+    std::cout << "  > ICMP time exceeded....... " << total.icmp_ttl_exceeded << std::endl;
+    std::cout << "  > Flowlet kept............. " << total.flowlet_kept << std::endl;
+    std::cout << "  > Weighted................. " << total.weighted << std::endl;
+    std::cout << "  > GEO spilled (class_C).... " << total.geo_spilled_bytes + total.geo_spilled_bytes_class_c << " byte (" << total.geo_spilled_bytes_class_c << " byte)" << std::endl;
+    std::cout << "  > Max. jam areas........... " << max_num_jam_areas << std::endl;
+    std::cout << "  > Written to: " << filename << std::endl;
+    std::cout << std::endl;
+}
+
+NextHopCandidates ArbiterLEOGSGEOHelper::InitialEmptyForwardingState(){
+    // each LEO and ground station has K candidates for each target (-2 indicates an invalid entry)
+    m_num_next_hop_candidates = ParseNumNextHopCandidates(m_basicSimulation);
+    std::cout << "  > Next hop candidates: " << m_num_next_hop_candidates << std::endl;
+
+    // satgen writes fstate files with 3 candidates, any other number is only calculated in the simulator
+    if(m_num_next_hop_candidates != 3 && m_basicSimulation->GetConfigParamOrDefault("routing_engine", "precomputed") != "in_simulator"){
+        throw std::invalid_argument("num_next_hop_candidates other than 3 needs routing_engine=in_simulator: " + std::to_string(m_num_next_hop_candidates));
+    }
     size_t num_leo_gs = m_topology->GetNumSatellites() + m_topology->GetNumGroundStations();
-    std::vector<std::vector<std::vector<std::tuple<int32_t, int32_t, int32_t>>>> initial_forwarding_state;
-    for (size_t i = 0; i < num_leo_gs; i++) {
-        std::vector<std::vector <std::tuple<int32_t, int32_t, int32_t>>> next_hop_list;
-        for (size_t j = 0; j < num_leo_gs; j++) {
-            std::vector <std::tuple<int32_t, int32_t, int32_t>> current_list;
-            for(size_t k = 0; k < 3; ++k){          // we assume that LEO and groud station have 3 candidate
-                current_list.push_back(std::make_tuple(-2, -2, -2));
+    return NextHopCandidates(num_leo_gs, m_num_next_hop_candidates, std::make_tuple(-2, -2, -2));
+}
+
+void ArbiterLEOGSGEOHelper::ValidateInterfaceLayouts(){
+    // interface for device in satellite:
+    // 0: loop-back interface
+    // 1 ~ 4: isl interface
+    // 5: gsl interface
+    // 6: ill interface (GSL network device)
+    // interface for device in ground station / GEO satellite:
+    // 0: loop-back interface
+    // 1: gsl / ill interface
+    NodeContainer nodes = m_topology->GetNodes();
+    m_interface_kinds.resize(nodes.GetN());
+    for(uint32_t node_id = 0; node_id < nodes.GetN(); ++node_id){
+        Ptr<Ipv4> ipv4 = nodes.Get(node_id)->GetObject<Ipv4>();
+        uint32_t expected_num_interfaces = node_id < m_topology->GetNumSatellites() ? 7 : 2;
+        NS_ABORT_MSG_IF(ipv4->GetNInterfaces() != expected_num_interfaces,
+                        "Node " + std::to_string(node_id) + " must have " + std::to_string(expected_num_interfaces)
+                        + " interfaces: " + std::to_string(ipv4->GetNInterfaces()));
+        m_interface_kinds[node_id] = std::vector<InterfaceKind>(expected_num_interfaces, InterfaceKind::loopback);
+        for(uint32_t i = 1; i < expected_num_interfaces; ++i){
+            bool must_be_isl = node_id < m_topology->GetNumSatellites() && i <= 4;
+            Ptr<GSLNetDevice> gsl = ipv4->GetNetDevice(i)->GetObject<GSLNetDevice>();
+            if(must_be_isl){
+                NS_ABORT_MSG_IF(m_topology->GetIslNeighbor(node_id, i).node_id == -1,
+                                "Interface " + std::to_string(i) + " of LEO " + std::to_string(node_id) + " must be an ISL network device");
+                m_interface_kinds[node_id][i] = InterfaceKind::isl;
+            }
+            else{
+                NS_ABORT_MSG_IF(gsl == 0, "Interface " + std::to_string(i) + " of node " + std::to_string(node_id) + " must be a GSL network device");
+                m_interface_kinds[node_id][i] = InterfaceKind::gsl;
             }
-            next_hop_list.push_back(current_list); // -2 indicates an invalid entry
         }
-        initial_forwarding_state.push_back(next_hop_list);
     }
-    return initial_forwarding_state;
+}
+
+void ArbiterLEOGSGEOHelper::InitializeRoutingEngine(){
+    m_routing_engine_mode = m_basicSimulation->GetConfigParamOrDefault("routing_engine", "precomputed");
+    std::cout << "  > Routing engine: " << m_routing_engine_mode << std::endl;
+    if(m_routing_engine_mode == "in_simulator" || m_routing_engine_mode == "validate"){
+        m_routing_engine = CreateObject<SatnetRoutingEngine>(m_basicSimulation, m_topology);
+    }
+    else if(m_routing_engine_mode != "precomputed"){
+        throw std::runtime_error("Unknown routing engine: " + m_routing_engine_mode);
+    }
+
+    // Without precomputed routes, the ills files are not needed either
+    m_ills_source = m_basicSimulation->GetConfigParamOrDefault("ills_source", m_routing_engine_mode == "in_simulator" ? "in_simulator" : "precomputed");
+    std::cout << "  > ILLs source: " << m_ills_source << std::endl;
+    if(m_ills_source == "in_simulator" || m_routing_engine_mode == "validate"){
+        m_geo_coverage_engine = CreateObject<GeoCoverageEngine>(m_basicSimulation, m_topology);
+    }
+    else if(m_ills_source != "precomputed"){
+        throw std::runtime_error("Unknown ills source: " + m_ills_source);
+    }
+
+    // The validation diffs the ills files against the coverage engine, as such they must be read
+    if(m_routing_engine_mode == "validate" && m_ills_source != "precomputed"){
+        throw std::invalid_argument("routing_engine=validate requires ills_source=precomputed (the ills files are validated)");
+    }
 }
 
 void ArbiterLEOGSGEOHelper::UpdateState(int64_t t){
-    UpdateForwardingState(t);
-    UpdateIllsState(t);
+    if(m_routing_engine_mode == "in_simulator"){
+        UpdateForwardingStateFromRoutingEngine();
+    }
+    else{
+        UpdateForwardingState(t);
+    }
+    if(m_ills_source == "in_simulator"){
+        UpdateIllsStateFromCoverageEngine();
+    }
+    else{
+        UpdateIllsState(t);
+    }
+    if(m_routing_engine_mode == "validate"){
+        ValidateRoutingEngine(t);
+    }
+
+    // The walk of the GEO arbiters depends on both the forwarding and the ills state
+    for(Ptr<ArbiterGEO> arbiter : m_arbiters_geo){
+        arbiter->NotifyNeighborStateChanged(-1);
+    }
 
     // Given that this code will only be used with satellite networks, this is okay-ish,
     // but it does create a very tight coupling between the two -- technically this class
@@ -123,11 +543,109 @@ void ArbiterLEOGSGEOHelper::UpdateState(int64_t t){
     }
 }
 
+void ArbiterLEOGSGEOHelper::UpdateDetourState(){
+    // Only the system which simulates a LEO satellite receives its packets,
+    // as such only there its receive data rates can be measured
+    uint32_t system_id = m_basicSimulation->GetSystemId();
+    if(m_measure_receive_datarates){
+        for(size_t sat = 0; sat < m_arbiters_leo.size(); ++sat){
+            if(m_topology->GetNodes().Get(sat)->GetSystemId() == system_id){
+                m_arbiters_leo[sat]->UpdateReceiveDatarate();
+            }
+        }
+        if(m_basicSimulation->IsDistributedEnabled() && m_basicSimulation->GetSystemsCount() > 1){
+            ExchangeReceiveDatarates();
+        }
+    }
+
+    // The ILL utilization of the GEO satellites, which the LEO satellites spill by
+    // (without measurement the fluid engine sets it from the loads of the flows)
+    if(ArbiterLEO::IsGEOSpillEnabled() && m_measure_receive_datarates){
+        size_t first_geo = m_topology->GetNumSatellites() + m_topology->GetNumGroundStations();
+        for(size_t geo = 0; geo < m_arbiters_geo.size(); ++geo){
+            if(m_topology->GetNodes().Get(first_geo + geo)->GetSystemId() == system_id){
+                m_arbiters_geo[geo]->UpdateIllUtilization();
+            }
+        }
+        if(m_basicSimulation->IsDistributedEnabled() && m_basicSimulation->GetSystemsCount() > 1){
+            ExchangeIllUtilizations();
+        }
+    }
+
+    // The jam areas are shared by all LEO satellites, so every system updates
+    // all of them in the same order (which keeps it equal to a single process run)
+    for(Ptr<ArbiterLEO> arbiter : m_arbiters_leo){
+        arbiter->UpdateState();
+    }
+    ArbiterLEO::AdvanceResidualTick();      // the weight tables of the arbiters are read again
+    if(m_enable_routing_decision_counters){
+        size_t num_jam_areas = ArbiterLEO::GetNumTraficJamAreas();
+        if(m_num_jam_areas_changes.empty() || m_num_jam_areas_changes.back().second != num_jam_areas){
+            m_num_jam_areas_changes.push_back(std::make_pair(Simulator::Now().GetNanoSeconds(), num_jam_areas));
+        }
+    }
+
+    // Plan next update (same signature as SampleRoutingDecisionCounters, labeled to tell them apart in the event profile)
+    ScheduleLabeled("ArbiterLEOGSGEOHelper::UpdateDetourState", NanoSeconds(m_receive_datarate_update_interval_ns), &ArbiterLEOGSGEOHelper::UpdateDetourState, this);
+}
+
+void ArbiterLEOGSGEOHelper::ExchangeReceiveDatarates(){
+#ifdef NS3_MPI
+    // Each system fills in the LEO satellites it simulates and leaves the others at zero,
+    // as such the sum over all systems is the measurement of every LEO satellite.
+    // All systems are at the same update event (the granted time window of the
+    // distributed scheduler is the same for all), so the collective call is safe.
+    size_t num_interfaces = m_arbiters_leo.empty() ? 0 : m_arbiters_leo[0]->GetReceiveDatarates().size();
+    uint32_t system_id = m_basicSimulation->GetSystemId();
+    std::vector<uint64_t> local_bps(m_arbiters_leo.size() * num_interfaces, 0);
+    for(size_t sat = 0; sat < m_arbiters_leo.size(); ++sat){
+        if(m_topology->GetNodes().Get(sat)->GetSystemId() == system_id){
+            const std::vector<uint64_t>& receive_bps = m_arbiters_leo[sat]->GetReceiveDatarates();
+            std::copy(receive_bps.begin(), receive_bps.end(), local_bps.begin() + sat * num_interfaces);
+        }
+    }
+    std::vector<uint64_t> all_bps(local_bps.size(), 0);
+    MPI_Allreduce(local_bps.data(), all_bps.data(), local_bps.size(), MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD);
+    for(size_t sat = 0; sat < m_arbiters_leo.size(); ++sat){
+        if(m_topology->GetNodes().Get(sat)->GetSystemId() != system_id){
+            m_arbiters_leo[sat]->SetReceiveDatarates(std::vector<uint64_t>(
+                    all_bps.begin() + sat * num_interfaces,
+                    all_bps.begin() + (sat + 1) * num_interfaces
+            ));
+        }
+    }
+#else
+    NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
+#endif
+}
+
+void ArbiterLEOGSGEOHelper::ExchangeIllUtilizations(){
+#ifdef NS3_MPI
+    // As the receive data rates: each system fills in the GEO satellites it simulates
+    size_t first_geo = m_topology->GetNumSatellites() + m_topology->GetNumGroundStations();
+    uint32_t system_id = m_basicSimulation->GetSystemId();
+    std::vector<double> local_utilizations(m_arbiters_geo.size(), 0);
+    for(size_t geo = 0; geo < m_arbiters_geo.size(); ++geo){
+        if(m_topology->GetNodes().Get(first_geo + geo)->GetSystemId() == system_id){
+            local_utilizations[geo] = m_arbiters_geo[geo]->GetIllUtilization();
+        }
+    }
+    std::vector<double> all_utilizations(local_utilizations.size(), 0);
+    MPI_Allreduce(local_utilizations.data(), all_utilizations.data(), local_utilizations.size(), MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    for(size_t geo = 0; geo < m_arbiters_geo.size(); ++geo){
+        if(m_topology->GetNodes().Get(first_geo + geo)->GetSystemId() != system_id){
+            m_arbiters_geo[geo]->SetIllUtilization(all_utilizations[geo]);
+        }
+    }
+#else
+    NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
+#endif
+}
+
 void ArbiterLEOGSGEOHelper::UpdateForwardingState(int64_t t) {
     /**
      * update LEO GS forwarding state
     */
-    NodeContainer m_nodes = m_topology->GetNodes();
 
     // Filename
     std::ostringstream res;
@@ -141,125 +659,169 @@ void ArbiterLEOGSGEOHelper::UpdateForwardingState(int64_t t) {
     }
 
     // Open file
-    std::string line;
     std::ifstream fstate_file(filename);
     if (fstate_file) {
-        // Go over each line
-        while (getline(fstate_file, line)) {
+        switch(m_num_next_hop_candidates){
+            case 1: ReadForwardingState<1>(fstate_file); break;
+            case 2: ReadForwardingState<2>(fstate_file); break;
+            case 3: ReadForwardingState<3>(fstate_file); break;
+            case 4: ReadForwardingState<4>(fstate_file); break;
+            default: NS_ABORT_MSG("Unsupported number of next hop candidates");
+        }
 
-            // Split on ,
-            std::vector<std::string> comma_split = split_string(line, ",", 11);
+        // Close file
+        fstate_file.close();
 
-            // Retrieve identifiers
-            int64_t current_node_id = parse_positive_int64(comma_split[0]);
-            int64_t target_node_id = parse_positive_int64(comma_split[1]);
-
-            std::vector<std::tuple<int32_t, int32_t, int32_t>> next_hop_list;
-            for(size_t i = 2; i < 11; i += 3){
-                int64_t next_hop_node_id = parse_int64(comma_split[i]);
-                int64_t my_if_id = parse_int64(comma_split[i + 1]);
-                int64_t next_if_id = parse_int64(comma_split[i + 2]);
-
-                int64_t num_leo_gs = m_topology->GetNumSatellites() + m_topology->GetNumGroundStations();
-                // Check the node identifiers
-                NS_ABORT_MSG_IF(current_node_id < 0 || current_node_id >= num_leo_gs, "Invalid current node id.");
-                NS_ABORT_MSG_IF(target_node_id < 0 || target_node_id >= num_leo_gs, "Invalid target node id.");
-                NS_ABORT_MSG_IF(next_hop_node_id < -1 || next_hop_node_id >= num_leo_gs, "Invalid next hop node id.");
-
-                // Drops are only valid if all three values are -1
+    } else {
+        throw std::runtime_error(format_string("File %s could not be read.", filename.c_str()));
+    }
+}
+
+template <size_t K>
+void ArbiterLEOGSGEOHelper::ReadForwardingState(std::ifstream& fstate_file) {
+    int64_t num_satellites = m_topology->GetNumSatellites();
+    int64_t num_leo_gs = num_satellites + m_topology->GetNumGroundStations();
+
+    // Go over each line
+    std::string line;
+    std::array<std::array<int64_t, 3>, K> next_hops;
+    std::vector<std::tuple<int32_t, int32_t, int32_t>> next_hop_list(K);
+    while (getline(fstate_file, line)) {
+
+        // Retrieve identifiers: <current>,<target>, then K times <next hop>,<my if>,<next if>
+        int64_t current_node_id;
+        int64_t target_node_id;
+        ParseFstateLine<K>(line, current_node_id, target_node_id, next_hops);
+
+        // Check the node identifiers
+        NS_ABORT_MSG_IF(current_node_id >= num_leo_gs, "Invalid current node id.");
+        NS_ABORT_MSG_IF(target_node_id >= num_leo_gs, "Invalid target node id.");
+
+        for(size_t i = 0; i < K; ++i){
+            int64_t next_hop_node_id = next_hops[i][0];
+            int64_t my_if_id = next_hops[i][1];
+            int64_t next_if_id = next_hops[i][2];
+            NS_ABORT_MSG_IF(next_hop_node_id < -1 || next_hop_node_id >= num_leo_gs, "Invalid next hop node id.");
+
+            // Drops are only valid if all three values are -1
+            bool is_drop = next_hop_node_id == -1 && my_if_id == -1 && next_if_id == -1;
+            NS_ABORT_MSG_IF(
+                    !is_drop && !(next_hop_node_id != -1 && my_if_id != -1 && next_if_id != -1),
+                    "All three must be -1 for it to signify a drop."
+            );
+
+            // Node id and interface id checks are only necessary for non-drops, against the
+            // interface layout which was validated at install (the ILL interface is not in the fstate):
+            //  LEO: 1 ~ 4 isl interface, 5 gsl interface; ground station: 1 gsl interface
+            if (!is_drop) {
+                int64_t num_current_interfaces = current_node_id < num_satellites ? 6 : 2;
+                int64_t num_next_interfaces = next_hop_node_id < num_satellites ? 6 : 2;
+                NS_ABORT_MSG_UNLESS(my_if_id >= 0 && my_if_id + 1 < num_current_interfaces, "Invalid current interface");
+                NS_ABORT_MSG_UNLESS(next_if_id >= 0 && next_if_id + 1 < num_next_interfaces, "Invalid next hop interface");
+
+                // If current is a GSL interface, the destination must also be a GSL interface
+                InterfaceKind source_kind = m_interface_kinds[current_node_id][1 + my_if_id];
+                InterfaceKind destination_kind = m_interface_kinds[next_hop_node_id][1 + next_if_id];
                 NS_ABORT_MSG_IF(
-                        !(next_hop_node_id == -1 && my_if_id == -1 && next_if_id == -1)
-                        &&
-                        !(next_hop_node_id != -1 && my_if_id != -1 && next_if_id != -1),
-                        "All three must be -1 for it to signify a drop."
+                    source_kind == InterfaceKind::gsl && destination_kind != InterfaceKind::gsl,
+                    "Destination interface must be attached to a GSL network device"
                 );
 
-                // Check the interfaces exist
-                /**
-                 *  // interface for device in satellite:
-                    // 0: loop-back interface
-                    // 1 ~ 4: isl interface
-                    // 5: gsl interface
-                    // 6: ill interface
-                    // interface for device in ground station:
-                    // 0: loop-back interface
-                    // 1: gsl interface
-                */
-                if(current_node_id < m_topology->GetNumSatellites()){
-                    NS_ABORT_MSG_UNLESS(my_if_id == -1 || 
-                                        (my_if_id >= 0 && my_if_id + 2 < m_nodes.Get(current_node_id)->GetObject<Ipv4>()->GetNInterfaces()), 
-                                        "Invalid current interface");
-                }
-                else{
-                    NS_ABORT_MSG_UNLESS(my_if_id == -1 || 
-                                        (my_if_id >= 0 && my_if_id + 1 < m_nodes.Get(current_node_id)->GetObject<Ipv4>()->GetNInterfaces()), 
-                                        "Invalid current interface");
+                // If current is a p2p laser interface, the destination must match exactly its counter-part
+                if (source_kind == InterfaceKind::isl) {
+                    NS_ABORT_MSG_IF(destination_kind != InterfaceKind::isl, "Destination interface must be an ISL network device");
+                    const IslNeighbor& neighbor = m_topology->GetIslNeighbor(current_node_id, 1 + my_if_id);
+                    NS_ABORT_MSG_IF(neighbor.node_id != next_hop_node_id, "Next hop node id across does not match");
+                    NS_ABORT_MSG_IF(neighbor.interface != 1 + next_if_id, "Next hop interface id across does not match");
                 }
+            }
 
-                if(next_hop_node_id < m_topology->GetNumSatellites()){
-                    NS_ABORT_MSG_UNLESS(next_if_id == -1 || 
-                                        (next_if_id >= 0 && next_if_id + 2 < m_nodes.Get(next_hop_node_id)->GetObject<Ipv4>()->GetNInterfaces()), 
-                                        "Invalid next hop interface");
-                }
-                else{
-                    NS_ABORT_MSG_UNLESS(next_if_id == -1 || 
-                                        (next_if_id >= 0 && next_if_id + 1 < m_nodes.Get(next_hop_node_id)->GetObject<Ipv4>()->GetNInterfaces()), 
-                                        "Invalid next hop interface");
-                }
+            // The same next hop (and drop) as the routing engine calculates
+            next_hop_list[i] = FstateNextHop(next_hop_node_id, my_if_id, next_if_id);
+        }
+
+        // Add to forwarding state
+        SetForwardState(current_node_id, target_node_id, next_hop_list);
+    }
+}
 
-                // Node id and interface id checks are only necessary for non-drops
-                if (next_hop_node_id != -1 && my_if_id != -1 && next_if_id != -1) {
-
-                    // It must be either GSL or ISL
-                    bool source_is_gsl = m_nodes.Get(current_node_id)->GetObject<Ipv4>()->GetNetDevice(1 + my_if_id)->GetObject<GSLNetDevice>() != 0;
-                    bool source_is_isl = m_nodes.Get(current_node_id)->GetObject<Ipv4>()->GetNetDevice(1 + my_if_id)->GetObject<PointToPointLaserNetDevice>() != 0;
-                    NS_ABORT_MSG_IF((!source_is_gsl) && (!source_is_isl), "Only GSL and ISL network devices are supported");
-
-                    // If current is a GSL interface, the destination must also be a GSL interface
-                    NS_ABORT_MSG_IF(
-                        source_is_gsl &&
-                        m_nodes.Get(next_hop_node_id)->GetObject<Ipv4>()->GetNetDevice(1 + next_if_id)->GetObject<GSLNetDevice>() == 0,
-                        "Destination interface must be attached to a GSL network device"
-                    );
-
-                    // If current is a p2p laser interface, the destination must match exactly its counter-part
-                    NS_ABORT_MSG_IF(
-                        source_is_isl &&
-                        m_nodes.Get(next_hop_node_id)->GetObject<Ipv4>()->GetNetDevice(1 + next_if_id)->GetObject<PointToPointLaserNetDevice>() == 0,
-                        "Destination interface must be an ISL network device"
-                    );
-
-                    if (source_is_isl) {
-                        Ptr<NetDevice> device0 = m_nodes.Get(current_node_id)->GetObject<Ipv4>()->GetNetDevice(1 + my_if_id)->GetObject<PointToPointLaserNetDevice>()->GetChannel()->GetDevice(0);
-                        Ptr<NetDevice> device1 = m_nodes.Get(current_node_id)->GetObject<Ipv4>()->GetNetDevice(1 + my_if_id)->GetObject<PointToPointLaserNetDevice>()->GetChannel()->GetDevice(1);
-                        Ptr<NetDevice> other_device = device0->GetNode()->GetId() == current_node_id ? device1 : device0;
-                        NS_ABORT_MSG_IF(other_device->GetNode()->GetId() != next_hop_node_id, "Next hop node id across does not match");
-                        NS_ABORT_MSG_IF(other_device->GetIfIndex() != 1 + next_if_id, "Next hop interface id across does not match");
-                    }
+void ArbiterLEOGSGEOHelper::SetForwardState(
+        int32_t current_node_id,
+        int32_t target_node_id,
+        const std::vector<std::tuple<int32_t, int32_t, int32_t>>& next_hop_list
+){
+    if(current_node_id < (int32_t) m_topology->GetNumSatellites()){
+        UpdateDetourSubscriptions(current_node_id, target_node_id, m_arbiters_leo.at(current_node_id)->GetLEOForwardState(target_node_id), next_hop_list);
+        m_arbiters_leo.at(current_node_id)->SetLEOForwardState(target_node_id, next_hop_list);
+    }
+    else{
+        int64_t index = current_node_id - m_topology->GetNumSatellites();
+        UpdateDetourSubscriptions(current_node_id, target_node_id, m_arbiters_gs.at(index)->GetGSForwardState(target_node_id), next_hop_list);
+        m_arbiters_gs.at(index)->SetGSForwardState(target_node_id, next_hop_list);
+    }
+}
 
-                }
-            
-                // Add to temp next_hop_list
-                // Add 1 for skip the loop-back interface
-                next_hop_list.push_back(std::make_tuple(next_hop_node_id, my_if_id + 1, next_if_id + 1));
+void ArbiterLEOGSGEOHelper::UpdateForwardingStateFromRoutingEngine(){
+    m_routing_engine->Calculate();
+
+    // Only the entries which changed are given to the arbiters (as the incremental fstate files)
+    int32_t num_satellites = m_topology->GetNumSatellites();
+    int32_t num_leo_gs = num_satellites + m_topology->GetNumGroundStations();
+    for(int32_t current_node_id = 0; current_node_id < num_leo_gs; ++current_node_id){
+        for(int32_t target_node_id = num_satellites; target_node_id < num_leo_gs; ++target_node_id){
+            if(current_node_id == target_node_id) continue;
+            const std::vector<std::tuple<int32_t, int32_t, int32_t>>& next_hop_list = m_routing_engine->GetForwardState(current_node_id, target_node_id);
+            std::vector<std::tuple<int32_t, int32_t, int32_t>> current_list = current_node_id < num_satellites ?
+                    m_arbiters_leo.at(current_node_id)->GetLEOForwardState(target_node_id) :
+                    m_arbiters_gs.at(current_node_id - num_satellites)->GetGSForwardState(target_node_id);
+            if(current_list != next_hop_list){
+                SetForwardState(current_node_id, target_node_id, next_hop_list);
             }
+        }
+    }
+}
+
+void ArbiterLEOGSGEOHelper::UpdateIllsStateFromCoverageEngine(){
+    // Only the LEOs which are handed over to another GEO
+    for(int32_t sat : m_geo_coverage_engine->Update()){
+        m_arbiters_leo.at(sat)->SetLEONextGEOID(m_geo_coverage_engine->GetNextGEOID(sat));
+    }
+}
 
-            // Add to forwarding state
-            if(current_node_id < m_topology->GetNumSatellites()){
-                m_arbiters_leo.at(current_node_id)->SetLEOForwardState(target_node_id, next_hop_list);
+void ArbiterLEOGSGEOHelper::ValidateRoutingEngine(int64_t t){
+    m_routing_engine->Calculate();
+
+    // Diff the state loaded from the files against the state of the routing engine
+    int32_t num_satellites = m_topology->GetNumSatellites();
+    int32_t num_leo_gs = num_satellites + m_topology->GetNumGroundStations();
+    int64_t num_entries = 0;
+    int64_t num_first_hop_diffs = 0;
+    int64_t num_candidate_diffs = 0;
+    int64_t num_ills_diffs = 0;
+    for(int32_t current_node_id = 0; current_node_id < num_leo_gs; ++current_node_id){
+        for(int32_t target_node_id = num_satellites; target_node_id < num_leo_gs; ++target_node_id){
+            if(current_node_id == target_node_id) continue;
+            const std::vector<std::tuple<int32_t, int32_t, int32_t>>& next_hop_list = m_routing_engine->GetForwardState(current_node_id, target_node_id);
+            std::vector<std::tuple<int32_t, int32_t, int32_t>> current_list = current_node_id < num_satellites ?
+                    m_arbiters_leo.at(current_node_id)->GetLEOForwardState(target_node_id) :
+                    m_arbiters_gs.at(current_node_id - num_satellites)->GetGSForwardState(target_node_id);
+            num_entries += 1;
+            if(current_list[0] != next_hop_list[0]){
+                num_first_hop_diffs += 1;
             }
-            else{
-                int64_t index = current_node_id - m_topology->GetNumSatellites();
-                m_arbiters_gs.at(index)->SetGSForwardState(target_node_id, next_hop_list);
+            if(current_list != next_hop_list){
+                num_candidate_diffs += 1;
             }
         }
-
-        // Close file
-        fstate_file.close();
-
-    } else {
-        throw std::runtime_error(format_string("File %s could not be read.", filename.c_str()));
     }
+    m_geo_coverage_engine->Update();
+    for(int32_t sat = 0; sat < num_satellites; ++sat){
+        if(m_arbiters_leo.at(sat)->GetLEONextGEOID() != m_geo_coverage_engine->GetNextGEOID(sat)){
+            num_ills_diffs += 1;
+        }
+    }
+
+    m_routing_engine_validation.push_back({t, num_entries, num_first_hop_diffs, num_candidate_diffs, num_ills_diffs});
 }
 
 void ArbiterLEOGSGEOHelper::UpdateIllsState(int64_t t){
@@ -14,6 +14,12 @@
 #include "ns3/arbiter-gs.h"
 #include "ns3/arbiter-geo.h"
 #include "ns3/arbiter-helper.h"
+#include "ns3/satnet-routing-engine.h"
+#include "ns3/geo-coverage-engine.h"
+#include "ns3/jam-area-predictor.h"
+#include "ns3/jam-area-membership.h"
+#include "ns3/next-hop-candidates.h"
+#include <unordered_map>
 
 namespace ns3 {
 
@@ -31,17 +37,105 @@ namespace ns3 {
 
         Ptr<BasicSimulation> GetBasicSimulation();
 
+        // Predicted jam area membership, 0 if the LEO arbiters check the distance at each update
+        Ptr<JamAreaPredictor> GetJamAreaPredictor();
+        Ptr<JamAreaMembership> GetJamAreaMembership();
+
+        /**
+         * Publish a detour state flip of a LEO satellite. Only the arbiters which currently use
+         * the LEO as a candidate next hop are notified (GEO arbiters are notified of jam area flips).
+         *
+         * @param leo_node_id           LEO satellite whose state flipped
+         * @param detour_flipped        True iff at least one of its interfaces_need_detour flipped
+         * @param jam_flipped           True iff its is_in_jam_area flipped
+         */
+        void NotifyDetourStateChanged(int32_t leo_node_id, bool detour_flipped, bool jam_flipped);
+
+        // The receive data rates of the LEO satellites are set with ArbiterLEO::SetReceiveDatarates,
+        // and the ILL utilization of the GEO satellites with ArbiterGEO::SetIllUtilization, before
+        // each detour update (fluid engine) instead of being measured on their net devices
+        void DisableReceiveDatarateMeasurement();
+
+        void WriteResults() override;
+
     protected:
-        std::vector<std::vector<std::vector<std::tuple<int32_t, int32_t, int32_t>>>> InitialEmptyForwardingState();
+        NextHopCandidates InitialEmptyForwardingState();
+        void ValidateInterfaceLayouts();
         void UpdateState(int64_t t);
+        void UpdateDetourState();
+        void ExchangeReceiveDatarates();
+        void ExchangeIllUtilizations();
         void UpdateForwardingState(int64_t t);
+        template <size_t K>
+        void ReadForwardingState(std::ifstream& fstate_file);
         void UpdateIllsState(int64_t t);
+        void SetForwardState(int32_t current_node_id, int32_t target_node_id, const std::vector<std::tuple<int32_t, int32_t, int32_t>>& next_hop_list);
+
+        // In-simulator routing and GEO coverage engine
+        void InitializeRoutingEngine();
+        void InitializeJamAreaPredictor();
+        void InitializeRoutingDecisionCounters();
+        RoutingDecisionCounters GetTotalRoutingDecisionCounters();
+        void SampleRoutingDecisionCounters();
+        void WriteRoutingDecisionCounters(std::string prefix);
+        void InitializeMemoryReport();
+        uint64_t EstimateForwardingStateMemoryBytes();
+        uint64_t EstimateIpToNodeIdMemoryBytes();
+        uint64_t EstimateGEODecisionCacheMemoryBytes();
+        uint64_t EstimateDetourSubscribersMemoryBytes();
+        void UpdateForwardingStateFromRoutingEngine();
+        void UpdateIllsStateFromCoverageEngine();
+        void ValidateRoutingEngine(int64_t t);
+        void UpdateDetourSubscriptions(
+                int32_t subscriber_node_id,
+                int32_t target_node_id,
+                const std::vector<std::tuple<int32_t, int32_t, int32_t>>& previous_next_hop_list,
+                const std::vector<std::tuple<int32_t, int32_t, int32_t>>& next_hop_list
+        );
 
         // Parameters
         int64_t m_dynamicStateUpdateIntervalNs;
+        int64_t m_receive_datarate_update_interval_ns;
+        bool m_measure_receive_datarates;
         std::vector<Ptr<ArbiterLEO>> m_arbiters_leo;
         std::vector<Ptr<ArbiterGS>> m_arbiters_gs;
         std::vector<Ptr<ArbiterGEO>> m_arbiters_geo;
+        size_t m_num_next_hop_candidates;                   // K candidates of each forwarding state entry
+
+        // Interface layout of the nodes, validated once at install (LEO: 1 ~ 4 ISL, 5 GSL, 6 ILL;
+        // GS: 1 GSL; GEO: 1 ILL), for the checks of the forwarding state (the satellite across
+        // an ISL is in the ISL neighbor table of the topology)
+        enum class InterfaceKind : uint8_t { loopback, isl, gsl };
+        std::vector<std::vector<InterfaceKind>> m_interface_kinds;                  // per node, per interface
+
+        // Source of the forwarding and ills state:
+        //  "precomputed": fstate/ills files of satellite_network_routes_dir
+        //  "in_simulator": calculated by the routing engine from the mobility models
+        //  "validate": precomputed, but diffed against the routing engine at each update
+        std::string m_routing_engine_mode;
+        Ptr<SatnetRoutingEngine> m_routing_engine;
+        std::string m_ills_source;                          // "precomputed" (ills files) or "in_simulator"
+        Ptr<GeoCoverageEngine> m_geo_coverage_engine;
+        std::vector<std::vector<int64_t>> m_routing_engine_validation;  // per update: t, entries, first hop diffs,
+                                                                        // candidate diffs, ills diffs
+
+        // Jam area detection: "polling" (distance at each detour update) or "predicted"
+        std::string m_jam_area_detection;
+        Ptr<JamAreaPredictor> m_jam_area_predictor;             // trafic_jam_area_detection=predicted
+        Ptr<JamAreaMembership> m_jam_area_membership;           // trafic_jam_area_detection=polling
+
+        // Detour state publish/subscribe
+        std::vector<std::unordered_map<int32_t, std::vector<int32_t>>> m_detour_subscribers;    // for each LEO, the LEO/GS nodes which use it
+                                                                                                // as a candidate, and for which targets
+        std::vector<uint64_t> m_detour_flips_per_second;            // number of detour flag flips in each simulated second
+        std::vector<uint64_t> m_jam_flips_per_second;               // number of jam area status flips in each simulated second
+
+        // Routing decision counters of the arbiters (written if enable_routing_decision_counters),
+        // their totals sampled each routing_decision_counters_sample_interval_ns (0: not sampled)
+        bool m_enable_routing_decision_counters;
+        int64_t m_routing_decision_counters_sample_interval_ns;
+        std::vector<std::pair<int64_t, RoutingDecisionCounters>> m_routing_decision_counters_samples;
+        std::vector<std::pair<int64_t, size_t>> m_num_jam_areas_changes;    // (t, number of jam areas) at each change
     };
 
 } // namespace ns3
@@ -31,23 +31,31 @@ void ArbiterTrafficClassifyHelper::Install(){
     NodeContainer m_nodes = m_topology->GetNodes();
 
     // Read in initial forwarding state
-    std::vector<std::vector<std::vector<std::tuple<int32_t, int32_t, int32_t>>>> initial_forwarding_state = InitialEmptyForwardingState();
+    ValidateInterfaceLayouts();
+    NextHopCandidates initial_forwarding_state = InitialEmptyForwardingState();
+    m_detour_subscribers.resize(m_topology->GetNumSatellites());
 
-    // Initialize
+    // Initialize (the flowlet config is shared by the LEO and GS arbiters)
+    FlowletTable::Initialize(m_basicSimulation);
     ArbiterTrafficLEO::InitializeArbiter(m_basicSimulation, m_topology->GetNumSatellites(), m_topology->GetNumGroundStations(), m_topology->GetNumGEOSatellites());
     ArbiterGS::InitializeArbiter(m_basicSimulation, m_topology->GetNumSatellites(), m_topology->GetNumGroundStations(), m_topology->GetNumGEOSatellites());
     ArbiterGEO::InitializeArbiter(m_basicSimulation, m_topology->GetNumSatellites(), m_topology->GetNumGroundStations(), m_topology->GetNumGEOSatellites());
+    InitializeJamAreaPredictor();
+    InitializeRoutingDecisionCounters();
+    InitializeMemoryReport();
     // Set the routing arbiters
     std::cout << "  > Setting the routing arbiter on LEO node" << std::endl;
     for (size_t i = 0; i < m_topology->GetNumSatellites(); i++) {
-        Ptr<ArbiterTrafficLEO> arbiter = CreateObject<ArbiterTrafficLEO>(m_nodes.Get(i), m_nodes, -2, initial_forwarding_state[i], this);
+        Ptr<ArbiterTrafficLEO> arbiter = CreateObject<ArbiterTrafficLEO>(m_nodes.Get(i), m_nodes, -2, initial_forwarding_state, this);
         m_arbiters_leo.push_back(arbiter);
         m_nodes.Get(i)->GetObject<Ipv4>()->GetRoutingProtocol()->GetObject<Ipv4ArbiterRouting>()->SetArbiter(arbiter);
     }
+    m_receive_datarate_update_interval_ns = parse_positive_int64(m_basicSimulation->GetConfigParamOrFail("receive_datarate_update_interval_ns"));
+    UpdateDetourState();
     std::cout << "  > Setting the routing arbiter on GS node" << std::endl;
     for (size_t i = 0; i < m_topology->GetNumGroundStations(); i++) {
         size_t gs_id = i + m_topology->GetNumSatellites();
-        Ptr<ArbiterGS> arbiter = CreateObject<ArbiterGS>(m_nodes.Get(gs_id), m_nodes, initial_forwarding_state[gs_id], this);
+        Ptr<ArbiterGS> arbiter = CreateObject<ArbiterGS>(m_nodes.Get(gs_id), m_nodes, initial_forwarding_state, this);
         m_arbiters_gs.push_back(arbiter);
         m_nodes.Get(gs_id)->GetObject<Ipv4>()->GetRoutingProtocol()->GetObject<Ipv4ArbiterRouting>()->SetArbiter(arbiter);
     }
@@ -63,6 +71,7 @@ void ArbiterTrafficClassifyHelper::Install(){
     // Load first forwarding state
     m_dynamicStateUpdateIntervalNs = parse_positive_int64(m_basicSimulation->GetConfigParamOrFail("dynamic_state_update_interval_ns"));
     std::cout << "  > Dynamic update interval: " << m_dynamicStateUpdateIntervalNs << "ns" << std::endl;
+    InitializeRoutingEngine();
     std::cout << "  > Perform first update state load for t=0" << std::endl;
     UpdateState(0);
     m_basicSimulation->RegisterTimestamp("Initialize Traffic Classify LEOGSGEO dynamic state");
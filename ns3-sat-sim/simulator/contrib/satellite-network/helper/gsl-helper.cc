@@ -115,7 +115,8 @@ GSLHelper::Install (NodeContainer satellites, NodeContainer ground_stations, std
 
     // The lower bound for the GSL channel must be set to facilitate distributed simulation.
     // However, this is challenging, as delays vary over time based on the movement.
-    // As such, for now this delay = lookahead time is set to 0.
+    // As such, it is set to 0 here, and in distributed mode the topology lowers it to the
+    // smallest delay the links can have over the simulation (see ConfigureDistributedLookahead)
     // (see also the Delay attribute in gsl-channel.cc)
     channel->SetAttribute("Delay", TimeValue(Seconds(0)));
 
@@ -123,39 +123,36 @@ PointToPointLaserHelper::Install (Ptr<Node> a, Ptr<Node> b)
   ndqiB->GetTxQueue (0)->ConnectQueueTraces (queueB);
   devB->AggregateObject (ndqiB);
 
-  // Distributed mode
-  NS_ABORT_MSG_IF(MpiInterface::IsEnabled(), "Distributed mode is not currently supported for point-to-point lasers.");
-
-  // Distributed mode is not currently supported, enable the below if it is:
-//  // If MPI is enabled, we need to see if both nodes have the same system id
-//  // (rank), and the rank is the same as this instance.  If both are true,
-//  //use a normal p2p channel, otherwise use a remote channel
-//  bool useNormalChannel = true;
-//  Ptr<PointToPointLaserChannel> channel = 0;
-//
-//  if (MpiInterface::IsEnabled ()) {
-//      uint32_t n1SystemId = a->GetSystemId ();
-//      uint32_t n2SystemId = b->GetSystemId ();
-//      uint32_t currSystemId = MpiInterface::GetSystemId ();
-//      if (n1SystemId != currSystemId || n2SystemId != currSystemId) {
-//          useNormalChannel = false;
-//      }
-//  }
-//  if (useNormalChannel) {
-//    channel = m_channelFactory.Create<PointToPointLaserChannel> ();
-//  }
-//  else {
-//    channel = m_remoteChannelFactory.Create<PointToPointLaserRemoteChannel>();
-//    Ptr<MpiReceiver> mpiRecA = CreateObject<MpiReceiver> ();
-//    Ptr<MpiReceiver> mpiRecB = CreateObject<MpiReceiver> ();
-//    mpiRecA->SetReceiveCallback (MakeCallback (&PointToPointLaserNetDevice::Receive, devA));
-//    mpiRecB->SetReceiveCallback (MakeCallback (&PointToPointLaserNetDevice::Receive, devB));
-//    devA->AggregateObject (mpiRecA);
-//    devB->AggregateObject (mpiRecB);
-//  }
-
-  // Create and attach channel
-  Ptr<PointToPointLaserChannel> channel = m_channelFactory.Create<PointToPointLaserChannel> ();
+  // If MPI is enabled, we need to see if both nodes have the same system id
+  // (rank), and the rank is the same as this instance.  If both are true,
+  // use a normal p2p channel, otherwise use a remote channel
+  bool useNormalChannel = true;
+  Ptr<PointToPointLaserChannel> channel = 0;
+
+  if (MpiInterface::IsEnabled ()) {
+      uint32_t n1SystemId = a->GetSystemId ();
+      uint32_t n2SystemId = b->GetSystemId ();
+      uint32_t currSystemId = MpiInterface::GetSystemId ();
+      if (n1SystemId != currSystemId || n2SystemId != currSystemId) {
+          useNormalChannel = false;
+      }
+  }
+  if (useNormalChannel) {
+    channel = m_channelFactory.Create<PointToPointLaserChannel> ();
+  }
+  else {
+    // The "Delay" of a remote channel is the lookahead of the distributed scheduler,
+    // the topology lowers it to the minimum distance the link can have
+    channel = m_remoteChannelFactory.Create<PointToPointLaserRemoteChannel>();
+    Ptr<MpiReceiver> mpiRecA = CreateObject<MpiReceiver> ();
+    Ptr<MpiReceiver> mpiRecB = CreateObject<MpiReceiver> ();
+    mpiRecA->SetReceiveCallback (MakeCallback (&PointToPointLaserNetDevice::Receive, devA));
+    mpiRecB->SetReceiveCallback (MakeCallback (&PointToPointLaserNetDevice::Receive, devB));
+    devA->AggregateObject (mpiRecA);
+    devB->AggregateObject (mpiRecB);
+  }
+
+  // Attach channel
   devA->Attach (channel);
   devB->Attach (channel);
   container.Add (devA);
@@ -0,0 +1,198 @@
+/**
+ * Author:  silent-rookie      2024
+*/
+
+#include "walker-constellation-helper.h"
+#include <fstream>
+#include <cmath>
+#include <cinttypes>
+#include <stdexcept>
+#include <algorithm>
+#include "ns3/exp-util.h"
+
+namespace ns3 {
+
+    // WGS72, as the SGP4 propagation of the simulator
+    static const double EARTH_RADIUS_M = 6378135.0;
+    static const double EARTH_FLATTENING = 1.0 / 298.26;
+    static const double EARTH_MU_M3_PER_S2 = 398600.8e9;
+    static const double GEO_ALTITUDE_M = 35786000.0;
+    static const double SECONDS_SIDEREAL_DAY = 86164.0905;
+    static const double ATMOSPHERE_M = 80000.0;             // ISLs must stay above it
+
+    // TLE line (without its last digit) followed by its checksum digit
+    static std::string TleWithChecksum(std::string line) {
+        int checksum = 0;
+        for (char c : line) {
+            if (c >= '0' && c <= '9') {
+                checksum += c - '0';
+            } else if (c == '-') {
+                checksum += 1;
+            }
+        }
+        return line + std::to_string(checksum % 10);
+    }
+
+    static void WriteTle(std::ofstream& ofs, std::string name, int64_t sat_number, double inclination_degree,
+                         double raan_degree, double mean_anomaly_degree, double mean_motion_rev_per_day) {
+        ofs << name << "\n";
+        ofs << TleWithChecksum(format_string(
+                "1 %05" PRId64 "U 00000ABC 00001.00000000  .00000000  00000-0  00000+0 0    0", sat_number
+        )) << "\n";
+        ofs << TleWithChecksum(format_string(
+                "2 %05" PRId64 " %8.4f %8.4f 0000001 %8.4f %8.4f %11.8f    0",
+                sat_number, inclination_degree, raan_degree, 0.0, mean_anomaly_degree, mean_motion_rev_per_day
+        )) << "\n";
+    }
+
+    WalkerConstellationHelper::WalkerConstellationHelper(
+            int64_t num_orbits,
+            int64_t num_sats_per_orbit,
+            double altitude_m,
+            double inclination_degree,
+            int64_t num_ground_stations,
+            int64_t num_geo,
+            double min_elevation_degree
+    ) {
+        if (num_orbits < 3 || num_sats_per_orbit < 3) {
+            throw std::invalid_argument("The +Grid ISLs need at least 3 orbits and 3 satellites per orbit");
+        }
+        if (num_orbits * num_sats_per_orbit + num_geo > 99999) {
+            throw std::invalid_argument("A TLE satellite number has at most 5 digits");
+        }
+        if (altitude_m <= ATMOSPHERE_M || altitude_m >= GEO_ALTITUDE_M) {
+            throw std::invalid_argument(format_string("Altitude must be in (%.0f, %.0f) m", ATMOSPHERE_M, GEO_ALTITUDE_M));
+        }
+        if (inclination_degree < 0 || inclination_degree > 180) {
+            throw std::invalid_argument("Inclination must be in [0, 180] degrees");
+        }
+        if (num_ground_stations < 0 || num_geo < 0) {
+            throw std::invalid_argument("Number of ground stations and GEO satellites cannot be negative");
+        }
+        if (min_elevation_degree < 0 || min_elevation_degree >= 90) {
+            throw std::invalid_argument("Minimum elevation must be in [0, 90) degrees");
+        }
+        m_num_orbits = num_orbits;
+        m_num_sats_per_orbit = num_sats_per_orbit;
+        m_altitude_m = altitude_m;
+        m_inclination_degree = inclination_degree;
+        m_num_ground_stations = num_ground_stations;
+        m_num_geo = num_geo;
+        m_min_elevation_degree = min_elevation_degree;
+    }
+
+    void WalkerConstellationHelper::Write(std::string satellite_network_dir) {
+        mkdir_if_not_exists(satellite_network_dir);
+        WriteTles(satellite_network_dir + "/tles.txt");
+        WriteGeoTles(satellite_network_dir + "/tles_GEO.txt");
+        WriteIsls(satellite_network_dir + "/isls.txt");
+        WriteGroundStations(satellite_network_dir + "/ground_stations.txt");
+        WriteInterfacesInfo(satellite_network_dir + "/gsl_interfaces_info.txt", satellite_network_dir + "/ill_interfaces_info.txt");
+        WriteDescription(satellite_network_dir + "/description.txt");
+    }
+
+    int64_t WalkerConstellationHelper::GetNumSatellites() {
+        return m_num_orbits * m_num_sats_per_orbit;
+    }
+
+    double WalkerConstellationHelper::GetMaxIslLengthM() {
+        return 2 * std::sqrt(std::pow(EARTH_RADIUS_M + m_altitude_m, 2) - std::pow(EARTH_RADIUS_M + ATMOSPHERE_M, 2));
+    }
+
+    double WalkerConstellationHelper::GetMaxGslLengthM() {
+        double min_elevation_rad = m_min_elevation_degree * M_PI / 180.0;
+        return std::sqrt(std::pow(EARTH_RADIUS_M + m_altitude_m, 2) - std::pow(EARTH_RADIUS_M * std::cos(min_elevation_rad), 2))
+               - EARTH_RADIUS_M * std::sin(min_elevation_rad);
+    }
+
+    double WalkerConstellationHelper::GetMaxIllLengthM() {
+        return std::sqrt(std::pow(EARTH_RADIUS_M + GEO_ALTITUDE_M, 2) - std::pow(EARTH_RADIUS_M + m_altitude_m, 2));
+    }
+
+    void WalkerConstellationHelper::WriteTles(std::string filename) {
+        double semi_major_axis_m = EARTH_RADIUS_M + m_altitude_m;
+        double mean_motion_rev_per_day = std::sqrt(EARTH_MU_M3_PER_S2 / std::pow(semi_major_axis_m, 3)) * 86400.0 / (2 * M_PI);
+        std::ofstream ofs(filename);
+        ofs << m_num_orbits << " " << m_num_sats_per_orbit << "\n";
+        for (int64_t orbit = 0; orbit < m_num_orbits; orbit++) {
+            double raan_degree = orbit * 360.0 / m_num_orbits;
+            double orbit_wise_shift = orbit % 2 == 1 ? 360.0 / (m_num_sats_per_orbit * 2.0) : 0.0;
+            for (int64_t n = 0; n < m_num_sats_per_orbit; n++) {
+                int64_t sat_id = orbit * m_num_sats_per_orbit + n;
+                double mean_anomaly_degree = std::fmod(orbit_wise_shift + n * 360.0 / m_num_sats_per_orbit, 360.0);
+                WriteTle(ofs, "Satellite " + std::to_string(sat_id), sat_id + 1, m_inclination_degree,
+                         raan_degree, mean_anomaly_degree, mean_motion_rev_per_day);
+            }
+        }
+    }
+
+    void WalkerConstellationHelper::WriteGeoTles(std::string filename) {
+        std::ofstream ofs(filename);
+        ofs << 1 << " " << m_num_geo << "\n";
+        for (int64_t geo = 0; geo < m_num_geo; geo++) {
+            WriteTle(ofs, "GEO " + std::to_string(geo), GetNumSatellites() + geo + 1, 0.001,
+                     0.0, geo * 360.0 / m_num_geo, 86400.0 / SECONDS_SIDEREAL_DAY);
+        }
+    }
+
+    void WalkerConstellationHelper::WriteIsls(std::string filename) {
+        std::ofstream ofs(filename);
+        for (int64_t orbit = 0; orbit < m_num_orbits; orbit++) {
+            for (int64_t n = 0; n < m_num_sats_per_orbit; n++) {
+                int64_t sat = orbit * m_num_sats_per_orbit + n;
+                int64_t sat_same_orbit = orbit * m_num_sats_per_orbit + (n + 1) % m_num_sats_per_orbit;
+                int64_t sat_adjacent_orbit = ((orbit + 1) % m_num_orbits) * m_num_sats_per_orbit + n;
+                ofs << std::min(sat, sat_same_orbit) << " " << std::max(sat, sat_same_orbit) << "\n";
+                ofs << std::min(sat, sat_adjacent_orbit) << " " << std::max(sat, sat_adjacent_orbit) << "\n";
+            }
+        }
+    }
+
+    void WalkerConstellationHelper::WriteGroundStations(std::string filename) {
+        // Golden angle spiral, equal area between the latitudes the shell covers (at most 60 degrees)
+        double e2 = 2 * EARTH_FLATTENING - EARTH_FLATTENING * EARTH_FLATTENING;
+        double max_latitude_rad = std::min(std::min(m_inclination_degree, 180.0 - m_inclination_degree), 60.0) * M_PI / 180.0;
+        std::ofstream ofs(filename);
+        for (int64_t gid = 0; gid < m_num_ground_stations; gid++) {
+            double latitude_rad = std::asin((1.0 - 2.0 * (gid + 0.5) / m_num_ground_stations) * std::sin(max_latitude_rad));
+            double longitude_rad = std::fmod(gid * M_PI * (3.0 - std::sqrt(5.0)), 2 * M_PI) - M_PI;
+
+            // Geodetic to cartesian (elevation zero)
+            double v = EARTH_RADIUS_M / std::sqrt(1 - e2 * std::sin(latitude_rad) * std::sin(latitude_rad));
+            ofs << format_string(
+                    "%" PRId64 ",GS-%" PRId64 ",%f,%f,0.0,%f,%f,%f",
+                    gid, gid, latitude_rad * 180.0 / M_PI, longitude_rad * 180.0 / M_PI,
+                    v * std::cos(latitude_rad) * std::cos(longitude_rad),
+                    v * std::cos(latitude_rad) * std::sin(longitude_rad),
+                    v * (1 - e2) * std::sin(latitude_rad)
+            ) << "\n";
+        }
+    }
+
+    void WalkerConstellationHelper::WriteInterfacesInfo(std::string gsl_filename, std::string ill_filename) {
+        int64_t num_sats = GetNumSatellites();
+
+        // GSL: satellites, then ground stations
+        std::ofstream gsl_ofs(gsl_filename);
+        for (int64_t node_id = 0; node_id < num_sats + m_num_ground_stations; node_id++) {
+            gsl_ofs << node_id << ",1,1.0\n";
+        }
+
+        // ILL: LEO satellites, then GEO satellites (their node ids are after the ground stations)
+        std::ofstream ill_ofs(ill_filename);
+        for (int64_t node_id = 0; node_id < num_sats; node_id++) {
+            ill_ofs << node_id << ",1,1.0\n";
+        }
+        for (int64_t geo = 0; geo < m_num_geo; geo++) {
+            ill_ofs << (num_sats + m_num_ground_stations + geo) << ",1,1.0\n";
+        }
+    }
+
+    void WalkerConstellationHelper::WriteDescription(std::string filename) {
+        std::ofstream ofs(filename);
+        ofs << format_string("max_isl_length_m=%f", GetMaxIslLengthM()) << "\n";
+        ofs << format_string("max_gsl_length_m=%f", GetMaxGslLengthM()) << "\n";
+        ofs << format_string("max_ill_length_m=%f", GetMaxIllLengthM()) << "\n";
+    }
+
+} // namespace ns3
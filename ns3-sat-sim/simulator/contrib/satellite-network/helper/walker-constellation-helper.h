@@ -0,0 +1,67 @@
+/**
+ * Author:  silent-rookie      2024
+*/
+
+#ifndef WALKER_CONSTELLATION_HELPER_H
+#define WALKER_CONSTELLATION_HELPER_H
+
+#include <string>
+#include <cstdint>
+
+namespace ns3 {
+
+    /**
+     * Writes a synthetic satellite network directory, in the same file formats as satgenpy,
+     * for a Walker-delta shell of num_orbits planes of num_sats_per_orbit satellites:
+     *
+     *  - tles.txt / tles_GEO.txt: circular orbits with the TLE epoch of satgenpy (2000-01-01),
+     *    the odd planes shifted by half a satellite spacing; the GEO satellites evenly spaced
+     *    over the equator
+     *  - isls.txt: +Grid (the next satellite in the plane and the same one in the next plane)
+     *  - ground_stations.txt: on a golden angle spiral over the latitudes the shell covers
+     *  - gsl_interfaces_info.txt / ill_interfaces_info.txt: one interface per node
+     *  - description.txt: maximum ISL, GSL (minimum elevation) and ILL lengths
+     *
+     * It does not calculate the routes, these are meant to be calculated in the simulator
+     * (routing_engine=in_simulator).
+     */
+    class WalkerConstellationHelper
+    {
+    public:
+        WalkerConstellationHelper(
+                int64_t num_orbits,
+                int64_t num_sats_per_orbit,
+                double altitude_m,
+                double inclination_degree,
+                int64_t num_ground_stations,
+                int64_t num_geo,
+                double min_elevation_degree
+        );
+
+        void Write(std::string satellite_network_dir);
+
+        int64_t GetNumSatellites();
+        double GetMaxIslLengthM();
+        double GetMaxGslLengthM();
+        double GetMaxIllLengthM();
+
+    private:
+        void WriteTles(std::string filename);
+        void WriteGeoTles(std::string filename);
+        void WriteIsls(std::string filename);
+        void WriteGroundStations(std::string filename);
+        void WriteInterfacesInfo(std::string gsl_filename, std::string ill_filename);
+        void WriteDescription(std::string filename);
+
+        int64_t m_num_orbits;
+        int64_t m_num_sats_per_orbit;
+        double m_altitude_m;
+        double m_inclination_degree;
+        int64_t m_num_ground_stations;
+        int64_t m_num_geo;
+        double m_min_elevation_degree;
+    };
+
+} // namespace ns3
+
+#endif /* WALKER_CONSTELLATION_HELPER_H */
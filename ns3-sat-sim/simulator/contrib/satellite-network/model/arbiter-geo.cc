@@ -37,10 +37,24 @@ ArbiterGEO::ArbiterGEO(
     ): ArbiterSatnet(this_node, nodes)
 {
     m_arbiter_helper = arbiter_helper;
+    m_ill_utilization = 0;
+
+    // interface for device in GEO satellite:
+    // 0: loop-back interface
+    // 1: ill interface
+    Ptr<Ipv4> ipv4 = m_nodes.Get(m_node_id)->GetObject<Ipv4>();
+    NS_ABORT_MSG_IF(ipv4->GetNInterfaces() != 2, "num interfaces in GEO must as 2: " + std::to_string(ipv4->GetNInterfaces()));
+    Ptr<GSLNetDevice> ill = ipv4->GetNetDevice(1)->GetObject<GSLNetDevice>();
+    NS_ABORT_MSG_IF(ill == 0, "Unidentified NetDevice in GEO");
+    m_ill_device = PeekPointer(ill);
 
     // Initialize must before
     NS_ABORT_MSG_IF(receive_datarate_update_interval_ns == 0, "Initialize must before");
-    UpdateReceiveDatarate();
+
+    // the ewma estimator is calculated when it is read, it needs no periodic update
+    if(!ReceiveDataRateDevice::IsLazyEstimator()){
+        UpdateReceiveDatarate();
+    }
 }
 
 void ArbiterGEO::InitializeArbiter(Ptr<BasicSimulation> basicSimulation, int64_t num_sat, int64_t num_gs, int64_t num_geo){
@@ -50,8 +64,8 @@ void ArbiterGEO::InitializeArbiter(Ptr<BasicSimulation> basicSimulation, int64_t
     num_groundstations = num_gs;
     num_GEOsatellites = num_geo;
 
-    // initialize receive_datarate_update_interval_ns in ReceiveDatarateDevice
-    ReceiveDataRateDevice::SetReceiveDatarateUpdateIntervalNS(receive_datarate_update_interval_ns);
+    // initialize receive_datarate_update_interval_ns and the estimator in ReceiveDatarateDevice
+    ReceiveDataRateDevice::Initialize(basicSimulation);
 }
 
 std::tuple<int32_t, int32_t, int32_t> 
@@ -65,6 +79,8 @@ ArbiterGEO::TopologySatelliteNetworkDecide(
     NS_ABORT_MSG_UNLESS(m_node_id >= num_satellites + num_groundstations, "arbiter_geo in: " + std::to_string(m_node_id));
     NS_ABORT_MSG_IF(target_node_id == m_node_id, "target_id == current_id, id: " + std::to_string(m_node_id));
 
+    m_routing_decision_counters.decisions += 1;
+
     FromTag tag;
     bool found = pkt->PeekPacketTag(tag);
     if(!found){
@@ -74,6 +90,7 @@ ArbiterGEO::TopologySatelliteNetworkDecide(
         if(header.GetTtl() == 0){
             // Icmp packet(see Ipv4L3Protocol::IpForward, line 1066, and Icmpv4L4Protocol::SendTimeExceededTtl).
             // we do not know the from LEO, so we can do nothing.
+            m_routing_decision_counters.icmp_ttl_exceeded += 1;
             return std::make_tuple(-1, -1, -1);
 
             // we can do more check: if(ResolveNodeIdFromIp(header.GetSource().Get()) == (uint32_t)target_node_id).
@@ -82,11 +99,55 @@ ArbiterGEO::TopologySatelliteNetworkDecide(
     }
     NS_ABORT_MSG_IF(!found, "a packet be forward to GEO can not find From LEO");
 
-    return FindNextHopForGEO(tag.GetFrom(), target_node_id);
+    // the jam area status along the walk did not change since the last decision
+    int64_t key = tag.GetFrom() * (num_satellites + num_groundstations) + target_node_id;
+    std::unordered_map<int64_t, std::pair<std::tuple<int32_t, int32_t, int32_t>, GEOFallback>>::iterator it = m_decision_cache.find(key);
+    if(it == m_decision_cache.end()){
+        m_routing_decision_counters.recomputed += 1;
+        GEOFallback fallback;
+        std::tuple<int32_t, int32_t, int32_t> decision = FindNextHopForGEO(tag.GetFrom(), target_node_id, &fallback);
+        it = m_decision_cache.emplace(key, std::make_pair(decision, fallback)).first;
+    }
+
+    if(it->second.second == GEOFallback::out_of_ill){
+        m_routing_decision_counters.geo_out_of_ill += 1;
+    }
+    else if(it->second.second == GEOFallback::all_in_jam){
+        m_routing_decision_counters.geo_all_in_jam += 1;
+    }
+    return it->second.first;
+}
+
+std::tuple<int32_t, int32_t, int32_t>
+ArbiterGEO::ResolveFlowNextHop(
+            int32_t target_node_id,
+            TrafficClass pclass,
+            const FlowFiveTuple& flow,
+            int32_t& from_node_id
+){
+    NS_ABORT_MSG_IF(from_node_id < 0, "a flow be forward to GEO can not find From LEO");
+
+    // the decision cache is only read
+    int64_t key = from_node_id * (num_satellites + num_groundstations) + target_node_id;
+    std::unordered_map<int64_t, std::pair<std::tuple<int32_t, int32_t, int32_t>, GEOFallback>>::iterator it = m_decision_cache.find(key);
+    if(it != m_decision_cache.end()){
+        return it->second.first;
+    }
+    return FindNextHopForGEO(from_node_id, target_node_id);
+}
+
+void ArbiterGEO::NotifyNeighborStateChanged(int32_t leo_node_id){
+    m_decision_cache.clear();
 }
 
 std::tuple<int32_t, int32_t, int32_t> 
-ArbiterGEO::FindNextHopForGEO(uint64_t from, int32_t target_node_id){
+ArbiterGEO::FindNextHopForGEO(uint64_t from, int32_t target_node_id, GEOFallback* fallback){
+    GEOFallback unused_fallback;
+    if(fallback == nullptr){
+        fallback = &unused_fallback;
+    }
+    *fallback = GEOFallback::none;
+
     int32_t ptr = std::get<0>(m_arbiter_helper->GetArbiterLEO(from)->GetLEOForwardState(target_node_id)[0]);
     if(target_node_id == ptr){
         // may be the from LEO satellite move and the target_node_id GS can see it.
@@ -99,6 +160,7 @@ ArbiterGEO::FindNextHopForGEO(uint64_t from, int32_t target_node_id){
         // make sure the next node is in ill distance
         int32_t next_GEO_id = m_arbiter_helper->GetArbiterLEO(ptr)->GetLEONextGEOID();
         if(next_GEO_id != m_node_id){
+            *fallback = GEOFallback::out_of_ill;
             if(last_ptr == ptr){
                 // the first next hop of GEOsatellite is out of ill. this situation 
                 // is special, because we already made a check in ArbiterLEO::ForwardToGEO.
@@ -132,6 +194,7 @@ ArbiterGEO::FindNextHopForGEO(uint64_t from, int32_t target_node_id){
     if(ptr == target_node_id){
         // all leo on the road are in jam area.
         // we can only detour to the last leo
+        *fallback = GEOFallback::all_in_jam;
         return std::make_tuple(last_ptr, 1, 6);
     }
     else{
@@ -139,30 +202,32 @@ ArbiterGEO::FindNextHopForGEO(uint64_t from, int32_t target_node_id){
     }
 }
 
+uint64_t ArbiterGEO::EstimateDecisionCacheMemoryBytes(){
+    return estimate_heap_bytes(m_decision_cache);
+}
+
+void ArbiterGEO::UpdateIllUtilization(){
+    m_ill_utilization = m_ill_device->GetReceiveDataRate().GetBitRate() / (ill_data_rate_megabit_per_s * 1000000.0);
+}
+
+double ArbiterGEO::GetIllUtilization(){
+    return m_ill_utilization;
+}
+
+void ArbiterGEO::SetIllUtilization(double utilization){
+    m_ill_utilization = utilization;
+}
+
 std::string ArbiterGEO::StringReprOfForwardingState(){
     // do nothing
     return "ArbiterGEO forwarding state";
 }
 
 void ArbiterGEO::UpdateReceiveDatarate(){
-    // interface for device in GEO satellite:
+    // interface for device in GEO satellite (validated at construction):
     // 0: loop-back interface
     // 1: ill interface
-    Ptr<Node> node = m_nodes.Get(m_node_id);
-    uint32_t num_interfaces = node->GetObject<Ipv4>()->GetNInterfaces();
-    NS_ABORT_MSG_IF(num_interfaces != 2, "num interfaces in GEO must as 2: " + std::to_string(num_interfaces));
-
-    // i begin at 1 to skip the loop-back interface
-    for(uint32_t i = 1; i < num_interfaces; ++i){
-        if(node->GetObject<Ipv4>()->GetNetDevice(i)->GetObject<GSLNetDevice>() != 0){
-            // ILL NetDevice(GSL NetDevice)
-            Ptr<GSLNetDevice> gsl = node->GetObject<Ipv4>()->GetNetDevice(i)->GetObject<GSLNetDevice>();
-            gsl->UpdateReceiveDataRate();
-        }
-        else{
-            NS_ABORT_MSG("Unidentified NetDevice in GS");
-        }
-    }
+    m_ill_device->UpdateReceiveDataRate();
 
     // Plan next update
     Simulator::Schedule(NanoSeconds(receive_datarate_update_interval_ns), &ArbiterGEO::UpdateReceiveDatarate, this);
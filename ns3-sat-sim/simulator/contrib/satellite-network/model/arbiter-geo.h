@@ -8,6 +8,8 @@
 #define ARBITER_GEO_H
 
 #include "ns3/arbiter-satnet.h"
+#include "ns3/receive-datarate-device.h"
+#include <unordered_map>
 
 namespace ns3{
 
@@ -34,17 +36,45 @@ public:
             ns3::Ipv4Header const &ipHeader,
             bool is_socket_request_for_source_ip
     );
+    std::tuple<int32_t, int32_t, int32_t> ResolveFlowNextHop(
+            int32_t target_node_id,
+            TrafficClass pclass,
+            const FlowFiveTuple& flow,
+            int32_t& from_node_id
+    );
+
+    // fallback taken by FindNextHopForGEO, if any
+    enum class GEOFallback { none, out_of_ill, all_in_jam };
 
     // find the next leo to for GEOsatellite
-    std::tuple<int32_t, int32_t, int32_t> FindNextHopForGEO(uint64_t from, int32_t target_node_id);
+    std::tuple<int32_t, int32_t, int32_t> FindNextHopForGEO(uint64_t from, int32_t target_node_id, GEOFallback* fallback = nullptr);
+
+    // Called by the helper when the jam area status of a LEO flipped,
+    // or the forwarding/ills state changed (leo_node_id = -1)
+    void NotifyNeighborStateChanged(int32_t leo_node_id);
+
+    // Receive data rate of the ILL over its data rate, published each detour update
+    // (the LEO satellites spill GEO-bound traffic above geo_ill_spill_utilization)
+    void UpdateIllUtilization();
+    double GetIllUtilization();
+    void SetIllUtilization(double utilization);
 
     std::string StringReprOfForwardingState();
 
+    // Estimated heap memory of the decision cache (memory report)
+    uint64_t EstimateDecisionCacheMemoryBytes();
+
 private:
     // update detour information each interval: receive_datarate_update_interval_ns
     void UpdateReceiveDatarate();
 
     Ptr<ArbiterLEOGSGEOHelper> m_arbiter_helper;
+    ReceiveDataRateDevice* m_ill_device;        // interface 1, validated at construction
+    double m_ill_utilization;
+
+    // precomputed FindNextHopForGEO result (and its fallback) for each (from LEO, target) pair.
+    // The walk may pass any LEO, so it is cleared on each notification
+    std::unordered_map<int64_t, std::pair<std::tuple<int32_t, int32_t, int32_t>, GEOFallback>> m_decision_cache;
 
     static int64_t receive_datarate_update_interval_ns;     // the interval that a netdevice receive datarate update
     static double ill_data_rate_megabit_per_s;
@@ -17,6 +17,7 @@ double ArbiterGS::gsl_data_rate_megabit_per_s = 0;
 int64_t ArbiterGS::num_satellites = 0;
 int64_t ArbiterGS::num_groundstations = 0;
 int64_t ArbiterGS::num_GEOsatellites = 0;
+std::set<TrafficClass> ArbiterGS::weighted_candidate_classes;
 
 TypeId ArbiterGS::GetTypeId (void)
 {
@@ -30,16 +31,41 @@ TypeId ArbiterGS::GetTypeId (void)
 ArbiterGS::ArbiterGS(
         Ptr<Node> this_node,
         NodeContainer nodes,
-        std::vector<std::vector<std::tuple<int32_t, int32_t, int32_t>>> next_hop_lists,
+        const NextHopCandidates& next_hop_lists,
         Ptr<ArbiterLEOGSGEOHelper> arbiter_helper
 ) : ArbiterSatnet(this_node, nodes)
 {
     m_next_hop_lists = next_hop_lists;
     m_arbiter_helper = arbiter_helper;
+    m_decision_cache = std::vector<int32_t>(next_hop_lists.GetNumTargets(), DECISION_INVALID);
+    if(!weighted_candidate_classes.empty()){
+        m_candidate_residual_bps = std::vector<double>(next_hop_lists.GetNumTargets() * next_hop_lists.GetNumCandidates(), 0);
+        m_candidate_residual_ticks = std::vector<uint64_t>(next_hop_lists.GetNumTargets(), NO_RESIDUAL_TICK);
+    }
+    switch(next_hop_lists.GetNumCandidates()){
+        case 1: m_find_candidate = &ArbiterGS::FindCandidate<1>; break;
+        case 2: m_find_candidate = &ArbiterGS::FindCandidate<2>; break;
+        case 3: m_find_candidate = &ArbiterGS::FindCandidate<3>; break;
+        case 4: m_find_candidate = &ArbiterGS::FindCandidate<4>; break;
+        default: NS_ABORT_MSG("Unsupported number of next hop candidates: " + std::to_string(next_hop_lists.GetNumCandidates()));
+    }
+
+    // interface for device in ground station:
+    // 0: loop-back interface
+    // 1: gsl interface
+    Ptr<Ipv4> ipv4 = m_nodes.Get(m_node_id)->GetObject<Ipv4>();
+    NS_ABORT_MSG_IF(ipv4->GetNInterfaces() != 2, "num interfaces in gs must as 2: " + std::to_string(ipv4->GetNInterfaces()));
+    Ptr<GSLNetDevice> gsl = ipv4->GetNetDevice(1)->GetObject<GSLNetDevice>();
+    NS_ABORT_MSG_IF(gsl == 0, "Unidentified NetDevice in GS");
+    m_gsl_device = PeekPointer(gsl);
 
     // Initialize must before
     NS_ABORT_MSG_IF(receive_datarate_update_interval_ns == 0, "Initialize must before");
-    UpdateReceiveDatarate();
+
+    // the ewma estimator is calculated when it is read, it needs no periodic update
+    if(!ReceiveDataRateDevice::IsLazyEstimator()){
+        UpdateReceiveDatarate();
+    }
 }
 
 void ArbiterGS::InitializeArbiter(Ptr<BasicSimulation> basicSimulation, int64_t num_sat, int64_t num_gs, int64_t num_geo){
@@ -49,8 +75,9 @@ void ArbiterGS::InitializeArbiter(Ptr<BasicSimulation> basicSimulation, int64_t
     num_groundstations = num_gs;
     num_GEOsatellites = num_geo;
 
-    // initialize receive_datarate_update_interval_ns in ReceiveDatarateDevice
-    ReceiveDataRateDevice::SetReceiveDatarateUpdateIntervalNS(receive_datarate_update_interval_ns);
+    // initialize receive_datarate_update_interval_ns and the estimator in ReceiveDatarateDevice
+    ReceiveDataRateDevice::Initialize(basicSimulation);
+    weighted_candidate_classes = ParseWeightedCandidateClasses(basicSimulation);
 }
 
 std::tuple<int32_t, int32_t, int32_t> ArbiterGS::TopologySatelliteNetworkDecide(
@@ -60,33 +87,174 @@ std::tuple<int32_t, int32_t, int32_t> ArbiterGS::TopologySatelliteNetworkDecide(
         Ipv4Header const &ipHeader,
         bool is_request_for_source_ip_so_no_next_header
 ) {
-    NS_ABORT_MSG_UNLESS(m_node_id >= num_satellites && m_node_id < num_satellites + num_groundstations, 
+    NS_ASSERT_MSG(m_node_id >= num_satellites && m_node_id < num_satellites + num_groundstations, 
                                                         "arbiter_gs in: " + std::to_string(m_node_id));
-    NS_ABORT_MSG_IF(target_node_id == m_node_id, "target_id == current_id, id: " + std::to_string(m_node_id));
+    NS_ASSERT_MSG(target_node_id != m_node_id, "target_id == current_id, id: " + std::to_string(m_node_id));
 
-    // Note! we assume that groud station have 3 candidate
-    for(size_t i = 0; i < m_next_hop_lists[target_node_id].size(); ++i){
-        int32_t next_node_index = std::get<0>(m_next_hop_lists[target_node_id][i]);
-        int32_t next_interface_index = std::get<2>(m_next_hop_lists[target_node_id][i]);
-        if(next_node_index == -1) break;   // the  num of LEO this GS can see is less than 3
+    m_routing_decision_counters.decisions += 1;
+
+    // with flowlets, the flow keeps the candidate of its ongoing flowlet as long as it does not detour
+    bool flowlets = FlowletTable::IsEnabled();
+    bool weighted = !weighted_candidate_classes.empty() && weighted_candidate_classes.count(GetTrafficClass(pkt));
+    uint32_t flow_hash = 0;
+    int64_t now_ns = 0;
+    if(flowlets){
+        flow_hash = m_flowlets.ComputeFiveTupleHash(ipHeader, pkt, is_request_for_source_ip_so_no_next_header);
+        now_ns = Simulator::Now().GetTimeStep();
+        int32_t candidate = m_flowlets.GetCandidate(flow_hash, target_node_id, now_ns);
+        if(candidate >= 0 && !CandidateNeedsDetour(target_node_id, candidate)){
+            m_flowlets.SetCandidate(flow_hash, target_node_id, candidate, now_ns);
+            m_routing_decision_counters.flowlet_kept += 1;
+            m_routing_decision_counters.CountCandidate(candidate);
+            return m_next_hop_lists[target_node_id][candidate];
+        }
+    }
+
+    // the flow is split over the candidates in proportion to their residual capacity,
+    // if none has any it is the first candidate which does not detour
+    int32_t decision = -1;
+    if(weighted){
+        decision = ChooseWeightedCandidate(target_node_id, ComputeFlowHash(ipHeader, pkt, is_request_for_source_ip_so_no_next_header));
+        if(decision >= 0){
+            m_routing_decision_counters.weighted += 1;
+        }
+    }
+    if(decision < 0){
+        decision = ChooseCandidate(target_node_id);
+    }
+    if(flowlets){
+        m_flowlets.SetCandidate(flow_hash, target_node_id, decision, now_ns);
+    }
+    m_routing_decision_counters.CountCandidate(decision);
+    return m_next_hop_lists[target_node_id][decision];
+}
+
+std::tuple<int32_t, int32_t, int32_t> ArbiterGS::ResolveFlowNextHop(
+        int32_t target_node_id,
+        TrafficClass pclass,
+        const FlowFiveTuple& flow,
+        int32_t& from_node_id
+) {
+    if(weighted_candidate_classes.count(pclass)){
+        int32_t candidate = ChooseWeightedCandidate(target_node_id, ComputeFlowHash(flow));
+        if(candidate >= 0){
+            return m_next_hop_lists[target_node_id][candidate];
+        }
+    }
+
+    // the decision cache is only read
+    int32_t decision = m_decision_cache[target_node_id];
+    if(decision == DECISION_INVALID){
+        decision = (this->*m_find_candidate)(target_node_id);
+    }
+    return m_next_hop_lists[target_node_id][decision >= 0 ? decision : 0];
+}
+
+int32_t ArbiterGS::ChooseCandidate(int32_t target_node_id){
+
+    // the detour state of the candidates did not change since the last decision
+    int32_t decision = m_decision_cache[target_node_id];
+    if(decision >= 0){
+        return decision;
+    }
+    if(decision == DECISION_ALL_DETOUR){
+        m_routing_decision_counters.gs_all_detour += 1;
+        return 0;
+    }
+    m_routing_decision_counters.recomputed += 1;
+
+    decision = (this->*m_find_candidate)(target_node_id);
+    m_decision_cache[target_node_id] = decision;
+    if(decision >= 0){
+        return decision;
+    }
+
+    // all neighbor leo satellites are in detour,
+    // we can only forward the packet to the nearest LEO satellite
+    m_routing_decision_counters.gs_all_detour += 1;
+    return 0;
+}
+
+int32_t ArbiterGS::ChooseWeightedCandidate(int32_t target_node_id, uint32_t flow_hash){
+    return PickWeightedCandidate(GetCandidateResidualBps(target_node_id), m_next_hop_lists.GetNumCandidates(), flow_hash);
+}
+
+const double* ArbiterGS::GetCandidateResidualBps(int32_t target_node_id){
+    size_t num_candidates = m_next_hop_lists.GetNumCandidates();
+    double* residual_bps = &m_candidate_residual_bps[target_node_id * num_candidates];
+    if(m_candidate_residual_ticks[target_node_id] != ArbiterLEO::GetResidualTick()){
+        const NextHop* next_hops = m_next_hop_lists[target_node_id];
+        for(size_t i = 0; i < num_candidates; ++i){
+            int32_t next_node_index = std::get<0>(next_hops[i]);
+            if(next_node_index < 0){
+                residual_bps[i] = 0;     // the num of LEO this GS can see is less than K
+            }
+            else{
+                residual_bps[i] = m_arbiter_helper->GetArbiterLEO(next_node_index)->GetResidualBps(std::get<2>(next_hops[i]));
+            }
+        }
+        m_candidate_residual_ticks[target_node_id] = ArbiterLEO::GetResidualTick();
+    }
+    return residual_bps;
+}
+
+TrafficClass ArbiterGS::GetTrafficClass(Ptr<const Packet> pkt){
+    FlowTosTag tag;
+    if(!pkt->PeekPacketTag(tag)){
+        return TrafficClass::class_default;
+    }
+    return Tos2TrafficClass(tag.GetTos());
+}
+
+bool ArbiterGS::CandidateNeedsDetour(int32_t target_node_id, int32_t candidate){
+    int32_t next_node_index = std::get<0>(m_next_hop_lists[target_node_id][candidate]);
+    int32_t next_interface_index = std::get<2>(m_next_hop_lists[target_node_id][candidate]);
+    return next_node_index < 0 || m_arbiter_helper->GetArbiterLEO(next_node_index)->CheckIfNeedDetour(next_interface_index);
+}
+
+template <size_t K>
+int32_t ArbiterGS::FindCandidate(int32_t target_node_id){
+    const NextHop* next_hops = m_next_hop_lists[target_node_id];
+    for(size_t i = 0; i < K; ++i){
+        int32_t next_node_index = std::get<0>(next_hops[i]);
+        int32_t next_interface_index = std::get<2>(next_hops[i]);
+        if(next_node_index == -1) break;   // the num of LEO this GS can see is less than K
         if(!m_arbiter_helper->GetArbiterLEO(next_node_index)->CheckIfNeedDetour(next_interface_index)){
             // find a neighbor leo satellite which can be forward
-            return m_next_hop_lists[target_node_id][i];
+            return i;
         }
     }
+    return DECISION_ALL_DETOUR;
+}
 
-    // 3 neighbor leo satellites are in detour,
-    // we can only forward the packet to the nearest LEO satellite
-    return m_next_hop_lists[target_node_id][0];
+template int32_t ArbiterGS::FindCandidate<1>(int32_t);
+template int32_t ArbiterGS::FindCandidate<2>(int32_t);
+template int32_t ArbiterGS::FindCandidate<3>(int32_t);
+template int32_t ArbiterGS::FindCandidate<4>(int32_t);
+
+uint64_t ArbiterGS::EstimateForwardingStateMemoryBytes(){
+    return m_next_hop_lists.EstimateHeapBytes() + estimate_heap_bytes(m_decision_cache) + m_flowlets.EstimateHeapBytes()
+           + estimate_heap_bytes(m_candidate_residual_bps) + estimate_heap_bytes(m_candidate_residual_ticks);
+}
+
+void ArbiterGS::SetGSForwardState(int32_t target_node_id, const std::vector<std::tuple<int32_t, int32_t, int32_t>>& next_hop_list){
+    m_next_hop_lists.Set(target_node_id, next_hop_list);
+    m_decision_cache[target_node_id] = DECISION_INVALID;
+    if(!m_candidate_residual_ticks.empty()){
+        m_candidate_residual_ticks[target_node_id] = NO_RESIDUAL_TICK;
+    }
 }
 
-void ArbiterGS::SetGSForwardState(int32_t target_node_id, std::vector<std::tuple<int32_t, int32_t, int32_t>> next_hop_list){
-    m_next_hop_lists[target_node_id] = next_hop_list;
+void ArbiterGS::NotifyNeighborStateChanged(const std::vector<int32_t>& target_node_ids){
+    // only the decisions which have that LEO as a candidate need to be recomputed
+    for(int32_t target : target_node_ids){
+        m_decision_cache[target] = DECISION_INVALID;
+    }
 }
 
 std::vector<std::tuple<int32_t, int32_t, int32_t>> 
 ArbiterGS::GetGSForwardState(int32_t target_node_id){
-    return m_next_hop_lists[target_node_id];
+    return m_next_hop_lists.Get(target_node_id);
 }
 
 std::string ArbiterGS::StringReprOfForwardingState(){
@@ -94,24 +262,10 @@ std::string ArbiterGS::StringReprOfForwardingState(){
 }
 
 void ArbiterGS::UpdateReceiveDatarate(){
-    // interface for device in ground station:
+    // interface for device in ground station (validated at construction):
     // 0: loop-back interface
     // 1: gsl interface
-    Ptr<Node> node = m_nodes.Get(m_node_id);
-    uint32_t num_interfaces = node->GetObject<Ipv4>()->GetNInterfaces();
-    NS_ABORT_MSG_IF(num_interfaces != 2, "num interfaces in gs must as 2: " + std::to_string(num_interfaces));
-
-    // i begin at 1 to skip the loop-back interface
-    for(uint32_t i = 1; i < num_interfaces; ++i){
-        if(node->GetObject<Ipv4>()->GetNetDevice(i)->GetObject<GSLNetDevice>() != 0){
-            // GSL NetDevice
-            Ptr<GSLNetDevice> gsl = node->GetObject<Ipv4>()->GetNetDevice(i)->GetObject<GSLNetDevice>();
-            gsl->UpdateReceiveDataRate();
-        }
-        else{
-            NS_ABORT_MSG("Unidentified NetDevice in GS");
-        }
-    }
+    m_gsl_device->UpdateReceiveDataRate();
 
     // Plan next update
     Simulator::Schedule(NanoSeconds(receive_datarate_update_interval_ns), &ArbiterGS::UpdateReceiveDatarate, this);
@@ -8,6 +8,10 @@
 #define ARBITER_GS_H
 
 #include "ns3/arbiter-satnet.h"
+#include "ns3/next-hop-candidates.h"
+#include "ns3/flowlet-table.h"
+#include "ns3/flow-tos-tag.h"
+#include "ns3/receive-datarate-device.h"
 #include "ns3/abort.h"
 #include "ns3/ipv4-header.h"
 #include "ns3/udp-header.h"
@@ -25,7 +29,7 @@ public:
     ArbiterGS(
             Ptr<Node> this_node,
             NodeContainer nodes,
-            std::vector<std::vector<std::tuple<int32_t, int32_t, int32_t>>> next_hop_lists,
+            const NextHopCandidates& next_hop_lists,
             Ptr<ArbiterLEOGSGEOHelper> arbiter_helper
     );
 
@@ -39,27 +43,70 @@ public:
             ns3::Ipv4Header const &ipHeader,
             bool is_socket_request_for_source_ip
     );
+    std::tuple<int32_t, int32_t, int32_t> ResolveFlowNextHop(
+            int32_t target_node_id,
+            TrafficClass pclass,
+            const FlowFiveTuple& flow,
+            int32_t& from_node_id
+    );
 
     // Update the forward state
-    void SetGSForwardState(int32_t target_node_id, std::vector<std::tuple<int32_t, int32_t, int32_t>> next_hop_list);
+    void SetGSForwardState(int32_t target_node_id, const std::vector<std::tuple<int32_t, int32_t, int32_t>>& next_hop_list);
 
     std::vector<std::tuple<int32_t, int32_t, int32_t>> GetGSForwardState(int32_t target_node_id);
 
+    // Called by the helper when the detour state of a candidate LEO flipped, with the
+    // targets of which that LEO is a candidate (its subscriptions)
+    void NotifyNeighborStateChanged(const std::vector<int32_t>& target_node_ids);
+
     std::string StringReprOfForwardingState();
 
+    // Estimated heap memory of the forwarding state (memory report)
+    uint64_t EstimateForwardingStateMemoryBytes();
+
 private:
     // update detour information each interval: receive_datarate_update_interval_ns
     void UpdateReceiveDatarate();
 
+    // First candidate which does not detour, or DECISION_ALL_DETOUR, with the number of
+    // candidates K known at compile time (instantiated for K = 1 .. MAX_NEXT_HOP_CANDIDATES)
+    template <size_t K>
+    int32_t FindCandidate(int32_t target_node_id);
+    int32_t (ArbiterGS::*m_find_candidate)(int32_t);
+
+    // Candidate of the decision cache (recomputed if invalid), 0 if every candidate detours
+    int32_t ChooseCandidate(int32_t target_node_id);
+    bool CandidateNeedsDetour(int32_t target_node_id, int32_t candidate);
+
+    // Candidate chosen for the flow in proportion to the residual capacity of the candidates, or -1 if none has any
+    int32_t ChooseWeightedCandidate(int32_t target_node_id, uint32_t flow_hash);
+    const double* GetCandidateResidualBps(int32_t target_node_id);      // as ArbiterLEO
+    static TrafficClass GetTrafficClass(Ptr<const Packet> pkt);     // class_default without FlowTosTag
+    FlowletTable m_flowlets;                    // used if flowlet_gap_ns > 0
+    ReceiveDataRateDevice* m_gsl_device;        // interface 1, validated at construction
+
 protected:
     Ptr<ArbiterLEOGSGEOHelper> m_arbiter_helper;
-    std::vector<std::vector<std::tuple<int32_t, int32_t, int32_t>>> m_next_hop_lists;
+    NextHopCandidates m_next_hop_lists;
+
+    // precomputed decision for each target: index of the candidate, or one of
+    // DECISION_INVALID / DECISION_ALL_DETOUR (the first candidate, although every
+    // candidate detours). Invalidated by NotifyNeighborStateChanged
+    static const int32_t DECISION_INVALID = -2;
+    static const int32_t DECISION_ALL_DETOUR = -1;
+    std::vector<int32_t> m_decision_cache;
+
+    // weight table of ChooseWeightedCandidate (as ArbiterLEO), only if weighted_candidate_classes is set
+    static const uint64_t NO_RESIDUAL_TICK = UINT64_MAX;
+    std::vector<double> m_candidate_residual_bps;
+    std::vector<uint64_t> m_candidate_residual_ticks;
 
     static int64_t receive_datarate_update_interval_ns;     // the interval that a netdevice receive datarate update
     static double gsl_data_rate_megabit_per_s;
     static int64_t num_satellites;
     static int64_t num_groundstations;
     static int64_t num_GEOsatellites;
+    static std::set<TrafficClass> weighted_candidate_classes;
 };
 
 }
@@ -13,6 +13,9 @@ namespace ns3{
 
 NS_OBJECT_ENSURE_REGISTERED (ArbiterLEO);
 
+std::set<TrafficClass> ArbiterLEO::weighted_candidate_classes;
+uint64_t ArbiterLEO::residual_tick = 0;
+double ArbiterLEO::geo_ill_spill_utilization = 0;
 ArbiterLEO::TraficAreasList ArbiterLEO::trafic_jam_areas;      // list of trafic jam area position
 ArbiterLEO::TraficAreasTime ArbiterLEO::trafic_areas_time;      // unordered map to record the time LEO satellite enter trafic jam area
 double ArbiterLEO::trafic_judge_rate_in_jam = 0;                  // Determine if a detour is necessary in jam area
@@ -21,9 +24,12 @@ double ArbiterLEO::trafic_judge_rate_jam_to_normal = 0;           // Determine i
 int64_t ArbiterLEO::trafic_jam_area_radius_m = 0;               // radius of a trafic jam area in meter
 int64_t ArbiterLEO::trafic_jam_update_interval_ns = 0;
 int64_t ArbiterLEO::receive_datarate_update_interval_ns = 0;
+int64_t ArbiterLEO::trafic_jam_prediction_lead_time_ns = 0;
 double ArbiterLEO::isl_data_rate_megabit_per_s = 0;
 double ArbiterLEO::gsl_data_rate_megabit_per_s = 0;
 double ArbiterLEO::ill_data_rate_megabit_per_s = 0;
+uint64_t ArbiterLEO::isl_data_rate_bps = 0;
+uint64_t ArbiterLEO::gsl_data_rate_bps = 0;
 int64_t ArbiterLEO::num_satellites = 0;
 int64_t ArbiterLEO::num_groundstations = 0;
 int64_t ArbiterLEO::num_GEOsatellites = 0;
@@ -41,7 +47,7 @@ ArbiterLEO::ArbiterLEO(
         Ptr<Node> this_node,
         NodeContainer nodes,
         int32_t next_GEO_node_id,
-        std::vector<std::vector<std::tuple<int32_t, int32_t, int32_t>>> next_hop_lists,
+        const NextHopCandidates& next_hop_lists,
         Ptr<ArbiterLEOGSGEOHelper> arbiter_helper
 ) : ArbiterSatnet(this_node, nodes)
 {
@@ -49,6 +55,18 @@ ArbiterLEO::ArbiterLEO(
     m_next_GEO_node_id = next_GEO_node_id;
     m_next_hop_lists = next_hop_lists;
     m_arbiter_helper = arbiter_helper;
+    m_decision_cache = std::vector<int32_t>(next_hop_lists.GetNumTargets(), DECISION_INVALID);
+    if(!weighted_candidate_classes.empty()){
+        m_candidate_residual_bps = std::vector<double>(next_hop_lists.GetNumTargets() * next_hop_lists.GetNumCandidates(), 0);
+        m_candidate_residual_ticks = std::vector<uint64_t>(next_hop_lists.GetNumTargets(), NO_RESIDUAL_TICK);
+    }
+    switch(next_hop_lists.GetNumCandidates()){
+        case 1: m_find_candidate = &ArbiterLEO::FindCandidate<1>; break;
+        case 2: m_find_candidate = &ArbiterLEO::FindCandidate<2>; break;
+        case 3: m_find_candidate = &ArbiterLEO::FindCandidate<3>; break;
+        case 4: m_find_candidate = &ArbiterLEO::FindCandidate<4>; break;
+        default: NS_ABORT_MSG("Unsupported number of next hop candidates: " + std::to_string(next_hop_lists.GetNumCandidates()));
+    }
 
     // interface for device in LEO satellite:
     // 0: loop-back interface
@@ -61,23 +79,36 @@ ArbiterLEO::ArbiterLEO(
 
     // initialize each interface detour information.
     interfaces_need_detour.push_back(false);    // loop-back interface
+    m_interface_is_isl.push_back(false);
+    m_receive_devices.push_back(nullptr);
     for(uint32_t i = 1; i < num_interfaces; ++i){
-        if(node->GetObject<Ipv4>()->GetNetDevice(i)->GetObject<GSLNetDevice>() != 0){
+        Ptr<NetDevice> device = node->GetObject<Ipv4>()->GetNetDevice(i);
+        if(device->GetObject<GSLNetDevice>() != 0){
             // ILL NetDevice(in our implement, ILL NetDevice is GSL NetDevice) do not attend detour calculation
+            NS_ABORT_MSG_IF(i != 5 && i != 6, "GSL NetDevice in LEO must be interface 5 or 6: " + std::to_string(i));
+            m_receive_devices.push_back(PeekPointer(device->GetObject<GSLNetDevice>()));
         }
-        else if(node->GetObject<Ipv4>()->GetNetDevice(i)->GetObject<PointToPointLaserNetDevice>() != 0){
+        else if(device->GetObject<PointToPointLaserNetDevice>() != 0){
             // ISL NetDevice
+            NS_ABORT_MSG_IF(i < 1 || i > 4, "ISL NetDevice in LEO must be interface 1 ~ 4: " + std::to_string(i));
             interfaces_need_detour.push_back(false);
+            m_interface_is_isl.push_back(true);
+            m_receive_devices.push_back(PeekPointer(device->GetObject<PointToPointLaserNetDevice>()));
         }
         else{
             NS_ABORT_MSG("Unidentified NetDevice in LEO");
         }
     }
     interfaces_need_detour.push_back(false);    // GSL interface
+    m_interface_is_isl.push_back(false);
+    m_receive_bps = std::vector<uint64_t>(num_interfaces, 0);
+    m_residual_bps = std::vector<uint64_t>(interfaces_need_detour.size(), 0);
+    for(uint32_t i = 1; i < m_residual_bps.size(); ++i){
+        m_residual_bps[i] = m_interface_is_isl[i] ? isl_data_rate_bps : gsl_data_rate_bps;
+    }
 
     // Initialize must before
     NS_ABORT_MSG_IF(receive_datarate_update_interval_ns == 0, "Initialize must before");
-    UpdateState();
 }
 
 void ArbiterLEO::InitializeArbiter(Ptr<BasicSimulation> basicSimulation, int64_t num_sat, int64_t num_gs, int64_t num_geo){
@@ -87,15 +118,22 @@ void ArbiterLEO::InitializeArbiter(Ptr<BasicSimulation> basicSimulation, int64_t
     trafic_jam_area_radius_m = parse_positive_int64(basicSimulation->GetConfigParamOrFail("trafic_jam_area_radius_m"));
     trafic_jam_update_interval_ns = parse_positive_int64(basicSimulation->GetConfigParamOrFail("trafic_jam_update_interval_ns"));
     receive_datarate_update_interval_ns = parse_positive_int64(basicSimulation->GetConfigParamOrFail("receive_datarate_update_interval_ns"));
+    trafic_jam_prediction_lead_time_ns = parse_positive_int64(basicSimulation->GetConfigParamOrDefault("trafic_jam_prediction_lead_time_ns", "0"));
+    NS_ABORT_MSG_IF(trafic_jam_prediction_lead_time_ns > 0 && basicSimulation->GetConfigParamOrDefault("trafic_jam_area_detection", "polling") != "predicted",
+                    "trafic_jam_prediction_lead_time_ns needs trafic_jam_area_detection=predicted");
     isl_data_rate_megabit_per_s = parse_positive_double(basicSimulation->GetConfigParamOrFail("isl_data_rate_megabit_per_s"));
     gsl_data_rate_megabit_per_s = parse_positive_double(basicSimulation->GetConfigParamOrFail("gsl_data_rate_megabit_per_s"));
     ill_data_rate_megabit_per_s = parse_positive_double(basicSimulation->GetConfigParamOrFail("ill_data_rate_megabit_per_s"));
+    isl_data_rate_bps = DataRate(std::to_string(isl_data_rate_megabit_per_s) + "Mbps").GetBitRate();
+    gsl_data_rate_bps = DataRate(std::to_string(gsl_data_rate_megabit_per_s) + "Mbps").GetBitRate();
     num_satellites = num_sat;
     num_groundstations = num_gs;
     num_GEOsatellites = num_geo;
 
-    // initialize receive_datarate_update_interval_ns in ReceiveDatarateDevice
-    ReceiveDataRateDevice::SetReceiveDatarateUpdateIntervalNS(receive_datarate_update_interval_ns);
+    // initialize receive_datarate_update_interval_ns and the estimator in ReceiveDatarateDevice
+    ReceiveDataRateDevice::Initialize(basicSimulation);
+    weighted_candidate_classes = ParseWeightedCandidateClasses(basicSimulation);
+    geo_ill_spill_utilization = parse_positive_double(basicSimulation->GetConfigParamOrDefault("geo_ill_spill_utilization", "0"));
 
     std::cout << "\n  > Algorithm argument" << std::endl;
     std::cout << "    trafic_judge_rate_in_jam:             " + std::to_string(trafic_judge_rate_in_jam) << std::endl;
@@ -104,6 +142,15 @@ void ArbiterLEO::InitializeArbiter(Ptr<BasicSimulation> basicSimulation, int64_t
     std::cout << "    trafic_jam_area_radius_m:             " + std::to_string(trafic_jam_area_radius_m) << std::endl;
     std::cout << "    trafic_jam_update_interval_ns:        " + std::to_string(trafic_jam_update_interval_ns) << std::endl;
     std::cout << "    receive_datarate_update_interval_ns:  " + std::to_string(receive_datarate_update_interval_ns) << std::endl;
+    std::cout << "    trafic_jam_prediction_lead_time_ns:   " + std::to_string(trafic_jam_prediction_lead_time_ns) << std::endl;
+    std::cout << "    receive_datarate_estimator:           " + std::string(ReceiveDataRateDevice::IsLazyEstimator() ? "ewma" : "interval") << std::endl;
+    std::cout << "    flowlet_gap_ns:                       " + std::to_string(FlowletTable::GetGapNs()) << std::endl;
+    std::cout << "    geo_ill_spill_utilization:            " + std::to_string(geo_ill_spill_utilization) << std::endl;
+    std::cout << "    weighted_candidate_classes:           ";
+    for(TrafficClass pclass : weighted_candidate_classes){
+        std::cout << TrafficClass2String(pclass) << " ";
+    }
+    std::cout << std::endl;
     std::cout << std::endl;
 }
 
@@ -116,29 +163,151 @@ ArbiterLEO::TopologySatelliteNetworkDecide(
         bool is_request_for_source_ip_so_no_next_header
 ) 
 {
-    NS_ABORT_MSG_UNLESS(m_node_id < num_satellites, "arbiter_leo in: " + std::to_string(m_node_id));
-    NS_ABORT_MSG_IF(target_node_id == m_node_id, "target_id == current_id, id: " + std::to_string(m_node_id));
+    NS_ASSERT_MSG(m_node_id < num_satellites, "arbiter_leo in: " + std::to_string(m_node_id));
+    NS_ASSERT_MSG(target_node_id != m_node_id, "target_id == current_id, id: " + std::to_string(m_node_id));
+
+    m_routing_decision_counters.decisions += 1;
+
+    // the flow is split over the candidates in proportion to their residual capacity
+    if(weighted_candidate_classes.count(TrafficClass::class_default)){
+        uint32_t flow_hash = ComputeFlowHash(ipHeader, pkt, is_request_for_source_ip_so_no_next_header);
+        int32_t candidate = ChooseWeightedCandidate(target_node_id, flow_hash, PeekFromTag(pkt));
+        if(candidate >= 0){
+            if(candidate > 0){
+                // to avoid network loopback (as class_B)
+                AddFromTag(pkt);
+            }
+            m_routing_decision_counters.weighted += 1;
+            m_routing_decision_counters.CountCandidate(candidate);
+            return m_next_hop_lists[target_node_id][candidate];
+        }
+    }
+
+    // the detour state of the candidates did not change since the last decision
+    int32_t decision = m_decision_cache[target_node_id];
+    if(decision >= 0){
+        m_routing_decision_counters.CountCandidate(decision);
+        return m_next_hop_lists[target_node_id][decision];
+    }
+    if(decision == DECISION_TO_GEO){
+        // the from tag must be added to each packet
+        return ForwardToGEOOrSpill(target_node_id, pkt, ipHeader, is_request_for_source_ip_so_no_next_header, TrafficClass::class_default);
+    }
+    m_routing_decision_counters.recomputed += 1;
+
+    decision = (this->*m_find_candidate)(target_node_id);
+    m_decision_cache[target_node_id] = decision;
+    if(decision >= 0){
+        m_routing_decision_counters.CountCandidate(decision);
+        return m_next_hop_lists[target_node_id][decision];
+    }
+
+    // all neighbor leo satellites are in detour,
+    // we can only forward the packet to GEOsatellite
+    return ForwardToGEOOrSpill(target_node_id, pkt, ipHeader, is_request_for_source_ip_so_no_next_header, TrafficClass::class_default);
+}
+
+std::tuple<int32_t, int32_t, int32_t>
+ArbiterLEO::ResolveFlowNextHop(
+        int32_t target_node_id,
+        TrafficClass pclass,
+        const FlowFiveTuple& flow,
+        int32_t& from_node_id
+)
+{
+    // as TopologySatelliteNetworkDecide, which routes each traffic class as class_default
+    if(weighted_candidate_classes.count(TrafficClass::class_default)){
+        int32_t candidate = ChooseWeightedCandidate(target_node_id, ComputeFlowHash(flow), from_node_id);
+        if(candidate >= 0){
+            if(candidate > 0){
+                from_node_id = m_node_id;
+            }
+            return m_next_hop_lists[target_node_id][candidate];
+        }
+    }
+
+    // the decision cache is only read
+    int32_t decision = m_decision_cache[target_node_id];
+    if(decision == DECISION_INVALID){
+        decision = (this->*m_find_candidate)(target_node_id);
+    }
+    if(decision >= 0){
+        return m_next_hop_lists[target_node_id][decision];
+    }
+    return ResolveFlowToGEOOrSpill(target_node_id, flow, from_node_id);
+}
 
-    // Note! we assume that LEO have 3 candidate
-    for(size_t i = 0; i < m_next_hop_lists[target_node_id].size(); ++i){
-        int32_t next_node_id = std::get<0>(m_next_hop_lists[target_node_id][i]);
-        int32_t next_interface_index = std::get<2>(m_next_hop_lists[target_node_id][i]);
+template <size_t K>
+int32_t ArbiterLEO::FindCandidate(int32_t target_node_id){
+    const NextHop* next_hops = m_next_hop_lists[target_node_id];
+    for(size_t i = 0; i < K; ++i){
+        int32_t next_node_id = std::get<0>(next_hops[i]);
+        int32_t next_interface_index = std::get<2>(next_hops[i]);
         if( next_node_id == target_node_id || 
             !m_arbiter_helper->GetArbiterLEO(next_node_id)->CheckIfNeedDetour(next_interface_index)){
             // find a neighbor ground station
             // or
             // find a neighbor leo satellite which can be forward
-            return m_next_hop_lists[target_node_id][i];
+            return i;
         }
     }
+    return DECISION_TO_GEO;
+}
 
-    // 3 neighbor leo satellites are in detour,
-    // we can only forward the packet to GEOsatellite
-    return ForwardToGEO(target_node_id, pkt);
+template int32_t ArbiterLEO::FindCandidate<1>(int32_t);
+template int32_t ArbiterLEO::FindCandidate<2>(int32_t);
+template int32_t ArbiterLEO::FindCandidate<3>(int32_t);
+template int32_t ArbiterLEO::FindCandidate<4>(int32_t);
+
+int32_t ArbiterLEO::ChooseWeightedCandidate(int32_t target_node_id, uint32_t flow_hash, int32_t from_node_id){
+    const NextHop* next_hops = m_next_hop_lists[target_node_id];
+    size_t num_candidates = m_next_hop_lists.GetNumCandidates();
+    const double* residual_bps = GetCandidateResidualBps(target_node_id);
+    std::array<double, MAX_NEXT_HOP_CANDIDATES> weights;
+    for(size_t i = 0; i < num_candidates; ++i){
+        int32_t next_node_id = std::get<0>(next_hops[i]);
+        if(next_node_id == target_node_id){
+            // a neighbor ground station
+            return i;
+        }
+        weights[i] = (next_node_id == from_node_id) ? 0 : residual_bps[i];
+    }
+
+    return PickWeightedCandidate(weights.data(), num_candidates, flow_hash);
+}
+
+const double* ArbiterLEO::GetCandidateResidualBps(int32_t target_node_id){
+    size_t num_candidates = m_next_hop_lists.GetNumCandidates();
+    double* residual_bps = &m_candidate_residual_bps[target_node_id * num_candidates];
+    if(m_candidate_residual_ticks[target_node_id] != residual_tick){
+        const NextHop* next_hops = m_next_hop_lists[target_node_id];
+        for(size_t i = 0; i < num_candidates; ++i){
+            int32_t next_node_id = std::get<0>(next_hops[i]);
+            if(next_node_id < 0 || next_node_id == target_node_id){
+                residual_bps[i] = 0;
+            }
+            else{
+                residual_bps[i] = m_arbiter_helper->GetArbiterLEO(next_node_id)->GetResidualBps(std::get<2>(next_hops[i]));
+            }
+        }
+        m_candidate_residual_ticks[target_node_id] = residual_tick;
+    }
+    return residual_bps;
 }
 
-void ArbiterLEO::SetLEOForwardState(int32_t target_node_id, std::vector<std::tuple<int32_t, int32_t, int32_t>> next_hop_list){
-    m_next_hop_lists[target_node_id] = next_hop_list;
+void ArbiterLEO::SetLEOForwardState(int32_t target_node_id, const std::vector<std::tuple<int32_t, int32_t, int32_t>>& next_hop_list){
+    m_next_hop_lists.Set(target_node_id, next_hop_list);
+    m_decision_cache[target_node_id] = DECISION_INVALID;
+    if(!m_candidate_residual_ticks.empty()){
+        m_candidate_residual_ticks[target_node_id] = NO_RESIDUAL_TICK;
+    }
+}
+
+void ArbiterLEO::NotifyNeighborStateChanged(const std::vector<int32_t>& target_node_ids){
+    // only the decisions which have that LEO as a candidate need to be recomputed
+    for(int32_t target : target_node_ids){
+        m_decision_cache[target] = DECISION_INVALID;
+    }
 }
 
 void ArbiterLEO::SetLEONextGEOID(int32_t next_GEO_node_id){
@@ -150,7 +319,12 @@ ArbiterLEO::ForwardToGEO(int32_t target_node_id, ns3::Ptr<const ns3::Packet> pkt
 {
     // forward to GEO
     AddFromTag(pkt);
+    return GetGEONextHop(target_node_id);
+}
 
+std::tuple<int32_t, int32_t, int32_t>
+ArbiterLEO::GetGEONextHop(int32_t target_node_id)
+{
     // make sure the GEO of next hop LEO is same to current LEO.
     int32_t next_node_id = std::get<0>(m_next_hop_lists[target_node_id][0]);
     if(m_arbiter_helper->GetArbiterLEO(next_node_id)->GetLEONextGEOID() != m_next_GEO_node_id){
@@ -176,15 +350,87 @@ ArbiterLEO::ForwardToGEO(int32_t target_node_id, ns3::Ptr<const ns3::Packet> pkt
     return std::make_tuple(m_next_GEO_node_id, 6, 1);
 }
 
+std::tuple<int32_t, int32_t, int32_t>
+ArbiterLEO::ForwardToGEOOrSpill(
+        int32_t target_node_id,
+        Ptr<const Packet> pkt,
+        Ipv4Header const &ipHeader,
+        bool is_request_for_source_ip_so_no_next_header,
+        TrafficClass pclass
+){
+    double share = GetGEOForwardShare(target_node_id);
+    if(share < 1){
+        uint32_t flow_hash = ComputeFlowHash(ipHeader, pkt, is_request_for_source_ip_so_no_next_header);
+        if(flow_hash / 4294967296.0 >= share){
+            if(pclass == TrafficClass::class_C){
+                m_routing_decision_counters.geo_spilled_bytes_class_c += pkt->GetSize();
+            }
+            else{
+                m_routing_decision_counters.geo_spilled_bytes += pkt->GetSize();
+            }
+            m_routing_decision_counters.CountCandidate(0);
+            return m_next_hop_lists[target_node_id][0];
+        }
+    }
+
+    if(pclass == TrafficClass::class_C){
+        m_routing_decision_counters.to_geo_class_c += 1;
+    }
+    else{
+        m_routing_decision_counters.to_geo += 1;
+    }
+    return ForwardToGEO(target_node_id, pkt);
+}
+
+std::tuple<int32_t, int32_t, int32_t>
+ArbiterLEO::ResolveFlowToGEOOrSpill(int32_t target_node_id, const FlowFiveTuple& flow, int32_t& from_node_id){
+    double share = GetGEOForwardShare(target_node_id);
+    if(share < 1 && ComputeFlowHash(flow) / 4294967296.0 >= share){
+        return m_next_hop_lists[target_node_id][0];
+    }
+    from_node_id = m_node_id;
+    return GetGEONextHop(target_node_id);
+}
+
+double ArbiterLEO::GetGEOForwardShare(int32_t target_node_id){
+    if(geo_ill_spill_utilization <= 0){
+        return 1;
+    }
+
+    // the GEO which ForwardToGEO forwards to, that of the first candidate
+    int32_t next_node_id = std::get<0>(m_next_hop_lists[target_node_id][0]);
+    int32_t geo_node_id = m_arbiter_helper->GetArbiterLEO(next_node_id)->GetLEONextGEOID();
+    Ptr<ArbiterGEO> geo = m_arbiter_helper->GetArbiterGEO(geo_node_id - num_satellites - num_groundstations);
+    if(geo == 0){
+        return 1;
+    }
+    double utilization = geo->GetIllUtilization();
+    return utilization > geo_ill_spill_utilization ? geo_ill_spill_utilization / utilization : 1;
+}
+
+bool ArbiterLEO::IsGEOSpillEnabled(){
+    return geo_ill_spill_utilization > 0;
+}
+
 void ArbiterLEO::AddFromTag(Ptr<const ns3::Packet> pkt){
+    // a packet which passed another forwarding LEO already has one, only the last is kept
     FromTag tag;
+    ConstCast<Packet>(pkt)->RemovePacketTag(tag);
     tag.SetFrom(m_node_id);
     pkt->AddPacketTag(tag);
 }
 
+int32_t ArbiterLEO::PeekFromTag(Ptr<const ns3::Packet> pkt){
+    FromTag tag;
+    if(!pkt->PeekPacketTag(tag)){
+        return -1;
+    }
+    return (int32_t) tag.GetFrom();
+}
+
 std::vector<std::tuple<int32_t, int32_t, int32_t>> 
 ArbiterLEO::GetLEOForwardState(int32_t target_node_id){
-    return m_next_hop_lists[target_node_id];
+    return m_next_hop_lists.Get(target_node_id);
 }
 
 int32_t ArbiterLEO::GetLEONextGEOID(){
@@ -195,33 +441,63 @@ bool ArbiterLEO::CheckIfInTraficJamArea(){
     return is_in_jam_area;
 }
 
+size_t ArbiterLEO::GetNumTraficJamAreas(){
+    return trafic_jam_areas.size();
+}
+
+uint64_t ArbiterLEO::EstimateForwardingStateMemoryBytes(){
+    return m_next_hop_lists.EstimateHeapBytes() + estimate_heap_bytes(m_decision_cache) + estimate_heap_bytes(m_receive_bps)
+           + estimate_heap_bytes(m_residual_bps) + m_flowlets.EstimateHeapBytes()
+           + estimate_heap_bytes(m_candidate_residual_bps) + estimate_heap_bytes(m_candidate_residual_ticks);
+}
+
+uint64_t ArbiterLEO::EstimateTraficJamAreasMemoryBytes(){
+    // list node (two pointers) with the shared position, which has its control block
+    uint64_t bytes = trafic_jam_areas.size() * (sizeof(std::shared_ptr<Vector>) + 2 * sizeof(void*) + sizeof(Vector) + 16);
+    bytes += estimate_heap_bytes(trafic_areas_time);
+    for(const std::pair<const std::shared_ptr<Vector>, std::unordered_map<int32_t, Time>>& area : trafic_areas_time){
+        bytes += estimate_heap_bytes(area.second);
+    }
+    return bytes;
+}
+
 bool ArbiterLEO::CheckIfNeedDetour(int32_t interface){
     // only detour in ISL NetDevice and GSL NetDevice
-    NS_ABORT_MSG_UNLESS(interface >= 1 && interface <= 5, 
+    NS_ASSERT_MSG(interface >= 1 && interface <= 5, 
                 "interface: " + std::to_string(interface) + " in LEO: " + std::to_string(m_node_id));
     return interfaces_need_detour[interface];
 }
 
+uint64_t ArbiterLEO::GetResidualBps(int32_t interface){
+    NS_ASSERT_MSG(interface >= 1 && interface <= 5,
+                "interface: " + std::to_string(interface) + " in LEO: " + std::to_string(m_node_id));
+    return m_residual_bps[interface];
+}
+
+uint64_t ArbiterLEO::GetResidualTick(){
+    return residual_tick;
+}
+
+void ArbiterLEO::AdvanceResidualTick(){
+    residual_tick++;
+}
+
 bool ArbiterLEO::CalculateIfInTraficJamArea(){
-    // check if the node is in trafic jam area
-    TraficAreasList::iterator ptr = trafic_jam_areas.begin();
-    while(ptr != trafic_jam_areas.end()){
-        if(CalculateIfInTheTraficJamArea(*ptr))
-            return true;
-        ++ptr;
+    Ptr<JamAreaPredictor> predictor = m_arbiter_helper->GetJamAreaPredictor();
+    if(predictor != 0){
+        return predictor->IsInAnyArea(m_node_id);
     }
 
-    return false;
+    // check if the node is in trafic jam area (calculated for all LEO satellites at once)
+    return m_arbiter_helper->GetJamAreaMembership()->IsInAnyArea(m_node_id);
 }
 
 bool ArbiterLEO::CalculateIfInTheTraficJamArea(std::shared_ptr<Vector> target){
-    Ptr<Node> node = m_nodes.Get(m_node_id);
-    Vector current_position = node->GetObject<MobilityModel>()->GetPosition();
-    double distance = CalculateDistance(current_position, *target);
-    if(distance < trafic_jam_area_radius_m)
-        return true;
-    else
-        return false;
+    Ptr<JamAreaPredictor> predictor = m_arbiter_helper->GetJamAreaPredictor();
+    if(predictor != 0){
+        return predictor->IsInArea(m_node_id, target);
+    }
+    return m_arbiter_helper->GetJamAreaMembership()->IsInArea(m_node_id, target);
 }
 
 std::string ArbiterLEO::StringReprOfForwardingState(){
@@ -229,56 +505,64 @@ std::string ArbiterLEO::StringReprOfForwardingState(){
 }
 
 void ArbiterLEO::UpdateState(){
-    UpdateReceiveDatarate();
+    bool previous_is_in_jam_area = is_in_jam_area;
+    std::vector<bool> previous_interfaces_need_detour = interfaces_need_detour;
+
     UpdateDetour();
 
-    // Plan next update
-    Simulator::Schedule(NanoSeconds(receive_datarate_update_interval_ns), &ArbiterLEO::UpdateState, this);
+    // Publish the flips to the arbiters which use this LEO as candidate
+    bool detour_flipped = (previous_interfaces_need_detour != interfaces_need_detour);
+    bool jam_flipped = (previous_is_in_jam_area != is_in_jam_area);
+    if(detour_flipped || jam_flipped){
+        m_arbiter_helper->NotifyDetourStateChanged(m_node_id, detour_flipped, jam_flipped);
+    }
 }
 
 void ArbiterLEO::UpdateDetour(){
-    // interface for device in satellite:
+    // interface for device in satellite (validated at construction):
     // 0: loop-back interface
     // 1 ~ 4: isl interface
     // 5: gsl interface
     // 6: ill interface
     Ptr<Node> node = m_nodes.Get(m_node_id);
-    uint32_t num_interfaces = node->GetObject<Ipv4>()->GetNInterfaces();
-    NS_ABORT_MSG_IF(num_interfaces != 7, "num interfaces in LEO must as 7: " + std::to_string(num_interfaces));
 
     // check if the node is in trafic jam area
     is_in_jam_area = CalculateIfInTraficJamArea();
 
+    // a LEO satellite which is about to enter a jam area already detours as if it is in it
+    bool use_judge_rate_in_jam = is_in_jam_area;
+    if(!is_in_jam_area && trafic_jam_prediction_lead_time_ns > 0){
+        use_judge_rate_in_jam = m_arbiter_helper->GetJamAreaPredictor()->GetTimeUntilEnter(m_node_id) <= NanoSeconds(trafic_jam_prediction_lead_time_ns);
+    }
+
     // update detour update
     int num_interface_detour = 0;
     // i begin at 1 to skip the loop-back interface
     for(uint32_t i = 1; i < interfaces_need_detour.size(); ++i){
-        if(node->GetObject<Ipv4>()->GetNetDevice(i)->GetObject<GSLNetDevice>() != 0){
+        if(!m_interface_is_isl[i]){
             // GSL(ILL) NetDevice
             // NOTE: GSL(ILL) do not attend detour calculation, but we
             // also update detour state because ground station need GSL detour state.
-            Ptr<GSLNetDevice> gsl = node->GetObject<Ipv4>()->GetNetDevice(i)->GetObject<GSLNetDevice>();
-            uint64_t now_bps = gsl->GetReceiveDataRate().GetBitRate();
-            uint64_t max_bps = DataRate(std::to_string(gsl_data_rate_megabit_per_s) + "Mbps").GetBitRate();
+            uint64_t now_bps = m_receive_bps[i];
+            uint64_t max_bps = gsl_data_rate_bps;
             interfaces_need_detour[i] = (now_bps >= max_bps * trafic_judge_rate_non_jam);
         }
-        else if(node->GetObject<Ipv4>()->GetNetDevice(i)->GetObject<PointToPointLaserNetDevice>() != 0){
+        else{
             // ISL NetDevice
-            Ptr<PointToPointLaserNetDevice> isl = node->GetObject<Ipv4>()->GetNetDevice(i)->GetObject<PointToPointLaserNetDevice>();
-            uint64_t now_bps = isl->GetReceiveDataRate().GetBitRate();
-            uint64_t max_bps = DataRate(std::to_string(isl_data_rate_megabit_per_s) + "Mbps").GetBitRate();
+            uint64_t now_bps = m_receive_bps[i];
+            uint64_t max_bps = isl_data_rate_bps;
 
             // update detour state
             if(now_bps < max_bps * trafic_judge_rate_jam_to_normal){
                 // do not need detour anymore
                 interfaces_need_detour[i] = false;
             }
-            else if(!is_in_jam_area && now_bps >= max_bps * trafic_judge_rate_non_jam){
+            else if(!use_judge_rate_in_jam && now_bps >= max_bps * trafic_judge_rate_non_jam){
                 // detour in non-jam area
                 interfaces_need_detour[i] = true;
                 ++num_interface_detour;
             }
-            else if(is_in_jam_area && now_bps >= max_bps * trafic_judge_rate_in_jam){
+            else if(use_judge_rate_in_jam && now_bps >= max_bps * trafic_judge_rate_in_jam){
                 // detour in jam area
                 interfaces_need_detour[i] = true;
                 ++num_interface_detour;
@@ -287,9 +571,10 @@ void ArbiterLEO::UpdateDetour(){
                 // detour state do not change
             }
         }
-        else{
-            NS_ABORT_MSG("Unidentified NetDevice");
-        }
+
+        // residual capacity (weighted_candidate_classes)
+        uint64_t capacity_bps = m_interface_is_isl[i] ? isl_data_rate_bps : gsl_data_rate_bps;
+        m_residual_bps[i] = (interfaces_need_detour[i] || m_receive_bps[i] >= capacity_bps) ? 0 : capacity_bps - m_receive_bps[i];
     }
 
     // We set a non-jam area change to jam area only
@@ -302,6 +587,12 @@ void ArbiterLEO::UpdateDetour(){
         std::shared_ptr<Vector> ptr = std::make_shared<Vector>(current_position);
         trafic_jam_areas.push_back(ptr);
         trafic_areas_time[ptr] = std::unordered_map<int32_t, Time>();
+        if(m_arbiter_helper->GetJamAreaPredictor() != 0){
+            m_arbiter_helper->GetJamAreaPredictor()->AddArea(ptr);
+        }
+        else{
+            m_arbiter_helper->GetJamAreaMembership()->AddArea(ptr);
+        }
 
         // display the progres of trafic jam list
         size_t areas_size = trafic_jam_areas.size();
@@ -337,6 +628,12 @@ void ArbiterLEO::UpdateDetour(){
                     // from start time to now is greater than trafic_jam_update_interval_ns, if yes, delete the jam area.
                     if(Simulator::Now() - trafic_areas_time.at(*ptr).at(m_node_id) >= NanoSeconds(trafic_jam_update_interval_ns)){
                         // jam area -> normal erea. So complicated! :-)
+                        if(m_arbiter_helper->GetJamAreaPredictor() != 0){
+                            m_arbiter_helper->GetJamAreaPredictor()->RemoveArea(*ptr);
+                        }
+                        else{
+                            m_arbiter_helper->GetJamAreaMembership()->RemoveArea(*ptr);
+                        }
                         ptr = trafic_jam_areas.erase(ptr);
                         is_in_jam_area = false;
                         is_delete_area = true;
@@ -377,104 +674,20 @@ void ArbiterLEO::UpdateReceiveDatarate(){
     // 1 ~ 4: isl interface
     // 5: gsl interface
     // 6: ill interface
-    Ptr<Node> node = m_nodes.Get(m_node_id);
-    uint32_t num_interfaces = node->GetObject<Ipv4>()->GetNInterfaces();
-    NS_ABORT_MSG_IF(num_interfaces != 7, "num interfaces in LEO must as 7: " + std::to_string(num_interfaces));
-
     // i begin at 1 to skip the loop-back interface
-    for(uint32_t i = 1; i < num_interfaces; ++i){
-        if(node->GetObject<Ipv4>()->GetNetDevice(i)->GetObject<GSLNetDevice>() != 0){
-            // GSL NetDevice(ILL NetDevice)
-            Ptr<GSLNetDevice> gsl = node->GetObject<Ipv4>()->GetNetDevice(i)->GetObject<GSLNetDevice>();
-            gsl->UpdateReceiveDataRate();
-        }
-        else if(node->GetObject<Ipv4>()->GetNetDevice(i)->GetObject<PointToPointLaserNetDevice>() != 0){
-            // ISL NetDevice
-            Ptr<PointToPointLaserNetDevice> isl = node->GetObject<Ipv4>()->GetNetDevice(i)->GetObject<PointToPointLaserNetDevice>();
-            isl->UpdateReceiveDataRate();
-        }
-        else{
-            NS_ABORT_MSG("Unidentified NetDevice in LEO");
-        }
+    for(uint32_t i = 1; i < m_receive_devices.size(); ++i){
+        m_receive_devices[i]->UpdateReceiveDataRate();
+        m_receive_bps[i] = m_receive_devices[i]->GetReceiveDataRate().GetBitRate();
     }
 }
 
-/***
-
-#include <iostream>
-#include <cmath>
-
-// 定义点的结构体
-struct Point {
-    double x, y, z;
-    Point(double _x, double _y, double _z) : x(_x), y(_y), z(_z) {}
-};
-
-// 定义轨道参数结构体
-struct OrbitParams {
-    double semi_major_axis; // 半长轴
-    double inclination;     // 倾角
-    // 其他轨道参数...
-};
-
-// 计算两点之间的距离
-double distance(const Point& p1, const Point& p2) {
-    return std::sqrt((p1.x - p2.x) * (p1.x - p2.x) +
-                     (p1.y - p2.y) * (p1.y - p2.y) +
-                     (p1.z - p2.z) * (p1.z - p2.z));
-}
-
-// 计算轨道平面与球心的最短距离
-double min_distance_to_sphere(const OrbitParams& orbit_params, const Point& sphere_center) {
-    // 计算轨道平面的法向量
-    double inclination_rad = orbit_params.inclination * M_PI / 180.0;
-    double normal_x = 0.0;
-    double normal_y = std::cos(inclination_rad);
-    double normal_z = std::sin(inclination_rad);
-
-    // 计算距离球心最近的轨道平面上的一点
-    // 该点到球心的向量与轨道平面的法向量垂直
-    double t = (sphere_center.x * normal_x + sphere_center.y * normal_y + sphere_center.z * normal_z) /
-               (normal_x * normal_x + normal_y * normal_y + normal_z * normal_z);
-    double x = sphere_center.x - t * normal_x;
-    double y = sphere_center.y - t * normal_y;
-    double z = sphere_center.z - t * normal_z;
-
-    // 计算轨道平面上的一点与球心的距离
-    Point point_on_orbit_plane(x, y, z);
-    return distance(point_on_orbit_plane, sphere_center);
-}
-
-// 判断轨道是否与给定球相交
-bool is_orbit_intersect_sphere(const OrbitParams& orbit_params, const Point& sphere_center, double sphere_radius) {
-    // 计算轨道平面与球心的最短距离
-    double min_distance = min_distance_to_sphere(orbit_params, sphere_center);
-
-    // 判断最短距离是否小于等于球的半径
-    if (min_distance <= sphere_radius) {
-        return true;
-    } else {
-        return false;
-    }
+const std::vector<uint64_t>& ArbiterLEO::GetReceiveDatarates(){
+    return m_receive_bps;
 }
 
-int main() {
-    // 示例数据
-    OrbitParams orbit_params = {1000.0, 30.0}; // 假设半长轴为1000，倾角为30度
-    Point sphere_center(500.0, 500.0, 500.0); // 球心坐标
-    double sphere_radius = 200.0; // 球的半径
-
-    // 判断轨道是否与给定球相交
-    bool result = is_orbit_intersect_sphere(orbit_params, sphere_center, sphere_radius);
-    if (result) {
-        std::cout << "轨道与给定球相交，卫星可能进入球内。" << std::endl;
-    } else {
-        std::cout << "轨道与给定球不相交，卫星不会进入球内。" << std::endl;
-    }
-
-    return 0;
+void ArbiterLEO::SetReceiveDatarates(const std::vector<uint64_t>& receive_bps){
+    NS_ABORT_MSG_IF(receive_bps.size() != m_receive_bps.size(), "Receive data rates must be given for each interface");
+    m_receive_bps = receive_bps;
 }
 
-*/
-
 }
\ No newline at end of file
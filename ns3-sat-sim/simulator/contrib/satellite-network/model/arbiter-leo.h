@@ -8,6 +8,9 @@
 #define ARBITER_LEO_H
 
 #include "ns3/arbiter-satnet.h"
+#include "ns3/next-hop-candidates.h"
+#include "ns3/flowlet-table.h"
+#include "ns3/receive-datarate-device.h"
 #include "ns3/abort.h"
 #include "ns3/ipv4-header.h"
 #include "ns3/udp-header.h"
@@ -27,7 +30,7 @@ public:
             Ptr<Node> this_node,
             NodeContainer nodes,
             int32_t next_GEO_hop,
-            std::vector<std::vector<std::tuple<int32_t, int32_t, int32_t>>> next_hop_lists,
+            const NextHopCandidates& next_hop_lists,
             Ptr<ArbiterLEOGSGEOHelper> arbiter_helper
     );
 
@@ -41,26 +44,97 @@ public:
             ns3::Ipv4Header const &ipHeader,
             bool is_socket_request_for_source_ip
     );
+    std::tuple<int32_t, int32_t, int32_t> ResolveFlowNextHop(
+            int32_t target_node_id,
+            TrafficClass pclass,
+            const FlowFiveTuple& flow,
+            int32_t& from_node_id
+    );
 
     // Update the forward state
-    void SetLEOForwardState(int32_t target_node_id, std::vector<std::tuple<int32_t, int32_t, int32_t>> next_hop_list);
+    void SetLEOForwardState(int32_t target_node_id, const std::vector<std::tuple<int32_t, int32_t, int32_t>>& next_hop_list);
     void SetLEONextGEOID(int32_t next_GEO_node_id);
 
     std::vector<std::tuple<int32_t, int32_t, int32_t>> GetLEOForwardState(int32_t target_node_id);
     int32_t GetLEONextGEOID();
 
     bool CheckIfInTraficJamArea();
+    static size_t GetNumTraficJamAreas();
     bool CheckIfNeedDetour(int32_t interface);
 
+    // GEO-bound traffic is spilled if the ILL utilization of the GEO is above geo_ill_spill_utilization (> 0)
+    static bool IsGEOSpillEnabled();
+
+    // Capacity of the interface minus its receive data rate (0 if it needs detour), at the last update
+    uint64_t GetResidualBps(int32_t interface);
+
+    // Number of detour state updates of all LEOs so far (the residual capacities change only at them)
+    static uint64_t GetResidualTick();
+    static void AdvanceResidualTick();
+
+    // Called by the helper when the detour state of a candidate LEO flipped, with the
+    // targets of which that LEO is a candidate (its subscriptions)
+    void NotifyNeighborStateChanged(const std::vector<int32_t>& target_node_ids);
+
+    // Update detour information each interval: receive_datarate_update_interval_ns.
+    // Driven by the helper: first the receive data rates are measured on the system which
+    // simulates the LEO (or set from the exchange between the systems), then the detour
+    // state of all LEOs is updated in the same order on every system
+    void UpdateReceiveDatarate();
+    const std::vector<uint64_t>& GetReceiveDatarates();
+    void SetReceiveDatarates(const std::vector<uint64_t>& receive_bps);
+    void UpdateState();
+
     std::string StringReprOfForwardingState();
 
+    // Estimated heap memory of the forwarding state and the jam areas (memory report)
+    uint64_t EstimateForwardingStateMemoryBytes();
+    static uint64_t EstimateTraficJamAreasMemoryBytes();
+
 protected:
     std::tuple<int32_t, int32_t, int32_t> ForwardToGEO(int32_t target_node_id, ns3::Ptr<const ns3::Packet> pkt);
+
+    // Next hop of ForwardToGEO, without the from tag
+    std::tuple<int32_t, int32_t, int32_t> GetGEONextHop(int32_t target_node_id);
+
+    // Share of the flows (by their hash) which ForwardToGEOOrSpill forwards to the GEO (1 if it does not spill)
+    double GetGEOForwardShare(int32_t target_node_id);
+
+    // Forwards to the GEO (ForwardToGEO), unless the ILL utilization of that GEO is above
+    // geo_ill_spill_utilization: then only the share geo_ill_spill_utilization / utilization of
+    // the flows (by their hash) is forwarded to it, the others are spilled to the first candidate
+    std::tuple<int32_t, int32_t, int32_t> ForwardToGEOOrSpill(
+            int32_t target_node_id,
+            ns3::Ptr<const ns3::Packet> pkt,
+            ns3::Ipv4Header const &ipHeader,
+            bool is_socket_request_for_source_ip,
+            TrafficClass pclass
+    );
+    // ForwardToGEOOrSpill for a flow (ResolveFlowNextHop)
+    std::tuple<int32_t, int32_t, int32_t> ResolveFlowToGEOOrSpill(int32_t target_node_id, const FlowFiveTuple& flow, int32_t& from_node_id);
+
     void AddFromTag(Ptr<const ns3::Packet> pkt);
+    static int32_t PeekFromTag(Ptr<const ns3::Packet> pkt);    // -1 without from tag
 
     bool CalculateIfInTraficJamArea();
     bool CalculateIfInTheTraficJamArea(std::shared_ptr<Vector> target);
 
+    // First candidate which does not detour, or DECISION_TO_GEO, with the number of
+    // candidates K known at compile time (instantiated for K = 1 .. MAX_NEXT_HOP_CANDIDATES)
+    template <size_t K>
+    int32_t FindCandidate(int32_t target_node_id);
+    int32_t (ArbiterLEO::*m_find_candidate)(int32_t);
+
+    // Candidate chosen for the flow in proportion to the residual capacity of the candidates
+    // (the LEO the packet came from excluded), or -1 if none has any. A neighbor ground station
+    // which is the target is always chosen. A detour (candidate > 0) needs the from tag.
+    // The flow hash is the one of ComputeFlowHash (salted with the node id)
+    int32_t ChooseWeightedCandidate(int32_t target_node_id, uint32_t flow_hash, int32_t from_node_id);
+
+    // Residual capacity of the K candidates of the target (0 for a drop or a neighbor ground station),
+    // read from the candidate LEOs once per residual tick
+    const double* GetCandidateResidualBps(int32_t target_node_id);
+
 private:
     // list of trafic jam area position
     typedef std::list<std::shared_ptr<Vector>> TraficAreasList;
@@ -69,19 +143,42 @@ private:
     // for each jam area, record the start time of LEO satellite enter to the jam area  
     typedef std::unordered_map<std::shared_ptr<Vector>, std::unordered_map<int32_t, Time>> TraficAreasTime;
 
-    // update detour information each interval: receive_datarate_update_interval_ns
     void UpdateDetour();
-    void UpdateReceiveDatarate();
-    void UpdateState();
 
 protected:
     // if the node which attach to this arbiter is detour
     bool is_in_jam_area;
     std::vector<bool> interfaces_need_detour;
+    std::vector<uint64_t> m_receive_bps;            // receive data rate of each interface at the last update
+    std::vector<uint64_t> m_residual_bps;           // residual capacity of each interface (1 ~ 5) at the last update
     int32_t m_next_GEO_node_id;
     Ptr<ArbiterLEOGSGEOHelper> m_arbiter_helper;
-    std::vector<std::vector<std::tuple<int32_t, int32_t, int32_t>>> m_next_hop_lists;
-
+    NextHopCandidates m_next_hop_lists;
+
+    // Interfaces which take part in the detour calculation (1 ~ 4: ISL, 5: GSL), the layout is
+    // validated once at construction: for each of them whether it is an ISL, and its device
+    std::vector<bool> m_interface_is_isl;
+    std::vector<ReceiveDataRateDevice*> m_receive_devices;     // all interfaces except the loop-back one
+
+    // precomputed decision for each target: index of the candidate, or one of
+    // DECISION_INVALID / DECISION_TO_GEO. Invalidated by NotifyNeighborStateChanged
+    static const int32_t DECISION_INVALID = -2;
+    static const int32_t DECISION_TO_GEO = -1;
+    std::vector<int32_t> m_decision_cache;
+
+    // weight table of ChooseWeightedCandidate: the K residual capacities of each target, and the
+    // residual tick at which they were read (NO_RESIDUAL_TICK: to be read). Only if weighted_candidate_classes is set
+    static const uint64_t NO_RESIDUAL_TICK = UINT64_MAX;
+    std::vector<double> m_candidate_residual_bps;
+    std::vector<uint64_t> m_candidate_residual_ticks;
+
+    // candidate of the ongoing flowlet of each class_B flow (ArbiterTrafficLEO, flowlet_gap_ns > 0),
+    // by the hash without node salt
+    FlowletTable m_flowlets;
+
+    static std::set<TrafficClass> weighted_candidate_classes;
+    static uint64_t residual_tick;
+    static double geo_ill_spill_utilization;                // spill GEO-bound traffic above this ILL utilization (0: never)
     static TraficAreasList trafic_jam_areas;                // list of trafic jam area position
     static TraficAreasTime trafic_areas_time;               // unordered map to record the time LEO satellite enter trafic jam area
     static double trafic_judge_rate_in_jam;                 // Determine if a detour is necessary in jam area
@@ -91,9 +188,13 @@ protected:
     static int64_t trafic_jam_update_interval_ns;           // after that interval time and a LEO satellites never detour in that time,
                                                             // a jam area be able to change to non-jam area
     static int64_t receive_datarate_update_interval_ns;     // the interval that a netdevice receive datarate update
+    static int64_t trafic_jam_prediction_lead_time_ns;      // with predicted jam areas: a LEO satellite which enters one within
+                                                            // that time already uses trafic_judge_rate_in_jam (0: disabled)
     static double isl_data_rate_megabit_per_s;
     static double gsl_data_rate_megabit_per_s;
     static double ill_data_rate_megabit_per_s;
+    static uint64_t isl_data_rate_bps;
+    static uint64_t gsl_data_rate_bps;
     static int64_t num_satellites;
     static int64_t num_groundstations;
     static int64_t num_GEOsatellites;
@@ -78,4 +78,16 @@ ArbiterResult ArbiterSatnet::Decide(
 
 }
 
+uint32_t ArbiterSatnet::ComputeFlowHash(const Ipv4Header &header, Ptr<const Packet> p, bool no_other_headers) {
+    return m_flow_hasher.Hash(header, p, m_node_id, no_other_headers);
+}
+
+uint32_t ArbiterSatnet::ComputeFlowHash(const FlowFiveTuple& flow) {
+    return m_flow_hasher.Hash(m_node_id, flow.src_ip, flow.dst_ip, flow.protocol, flow.src_port, flow.dst_port);
+}
+
+const RoutingDecisionCounters& ArbiterSatnet::GetRoutingDecisionCounters() {
+    return m_routing_decision_counters;
+}
+
 }
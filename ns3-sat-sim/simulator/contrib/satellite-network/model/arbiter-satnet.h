@@ -38,9 +38,22 @@
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-header.h"
 #include "ns3/arbiter.h"
+#include "ns3/five-tuple-hasher.h"
+#include "ns3/routing-decision-counters.h"
+#include "ns3/traffic-classify-tos.h"
 
 namespace ns3 {
 
+// 5-tuple of a flow, known without a packet (fluid engine)
+struct FlowFiveTuple
+{
+    uint32_t src_ip;
+    uint32_t dst_ip;
+    uint8_t protocol;
+    uint16_t src_port;
+    uint16_t dst_port;
+};
+
 class ArbiterSatnet : public Arbiter
 {
 
@@ -79,8 +92,40 @@ public:
             bool is_socket_request_for_source_ip
     ) = 0;
 
+    /**
+     * Next hop which TopologySatelliteNetworkDecide picks for the packets of a flow, without any
+     * side effect on the arbiter (counters, decision cache, flowlets, tags). The fluid engine walks
+     * the path of each flow with it. A flow has no gaps, so flowlets do not apply.
+     *
+     * @param target_node_id                                Node where the flow has to go to
+     * @param pclass                                        Traffic class of the flow
+     * @param flow                                          5-tuple of the flow (hashed as ComputeFlowHash)
+     * @param from_node_id                                  Node of the from tag of its packets (-1 if none),
+     *                                                      set to the from tag they leave with
+     *
+     * @return Tuple of (next node id, my own interface id, next interface id)
+     */
+    virtual std::tuple<int32_t, int32_t, int32_t> ResolveFlowNextHop(
+            int32_t target_node_id,
+            TrafficClass pclass,
+            const FlowFiveTuple& flow,
+            int32_t& from_node_id
+    ) = 0;
+
     virtual std::string StringReprOfForwardingState() = 0;
 
+    // Counters of the routing decisions of this arbiter
+    const RoutingDecisionCounters& GetRoutingDecisionCounters();
+
+protected:
+    // Hash of the 5-tuple salted with the node id (as ArbiterEcmp), with which the flows are split
+    // (weighted candidates, GEO spill): the split of a node is independent of that of the nodes before it
+    uint32_t ComputeFlowHash(const Ipv4Header &header, Ptr<const Packet> p, bool no_other_headers);
+    uint32_t ComputeFlowHash(const FlowFiveTuple& flow);
+
+    RoutingDecisionCounters m_routing_decision_counters;
+    FiveTupleHasher m_flow_hasher;
+
 };
 
 }
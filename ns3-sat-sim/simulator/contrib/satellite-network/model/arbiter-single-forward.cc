@@ -50,6 +50,15 @@ std::tuple<int32_t, int32_t, int32_t> ArbiterSingleForward::TopologySatelliteNet
     return m_next_hop_list[target_node_id];
 }
 
+std::tuple<int32_t, int32_t, int32_t> ArbiterSingleForward::ResolveFlowNextHop(
+        int32_t target_node_id,
+        TrafficClass pclass,
+        const FlowFiveTuple& flow,
+        int32_t& from_node_id
+) {
+    return m_next_hop_list[target_node_id];
+}
+
 void ArbiterSingleForward::SetSingleForwardState(int32_t target_node_id, int32_t next_node_id, int32_t own_if_id, int32_t next_if_id) {
     NS_ABORT_MSG_IF(next_node_id == -2 || own_if_id == -2 || next_if_id == -2, "Not permitted to set invalid (-2).");
     m_next_hop_list[target_node_id] = std::make_tuple(next_node_id, own_if_id, next_if_id);
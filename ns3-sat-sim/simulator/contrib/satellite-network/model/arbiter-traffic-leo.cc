@@ -3,7 +3,6 @@
 */
 
 #include "arbiter-traffic-leo.h"
-#include "ns3/from-tag.h"
 
 
 
@@ -24,7 +23,7 @@ ArbiterTrafficLEO::ArbiterTrafficLEO(
             Ptr<Node> this_node,
             NodeContainer nodes,
             int32_t next_GEO_hop,
-            std::vector<std::vector<std::tuple<int32_t, int32_t, int32_t>>> next_hop_lists,
+            const NextHopCandidates& next_hop_lists,
             Ptr<ArbiterLEOGSGEOHelper> arbiter_leogeo_helper
 ): ArbiterLEO(this_node, nodes, next_GEO_hop, next_hop_lists, arbiter_leogeo_helper)
 {
@@ -38,8 +37,8 @@ std::tuple<int32_t, int32_t, int32_t> ArbiterTrafficLEO::TopologySatelliteNetwor
             ns3::Ipv4Header const &ipHeader,
             bool is_socket_request_for_source_ip)
 {
-    NS_ABORT_MSG_UNLESS(m_node_id < num_satellites, "arbiter_leo in: " + std::to_string(m_node_id));
-    NS_ABORT_MSG_IF(target_node_id == m_node_id, "target_id == current_id, id: " + std::to_string(m_node_id));
+    NS_ASSERT_MSG(m_node_id < num_satellites, "arbiter_leo in: " + std::to_string(m_node_id));
+    NS_ASSERT_MSG(target_node_id != m_node_id, "target_id == current_id, id: " + std::to_string(m_node_id));
 
     FlowTosTag tag;
     bool found = pkt->PeekPacketTag(tag);
@@ -50,6 +49,9 @@ std::tuple<int32_t, int32_t, int32_t> ArbiterTrafficLEO::TopologySatelliteNetwor
         if(header.GetTtl() == 0){
             // Icmp packet(see Ipv4L3Protocol::IpForward, line 1066, and Icmpv4L4Protocol::SendTimeExceededTtl)
             // just forward to shortest LEO
+            m_routing_decision_counters.decisions += 1;
+            m_routing_decision_counters.icmp_ttl_exceeded += 1;
+            m_routing_decision_counters.CountCandidate(0);
             return m_next_hop_lists[target_node_id][0];
 
             // we can do more check: if(ResolveNodeIdFromIp(header.GetSource().Get()) == (uint32_t)target_node_id).
@@ -64,6 +66,49 @@ std::tuple<int32_t, int32_t, int32_t> ArbiterTrafficLEO::TopologySatelliteNetwor
     if(pclass == TrafficClass::class_default){
         return ArbiterLEO::TopologySatelliteNetworkDecide(source_node_id, target_node_id, pkt, ipHeader, is_socket_request_for_source_ip);
     }
+    m_routing_decision_counters.decisions += 1;
+    m_routing_decision_counters.recomputed += 1;
+    if(pclass == TrafficClass::class_A){
+        m_routing_decision_counters.class_a += 1;
+    }
+    else if(pclass == TrafficClass::class_B){
+        m_routing_decision_counters.class_b += 1;
+    }
+
+    // with flowlets, a class_B flow keeps the candidate of its ongoing flowlet as long as it does not detour
+    bool flowlets = pclass == TrafficClass::class_B && FlowletTable::IsEnabled();
+    bool weighted = pclass == TrafficClass::class_B && weighted_candidate_classes.count(TrafficClass::class_B);
+    uint32_t flow_hash = 0;
+    int64_t now_ns = 0;
+    if(flowlets){
+        flow_hash = m_flowlets.ComputeFiveTupleHash(ipHeader, pkt, is_socket_request_for_source_ip);
+        now_ns = Simulator::Now().GetTimeStep();
+        int32_t candidate = m_flowlets.GetCandidate(flow_hash, target_node_id, now_ns);
+        if(candidate >= 0 && CanKeepFlowletCandidate(target_node_id, candidate, pkt)){
+            m_flowlets.SetCandidate(flow_hash, target_node_id, candidate, now_ns);
+            m_routing_decision_counters.flowlet_kept += 1;
+            m_routing_decision_counters.CountCandidate(candidate);
+            return m_next_hop_lists[target_node_id][candidate];
+        }
+    }
+
+    // the flow is split over the candidates in proportion to their residual capacity
+    if(weighted){
+        uint32_t salted_flow_hash = ComputeFlowHash(ipHeader, pkt, is_socket_request_for_source_ip);
+        int32_t candidate = ChooseWeightedCandidate(target_node_id, salted_flow_hash, PeekFromTag(pkt));
+        if(candidate >= 0){
+            if(candidate > 0){
+                // to avoid network loopback
+                AddFromTag(pkt);
+            }
+            if(flowlets){
+                m_flowlets.SetCandidate(flow_hash, target_node_id, candidate, now_ns);
+            }
+            m_routing_decision_counters.weighted += 1;
+            m_routing_decision_counters.CountCandidate(candidate);
+            return m_next_hop_lists[target_node_id][candidate];
+        }
+    }
 
     // the next node do not need detour
     // or
@@ -71,12 +116,17 @@ std::tuple<int32_t, int32_t, int32_t> ArbiterTrafficLEO::TopologySatelliteNetwor
     int32_t next_node_id = std::get<0>(m_next_hop_lists[target_node_id][0]);
     int32_t next_interface_id = std::get<2>(m_next_hop_lists[target_node_id][0]);
     if(next_node_id == target_node_id || !m_arbiter_helper->GetArbiterLEO(next_node_id)->CheckIfNeedDetour(next_interface_id)){
+        if(flowlets){
+            m_flowlets.SetCandidate(flow_hash, target_node_id, 0, now_ns);
+        }
+        m_routing_decision_counters.CountCandidate(0);
         return m_next_hop_lists[target_node_id][0];
     }
 
     // the next node need detour
     if(pclass == TrafficClass::class_A){
         // never detour
+        m_routing_decision_counters.CountCandidate(0);
         return m_next_hop_lists[target_node_id][0];
     }
     else if(pclass == TrafficClass::class_B){
@@ -84,42 +134,112 @@ std::tuple<int32_t, int32_t, int32_t> ArbiterTrafficLEO::TopologySatelliteNetwor
         // skip shortest LEO satellite.
 
         // Note: For B class flow, we add from tag  to avoid network loopback
-        FromTag from_tag;
-        pkt->PeekPacketTag(from_tag);
-        int32_t from = from_tag.GetFrom();
-
+        int32_t from = PeekFromTag(pkt);
         AddFromTag(pkt);
 
-        std::tuple<int32_t, int32_t, int32_t> res;
-        // find a default res which is not the from node
-        for(size_t i = 1; i < m_next_hop_lists[target_node_id].size(); ++i){
-            next_node_id = std::get<0>(m_next_hop_lists[target_node_id][i]);
-            if(next_node_id != from){
-                res = m_next_hop_lists[target_node_id][i];
-                break;
-            }
+        bool fallback;
+        int32_t candidate = FindDetourCandidate(target_node_id, from, m_routing_decision_counters.class_b_loop_avoided, fallback);
+        if(fallback){
+            m_routing_decision_counters.class_b_fallback += 1;
         }
-        // find a next node which is not need detour
-        for(size_t i = 1; i < m_next_hop_lists[target_node_id].size(); ++i){
-            next_node_id = std::get<0>(m_next_hop_lists[target_node_id][i]);
-            next_interface_id = std::get<2>(m_next_hop_lists[target_node_id][i]);
-            // The next_node do not need detour. And the packet is not from next_node(to avoid network loopback)
-            if(!m_arbiter_helper->GetArbiterLEO(next_node_id)->CheckIfNeedDetour(next_interface_id) && from != next_node_id){
-                res = m_next_hop_lists[target_node_id][i];
-                break;
-            }
+        if(flowlets){
+            m_flowlets.SetCandidate(flow_hash, target_node_id, candidate, now_ns);
         }
-        return res;
+        m_routing_decision_counters.CountCandidate(candidate);
+        return m_next_hop_lists[target_node_id][candidate];
     }
     else if(pclass == TrafficClass::class_C){
-        // detour to GEO satellite
-        return ForwardToGEO(target_node_id, pkt);
+        // detour to GEO satellite (unless its ILL is congested)
+        return ForwardToGEOOrSpill(target_node_id, pkt, ipHeader, is_socket_request_for_source_ip, TrafficClass::class_C);
     }
     else{
         NS_ABORT_MSG("TrafficClass error");
     }
 }
 
+std::tuple<int32_t, int32_t, int32_t> ArbiterTrafficLEO::ResolveFlowNextHop(
+            int32_t target_node_id,
+            TrafficClass pclass,
+            const FlowFiveTuple& flow,
+            int32_t& from_node_id)
+{
+    if(pclass == TrafficClass::class_default){
+        return ArbiterLEO::ResolveFlowNextHop(target_node_id, pclass, flow, from_node_id);
+    }
+
+    // as TopologySatelliteNetworkDecide
+    if(pclass == TrafficClass::class_B && weighted_candidate_classes.count(TrafficClass::class_B)){
+        int32_t candidate = ChooseWeightedCandidate(target_node_id, ComputeFlowHash(flow), from_node_id);
+        if(candidate >= 0){
+            if(candidate > 0){
+                from_node_id = m_node_id;
+            }
+            return m_next_hop_lists[target_node_id][candidate];
+        }
+    }
+    int32_t next_node_id = std::get<0>(m_next_hop_lists[target_node_id][0]);
+    int32_t next_interface_id = std::get<2>(m_next_hop_lists[target_node_id][0]);
+    if(pclass == TrafficClass::class_A || next_node_id == target_node_id
+       || !m_arbiter_helper->GetArbiterLEO(next_node_id)->CheckIfNeedDetour(next_interface_id)){
+        return m_next_hop_lists[target_node_id][0];
+    }
+    if(pclass == TrafficClass::class_B){
+        uint64_t num_loops_avoided = 0;
+        bool fallback;
+        int32_t candidate = FindDetourCandidate(target_node_id, from_node_id, num_loops_avoided, fallback);
+        from_node_id = m_node_id;
+        return m_next_hop_lists[target_node_id][candidate];
+    }
+    return ResolveFlowToGEOOrSpill(target_node_id, flow, from_node_id);
+}
+
+int32_t ArbiterTrafficLEO::FindDetourCandidate(int32_t target_node_id, int32_t from_node_id, uint64_t& num_loops_avoided, bool& fallback){
+    // skip shortest LEO satellite.
+    // find a default candidate which is not the from node
+    int32_t res_index = 0;
+    for(size_t i = 1; i < m_next_hop_lists.GetNumCandidates(); ++i){
+        if(std::get<0>(m_next_hop_lists[target_node_id][i]) != from_node_id){
+            res_index = i;
+            break;
+        }
+    }
+    // find a next node which is not need detour
+    for(size_t i = 1; i < m_next_hop_lists.GetNumCandidates(); ++i){
+        int32_t next_node_id = std::get<0>(m_next_hop_lists[target_node_id][i]);
+        int32_t next_interface_id = std::get<2>(m_next_hop_lists[target_node_id][i]);
+        // The next_node do not need detour. And the packet is not from next_node(to avoid network loopback)
+        if(!m_arbiter_helper->GetArbiterLEO(next_node_id)->CheckIfNeedDetour(next_interface_id)){
+            if(from_node_id != next_node_id){
+                fallback = false;
+                return i;
+            }
+            num_loops_avoided += 1;
+        }
+    }
+    fallback = true;
+    return res_index;
+}
+
+bool ArbiterTrafficLEO::CanKeepFlowletCandidate(int32_t target_node_id, int32_t candidate, Ptr<const Packet> pkt){
+    int32_t next_node_id = std::get<0>(m_next_hop_lists[target_node_id][candidate]);
+    int32_t next_interface_id = std::get<2>(m_next_hop_lists[target_node_id][candidate]);
+    if(next_node_id < 0){
+        return false;
+    }
+
+    // the shortest LEO satellite, or the ground station
+    if(candidate == 0){
+        return next_node_id == target_node_id || !m_arbiter_helper->GetArbiterLEO(next_node_id)->CheckIfNeedDetour(next_interface_id);
+    }
+
+    // a detour, as such it must not be the node the packet came from (and it gets the from tag)
+    if(PeekFromTag(pkt) == next_node_id || m_arbiter_helper->GetArbiterLEO(next_node_id)->CheckIfNeedDetour(next_interface_id)){
+        return false;
+    }
+    AddFromTag(pkt);
+    return true;
+}
+
 
 
 
@@ -26,7 +26,7 @@ public:
             Ptr<Node> this_node,
             NodeContainer nodes,
             int32_t next_GEO_hop,
-            std::vector<std::vector<std::tuple<int32_t, int32_t, int32_t>>> next_hop_lists,
+            const NextHopCandidates& next_hop_lists,
             Ptr<ArbiterLEOGSGEOHelper> arbiter_leogeo_helper
     );
 
@@ -37,6 +37,22 @@ public:
             ns3::Ipv4Header const &ipHeader,
             bool is_socket_request_for_source_ip
     ) override;
+    std::tuple<int32_t, int32_t, int32_t> ResolveFlowNextHop(
+            int32_t target_node_id,
+            TrafficClass pclass,
+            const FlowFiveTuple& flow,
+            int32_t& from_node_id
+    ) override;
+
+private:
+    // Detour of a class_B flow of which the first candidate detours: the first other candidate
+    // which does not detour and is not the node the packet came from, else the first other
+    // candidate which is not that node (fallback)
+    int32_t FindDetourCandidate(int32_t target_node_id, int32_t from_node_id, uint64_t& num_loops_avoided, bool& fallback);
+
+    // The candidate of the ongoing flowlet of a class_B flow does not detour (and, if it is a
+    // detour, is not the node the packet came from)
+    bool CanKeepFlowletCandidate(int32_t target_node_id, int32_t candidate, Ptr<const Packet> pkt);
 
 };
 
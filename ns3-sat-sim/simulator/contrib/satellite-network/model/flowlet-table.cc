@@ -0,0 +1,68 @@
+/**
+ * Author:  silent-rookie      2024
+*/
+
+#include "flowlet-table.h"
+
+namespace ns3 {
+
+int64_t FlowletTable::flowlet_gap_ns = 0;
+size_t FlowletTable::flowlet_table_size = 0;
+
+void FlowletTable::Initialize(Ptr<BasicSimulation> basicSimulation){
+    flowlet_gap_ns = parse_positive_int64(basicSimulation->GetConfigParamOrDefault("flowlet_gap_ns", "0"));
+    int64_t table_size = parse_positive_int64(basicSimulation->GetConfigParamOrDefault("flowlet_table_size", "1024"));
+    if(table_size < 1 || (table_size & (table_size - 1)) != 0){
+        throw std::invalid_argument("flowlet_table_size must be a power of two: " + std::to_string(table_size));
+    }
+    flowlet_table_size = (size_t) table_size;
+}
+
+bool FlowletTable::IsEnabled(){
+    return flowlet_gap_ns > 0;
+}
+
+int64_t FlowletTable::GetGapNs(){
+    return flowlet_gap_ns;
+}
+
+FlowletTable::FlowletTable(){
+
+}
+
+uint32_t FlowletTable::ComputeFiveTupleHash(const Ipv4Header &header, Ptr<const Packet> p, bool no_other_headers){
+    return m_hasher.Hash(header, p, 0, no_other_headers);
+}
+
+uint32_t FlowletTable::ComputeFiveTupleHash(uint32_t src_ip, uint32_t dst_ip, uint8_t protocol, uint16_t src_port, uint16_t dst_port){
+    return m_hasher.Hash(0, src_ip, dst_ip, protocol, src_port, dst_port);
+}
+
+int32_t FlowletTable::GetCandidate(uint32_t hash, int32_t target_node_id, int64_t now_ns){
+    if(m_flowlets.empty()){
+        return -1;
+    }
+    const Flowlet& flowlet = m_flowlets[hash & (flowlet_table_size - 1)];
+    if(flowlet.last_packet_ns < 0 || flowlet.hash != hash || flowlet.target_node_id != target_node_id
+       || now_ns - flowlet.last_packet_ns > flowlet_gap_ns){
+        return -1;
+    }
+    return flowlet.candidate;
+}
+
+void FlowletTable::SetCandidate(uint32_t hash, int32_t target_node_id, int32_t candidate, int64_t now_ns){
+    if(m_flowlets.empty()){
+        m_flowlets = std::vector<Flowlet>(flowlet_table_size, Flowlet{0, -1, -1, -1});
+    }
+    Flowlet& flowlet = m_flowlets[hash & (flowlet_table_size - 1)];
+    flowlet.hash = hash;
+    flowlet.target_node_id = target_node_id;
+    flowlet.candidate = candidate;
+    flowlet.last_packet_ns = now_ns;
+}
+
+uint64_t FlowletTable::EstimateHeapBytes() const {
+    return estimate_heap_bytes(m_flowlets);
+}
+
+}
@@ -0,0 +1,67 @@
+/**
+ * Author:  silent-rookie      2024
+*/
+
+#ifndef FLOWLET_TABLE_H
+#define FLOWLET_TABLE_H
+
+#include <vector>
+#include "ns3/basic-simulation.h"
+#include "ns3/five-tuple-hasher.h"
+
+namespace ns3 {
+
+/**
+ * Candidate next hop of each flow of an arbiter, such that the packets of a flow keep
+ * the same candidate while the detour states flip (flowlet_gap_ns > 0, default 0 which
+ * chooses per packet). The candidate of a flow is only chosen again on a flowlet boundary
+ * (no packet of the flow for more than flowlet_gap_ns), or when the arbiter finds the
+ * candidate congested.
+ *
+ * The flows are identified by the hash of their 5-tuple (FiveTupleHasher, as ArbiterEcmp, but
+ * the same at each hop), which indexes a
+ * table of flowlet_table_size entries (default 1024, a power of two). Two flows of which
+ * the hash is in the same entry replace each other, which only ends a flowlet early.
+ * The table of an arbiter is allocated at its first flowlet.
+ */
+class FlowletTable
+{
+public:
+    // Reads flowlet_gap_ns and flowlet_table_size
+    static void Initialize(Ptr<BasicSimulation> basicSimulation);
+    static bool IsEnabled();
+    static int64_t GetGapNs();
+
+    FlowletTable();
+
+    // Hash of the 5-tuple (ports are 0 if there is no UDP or TCP header to peek at), without node salt
+    uint32_t ComputeFiveTupleHash(const Ipv4Header &header, Ptr<const Packet> p, bool no_other_headers);
+    uint32_t ComputeFiveTupleHash(uint32_t src_ip, uint32_t dst_ip, uint8_t protocol, uint16_t src_port, uint16_t dst_port);
+
+    // Candidate of the ongoing flowlet of the flow to the target, or -1 on a flowlet boundary
+    int32_t GetCandidate(uint32_t hash, int32_t target_node_id, int64_t now_ns);
+
+    // Starts or continues the flowlet of the flow on the candidate
+    void SetCandidate(uint32_t hash, int32_t target_node_id, int32_t candidate, int64_t now_ns);
+
+    uint64_t EstimateHeapBytes() const;
+
+private:
+    struct Flowlet
+    {
+        uint32_t hash;
+        int32_t target_node_id;
+        int32_t candidate;
+        int64_t last_packet_ns;         // -1 if the entry is free
+    };
+
+    static int64_t flowlet_gap_ns;
+    static size_t flowlet_table_size;
+
+    std::vector<Flowlet> m_flowlets;
+    FiveTupleHasher m_hasher;
+};
+
+}
+
+#endif //FLOWLET_TABLE_H
@@ -0,0 +1,450 @@
+/**
+ * Author:  silent-rookie      2024
+*/
+
+#include "fluid-engine.h"
+#include "ns3/ipv4-arbiter-routing.h"
+#include "ns3/udp-burst-application.h"
+#include "ns3/mobility-model.h"
+#include "ns3/gsl-net-device.h"
+#include "ns3/point-to-point-laser-net-device.h"
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (FluidEngine);
+
+TypeId FluidEngine::GetTypeId (void)
+{
+    static TypeId tid = TypeId ("ns3::FluidEngine")
+            .SetParent<Object> ()
+            .SetGroupName("BasicSim")
+    ;
+    return tid;
+}
+
+FluidEngine::FluidEngine(Ptr<BasicSimulation> basicSimulation, Ptr<TopologySatelliteNetwork> topology, Ptr<ArbiterHelper> arbiterHelper, bool hybrid)
+        : m_hybrid(hybrid), m_num_steps(0), m_num_unreachable_walks(0) {
+    printf("FLUID ENGINE\n");
+    m_basicSimulation = basicSimulation;
+    m_topology = topology;
+    m_simulation_end_time_ns = m_basicSimulation->GetSimulationEndTimeNs();
+
+    // Only the UDP bursts are simulated as flows (the others are packets in the hybrid mode)
+    if (m_basicSimulation->IsDistributedEnabled()) {
+        throw std::invalid_argument("The fluid engine does not support distributed simulation");
+    }
+    if (!m_hybrid && (parse_boolean(m_basicSimulation->GetConfigParamOrDefault("enable_tcp_flow_scheduler", "false"))
+        || parse_boolean(m_basicSimulation->GetConfigParamOrDefault("enable_pingmesh_scheduler", "false")))) {
+        throw std::invalid_argument("The fluid engine only simulates UDP bursts (no TCP flows or pingmesh)");
+    }
+    m_enabled = parse_boolean(m_basicSimulation->GetConfigParamOrDefault("enable_udp_burst_scheduler", "false"));
+    if (!m_enabled) {
+        std::cout << "  > UDP burst scheduler is not enabled, so there are no flows" << std::endl << std::endl;
+        return;
+    }
+
+    // Parameters
+    m_time_step_ns = parse_positive_int64(m_basicSimulation->GetConfigParamOrDefault(
+            "fluid_time_step_ns",
+            m_basicSimulation->GetConfigParamOrDefault("receive_datarate_update_interval_ns", "20000000")
+    ));
+    NS_ABORT_MSG_IF(m_time_step_ns <= 0, "fluid_time_step_ns must be positive");
+    m_max_iterations = parse_positive_int64(m_basicSimulation->GetConfigParamOrDefault("fluid_max_iterations", "50"));
+    NS_ABORT_MSG_IF(m_max_iterations <= 0, "fluid_max_iterations must be positive");
+    std::cout << "  > Time step.......... " << m_time_step_ns << " ns" << std::endl;
+    std::cout << "  > Max. iterations.... " << m_max_iterations << std::endl;
+
+    // Traffic model of the UDP bursts
+    UdpBurstApplication::Initialize(m_basicSimulation);
+    m_mean_on_fraction = UdpBurstApplication::GetMeanOnFraction();
+    m_schedule = read_udp_burst_schedule(
+            m_basicSimulation->GetRunDir() + "/" + m_basicSimulation->GetConfigParamOrFail("udp_burst_schedule_filename"),
+            m_topology,
+            m_simulation_end_time_ns
+    );
+    if (m_hybrid) {
+        std::vector<UdpBurstInfo> fluid_bursts;
+        for (UdpBurstInfo& info : m_schedule) {
+            if (UdpBurstScheduler::IsFluidBurst(info)) {
+                fluid_bursts.push_back(info);
+            }
+        }
+        m_schedule = fluid_bursts;
+    }
+    if (!m_hybrid && !parse_set_positive_int64(m_basicSimulation->GetConfigParamOrDefault("udp_burst_enable_logging_for_udp_burst_ids", "set()")).empty()) {
+        std::cout << "  > There are no packets, so udp_burst_enable_logging_for_udp_burst_ids is ignored" << std::endl;
+    }
+    printf("  > Read schedule (%s UDP bursts: %lu)\n", m_hybrid ? "fluid" : "total", m_schedule.size());
+    printf("  > Mean on fraction... %.3f\n", m_mean_on_fraction);
+    for (size_t i = 0; i < m_schedule.size(); i++) {
+        std::map<TrafficClass, double> zero;
+        for (TrafficClass pclass : TrafficClassVec) {
+            zero[pclass] = 0;
+        }
+        m_sent_bits.push_back(zero);
+        m_received_bits.push_back(zero);
+        m_received_bits_delay_ns.push_back(zero);
+    }
+
+    // Arbiters which pick the paths
+    NodeContainer nodes = m_topology->GetNodes();
+    for (uint32_t i = 0; i < nodes.GetN(); i++) {
+        Ptr<ArbiterSatnet> arbiter = DynamicCast<ArbiterSatnet>(
+                nodes.Get(i)->GetObject<Ipv4>()->GetRoutingProtocol()->GetObject<Ipv4ArbiterRouting>()->GetArbiter()
+        );
+        NS_ABORT_MSG_IF(arbiter == 0, "The fluid engine needs a satellite network arbiter on each node");
+        m_arbiters.push_back(arbiter);
+    }
+
+    // The packets of all bursts of a node go over the same socket (as such the same 5-tuple
+    // for all of its bursts to the same node), each arbiter hashes it salted with its node id
+    for (UdpBurstInfo& info : m_schedule) {
+        FlowFiveTuple flow;
+        flow.src_ip = nodes.Get(info.GetFromNodeId())->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal().Get();
+        flow.dst_ip = nodes.Get(info.GetToNodeId())->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal().Get();
+        flow.protocol = UDP_PROT_NUMBER;
+        flow.src_port = UDP_BURST_PORT;
+        flow.dst_port = UDP_BURST_PORT;
+        m_flow_tuples.push_back(flow);
+    }
+
+    // The detour logic gets the receive data rates of the flows
+    // (in the hybrid mode those of the devices, which include the background)
+    m_detour_helper = DynamicCast<ArbiterLEOGSGEOHelper>(arbiterHelper);
+    if (m_detour_helper != 0 && !m_hybrid) {
+        m_detour_helper->DisableReceiveDatarateMeasurement();
+    }
+
+    ReadLinks();
+    m_positions = std::vector<Vector>(nodes.GetN());
+    m_position_time_ns = std::vector<int64_t>(nodes.GetN(), -1);
+    m_basicSimulation->RegisterTimestamp("Setup fluid engine");
+
+    // Results of the UDP bursts
+    m_performance_dir = m_basicSimulation->GetRunDir() + "/algorithm_performance";
+    mkdir_if_not_exists(m_performance_dir);
+    if (m_hybrid) {
+        m_performance_dir += "/fluid_background";
+        mkdir_if_not_exists(m_performance_dir);
+    }
+
+    // First step at the start
+    Simulator::Schedule(NanoSeconds(0), &FluidEngine::Step, this);
+    std::cout << std::endl;
+}
+
+void FluidEngine::ReadLinks() {
+
+    // interface for device in LEO satellite:
+    // 1 ~ 4: isl interface, 5: gsl interface, 6: ill interface
+    // ground station: 1: gsl interface
+    // GEO satellite: 1: ill interface
+    NodeContainer nodes = m_topology->GetNodes();
+    m_link_index.resize(nodes.GetN());
+    for (uint32_t node_id = 0; node_id < nodes.GetN(); node_id++) {
+        Ptr<Ipv4> ipv4 = nodes.Get(node_id)->GetObject<Ipv4>();
+        m_link_index[node_id] = std::vector<size_t>(ipv4->GetNInterfaces(), 0);
+        for (uint32_t i = 1; i < ipv4->GetNInterfaces(); i++) {
+            Ptr<NetDevice> device = ipv4->GetNetDevice(i);
+            Link link;
+            link.node_id = node_id;
+            link.interface = i;
+            Ptr<Queue<Packet>> queue;
+            DataRateValue data_rate;
+            if (device->GetObject<PointToPointLaserNetDevice>() != 0) {
+                link.type = "ISL";
+                queue = device->GetObject<PointToPointLaserNetDevice>()->GetQueue();
+                link.device = PeekPointer(device->GetObject<PointToPointLaserNetDevice>());
+            } else if (device->GetObject<GSLNetDevice>() != 0) {
+                bool is_ill = !m_topology->IsSatelliteId(node_id) && !m_topology->IsGroundStationId(node_id);
+                is_ill = is_ill || (m_topology->IsSatelliteId(node_id) && i == 6);
+                link.type = is_ill ? "ILL" : "GSL";
+                queue = device->GetObject<GSLNetDevice>()->GetQueue();
+                link.device = PeekPointer(device->GetObject<GSLNetDevice>());
+            } else {
+                throw std::runtime_error("Unidentified net device on node " + std::to_string(node_id));
+            }
+            device->GetAttribute("DataRate", data_rate);
+            link.capacity_bps = data_rate.Get().GetBitRate();
+            link.max_queue_pkt = queue->GetMaxSize().GetValue();
+            m_link_index[node_id][i] = m_links.size();
+            m_links.push_back(link);
+        }
+    }
+    m_link_used = std::vector<bool>(m_links.size(), false);
+    m_link_capacity_bps = std::vector<double>(m_links.size(), 0.0);
+    for (size_t l = 0; l < m_links.size(); l++) {
+        m_link_capacity_bps[l] = m_links[l].capacity_bps;
+    }
+    m_link_pass = std::vector<double>(m_links.size(), 1.0);
+    m_link_arrival_bps = std::vector<double>(m_links.size(), 0.0);
+    m_link_receive_bps = std::vector<double>(m_links.size(), 0.0);
+    m_link_offered_bits = std::vector<double>(m_links.size(), 0.0);
+    m_link_carried_bits = std::vector<double>(m_links.size(), 0.0);
+    m_link_max_utilization = std::vector<double>(m_links.size(), 0.0);
+    printf("  > Links.............. %lu\n", m_links.size());
+}
+
+bool FluidEngine::WalkPath(int32_t from_node_id, int32_t to_node_id, TrafficClass pclass, const FlowFiveTuple& flow, std::vector<Hop>& hops) {
+
+    // The from tag which the packets of the flow would carry along the walk
+    int32_t from_tag_node_id = -1;
+
+    int32_t current_node_id = from_node_id;
+    for (size_t i = 0; i < MAX_HOPS; i++) {
+        std::tuple<int32_t, int32_t, int32_t> next_hop = m_arbiters[current_node_id]->ResolveFlowNextHop(
+                to_node_id, pclass, flow, from_tag_node_id
+        );
+        int32_t next_node_id = std::get<0>(next_hop);
+        if (next_node_id < 0) {
+            return false;
+        }
+        Hop hop;
+        hop.link = m_link_index[current_node_id][std::get<1>(next_hop)];
+        hop.receive_link = m_link_index[next_node_id][std::get<2>(next_hop)];
+        hops.push_back(hop);
+        if (next_node_id == to_node_id) {
+            return true;
+        }
+        current_node_id = next_node_id;
+    }
+    return false;
+}
+
+void FluidEngine::SolveLinkRates() {
+    for (size_t l : m_used_links) {
+        m_link_pass[l] = 1.0;
+        if (m_hybrid) {
+            double packets_bps = m_links[l].device->GetTransmitDataRate().GetBitRate();
+            m_link_capacity_bps[l] = std::max(m_links[l].capacity_bps - packets_bps, m_links[l].capacity_bps * ReceiveDataRateDevice::MIN_PACKET_CAPACITY_SHARE);
+        }
+    }
+
+    // Each link carries min(1, capacity / arrival) of its arrival rate, which itself
+    // depends on the links before it: iterate until it no longer changes
+    for (int64_t iteration = 0; iteration < m_max_iterations; iteration++) {
+        for (size_t l : m_used_links) {
+            m_link_arrival_bps[l] = 0;
+        }
+        for (const Flow& flow : m_flows) {
+            double rate_bps = flow.offered_bps;
+            for (const Hop& hop : flow.hops) {
+                m_link_arrival_bps[hop.link] += rate_bps;
+                rate_bps *= m_link_pass[hop.link];
+            }
+        }
+        double max_change = 0;
+        for (size_t l : m_used_links) {
+            double pass = m_link_arrival_bps[l] > m_link_capacity_bps[l] ? m_link_capacity_bps[l] / m_link_arrival_bps[l] : 1.0;
+            max_change = std::max(max_change, std::abs(pass - m_link_pass[l]));
+            m_link_pass[l] = pass;
+        }
+        if (max_change < 1e-9) {
+            break;
+        }
+    }
+
+    // Delivered rates, delays and the rates at the receiving devices
+    for (size_t l : m_used_links) {
+        m_link_receive_bps[l] = 0;
+    }
+    for (Flow& flow : m_flows) {
+        double rate_bps = flow.offered_bps;
+        flow.delay_ns = 0;
+        for (const Hop& hop : flow.hops) {
+            rate_bps *= m_link_pass[hop.link];
+            m_link_receive_bps[hop.receive_link] += rate_bps;
+            flow.delay_ns += HopDelayNs(hop);
+        }
+        flow.delivered_bps = flow.reached ? rate_bps : 0;
+    }
+}
+
+double FluidEngine::HopDelayNs(const Hop& hop) {
+    const Link& link = m_links[hop.link];
+    int32_t nodes_of_hop[2] = {link.node_id, m_links[hop.receive_link].node_id};
+    int64_t now_ns = Simulator::Now().GetNanoSeconds();
+    for (int32_t node_id : nodes_of_hop) {
+        if (m_position_time_ns[node_id] != now_ns) {
+            m_positions[node_id] = m_topology->GetNodes().Get(node_id)->GetObject<MobilityModel>()->GetPosition();
+            m_position_time_ns[node_id] = now_ns;
+        }
+    }
+    double propagation_ns = CalculateDistance(m_positions[nodes_of_hop[0]], m_positions[nodes_of_hop[1]]) / 299792458.0 * 1e9;
+
+    // Transmission and queueing (M/D/1 waiting time, the full queue if overloaded)
+    double transmission_ns = PACKET_SIZE_BYTE * 8.0 / link.capacity_bps * 1e9;
+    double utilization = m_link_arrival_bps[hop.link] / m_link_capacity_bps[hop.link];
+    double queue_pkt = utilization >= 1.0 ? link.max_queue_pkt : std::min(link.max_queue_pkt, utilization / (2 * (1 - utilization)));
+    return propagation_ns + transmission_ns + queue_pkt * transmission_ns;
+}
+
+void FluidEngine::SetReceiveDatarates() {
+    if (m_detour_helper == 0) {
+        return;
+    }
+    for (uint32_t sat = 0; sat < m_topology->GetNumSatellites(); sat++) {
+        std::vector<uint64_t> receive_bps(m_link_index[sat].size(), 0);
+        for (size_t i = 1; i < m_link_index[sat].size(); i++) {
+            receive_bps[i] = (uint64_t) m_link_receive_bps[m_link_index[sat][i]];
+        }
+        m_detour_helper->GetArbiterLEO(sat)->SetReceiveDatarates(receive_bps);
+    }
+
+    // The ILL utilization of the GEO satellites (interface 1), which the LEO satellites spill by
+    if (ArbiterLEO::IsGEOSpillEnabled()) {
+        uint32_t first_geo = m_topology->GetNumSatellites() + m_topology->GetNumGroundStations();
+        for (uint32_t geo = 0; geo < m_topology->GetNumGEOSatellites(); geo++) {
+            size_t ill_link = m_link_index[first_geo + geo][1];
+            m_detour_helper->GetArbiterGEO(geo)->SetIllUtilization(m_link_receive_bps[ill_link] / m_links[ill_link].capacity_bps);
+        }
+    }
+}
+
+void FluidEngine::SetBackgroundDataRates() {
+    for (size_t l = 0; l < m_links.size(); l++) {
+        if (m_link_used[l]) {
+            m_links[l].device->SetBackgroundDataRates(m_link_receive_bps[l], m_link_arrival_bps[l] * m_link_pass[l]);
+        } else {
+            m_links[l].device->SetBackgroundDataRates(0, 0);
+        }
+    }
+}
+
+void FluidEngine::Step() {
+    int64_t now_ns = Simulator::Now().GetNanoSeconds();
+    int64_t step_end_ns = std::min(now_ns + m_time_step_ns, m_simulation_end_time_ns);
+
+    // Flows of the bursts which are active during the step (their paths at its start)
+    m_flows.clear();
+    for (size_t l : m_used_links) {
+        m_link_used[l] = false;
+    }
+    m_used_links.clear();
+    for (size_t b = 0; b < m_schedule.size(); b++) {
+        UdpBurstInfo& info = m_schedule[b];
+        int64_t burst_end_ns = info.GetStartTimeNs() + info.GetDurationNs();
+        if (info.GetStartTimeNs() >= step_end_ns || burst_end_ns <= now_ns) {
+            continue;
+        }
+        for (size_t c = 0; c < TrafficClassVec.size(); c++) {
+            double share = UdpBurstApplication::GetTrafficClassRate(TrafficClassVec[c]);
+            if (share <= 0) {
+                continue;
+            }
+            Flow flow;
+            flow.burst = b;
+            flow.traffic_class = c;
+            flow.offered_bps = info.GetTargetRateMegabitPerSec() * 1e6 * m_mean_on_fraction * share;
+            flow.reached = WalkPath(info.GetFromNodeId(), info.GetToNodeId(), TrafficClassVec[c], m_flow_tuples[b], flow.hops);
+            if (!flow.reached) {
+                m_num_unreachable_walks++;
+            }
+            for (const Hop& hop : flow.hops) {
+                if (!m_link_used[hop.link]) {
+                    m_link_used[hop.link] = true;
+                    m_used_links.push_back(hop.link);
+                }
+                if (!m_link_used[hop.receive_link]) {
+                    m_link_used[hop.receive_link] = true;
+                    m_used_links.push_back(hop.receive_link);
+                }
+            }
+            m_flows.push_back(flow);
+        }
+    }
+    SolveLinkRates();
+
+    // Totals over the part of the step in which each burst is active
+    for (const Flow& flow : m_flows) {
+        UdpBurstInfo& info = m_schedule[flow.burst];
+        int64_t active_ns = std::min(step_end_ns, info.GetStartTimeNs() + info.GetDurationNs()) - std::max(now_ns, info.GetStartTimeNs());
+        double seconds = active_ns / 1e9;
+        TrafficClass pclass = TrafficClassVec[flow.traffic_class];
+        m_sent_bits[flow.burst][pclass] += flow.offered_bps * seconds;
+        m_received_bits[flow.burst][pclass] += flow.delivered_bps * seconds;
+        m_received_bits_delay_ns[flow.burst][pclass] += flow.delivered_bps * seconds * flow.delay_ns;
+    }
+    double step_seconds = (step_end_ns - now_ns) / 1e9;
+    for (size_t l : m_used_links) {
+        double carried_bps = m_link_arrival_bps[l] * m_link_pass[l];
+        m_link_offered_bits[l] += m_link_arrival_bps[l] * step_seconds;
+        m_link_carried_bits[l] += carried_bps * step_seconds;
+        m_link_max_utilization[l] = std::max(m_link_max_utilization[l], carried_bps / m_links[l].capacity_bps);
+    }
+
+    // Loads of this step for the next detour update
+    if (m_hybrid) {
+        SetBackgroundDataRates();
+    } else {
+        SetReceiveDatarates();
+    }
+    m_num_steps++;
+
+    if (step_end_ns < m_simulation_end_time_ns) {
+        Simulator::Schedule(NanoSeconds(step_end_ns - now_ns), &FluidEngine::Step, this);
+    }
+}
+
+void FluidEngine::WriteResults() {
+    std::cout << "STORE FLUID ENGINE RESULTS" << std::endl;
+    if (!m_enabled) {
+        std::cout << "  > Not enabled, so no fluid results are written" << std::endl << std::endl;
+        return;
+    }
+    std::cout << "  > Steps.............. " << m_num_steps << std::endl;
+    std::cout << "  > Walks without path. " << m_num_unreachable_walks << std::endl;
+
+    // Performance of the UDP bursts, in packets of the full size
+    std::vector<std::map<TrafficClass, uint64_t>> sent_counters;
+    std::vector<std::map<TrafficClass, uint64_t>> received_counters;
+    std::vector<std::map<TrafficClass, int64_t>> received_delays_ns;
+    double packet_bits = PACKET_SIZE_BYTE * 8.0;
+    for (size_t b = 0; b < m_schedule.size(); b++) {
+        std::map<TrafficClass, uint64_t> sent;
+        std::map<TrafficClass, uint64_t> received;
+        std::map<TrafficClass, int64_t> delay_ns;
+        for (TrafficClass pclass : TrafficClassVec) {
+            sent[pclass] = (uint64_t) std::llround(m_sent_bits[b][pclass] / packet_bits);
+            received[pclass] = (uint64_t) std::llround(m_received_bits[b][pclass] / packet_bits);
+            delay_ns[pclass] = m_received_bits[b][pclass] > 0 ? (int64_t) (m_received_bits_delay_ns[b][pclass] / m_received_bits[b][pclass]) : 0;
+        }
+        sent_counters.push_back(sent);
+        received_counters.push_back(received);
+        received_delays_ns.push_back(delay_ns);
+    }
+    if (!m_schedule.empty()) {
+        UdpBurstScheduler::WritePerformanceFiles(
+                m_performance_dir,
+                m_schedule, sent_counters, received_counters, received_delays_ns, m_simulation_end_time_ns
+        );
+    }
+
+    // Load of each link which carried a flow
+    // (line format: node id,interface,ISL/GSL/ILL,capacity (Mbit/s),mean offered (Mbit/s),
+    //  mean carried (Mbit/s),mean utilization,max utilization,dropped (%))
+    std::string filename = m_basicSimulation->GetLogsDir() + "/fluid_link_loads.csv";
+    FILE* file = fopen(filename.c_str(), "w+");
+    if (file == nullptr) {
+        throw std::runtime_error("Could not open " + filename);
+    }
+    double duration_s = m_simulation_end_time_ns / 1e9;
+    for (size_t l = 0; l < m_links.size(); l++) {
+        if (m_link_offered_bits[l] <= 0) {
+            continue;
+        }
+        const Link& link = m_links[l];
+        fprintf(
+                file, "%d,%d,%s,%.3f,%.6f,%.6f,%.6f,%.6f,%.5f\n",
+                link.node_id, link.interface, link.type.c_str(), link.capacity_bps / 1e6,
+                m_link_offered_bits[l] / duration_s / 1e6, m_link_carried_bits[l] / duration_s / 1e6,
+                m_link_carried_bits[l] / duration_s / link.capacity_bps, m_link_max_utilization[l],
+                (1 - m_link_carried_bits[l] / m_link_offered_bits[l]) * 100
+        );
+    }
+    fclose(file);
+    std::cout << "  > Link loads written to: " << filename << std::endl;
+    std::cout << std::endl;
+}
+
+}
@@ -0,0 +1,131 @@
+/**
+ * Author:  silent-rookie      2024
+*/
+
+#ifndef FLUID_ENGINE_H
+#define FLUID_ENGINE_H
+
+#include <vector>
+#include <map>
+#include "ns3/basic-simulation.h"
+#include "ns3/topology-satellite-network.h"
+#include "ns3/arbiter-satnet.h"
+#include "ns3/arbiter-helper.h"
+#include "ns3/arbiter-leo-gs-geo-helper.h"
+#include "ns3/udp-burst-scheduler.h"
+#include "ns3/traffic-classify-tos.h"
+#include "ns3/receive-datarate-device.h"
+
+namespace ns3 {
+
+/**
+ * Flow-level (fluid) simulation of the UDP bursts (simulation_mode=fluid).
+ *
+ * Instead of sending packets, every fluid_time_step_ns the mean rate of each active
+ * UDP burst (target rate x mean on fraction) is split over the traffic classes, and each
+ * of those flows is pushed along the path which the arbiters of the nodes pick for the
+ * packets of its class (ResolveFlowNextHop with the 5-tuple of the burst, which leaves
+ * the arbiters as they are). An overloaded link carries its capacity, shared by the flows in
+ * proportion of their arrival rate (fixed point over the upstream losses, at most
+ * fluid_max_iterations). The delivered rates are the receive data rates of the LEO
+ * satellites and the ILL utilization of the GEO satellites at the next detour update, as
+ * such the detour logic and the GEO spill run as with packets.
+ *
+ * The delay of a flow is the propagation delay, the transmission time and an M/D/1 queueing
+ * delay (the full queue if overloaded) of each link. At the end the same algorithm_performance
+ * files as UdpBurstScheduler are written, and the load of each link to fluid_link_loads.csv.
+ *
+ * In the hybrid mode (simulation_mode=hybrid) only the UDP bursts marked fluid are flows, the
+ * other bursts and the TCP flows are packets. The flows then see the capacity which the packets
+ * leave (the transmit data rate of the device), and their rates are the background of the
+ * devices: added to the receive data rate of the detour logic (and of the GEO ILLs), and taking their part of the
+ * transmit capacity for the packets. Their performance is written to algorithm_performance/fluid_background.
+ */
+class FluidEngine : public Object
+{
+public:
+    static TypeId GetTypeId (void);
+    FluidEngine(Ptr<BasicSimulation> basicSimulation, Ptr<TopologySatelliteNetwork> topology, Ptr<ArbiterHelper> arbiterHelper, bool hybrid);
+
+    void WriteResults();
+
+protected:
+    struct Link {
+        int32_t node_id;
+        int32_t interface;
+        std::string type;           // ISL, GSL or ILL
+        double capacity_bps;
+        double max_queue_pkt;
+        ReceiveDataRateDevice* device;
+    };
+
+    struct Hop {
+        size_t link;                // link index of the transmitting device
+        size_t receive_link;        // link index of the receiving device
+    };
+
+    struct Flow {
+        size_t burst;
+        size_t traffic_class;       // index in TrafficClassVec
+        double offered_bps;
+        double delivered_bps;
+        double delay_ns;
+        bool reached;               // false if the walk ended without a next hop or exceeded the TTL
+        std::vector<Hop> hops;
+    };
+
+    void ReadLinks();
+    void Step();
+    bool WalkPath(int32_t from_node_id, int32_t to_node_id, TrafficClass pclass, const FlowFiveTuple& flow, std::vector<Hop>& hops);
+    void SolveLinkRates();
+    double HopDelayNs(const Hop& hop);
+    void SetReceiveDatarates();
+    void SetBackgroundDataRates();
+
+    static const size_t MAX_HOPS = 64;              // default IPv4 TTL
+    static const uint32_t PACKET_SIZE_BYTE = 1500;  // full UDP burst packet
+    static const uint16_t UDP_BURST_PORT = 1026;    // of the UDP burst applications (UdpBurstScheduler)
+
+    Ptr<BasicSimulation> m_basicSimulation;
+    Ptr<TopologySatelliteNetwork> m_topology;
+    Ptr<ArbiterLEOGSGEOHelper> m_detour_helper;     // 0 if the algorithm does not detour
+    std::vector<Ptr<ArbiterSatnet>> m_arbiters;     // per node
+    int64_t m_simulation_end_time_ns;
+    int64_t m_time_step_ns;
+    int64_t m_max_iterations;
+    double m_mean_on_fraction;
+    bool m_enabled;
+    bool m_hybrid;
+    std::string m_performance_dir;
+
+    // Links: one per transmitting device
+    std::vector<Link> m_links;
+    std::vector<std::vector<size_t>> m_link_index;  // per node, per interface
+
+    // State of the current step
+    std::vector<UdpBurstInfo> m_schedule;
+    std::vector<FlowFiveTuple> m_flow_tuples;       // per burst, the 5-tuple of its packets
+    std::vector<Flow> m_flows;
+    std::vector<size_t> m_used_links;
+    std::vector<bool> m_link_used;
+    std::vector<double> m_link_capacity_bps;        // left by the packets in the hybrid mode
+    std::vector<double> m_link_pass;                // share of the arrival rate which the link carries
+    std::vector<double> m_link_arrival_bps;
+    std::vector<double> m_link_receive_bps;         // per receiving device
+    std::vector<Vector> m_positions;
+    std::vector<int64_t> m_position_time_ns;
+
+    // Totals
+    std::vector<std::map<TrafficClass, double>> m_sent_bits;             // per burst
+    std::vector<std::map<TrafficClass, double>> m_received_bits;
+    std::vector<std::map<TrafficClass, double>> m_received_bits_delay_ns;
+    std::vector<double> m_link_offered_bits;
+    std::vector<double> m_link_carried_bits;
+    std::vector<double> m_link_max_utilization;
+    int64_t m_num_steps;
+    uint64_t m_num_unreachable_walks;
+};
+
+}
+
+#endif //FLUID_ENGINE_H
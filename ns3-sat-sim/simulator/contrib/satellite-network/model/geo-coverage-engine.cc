@@ -0,0 +1,97 @@
+/**
+ * Author:  silent-rookie      2024
+*/
+
+#include "geo-coverage-engine.h"
+#include <cmath>
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (GeoCoverageEngine);
+
+TypeId GeoCoverageEngine::GetTypeId (void){
+    static TypeId tid = TypeId ("ns3::GeoCoverageEngine")
+            .SetParent<Object> ()
+            .SetGroupName("BasicSim")
+    ;
+    return tid;
+}
+
+GeoCoverageEngine::GeoCoverageEngine(Ptr<BasicSimulation> basicSimulation, Ptr<TopologySatelliteNetwork> topology){
+    m_topology = topology;
+    m_num_satellites = topology->GetNumSatellites();
+    m_first_GEO_node_id = topology->GetNumSatellites() + topology->GetNumGroundStations();
+    m_max_ill_length_m = topology->GetMaxILL_Length_M();
+    m_handover_hysteresis_m = parse_double(basicSimulation->GetConfigParamOrDefault("ill_handover_hysteresis_m", "0"));
+    NS_ABORT_MSG_IF(m_handover_hysteresis_m < 0, "ill_handover_hysteresis_m must be non-negative");
+
+    // Sub-satellite points of the GEO satellites
+    NodeContainer nodes = m_topology->GetNodes();
+    for(uint32_t geo = 0; geo < m_topology->GetNumGEOSatellites(); ++geo){
+        Vector position = nodes.Get(m_first_GEO_node_id + geo)->GetObject<MobilityModel>()->GetPosition();
+        double radius_m = std::sqrt(position.x * position.x + position.y * position.y + position.z * position.z);
+        m_geo_directions.push_back(Vector(position.x / radius_m, position.y / radius_m, position.z / radius_m));
+        m_geo_radius_m.push_back(radius_m);
+    }
+
+    m_next_GEO_ids = std::vector<int32_t>(m_num_satellites, -1);
+    m_num_handovers = 0;
+
+    std::cout << "  > ILL handover hysteresis: " << m_handover_hysteresis_m << "m" << std::endl;
+}
+
+const std::vector<int32_t>& GeoCoverageEngine::Update(){
+    NodeContainer nodes = m_topology->GetNodes();
+    double max_ill_length_squared = m_max_ill_length_m * m_max_ill_length_m;
+
+    m_changed.clear();
+    for(int64_t sat = 0; sat < m_num_satellites; ++sat){
+        Vector position = nodes.Get(sat)->GetObject<MobilityModel>()->GetPosition();
+        double radius_squared = position.x * position.x + position.y * position.y + position.z * position.z;
+
+        // Nearest GEO in ILL range, and the distance to the current GEO
+        int32_t nearest_geo = -1;
+        double nearest_distance_squared = max_ill_length_squared;
+        double current_distance_squared = -1;
+        for(size_t geo = 0; geo < m_geo_directions.size(); ++geo){
+            const Vector& u = m_geo_directions[geo];
+            double projection = position.x * u.x + position.y * u.y + position.z * u.z;
+            double distance_squared = radius_squared + m_geo_radius_m[geo] * m_geo_radius_m[geo] - 2 * m_geo_radius_m[geo] * projection;
+            if(distance_squared < nearest_distance_squared){
+                nearest_distance_squared = distance_squared;
+                nearest_geo = m_first_GEO_node_id + geo;
+            }
+            if(m_first_GEO_node_id + (int64_t) geo == m_next_GEO_ids[sat]){
+                current_distance_squared = distance_squared;
+            }
+        }
+        if(nearest_geo == -1){
+            throw std::runtime_error(format_string("No suitable ILL for LEO %" PRId64 " at t=%" PRId64 "ns", sat, Simulator::Now().GetTimeStep()));
+        }
+
+        // Hand over if the current GEO is out of range, or if the nearest is sufficiently closer
+        bool current_in_range = m_next_GEO_ids[sat] != -1 && current_distance_squared < max_ill_length_squared;
+        if(current_in_range && std::sqrt(current_distance_squared) <= std::sqrt(nearest_distance_squared) + m_handover_hysteresis_m){
+            continue;
+        }
+        if(nearest_geo != m_next_GEO_ids[sat]){
+            if(m_next_GEO_ids[sat] != -1){
+                m_num_handovers += 1;
+            }
+            m_next_GEO_ids[sat] = nearest_geo;
+            m_changed.push_back(sat);
+        }
+    }
+
+    return m_changed;
+}
+
+int32_t GeoCoverageEngine::GetNextGEOID(int32_t leo_node_id){
+    return m_next_GEO_ids.at(leo_node_id);
+}
+
+uint64_t GeoCoverageEngine::GetNumHandovers(){
+    return m_num_handovers;
+}
+
+}
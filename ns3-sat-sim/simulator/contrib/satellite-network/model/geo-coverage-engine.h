@@ -0,0 +1,54 @@
+/**
+ * Author:  silent-rookie      2024
+*/
+
+#ifndef GEO_COVERAGE_ENGINE_H
+#define GEO_COVERAGE_ENGINE_H
+
+#include <vector>
+#include "ns3/topology-satellite-network.h"
+
+namespace ns3 {
+
+/**
+ * Assigns each LEO satellite to a GEO satellite in ILL range, from the current positions
+ * of the mobility models (replaces the ills_<t>.txt files).
+ *
+ * The GEO satellites are geostationary, so the direction to their sub-satellite point is
+ * calculated once. The distance of a LEO to a GEO then only needs a dot product:
+ *   d^2 = r_leo^2 + r_geo^2 - 2 * r_geo * (p_leo . u_geo)
+ *
+ * A LEO stays with its GEO as long as it is in ILL range, and the nearest GEO is not more
+ * than ill_handover_hysteresis_m closer (0: always the nearest GEO, as satgen_GEO).
+ */
+class GeoCoverageEngine : public Object
+{
+public:
+    static TypeId GetTypeId (void);
+    GeoCoverageEngine(Ptr<BasicSimulation> basicSimulation, Ptr<TopologySatelliteNetwork> topology);
+
+    // Recalculate the assignment for the current simulation time,
+    // returns the LEO satellites whose GEO satellite changed
+    const std::vector<int32_t>& Update();
+
+    int32_t GetNextGEOID(int32_t leo_node_id);
+    uint64_t GetNumHandovers();
+
+private:
+    Ptr<TopologySatelliteNetwork> m_topology;
+    int64_t m_num_satellites;
+    int64_t m_first_GEO_node_id;
+    double m_max_ill_length_m;
+    double m_handover_hysteresis_m;
+
+    std::vector<Vector> m_geo_directions;       // unit vector to the sub-satellite point of each GEO
+    std::vector<double> m_geo_radius_m;         // distance of each GEO to the earth center
+
+    std::vector<int32_t> m_next_GEO_ids;        // per LEO, -1 if not assigned yet
+    std::vector<int32_t> m_changed;
+    uint64_t m_num_handovers;
+};
+
+}
+
+#endif //GEO_COVERAGE_ENGINE_H
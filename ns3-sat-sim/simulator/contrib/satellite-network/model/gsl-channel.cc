@@ -98,29 +98,31 @@ GSLChannel::TransmitTo(Ptr<const Packet> p, Ptr<GSLNetDevice> srcNetDevice, Ptr<
           << " to " << destNetDevice->GetNode()->GetId() << " with delay " << delay
   );
 
-  // Distributed mode is not enabled
-  NS_ABORT_MSG_UNLESS(isSameSystem, "MPI distributed mode is currently not supported by the GSL channel.");
-
-  // Schedule arrival of packet at destination network device
-  Simulator::ScheduleWithContext(
-          receiverNode->GetId(),
-          txTime + delay,
-          &GSLNetDevice::Receive,
-          destNetDevice,
-          p->Copy ()
-  );
+  if (isSameSystem) {
+
+    // Schedule arrival of packet at destination network device
+    Simulator::ScheduleWithContext(
+            receiverNode->GetId(),
+            txTime + delay,
+            &GSLNetDevice::Receive,
+            destNetDevice,
+            p->Copy ()
+    );
+
+  } else {
+
+    // The destination is simulated by another system: hand it over to MPI, it arrives
+    // there at the absolute receive time (which is at least the lookahead in the future,
+    // as the delay is never below the lower-bound "Delay" attribute)
+#ifdef NS3_MPI
+    NS_ABORT_MSG_IF(delay < m_lowerBoundDelay, "GSL delay is below the lower bound used as lookahead");
+    Time rxTime = Simulator::Now () + txTime + delay;
+    MpiInterface::SendPacket (p->Copy (), rxTime, destNetDevice->GetNode()->GetId (), destNetDevice->GetIfIndex());
+#else
+    NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
+#endif
 
-  // Re-enabled below code if distributed is again enabled:
-  //  if (isSameSystem) {
-  //
-  //  } else {
-  //#ifdef NS3_MPI
-  //    Time rxTime = Simulator::Now () + txTime + delay;
-  //    MpiInterface::SendPacket (p->Copy (), rxTime, destNetDevice->GetNode()->GetId (), destNetDevice->GetIfIndex());
-  //#else
-  //    NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
-  //#endif
-  //  }
+  }
 
   return true;
 }
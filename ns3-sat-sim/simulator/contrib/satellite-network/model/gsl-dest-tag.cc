@@ -0,0 +1,61 @@
+/**
+ * Author:  silent-rookie      2024
+*/
+
+#include "gsl-dest-tag.h"
+
+namespace ns3{
+
+NS_OBJECT_ENSURE_REGISTERED (GslDestTag);
+
+TypeId GslDestTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::GslDestTag")
+    .SetParent<Tag> ()
+    .SetGroupName("GSL")
+    .AddConstructor<GslDestTag> ()
+    ;
+  return tid;
+}
+
+
+GslDestTag::GslDestTag()
+{
+
+}
+
+void GslDestTag::SetDest(Mac48Address dest){
+    m_dest = dest;
+}
+
+Mac48Address GslDestTag::GetDest() const{
+    return m_dest;
+}
+
+TypeId GslDestTag::GetInstanceTypeId (void) const{
+    return GetTypeId();
+}
+
+uint32_t GslDestTag::GetSerializedSize (void) const{
+    return 6;
+}
+
+void GslDestTag::Serialize (TagBuffer i) const{
+    uint8_t buffer[6];
+    m_dest.CopyTo(buffer);
+    i.Write(buffer, 6);
+}
+
+void GslDestTag::Deserialize (TagBuffer i){
+    uint8_t buffer[6];
+    i.Read(buffer, 6);
+    m_dest.CopyFrom(buffer);
+}
+
+void GslDestTag::Print (std::ostream &os) const{
+    os << "Dest = " << m_dest;
+}
+
+
+
+}
@@ -0,0 +1,41 @@
+/**
+ * Author:  silent-rookie      2024
+*/
+
+#ifndef GSL_DEST_TAG_H
+#define GSL_DEST_TAG_H
+
+#include "ns3/tag.h"
+#include "ns3/mac48-address.h"
+
+namespace ns3{
+
+/**
+ * Destination MAC address of a packet in the queue of a GSLNetDevice of which the queue
+ * may reorder the packets (TrafficClassQueue). Removed when the device dequeues the packet.
+ */
+class GslDestTag : public Tag
+{
+public:
+    static TypeId GetTypeId (void);
+
+    GslDestTag();
+    void SetDest(Mac48Address dest);
+    Mac48Address GetDest() const;
+
+    virtual TypeId GetInstanceTypeId (void) const;
+    virtual uint32_t GetSerializedSize (void) const;
+    virtual void Serialize (TagBuffer i) const;
+    virtual void Deserialize (TagBuffer i);
+    virtual void Print (std::ostream &os) const;
+
+private:
+    Mac48Address m_dest;
+};
+
+
+}
+
+
+
+#endif
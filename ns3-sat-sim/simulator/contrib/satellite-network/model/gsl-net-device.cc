@@ -38,6 +38,8 @@
 #include "ns3/node-container.h"
 #include "gsl-net-device.h"
 #include "gsl-channel.h"
+#include "gsl-dest-tag.h"
+#include "traffic-class-queue.h"
 
 namespace ns3 {
 
@@ -186,6 +188,7 @@ GSLNetDevice::GSLNetDevice ()
   :
     m_txMachineState (READY),
     m_channel (0),
+    m_queueReorders (false),
     m_linkUp (false),
     m_currentPkt (0)
 {
@@ -225,8 +228,8 @@ GSLNetDevice::DoDispose ()
   m_receiveErrorModel = 0;
   m_currentPkt = 0;
   m_queue = 0;
-  while (!m_queueDests.empty()) {
-      m_queueDests.pop();
+  while (!m_queueDests.empty ()) {
+      m_queueDests.pop ();
   }
   NetDevice::DoDispose ();
 }
@@ -260,8 +263,10 @@ GSLNetDevice::TransmitStart (Ptr<Packet> p, const Address dest)
   m_txMachineState = BUSY;
   m_currentPkt = p;
   m_phyTxBeginTrace (m_currentPkt);
+  NotifyTransmit (p->GetSize ());
+  NotifyQueueBytes (m_queue->GetNBytes ());
 
-  Time txTime = m_bps.CalculateBytesTxTime (p->GetSize ());
+  Time txTime = GetPacketCapacity (m_bps).CalculateBytesTxTime (p->GetSize ());
   Time txCompleteTime = txTime + m_tInterframeGap;
 
   NS_LOG_LOGIC ("Schedule TransmitCompleteEvent in " << txCompleteTime.GetSeconds () << "sec");
@@ -277,6 +282,21 @@ GSLNetDevice::TransmitStart (Ptr<Packet> p, const Address dest)
   return result;
 }
 
+Address
+GSLNetDevice::PopQueueDest (Ptr<Packet> p)
+{
+  if (m_queueReorders)
+    {
+      GslDestTag tag;
+      bool found = p->RemovePacketTag (tag);
+      NS_ASSERT_MSG (found, "GSLNetDevice::PopQueueDest(): packet has no GslDestTag");
+      return tag.GetDest ();
+    }
+  Address dest = m_queueDests.front ();
+  m_queueDests.pop ();
+  return dest;
+}
+
 void
 GSLNetDevice::TransmitComplete (const Address dest)
 {
@@ -302,8 +322,7 @@ GSLNetDevice::TransmitComplete (const Address dest)
       NS_LOG_LOGIC ("No pending packets in device queue after tx complete");
       return;
     }
-    Address next_dest = m_queueDests.front ();
-    m_queueDests.pop ();
+  Address next_dest = PopQueueDest (p);
 
   //
   // Got another packet off of the queue, so start the transmit process again.
@@ -336,6 +355,7 @@ GSLNetDevice::SetQueue (Ptr<Queue<Packet> > q)
 {
   NS_LOG_FUNCTION (this << q);
   m_queue = q;
+  m_queueReorders = DynamicCast<TrafficClassQueue> (q) != 0;
 }
 
 void
@@ -377,7 +397,7 @@ GSLNetDevice::Receive (Ptr<Packet> packet)
       Ptr<Packet> originalPacket = packet->Copy ();
 
       // add receive_bytes for receive_rate
-      receive_bytes += packet->GetSize();
+      NotifyReceive (packet->GetSize ());
 
       //
       // Strip off the point-to-point protocol header and forward this packet
@@ -541,20 +561,30 @@ GSLNetDevice::Send (
 
   m_macTxTrace (packet);
 
+  if (m_queueReorders)
+    {
+      GslDestTag tag;
+      tag.SetDest (Mac48Address::ConvertFrom (dest));
+      packet->AddPacketTag (tag);
+    }
+
   //
   // We should enqueue and dequeue the packet to hit the tracing hooks.
   //
   if (m_queue->Enqueue (packet))
     {
-        m_queueDests.push (dest);
+      NotifyQueueBytes (m_queue->GetNBytes ());
+      if (!m_queueReorders)
+        {
+          m_queueDests.push (dest);
+        }
       //
       // If the channel is ready for transition we send the packet right now
       // 
       if (m_txMachineState == READY)
         {
           packet = m_queue->Dequeue ();
-          Address next_dest = m_queueDests.front ();
-          m_queueDests.pop ();
+          Address next_dest = PopQueueDest (packet);
           m_snifferTrace (packet);
           m_promiscSnifferTrace (packet);
           bool ret = TransmitStart (packet, next_dest);
@@ -269,6 +269,15 @@ private:
    */
   void TransmitComplete (const Address destination);
 
+  /**
+   * Destination MAC address of a packet which has been dequeued: its GslDestTag (removed)
+   * if the queue reorders the packets, else the head of m_queueDests
+   *
+   * \param p the packet which has been dequeued
+   * \return the destination with which the packet was enqueued
+   */
+  Address PopQueueDest (Ptr<Packet> p);
+
   /**
    * \brief Make the link up and running
    *
@@ -315,9 +324,15 @@ private:
    */
   Ptr<Queue<Packet> > m_queue;
 
-    /**
-     * The FIFO queue for the destination MAC addresses
-     */
+  /**
+   * True if the queue may reorder the packets (TrafficClassQueue): the destination MAC
+   * address of a queued packet is then carried in its GslDestTag
+   */
+  bool m_queueReorders;
+
+  /**
+   * The FIFO queue for the destination MAC addresses (if the queue does not reorder)
+   */
   std::queue<Address> m_queueDests;
 
   /**
@@ -0,0 +1,164 @@
+/**
+ * Author:  silent-rookie      2024
+*/
+
+#include "jam-area-membership.h"
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (JamAreaMembership);
+
+TypeId JamAreaMembership::GetTypeId (void){
+    static TypeId tid = TypeId ("ns3::JamAreaMembership")
+            .SetParent<Object> ()
+            .SetGroupName("BasicSim")
+    ;
+    return tid;
+}
+
+JamAreaMembership::JamAreaMembership(Ptr<BasicSimulation> basicSimulation, Ptr<TopologySatelliteNetwork> topology){
+    m_topology = topology;
+    m_num_satellites = topology->GetNumSatellites();
+    double radius_m = parse_positive_int64(basicSimulation->GetConfigParamOrFail("trafic_jam_area_radius_m"));
+    m_radius_squared_m2 = radius_m * radius_m;
+
+    m_positions_time_ns = -1;
+    m_x = std::vector<double>(m_num_satellites, 0);
+    m_y = std::vector<double>(m_num_satellites, 0);
+    m_z = std::vector<double>(m_num_satellites, 0);
+    m_inside = std::vector<uint8_t>(m_num_satellites, 0);
+    m_num_words = 0;
+}
+
+void JamAreaMembership::AddArea(std::shared_ptr<Vector> area){
+    NS_ABORT_MSG_IF(m_area_slots.find(area) != m_area_slots.end(), "Jam area has already been added");
+
+    // First free slot
+    size_t slot = 0;
+    while(slot < m_slot_areas.size() && m_slot_areas[slot] != nullptr){
+        ++slot;
+    }
+    if(slot == m_slot_areas.size()){
+        m_slot_areas.push_back(nullptr);
+        m_area_x.push_back(0);
+        m_area_y.push_back(0);
+        m_area_z.push_back(0);
+        if(m_slot_areas.size() > m_num_words * 64){
+            GrowMasks();
+        }
+    }
+    m_slot_areas[slot] = area;
+    m_area_x[slot] = area->x;
+    m_area_y[slot] = area->y;
+    m_area_z[slot] = area->z;
+    m_area_slots[area] = slot;
+
+    // The other areas are up to date if the positions are
+    if(m_positions_time_ns != Simulator::Now().GetTimeStep()){
+        UpdatePositions();
+    }
+    else{
+        CalculateMembership(slot);
+    }
+}
+
+void JamAreaMembership::RemoveArea(std::shared_ptr<Vector> area){
+    auto it = m_area_slots.find(area);
+    NS_ABORT_MSG_IF(it == m_area_slots.end(), "Jam area was never added");
+    size_t slot = it->second;
+    uint64_t clear = ~(((uint64_t) 1) << (slot % 64));
+    for(size_t sat = 0; sat < m_num_satellites; ++sat){
+        m_masks[sat * m_num_words + slot / 64] &= clear;
+    }
+    m_slot_areas[slot] = nullptr;
+    m_area_slots.erase(it);
+}
+
+bool JamAreaMembership::IsInArea(int32_t leo_node_id, std::shared_ptr<Vector> area){
+    size_t slot = m_area_slots.at(area);
+    if(m_positions_time_ns != Simulator::Now().GetTimeStep()){
+        UpdatePositions();
+    }
+    return (m_masks[leo_node_id * m_num_words + slot / 64] >> (slot % 64)) & 1;
+}
+
+bool JamAreaMembership::IsInAnyArea(int32_t leo_node_id){
+    if(m_area_slots.empty()){
+        return false;
+    }
+    if(m_positions_time_ns != Simulator::Now().GetTimeStep()){
+        UpdatePositions();
+    }
+    const uint64_t* mask = &m_masks[leo_node_id * m_num_words];
+    for(size_t w = 0; w < m_num_words; ++w){
+        if(mask[w] != 0){
+            return true;
+        }
+    }
+    return false;
+}
+
+uint64_t JamAreaMembership::EstimateMemoryBytes(){
+    return estimate_heap_bytes(m_x) + estimate_heap_bytes(m_y) + estimate_heap_bytes(m_z)
+           + estimate_heap_bytes(m_slot_areas) + estimate_heap_bytes(m_area_x) + estimate_heap_bytes(m_area_y)
+           + estimate_heap_bytes(m_area_z) + estimate_heap_bytes(m_area_slots) + estimate_heap_bytes(m_masks)
+           + estimate_heap_bytes(m_inside);
+}
+
+void JamAreaMembership::UpdatePositions(){
+    NodeContainer nodes = m_topology->GetNodes();
+    for(size_t sat = 0; sat < m_num_satellites; ++sat){
+        Vector position = nodes.Get(sat)->GetObject<MobilityModel>()->GetPosition();
+        m_x[sat] = position.x;
+        m_y[sat] = position.y;
+        m_z[sat] = position.z;
+    }
+    m_positions_time_ns = Simulator::Now().GetTimeStep();
+
+    for(size_t slot = 0; slot < m_slot_areas.size(); ++slot){
+        if(m_slot_areas[slot] != nullptr){
+            CalculateMembership(slot);
+        }
+    }
+}
+
+void JamAreaMembership::CalculateMembership(size_t slot){
+    // Squared distance of every LEO to the area (no branches, such that it is vectorized)
+    const double cx = m_area_x[slot];
+    const double cy = m_area_y[slot];
+    const double cz = m_area_z[slot];
+    const double r2 = m_radius_squared_m2;
+    const double* x = m_x.data();
+    const double* y = m_y.data();
+    const double* z = m_z.data();
+    uint8_t* inside = m_inside.data();
+    for(size_t sat = 0; sat < m_num_satellites; ++sat){
+        double dx = x[sat] - cx;
+        double dy = y[sat] - cy;
+        double dz = z[sat] - cz;
+        inside[sat] = (dx * dx + dy * dy + dz * dz) < r2;
+    }
+
+    // Into the bit of the slot
+    size_t word = slot / 64;
+    uint32_t bit = slot % 64;
+    uint64_t clear = ~(((uint64_t) 1) << bit);
+    for(size_t sat = 0; sat < m_num_satellites; ++sat){
+        uint64_t& mask = m_masks[sat * m_num_words + word];
+        mask = (mask & clear) | (((uint64_t) inside[sat]) << bit);
+    }
+}
+
+void JamAreaMembership::GrowMasks(){
+    size_t num_words = m_num_words + 1;
+    std::vector<uint64_t> masks(m_num_satellites * num_words, 0);
+    for(size_t sat = 0; sat < m_num_satellites; ++sat){
+        for(size_t w = 0; w < m_num_words; ++w){
+            masks[sat * num_words + w] = m_masks[sat * m_num_words + w];
+        }
+    }
+    m_masks.swap(masks);
+    m_num_words = num_words;
+}
+
+}
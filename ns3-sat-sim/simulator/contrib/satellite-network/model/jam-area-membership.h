@@ -0,0 +1,70 @@
+/**
+ * Author:  silent-rookie      2024
+*/
+
+#ifndef JAM_AREA_MEMBERSHIP_H
+#define JAM_AREA_MEMBERSHIP_H
+
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include "ns3/topology-satellite-network.h"
+
+namespace ns3 {
+
+/**
+ * Membership of all LEO satellites in all trafic jam areas (trafic_jam_area_detection=polling),
+ * instead of each LEO arbiter fetching its own position and looping over the jam list.
+ *
+ * The positions of all LEO satellites are fetched once per simulation time at which the
+ * membership is read (the detour update), as arrays x[], y[], z[], together with the
+ * centers of the areas. For each area one loop over those arrays compares the squared
+ * distance with the squared radius (a branch-free loop which the compiler vectorizes), and
+ * the result is a bitmask per LEO satellite (one bit per area slot). An area added or removed
+ * during the update only calculates or clears its own bit.
+ */
+class JamAreaMembership : public Object
+{
+public:
+    static TypeId GetTypeId (void);
+    JamAreaMembership(Ptr<BasicSimulation> basicSimulation, Ptr<TopologySatelliteNetwork> topology);
+
+    void AddArea(std::shared_ptr<Vector> area);
+    void RemoveArea(std::shared_ptr<Vector> area);
+
+    bool IsInArea(int32_t leo_node_id, std::shared_ptr<Vector> area);
+    bool IsInAnyArea(int32_t leo_node_id);
+
+    uint64_t EstimateMemoryBytes();
+
+private:
+    void UpdatePositions();
+    void CalculateMembership(size_t slot);
+    void GrowMasks();
+
+    Ptr<TopologySatelliteNetwork> m_topology;
+    size_t m_num_satellites;
+    double m_radius_squared_m2;
+
+    // Positions of the LEO satellites (per LEO), at m_positions_time_ns
+    int64_t m_positions_time_ns;
+    std::vector<double> m_x;
+    std::vector<double> m_y;
+    std::vector<double> m_z;
+
+    // Areas (per slot, a removed area leaves its slot free for the next one)
+    std::vector<std::shared_ptr<Vector>> m_slot_areas;                  // nullptr if free
+    std::vector<double> m_area_x;
+    std::vector<double> m_area_y;
+    std::vector<double> m_area_z;
+    std::unordered_map<std::shared_ptr<Vector>, size_t> m_area_slots;
+
+    // Per LEO m_num_words words, bit (slot % 64) of word (slot / 64) is set if it is in the area
+    size_t m_num_words;
+    std::vector<uint64_t> m_masks;
+    std::vector<uint8_t> m_inside;                                      // per LEO, of the area being calculated
+};
+
+}
+
+#endif //JAM_AREA_MEMBERSHIP_H
@@ -0,0 +1,159 @@
+/**
+ * Author:  silent-rookie      2024
+*/
+
+#include "jam-area-predictor.h"
+#include <cmath>
+#include <algorithm>
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (JamAreaPredictor);
+
+TypeId JamAreaPredictor::GetTypeId (void){
+    static TypeId tid = TypeId ("ns3::JamAreaPredictor")
+            .SetParent<Object> ()
+            .SetGroupName("BasicSim")
+    ;
+    return tid;
+}
+
+JamAreaPredictor::JamAreaPredictor(Ptr<BasicSimulation> basicSimulation, Ptr<TopologySatelliteNetwork> topology){
+    m_topology = topology;
+    m_num_satellites = topology->GetNumSatellites();
+    m_simulation_end_time_ns = basicSimulation->GetSimulationEndTimeNs();
+    m_radius_m = parse_positive_int64(basicSimulation->GetConfigParamOrFail("trafic_jam_area_radius_m"));
+    m_resolution_ns = parse_positive_int64(basicSimulation->GetConfigParamOrDefault("trafic_jam_prediction_resolution_ns", "1000000"));
+    NS_ABORT_MSG_IF(m_resolution_ns == 0, "trafic_jam_prediction_resolution_ns must be positive");
+
+    // The satellites either all move (SGP4), or are all static at the epoch
+    NodeContainer nodes = m_topology->GetNodes();
+    m_max_speed_m_per_s = 0;
+    for(int64_t sat = 0; sat < m_num_satellites; ++sat){
+        Ptr<SatellitePositionMobilityModel> mobility = nodes.Get(sat)->GetObject<SatellitePositionMobilityModel>();
+        if(mobility != 0){
+            m_mobility.push_back(mobility);
+            Vector velocity = mobility->GetVelocity();
+            m_max_speed_m_per_s = std::max(m_max_speed_m_per_s,
+                    std::sqrt(velocity.x * velocity.x + velocity.y * velocity.y + velocity.z * velocity.z));
+        }
+    }
+    m_static = m_mobility.empty();
+    NS_ABORT_MSG_IF(!m_static && m_mobility.size() != (size_t) m_num_satellites, "Either all or none of the LEO satellites must move");
+
+    // The speed is nearly constant on the (near circular) orbits, the margin covers the remainder
+    m_max_speed_m_per_s *= 1.1;
+
+    m_num_areas_inside = std::vector<uint32_t>(m_num_satellites, 0);
+    m_num_crossings = 0;
+
+    std::cout << "  > Jam area prediction resolution: " << m_resolution_ns << "ns" << std::endl;
+}
+
+void JamAreaPredictor::AddArea(std::shared_ptr<Vector> area){
+    NS_ABORT_MSG_IF(m_areas.find(area) != m_areas.end(), "Jam area has already been added");
+    std::vector<AreaMembership>& memberships = m_areas[area];
+    memberships.resize(m_num_satellites);
+    int64_t now_ns = Simulator::Now().GetTimeStep();
+    for(int64_t sat = 0; sat < m_num_satellites; ++sat){
+        memberships[sat].inside = CalculateDistance(GetPosition(sat, now_ns), *area) < m_radius_m;
+        memberships[sat].next_crossing_ns = -1;
+        if(memberships[sat].inside){
+            m_num_areas_inside[sat] += 1;
+        }
+        ScheduleNextCrossing(sat, area);
+    }
+}
+
+void JamAreaPredictor::RemoveArea(std::shared_ptr<Vector> area){
+    auto it = m_areas.find(area);
+    NS_ABORT_MSG_IF(it == m_areas.end(), "Jam area was never added");
+    for(int64_t sat = 0; sat < m_num_satellites; ++sat){
+        it->second[sat].event.Cancel();
+        if(it->second[sat].inside){
+            m_num_areas_inside[sat] -= 1;
+        }
+    }
+    m_areas.erase(it);
+}
+
+bool JamAreaPredictor::IsInArea(int32_t leo_node_id, std::shared_ptr<Vector> area){
+    return m_areas.at(area).at(leo_node_id).inside;
+}
+
+bool JamAreaPredictor::IsInAnyArea(int32_t leo_node_id){
+    return m_num_areas_inside.at(leo_node_id) > 0;
+}
+
+Time JamAreaPredictor::GetTimeUntilEnter(int32_t leo_node_id){
+    if(IsInAnyArea(leo_node_id)){
+        return Seconds(0);
+    }
+    int64_t first_enter_ns = -1;
+    for(const auto& area : m_areas){
+        int64_t t = area.second[leo_node_id].next_crossing_ns;
+        if(t != -1 && (first_enter_ns == -1 || t < first_enter_ns)){
+            first_enter_ns = t;
+        }
+    }
+    if(first_enter_ns == -1){
+        return Time::Max();
+    }
+    return NanoSeconds(first_enter_ns) - Simulator::Now();
+}
+
+uint64_t JamAreaPredictor::GetNumCrossings(){
+    return m_num_crossings;
+}
+
+Vector JamAreaPredictor::GetPosition(int32_t leo_node_id, int64_t t_ns){
+    if(m_static){
+        return m_topology->GetNodes().Get(leo_node_id)->GetObject<MobilityModel>()->GetPosition();
+    }
+
+    // Same as SatellitePositionHelper::GetPosition(), but at any time
+    const Ptr<SatellitePositionMobilityModel>& mobility = m_mobility[leo_node_id];
+    return mobility->GetSatellite()->GetPosition(mobility->GetStartTime() + NanoSeconds(t_ns));
+}
+
+int64_t JamAreaPredictor::FindNextCrossing(int32_t leo_node_id, const Vector& area, bool inside, int64_t from_ns){
+    int64_t t_ns = from_ns;
+    while(t_ns < m_simulation_end_time_ns){
+        double distance_m = CalculateDistance(GetPosition(leo_node_id, t_ns), area);
+        if((distance_m < m_radius_m) != inside){
+            return t_ns;
+        }
+
+        // It cannot reach the boundary before this step
+        double step_s = std::abs(distance_m - m_radius_m) / m_max_speed_m_per_s;
+        t_ns += std::max(m_resolution_ns, (int64_t) (step_s * 1e9));
+    }
+    return -1;
+}
+
+void JamAreaPredictor::ScheduleNextCrossing(int32_t leo_node_id, std::shared_ptr<Vector> area){
+    AreaMembership& membership = m_areas.at(area)[leo_node_id];
+    if(m_static){
+        return;
+    }
+    int64_t now_ns = Simulator::Now().GetTimeStep();
+    membership.next_crossing_ns = FindNextCrossing(leo_node_id, *area, membership.inside, now_ns + m_resolution_ns);
+    if(membership.next_crossing_ns != -1){
+        membership.event = Simulator::Schedule(NanoSeconds(membership.next_crossing_ns - now_ns), &JamAreaPredictor::Cross, this, leo_node_id, area);
+    }
+}
+
+void JamAreaPredictor::Cross(int32_t leo_node_id, std::shared_ptr<Vector> area){
+    AreaMembership& membership = m_areas.at(area)[leo_node_id];
+    membership.inside = !membership.inside;
+    if(membership.inside){
+        m_num_areas_inside[leo_node_id] += 1;
+    }
+    else{
+        m_num_areas_inside[leo_node_id] -= 1;
+    }
+    m_num_crossings += 1;
+    ScheduleNextCrossing(leo_node_id, area);
+}
+
+}
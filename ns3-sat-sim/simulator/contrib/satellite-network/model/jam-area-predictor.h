@@ -0,0 +1,74 @@
+/**
+ * Author:  silent-rookie      2024
+*/
+
+#ifndef JAM_AREA_PREDICTOR_H
+#define JAM_AREA_PREDICTOR_H
+
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include "ns3/topology-satellite-network.h"
+#include "ns3/satellite-position-mobility-model.h"
+
+namespace ns3 {
+
+/**
+ * Predicts when each LEO satellite enters and leaves the trafic jam areas, from the
+ * orbits (the same SGP4 prediction as the mobility models), instead of checking the
+ * distance to every area at each detour update.
+ *
+ * When an area is added, for each LEO satellite only the next crossing of the area
+ * boundary is calculated and scheduled as one event, which then calculates the next one.
+ * The crossing is found by conservative advancement: a satellite at distance d from the
+ * area cannot cross its boundary within |d - radius| / v_max, so it is only sampled at
+ * those steps (at least trafic_jam_prediction_resolution_ns). The event is at most
+ * that resolution after the exact crossing.
+ */
+class JamAreaPredictor : public Object
+{
+public:
+    static TypeId GetTypeId (void);
+    JamAreaPredictor(Ptr<BasicSimulation> basicSimulation, Ptr<TopologySatelliteNetwork> topology);
+
+    void AddArea(std::shared_ptr<Vector> area);
+    void RemoveArea(std::shared_ptr<Vector> area);
+
+    bool IsInArea(int32_t leo_node_id, std::shared_ptr<Vector> area);
+    bool IsInAnyArea(int32_t leo_node_id);
+
+    // Time until the LEO enters a jam area: zero if it is in one,
+    // Time::Max() if it does not enter one before the end of the simulation
+    Time GetTimeUntilEnter(int32_t leo_node_id);
+
+    uint64_t GetNumCrossings();
+
+private:
+    struct AreaMembership {
+        bool inside;
+        int64_t next_crossing_ns;       // -1 if there is none before the end of the simulation
+        EventId event;
+    };
+
+    Vector GetPosition(int32_t leo_node_id, int64_t t_ns);
+    int64_t FindNextCrossing(int32_t leo_node_id, const Vector& area, bool inside, int64_t from_ns);
+    void ScheduleNextCrossing(int32_t leo_node_id, std::shared_ptr<Vector> area);
+    void Cross(int32_t leo_node_id, std::shared_ptr<Vector> area);
+
+    Ptr<TopologySatelliteNetwork> m_topology;
+    int64_t m_num_satellites;
+    int64_t m_simulation_end_time_ns;
+    double m_radius_m;
+    int64_t m_resolution_ns;
+    double m_max_speed_m_per_s;
+    bool m_static;
+    std::vector<Ptr<SatellitePositionMobilityModel>> m_mobility;       // per LEO, empty if static
+
+    std::unordered_map<std::shared_ptr<Vector>, std::vector<AreaMembership>> m_areas;  // per area, per LEO
+    std::vector<uint32_t> m_num_areas_inside;                                           // per LEO
+    uint64_t m_num_crossings;
+};
+
+}
+
+#endif //JAM_AREA_PREDICTOR_H
@@ -0,0 +1,138 @@
+/**
+ * Author:  silent-rookie      2024
+*/
+
+#include "next-hop-candidates.h"
+#include <cerrno>
+#include <cstdlib>
+
+namespace ns3 {
+
+size_t ParseNumNextHopCandidates(Ptr<BasicSimulation> basicSimulation){
+    int64_t num_candidates = parse_positive_int64(basicSimulation->GetConfigParamOrDefault("num_next_hop_candidates", "3"));
+    if(num_candidates < 1 || num_candidates > (int64_t) MAX_NEXT_HOP_CANDIDATES){
+        throw std::invalid_argument("num_next_hop_candidates must be in [1, " + std::to_string(MAX_NEXT_HOP_CANDIDATES) + "]: " + std::to_string(num_candidates));
+    }
+    return (size_t) num_candidates;
+}
+
+std::set<TrafficClass> ParseWeightedCandidateClasses(Ptr<BasicSimulation> basicSimulation){
+    std::set<TrafficClass> classes;
+    for(const std::string& name : parse_set_string(basicSimulation->GetConfigParamOrDefault("weighted_candidate_classes", "set()"))){
+        bool found = false;
+        for(TrafficClass pclass : TrafficClassVec){
+            if(TrafficClass2String(pclass) == name){
+                classes.insert(pclass);
+                found = true;
+            }
+        }
+        if(!found){
+            throw std::invalid_argument("weighted_candidate_classes must be Default, A, B or C: " + name);
+        }
+    }
+    return classes;
+}
+
+int32_t PickWeightedCandidate(const double* weights, size_t num_candidates, uint32_t hash){
+    double total = 0;
+    for(size_t i = 0; i < num_candidates; ++i){
+        total += weights[i];
+    }
+    if(total <= 0){
+        return -1;
+    }
+    double point = (hash / 4294967296.0) * total;
+    double cumulative = 0;
+    int32_t last = -1;
+    for(size_t i = 0; i < num_candidates; ++i){
+        if(weights[i] > 0){
+            cumulative += weights[i];
+            last = i;
+            if(point < cumulative){
+                return i;
+            }
+        }
+    }
+    return last;        // rounding
+}
+
+NextHop FstateNextHop(int64_t next_hop_node_id, int64_t my_if_id, int64_t next_if_id){
+    if(next_hop_node_id == -1 && my_if_id == -1 && next_if_id == -1){
+        return DROP_NEXT_HOP;
+    }
+
+    // Add 1 for skip the loop-back interface
+    return NextHop(next_hop_node_id, my_if_id + 1, next_if_id + 1);
+}
+
+NextHopCandidates::NextHopCandidates() : m_num_targets(0), m_num_candidates(0) {
+
+}
+
+NextHopCandidates::NextHopCandidates(size_t num_targets, size_t num_candidates, NextHop fill)
+        : m_num_targets(num_targets), m_num_candidates(num_candidates), m_hops(num_targets * num_candidates, fill) {
+
+}
+
+size_t NextHopCandidates::GetNumCandidates() const {
+    return m_num_candidates;
+}
+
+size_t NextHopCandidates::GetNumTargets() const {
+    return m_num_targets;
+}
+
+std::vector<NextHop> NextHopCandidates::Get(size_t target) const {
+    const NextHop* first = (*this)[target];
+    return std::vector<NextHop>(first, first + m_num_candidates);
+}
+
+void NextHopCandidates::Set(size_t target, const std::vector<NextHop>& next_hop_list){
+    NS_ABORT_MSG_IF(next_hop_list.size() != m_num_candidates,
+                    "Expected " + std::to_string(m_num_candidates) + " candidates, got " + std::to_string(next_hop_list.size()));
+    std::copy(next_hop_list.begin(), next_hop_list.end(), m_hops.begin() + target * m_num_candidates);
+}
+
+uint64_t NextHopCandidates::EstimateHeapBytes() const {
+    return estimate_heap_bytes(m_hops);
+}
+
+// Parses the integer which starts at pos, which must be followed by the separator (or the end of the line)
+static int64_t ParseFstateField(const std::string& line, size_t& pos, bool last){
+    const char* start = line.c_str() + pos;
+    char* end = nullptr;
+    errno = 0;
+    long long value = std::strtoll(start, &end, 10);
+    if(end == start || errno != 0 || (last ? *end != '\0' : *end != ',')){
+        throw std::invalid_argument("Invalid fstate line: " + line);
+    }
+    pos = (end - line.c_str()) + 1;
+    return (int64_t) value;
+}
+
+template <size_t K>
+void ParseFstateLine(
+        const std::string& line,
+        int64_t& current_node_id,
+        int64_t& target_node_id,
+        std::array<std::array<int64_t, 3>, K>& next_hops
+){
+    size_t pos = 0;
+    current_node_id = ParseFstateField(line, pos, false);
+    target_node_id = ParseFstateField(line, pos, false);
+    if(current_node_id < 0 || target_node_id < 0){
+        throw std::invalid_argument("Invalid fstate line: " + line);
+    }
+    for(size_t i = 0; i < K; ++i){
+        for(size_t j = 0; j < 3; ++j){
+            next_hops[i][j] = ParseFstateField(line, pos, i == K - 1 && j == 2);
+        }
+    }
+}
+
+template void ParseFstateLine<1>(const std::string&, int64_t&, int64_t&, std::array<std::array<int64_t, 3>, 1>&);
+template void ParseFstateLine<2>(const std::string&, int64_t&, int64_t&, std::array<std::array<int64_t, 3>, 2>&);
+template void ParseFstateLine<3>(const std::string&, int64_t&, int64_t&, std::array<std::array<int64_t, 3>, 3>&);
+template void ParseFstateLine<4>(const std::string&, int64_t&, int64_t&, std::array<std::array<int64_t, 3>, 4>&);
+
+}
@@ -0,0 +1,86 @@
+/**
+ * Author:  silent-rookie      2024
+*/
+
+#ifndef NEXT_HOP_CANDIDATES_H
+#define NEXT_HOP_CANDIDATES_H
+
+#include <array>
+#include <set>
+#include <tuple>
+#include <vector>
+#include <string>
+#include "ns3/basic-simulation.h"
+#include "ns3/traffic-classify-tos.h"
+
+namespace ns3 {
+
+// (next node id, my interface, next interface), the interfaces include the loop-back interface
+typedef std::tuple<int32_t, int32_t, int32_t> NextHop;
+
+static const size_t MAX_NEXT_HOP_CANDIDATES = 4;
+
+// No next hop (a drop), as read from an fstate file and as calculated by the routing engine
+static const NextHop DROP_NEXT_HOP = NextHop(-1, -1, -1);
+
+// Next hop of an fstate entry <next hop node id>,<my interface>,<next interface> (interfaces
+// without the loop-back interface), DROP_NEXT_HOP if all three are -1
+NextHop FstateNextHop(int64_t next_hop_node_id, int64_t my_if_id, int64_t next_if_id);
+
+// Number of candidate next hops K of each forwarding state entry (num_next_hop_candidates, default 3)
+size_t ParseNumNextHopCandidates(Ptr<BasicSimulation> basicSimulation);
+
+// Traffic classes (Default, A, B, C) of which the candidate is chosen per flow in proportion to
+// the residual capacity of the candidates (weighted_candidate_classes, default set(), which
+// chooses the first candidate which does not detour)
+std::set<TrafficClass> ParseWeightedCandidateClasses(Ptr<BasicSimulation> basicSimulation);
+
+// Candidate on which the hash of a flow falls if [0, 2^32) is split over the candidates in
+// proportion to their weights, or -1 if every weight is 0
+int32_t PickWeightedCandidate(const double* weights, size_t num_candidates, uint32_t hash);
+
+/**
+ * Forwarding state of a LEO or GS arbiter: the K candidate next hops of each target,
+ * stored as one contiguous block (each target has its K consecutive hops, as a
+ * std::array<NextHop, K>). K is fixed at install, such that the arbiters walk
+ * the candidates of a target without any size check.
+ */
+class NextHopCandidates
+{
+public:
+    NextHopCandidates();
+    NextHopCandidates(size_t num_targets, size_t num_candidates, NextHop fill);
+
+    // The K candidates of the target
+    const NextHop* operator[](size_t target) const {
+        return &m_hops[target * m_num_candidates];
+    }
+
+    size_t GetNumCandidates() const;
+    size_t GetNumTargets() const;
+    std::vector<NextHop> Get(size_t target) const;
+    void Set(size_t target, const std::vector<NextHop>& next_hop_list);
+    uint64_t EstimateHeapBytes() const;
+
+private:
+    size_t m_num_targets;
+    size_t m_num_candidates;
+    std::vector<NextHop> m_hops;
+};
+
+/**
+ * Parses a line of an fstate file: <current node id>,<target node id>, followed by K times
+ * <next hop node id>,<my interface>,<next interface> (interfaces without the loop-back
+ * interface, all three -1 for a drop). Explicitly instantiated for K = 1 .. 4.
+ */
+template <size_t K>
+void ParseFstateLine(
+        const std::string& line,
+        int64_t& current_node_id,
+        int64_t& target_node_id,
+        std::array<std::array<int64_t, 3>, K>& next_hops
+);
+
+}
+
+#endif //NEXT_HOP_CANDIDATES_H
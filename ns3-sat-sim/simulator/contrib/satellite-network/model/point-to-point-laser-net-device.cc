@@ -257,9 +257,11 @@ PointToPointLaserNetDevice::TransmitStart (Ptr<Packet> p)
   m_txMachineState = BUSY;
   m_currentPkt = p;
   m_phyTxBeginTrace (m_currentPkt);
+  NotifyTransmit (p->GetSize ());
+  NotifyQueueBytes (m_queue->GetNBytes ());
   TrackUtilization(true);
 
-  Time txTime = m_bps.CalculateBytesTxTime (p->GetSize ());
+  Time txTime = GetPacketCapacity (m_bps).CalculateBytesTxTime (p->GetSize ());
   Time txCompleteTime = txTime + m_tInterframeGap;
 
   NS_LOG_LOGIC ("Schedule TransmitCompleteEvent in " << txCompleteTime.GetSeconds () << "sec");
@@ -372,7 +374,7 @@ PointToPointLaserNetDevice::Receive (Ptr<Packet> packet)
       Ptr<Packet> originalPacket = packet->Copy ();
 
       // add receive_bytes for receive_rate
-      receive_bytes += packet->GetSize();
+      NotifyReceive (packet->GetSize ());
 
       //
       // Strip off the point-to-point protocol header and forward this packet
@@ -564,6 +566,7 @@ PointToPointLaserNetDevice::Send (
   //
   if (m_queue->Enqueue (packet))
     {
+      NotifyQueueBytes (m_queue->GetNBytes ());
       //
       // If the channel is ready for transition we send the packet right now
       // 
@@ -762,5 +765,10 @@ PointToPointLaserNetDevice::FinalizeUtilization() {
     return m_utilization;
 }
 
+uint64_t
+PointToPointLaserNetDevice::EstimateUtilizationMemoryBytes() {
+    return m_utilization.capacity() * sizeof(double);
+}
+
 
 } // namespace ns3
@@ -489,6 +489,7 @@ private:
 public:
     void EnableUtilizationTracking(int64_t interval_ns);
     const std::vector<double>& FinalizeUtilization();
+    uint64_t EstimateUtilizationMemoryBytes();
 
 };
 
@@ -4,6 +4,8 @@
 
 #include "ns3/basic-simulation.h"
 #include "receive-datarate-device.h"
+#include <cmath>
+#include <algorithm>
 
 
 
@@ -12,12 +14,39 @@ namespace ns3{
 NS_LOG_COMPONENT_DEFINE ("ReceiveDataRateDevice");
 
 int64_t ReceiveDataRateDevice::m_receive_datarate_update_interval_ns = 0;
+bool ReceiveDataRateDevice::m_lazy_estimator = false;
+int64_t ReceiveDataRateDevice::m_ewma_time_constant_ns = 0;
+constexpr double ReceiveDataRateDevice::MIN_PACKET_CAPACITY_SHARE;
 
-ReceiveDataRateDevice::ReceiveDataRateDevice(): receive_bytes(0) {
+ReceiveDataRateDevice::ReceiveDataRateDevice(): receive_bytes(0), m_last_update_ns(0), m_receive_ewma_bps(0),
+                                                m_transmit_ewma_bps(0), m_queue_bytes(0), m_queue_ewma_bytes(0),
+                                                m_background_receive_bps(0), m_background_transmit_bps(0) {
 
 }
 
+void ReceiveDataRateDevice::Initialize(Ptr<BasicSimulation> basicSimulation){
+    int64_t receive_datarate_update_interval_ns = parse_positive_int64(basicSimulation->GetConfigParamOrFail("receive_datarate_update_interval_ns"));
+    SetReceiveDatarateUpdateIntervalNS(receive_datarate_update_interval_ns);
+
+    std::string estimator = basicSimulation->GetConfigParamOrDefault("receive_datarate_estimator", "interval");
+    if(estimator == "interval"){
+        m_lazy_estimator = false;
+    }
+    else if(estimator == "ewma"){
+        m_lazy_estimator = true;
+    }
+    else{
+        throw std::invalid_argument("Invalid receive_datarate_estimator: " + estimator);
+    }
+    SetEwmaTimeConstantNS(parse_positive_int64(basicSimulation->GetConfigParamOrDefault(
+            "receive_datarate_ewma_time_constant_ns", std::to_string(receive_datarate_update_interval_ns))));
+}
+
 void ReceiveDataRateDevice::UpdateReceiveDataRate(){
+    if(m_lazy_estimator){
+        return;
+    }
+
     // calculte bps
     NS_ABORT_MSG_IF(m_receive_datarate_update_interval_ns == 0, "receive_datarate_update_interval_ns == 0");
     double seconds = (double)m_receive_datarate_update_interval_ns / 1000 / 1000 / 1000;
@@ -42,6 +71,18 @@ void ReceiveDataRateDevice::UpdateReceiveDataRate(){
 
 void ReceiveDataRateDevice::SetReceiveDatarateUpdateIntervalNS(int64_t receive_datarate_update_interval_ns) {
     m_receive_datarate_update_interval_ns = receive_datarate_update_interval_ns;
+    if(m_ewma_time_constant_ns == 0){
+        m_ewma_time_constant_ns = receive_datarate_update_interval_ns;
+    }
+}
+
+void ReceiveDataRateDevice::SetEwmaTimeConstantNS(int64_t ewma_time_constant_ns) {
+    NS_ABORT_MSG_IF(ewma_time_constant_ns <= 0, "EWMA time constant must be positive");
+    m_ewma_time_constant_ns = ewma_time_constant_ns;
+}
+
+bool ReceiveDataRateDevice::IsLazyEstimator() {
+    return m_lazy_estimator;
 }
 
 // void ReceiveDataRateDevice::SetSimulateEndTimeNS(int64_t simulate_end_time_ns) {
@@ -49,7 +90,75 @@ void ReceiveDataRateDevice::SetReceiveDatarateUpdateIntervalNS(int64_t receive_d
 // }
 
 DataRate ReceiveDataRateDevice::GetReceiveDataRate() { 
+    if(m_lazy_estimator){
+        DecayTo(Simulator::Now().GetTimeStep());
+        return DataRate((uint64_t) (m_receive_ewma_bps + m_background_receive_bps));
+    }
+    if(m_background_receive_bps > 0){
+        return DataRate(receive_rate.GetBitRate() + (uint64_t) m_background_receive_bps);
+    }
     return receive_rate; 
 }
 
+DataRate ReceiveDataRateDevice::GetTransmitDataRate() {
+    DecayTo(Simulator::Now().GetTimeStep());
+    return DataRate((uint64_t) m_transmit_ewma_bps);
+}
+
+double ReceiveDataRateDevice::GetQueueOccupancyBytes() {
+    DecayTo(Simulator::Now().GetTimeStep());
+    return m_queue_ewma_bytes;
+}
+
+void ReceiveDataRateDevice::NotifyReceive(uint32_t bytes) {
+    if(m_lazy_estimator){
+        DecayTo(Simulator::Now().GetTimeStep());
+        m_receive_ewma_bps += bytes * 8.0 * 1e9 / m_ewma_time_constant_ns;
+    }
+    else{
+        receive_bytes += bytes;
+    }
+}
+
+void ReceiveDataRateDevice::NotifyTransmit(uint32_t bytes) {
+    DecayTo(Simulator::Now().GetTimeStep());
+    m_transmit_ewma_bps += bytes * 8.0 * 1e9 / m_ewma_time_constant_ns;
+}
+
+void ReceiveDataRateDevice::NotifyQueueBytes(uint32_t bytes) {
+    DecayTo(Simulator::Now().GetTimeStep());
+    m_queue_bytes = bytes;
+}
+
+void ReceiveDataRateDevice::SetBackgroundDataRates(double receive_bps, double transmit_bps) {
+    m_background_receive_bps = receive_bps;
+    m_background_transmit_bps = transmit_bps;
+}
+
+double ReceiveDataRateDevice::GetBackgroundTransmitBps() {
+    return m_background_transmit_bps;
+}
+
+DataRate ReceiveDataRateDevice::GetPacketCapacity(const DataRate& bps) {
+    if(m_background_transmit_bps <= 0){
+        return bps;
+    }
+    double share = std::max(1.0 - m_background_transmit_bps / bps.GetBitRate(), MIN_PACKET_CAPACITY_SHARE);
+    return DataRate((uint64_t) (bps.GetBitRate() * share));
+}
+
+void ReceiveDataRateDevice::DecayTo(int64_t now_ns) {
+    // Each byte adds 8 / tau to the rate, and decays with exp(-t / tau), as such a constant
+    // rate r converges to r. The queue occupancy is constant since the last update.
+    if(now_ns <= m_last_update_ns){
+        return;
+    }
+    NS_ABORT_MSG_IF(m_ewma_time_constant_ns == 0, "receive_datarate_ewma_time_constant_ns == 0");
+    double decay = std::exp(-(double) (now_ns - m_last_update_ns) / m_ewma_time_constant_ns);
+    m_receive_ewma_bps *= decay;
+    m_transmit_ewma_bps *= decay;
+    m_queue_ewma_bytes = m_queue_ewma_bytes * decay + m_queue_bytes * (1 - decay);
+    m_last_update_ns = now_ns;
+}
+
 }
\ No newline at end of file
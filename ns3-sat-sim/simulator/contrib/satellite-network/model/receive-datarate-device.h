@@ -6,10 +6,28 @@
 #define RECEIVE_DATARATE_DEVICE_H
 
 #include "ns3/data-rate.h"
+#include "ns3/basic-simulation.h"
 
 
 namespace ns3{
 
+/**
+ * Load estimation of a net device. Two estimators for the receive data rate
+ * (receive_datarate_estimator):
+ *
+ *  - interval (default): the bytes received since the last UpdateReceiveDataRate(),
+ *    which must be called every receive_datarate_update_interval_ns.
+ *
+ *  - ewma: an exponentially weighted moving average with time constant
+ *    receive_datarate_ewma_time_constant_ns (default: receive_datarate_update_interval_ns),
+ *    only calculated when it is read (from the bytes and the time of the last update),
+ *    as such it needs no periodic events.
+ *
+ * The transmit data rate and the queue occupancy (time average) always use the ewma.
+ *
+ * In the hybrid mode the fluid background of the device (SetBackgroundDataRates) is added
+ * to the receive data rate, and takes its part of the transmit capacity for the packets.
+ */
 class ReceiveDataRateDevice{
 public:
     ReceiveDataRateDevice();
@@ -17,22 +35,54 @@ public:
     /**
      * \brief update reveive datarate
      * we update each device receive datarate in each m_receive_datarate_update_interval_ns
-     * it is update in ArbiterLEOGS::UpdateDetour
+     * it is update in ArbiterLEOGS::UpdateDetour (nothing to do for the ewma estimator)
     */
     void UpdateReceiveDataRate();
     // void UpdateReceiveDateRate(int64_t current_time);
 
+    static void Initialize(Ptr<BasicSimulation> basicSimulation);
     static void SetReceiveDatarateUpdateIntervalNS(int64_t receive_datarate_update_interval_ns);
+    static void SetEwmaTimeConstantNS(int64_t ewma_time_constant_ns);
+    static bool IsLazyEstimator();
     // void SetSimulateEndTimeNS(int64_t simulate_end_time_ns);
 
     DataRate GetReceiveDataRate();
+    DataRate GetTransmitDataRate();
+    double GetQueueOccupancyBytes();
+
+    // Fluid background (bit/s) received and transmitted by the device
+    void SetBackgroundDataRates(double receive_bps, double transmit_bps);
+    double GetBackgroundTransmitBps();
 protected:
+    // Called by the net devices
+    void NotifyReceive(uint32_t bytes);
+    void NotifyTransmit(uint32_t bytes);
+    void NotifyQueueBytes(uint32_t bytes);
+
+    // Transmit capacity which the fluid background leaves for the packets,
+    // at least MIN_PACKET_CAPACITY_SHARE of the data rate
+    DataRate GetPacketCapacity(const DataRate& bps);
+    static constexpr double MIN_PACKET_CAPACITY_SHARE = 0.01;
+
     uint32_t receive_bytes;
     DataRate receive_rate;
     static int64_t m_receive_datarate_update_interval_ns;
     // int64_t m_simulate_end_time_ns;
+
+private:
+    void DecayTo(int64_t now_ns);
+
+    static bool m_lazy_estimator;
+    static int64_t m_ewma_time_constant_ns;
+    int64_t m_last_update_ns;
+    double m_receive_ewma_bps;
+    double m_transmit_ewma_bps;
+    uint32_t m_queue_bytes;
+    double m_queue_ewma_bytes;
+    double m_background_receive_bps;
+    double m_background_transmit_bps;
 };
 
 }
 
-#endif
\ No newline at end of file
+#endif
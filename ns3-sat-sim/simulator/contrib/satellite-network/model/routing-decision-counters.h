@@ -0,0 +1,71 @@
+/**
+ * Author:  silent-rookie      2024
+*/
+
+#ifndef ROUTING_DECISION_COUNTERS_H
+#define ROUTING_DECISION_COUNTERS_H
+
+#include <cstdint>
+#include <cstddef>
+#include "ns3/next-hop-candidates.h"
+
+namespace ns3 {
+
+/**
+ * Counters of the routing decisions of an arbiter, one increment per forwarded packet
+ * (decisions taken from the decision cache included). They are plain increments which
+ * are always counted; ArbiterLEOGSGEOHelper writes them if enable_routing_decision_counters=true.
+ */
+struct RoutingDecisionCounters
+{
+    static const size_t NUM_CANDIDATES = MAX_NEXT_HOP_CANDIDATES;    // one counter per index of any K
+
+    uint64_t decisions = 0;                             // forwarded packets
+    uint64_t recomputed = 0;                            // decisions not taken from the decision cache
+    uint64_t candidate[NUM_CANDIDATES] = {};            // chosen candidate index
+    uint64_t to_geo = 0;                                // LEO: forwarded to its GEO (not traffic classified or class_default)
+    uint64_t to_geo_class_c = 0;                        // LEO: class_C forwarded to its GEO
+    uint64_t class_a = 0;                               // LEO: class_A decisions (never detour)
+    uint64_t class_b = 0;                               // LEO: class_B decisions
+    uint64_t class_b_loop_avoided = 0;                  // LEO: class_B, a candidate skipped because the packet came from it
+    uint64_t class_b_fallback = 0;                      // LEO: class_B, every other candidate detours
+    uint64_t gs_all_detour = 0;                         // GS: every candidate detours, forwarded to the nearest LEO
+    uint64_t geo_out_of_ill = 0;                        // GEO: the LEO to leave the jam area at is out of ill
+    uint64_t geo_all_in_jam = 0;                        // GEO: every LEO on the path is in a jam area
+    uint64_t icmp_ttl_exceeded = 0;                     // ICMP time exceeded packets (no tag to route them with)
+    uint64_t flowlet_kept = 0;                          // GS, LEO class_B: candidate of the ongoing flowlet of the flow
+    uint64_t weighted = 0;                              // GS, LEO: candidate chosen in proportion to the residual capacities
+    uint64_t geo_spilled_bytes = 0;                     // LEO: bytes for its GEO (not traffic classified or class_default)
+                                                        //      spilled to the first candidate as the ILL of the GEO is congested
+    uint64_t geo_spilled_bytes_class_c = 0;             // LEO: class_C bytes spilled to the first candidate
+
+    void CountCandidate(size_t index) {
+        candidate[index] += 1;
+    }
+
+    void Add(const RoutingDecisionCounters& other) {
+        decisions += other.decisions;
+        recomputed += other.recomputed;
+        for (size_t i = 0; i < NUM_CANDIDATES; i++) {
+            candidate[i] += other.candidate[i];
+        }
+        to_geo += other.to_geo;
+        to_geo_class_c += other.to_geo_class_c;
+        class_a += other.class_a;
+        class_b += other.class_b;
+        class_b_loop_avoided += other.class_b_loop_avoided;
+        class_b_fallback += other.class_b_fallback;
+        gs_all_detour += other.gs_all_detour;
+        geo_out_of_ill += other.geo_out_of_ill;
+        geo_all_in_jam += other.geo_all_in_jam;
+        icmp_ttl_exceeded += other.icmp_ttl_exceeded;
+        flowlet_kept += other.flowlet_kept;
+        weighted += other.weighted;
+        geo_spilled_bytes += other.geo_spilled_bytes;
+        geo_spilled_bytes_class_c += other.geo_spilled_bytes_class_c;
+    }
+};
+
+}
+
+#endif //ROUTING_DECISION_COUNTERS_H
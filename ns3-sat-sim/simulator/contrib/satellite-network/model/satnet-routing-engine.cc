@@ -0,0 +1,238 @@
+/**
+ * Author:  silent-rookie      2024
+*/
+
+#include "satnet-routing-engine.h"
+#include <queue>
+#include <limits>
+#include <algorithm>
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (SatnetRoutingEngine);
+
+TypeId SatnetRoutingEngine::GetTypeId (void){
+    static TypeId tid = TypeId ("ns3::SatnetRoutingEngine")
+            .SetParent<Object> ()
+            .SetGroupName("BasicSim")
+    ;
+    return tid;
+}
+
+SatnetRoutingEngine::SatnetRoutingEngine(Ptr<BasicSimulation> basicSimulation, Ptr<TopologySatelliteNetwork> topology){
+    m_basicSimulation = basicSimulation;
+    m_topology = topology;
+    m_num_satellites = topology->GetNumSatellites();
+    m_num_groundstations = topology->GetNumGroundStations();
+
+    // Number of threads for the shortest path calculation (0 = one per hardware thread)
+    m_num_threads = parse_positive_int64(m_basicSimulation->GetConfigParamOrDefault("routing_engine_num_threads", "0"));
+    if(m_num_threads == 0){
+        m_num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // Number of candidate next hops of each (node, ground station) pair
+    m_num_candidates = ParseNumNextHopCandidates(m_basicSimulation);
+
+    ReadInterfaces();
+
+    // Result
+    m_sat_to_gs_distance_m = std::vector<std::vector<double>>(m_num_satellites, std::vector<double>(m_num_groundstations));
+    m_forward_state = std::vector<std::vector<std::vector<std::tuple<int32_t, int32_t, int32_t>>>>(
+            m_num_satellites + m_num_groundstations,
+            std::vector<std::vector<std::tuple<int32_t, int32_t, int32_t>>>(m_num_groundstations)
+    );
+
+    std::cout << "  > Routing engine threads: " << m_num_threads << std::endl;
+}
+
+void SatnetRoutingEngine::ReadInterfaces(){
+    // interface for device in satellite:
+    // 0: loop-back interface
+    // 1 ~ 4: isl interface
+    // 5: gsl interface
+    // 6: ill interface
+    NodeContainer nodes = m_topology->GetNodes();
+    m_isl_neighbors.resize(m_num_satellites);
+    m_gsl_interface.resize(m_num_satellites);
+    for(int64_t sat = 0; sat < m_num_satellites; ++sat){
+        Ptr<Ipv4> ipv4 = nodes.Get(sat)->GetObject<Ipv4>();
+        for(uint32_t i = 1; i < ipv4->GetNInterfaces(); ++i){
+            const IslNeighbor& neighbor = m_topology->GetIslNeighbor(sat, i);
+            if(neighbor.node_id != -1){
+                m_isl_neighbors[sat].push_back(std::make_tuple(neighbor.node_id, i, neighbor.interface));
+            }
+        }
+
+        // The GSL interface directly follows the ISL interfaces
+        m_gsl_interface[sat] = m_isl_neighbors[sat].size() + 1;
+        NS_ABORT_MSG_IF(ipv4->GetNetDevice(m_gsl_interface[sat])->GetObject<GSLNetDevice>() == 0,
+                        "GSL interface must follow the ISL interfaces in LEO: " + std::to_string(sat));
+    }
+}
+
+void SatnetRoutingEngine::Calculate(){
+    CalculatePositions();
+
+    // Shortest paths from each LEO which is in range of a ground station
+    m_source_index = std::vector<int32_t>(m_num_satellites, -1);
+    m_sources.clear();
+    for(int64_t gid = 0; gid < m_num_groundstations; ++gid){
+        for(const std::pair<double, int32_t>& in_range : m_gs_in_range[gid]){
+            if(m_source_index[in_range.second] == -1){
+                m_source_index[in_range.second] = m_sources.size();
+                m_sources.push_back(in_range.second);
+            }
+        }
+    }
+    m_source_distances.resize(m_sources.size());
+    ParallelFor(m_sources.size(), [this](size_t i){ CalculateShortestPaths(i); });
+
+    // Forwarding state (the ground stations use the distances of the satellites)
+    ParallelFor(m_num_satellites, [this](size_t i){ CalculateSatelliteForwardState(i); });
+    ParallelFor(m_num_groundstations, [this](size_t i){ CalculateGroundStationForwardState(m_num_satellites + i); });
+}
+
+void SatnetRoutingEngine::CalculatePositions(){
+    // The mobility models are not thread-safe, so positions are only read here
+    NodeContainer nodes = m_topology->GetNodes();
+    m_positions.resize(nodes.GetN());
+    for(uint32_t i = 0; i < nodes.GetN(); ++i){
+        m_positions[i] = nodes.Get(i)->GetObject<MobilityModel>()->GetPosition();
+    }
+
+    // ISL lengths
+    m_isl_lengths_m.resize(m_num_satellites);
+    for(int64_t sat = 0; sat < m_num_satellites; ++sat){
+        m_isl_lengths_m[sat].resize(m_isl_neighbors[sat].size());
+        for(size_t j = 0; j < m_isl_neighbors[sat].size(); ++j){
+            m_isl_lengths_m[sat][j] = CalculateDistance(m_positions[sat], m_positions[std::get<0>(m_isl_neighbors[sat][j])]);
+        }
+    }
+
+    // Satellites in range of each ground station
+    m_gs_in_range.resize(m_num_groundstations);
+    for(int64_t gid = 0; gid < m_num_groundstations; ++gid){
+        m_gs_in_range[gid].clear();
+        for(int64_t sat = 0; sat < m_num_satellites; ++sat){
+            double distance_m = CalculateDistance(m_positions[m_num_satellites + gid], m_positions[sat]);
+            if(distance_m <= m_topology->GetMaxGSL_Length_M()){
+                m_gs_in_range[gid].push_back(std::make_pair(distance_m, sat));
+            }
+        }
+    }
+}
+
+void SatnetRoutingEngine::CalculateShortestPaths(size_t source_index){
+    // Dijkstra over the ISLs
+    std::vector<double>& distances = m_source_distances[source_index];
+    distances.assign(m_num_satellites, std::numeric_limits<double>::infinity());
+    typedef std::pair<double, int32_t> QueueEntry;
+    std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> queue;
+    distances[m_sources[source_index]] = 0;
+    queue.push(std::make_pair(0.0, m_sources[source_index]));
+    while(!queue.empty()){
+        QueueEntry entry = queue.top();
+        queue.pop();
+        if(entry.first > distances[entry.second]) continue;
+        for(size_t j = 0; j < m_isl_neighbors[entry.second].size(); ++j){
+            int32_t neighbor = std::get<0>(m_isl_neighbors[entry.second][j]);
+            double distance_m = entry.first + m_isl_lengths_m[entry.second][j];
+            if(distance_m < distances[neighbor]){
+                distances[neighbor] = distance_m;
+                queue.push(std::make_pair(distance_m, neighbor));
+            }
+        }
+    }
+}
+
+void SatnetRoutingEngine::CalculateSatelliteForwardState(int32_t current_node_id){
+    for(int64_t gid = 0; gid < m_num_groundstations; ++gid){
+        std::vector<std::tuple<int32_t, int32_t, int32_t>> next_hop_list(m_num_candidates, DROP_NEXT_HOP);
+
+        // Among the satellites in range of the destination ground station,
+        // find the one which promises the shortest distance (ties by lowest id, as satgen)
+        double best_distance_m = std::numeric_limits<double>::infinity();
+        int32_t dst_sat = -1;
+        for(const std::pair<double, int32_t>& in_range : m_gs_in_range[gid]){
+            double distance_m = m_source_distances[m_source_index[in_range.second]][current_node_id] + in_range.first;
+            if(distance_m < best_distance_m || (distance_m == best_distance_m && in_range.second < dst_sat)){
+                best_distance_m = distance_m;
+                dst_sat = in_range.second;
+            }
+        }
+
+        if(dst_sat == current_node_id){
+            // This is the destination satellite, as such the next hop is the ground station itself
+            next_hop_list[0] = std::make_tuple(m_num_satellites + gid, m_gsl_interface[current_node_id], 1);
+        }
+        else if(dst_sat != -1){
+            // pick K neighbors are add to candidate lists for detour
+            const std::vector<double>& dst_distances = m_source_distances[m_source_index[dst_sat]];
+            std::vector<std::tuple<double, int32_t, int32_t, int32_t>> candidates;
+            for(size_t j = 0; j < m_isl_neighbors[current_node_id].size(); ++j){
+                const std::tuple<int32_t, int32_t, int32_t>& neighbor = m_isl_neighbors[current_node_id][j];
+                candidates.push_back(std::make_tuple(
+                        m_isl_lengths_m[current_node_id][j] + dst_distances[std::get<0>(neighbor)],
+                        std::get<0>(neighbor), std::get<1>(neighbor), std::get<2>(neighbor)
+                ));
+            }
+            std::sort(candidates.begin(), candidates.end());
+            for(size_t i = 0; i < candidates.size() && i < m_num_candidates; ++i){
+                next_hop_list[i] = std::make_tuple(std::get<1>(candidates[i]), std::get<2>(candidates[i]), std::get<3>(candidates[i]));
+            }
+        }
+
+        m_sat_to_gs_distance_m[current_node_id][gid] = best_distance_m;
+        m_forward_state[current_node_id][gid] = next_hop_list;
+    }
+}
+
+void SatnetRoutingEngine::CalculateGroundStationForwardState(int32_t current_node_id){
+    int64_t src_gid = current_node_id - m_num_satellites;
+    for(int64_t dst_gid = 0; dst_gid < m_num_groundstations; ++dst_gid){
+        std::vector<std::tuple<int32_t, int32_t, int32_t>> next_hop_list(m_num_candidates, DROP_NEXT_HOP);
+        if(src_gid != dst_gid){
+            // Rank the satellites in range of the source ground station
+            std::vector<std::pair<double, int32_t>> possibilities;
+            for(const std::pair<double, int32_t>& in_range : m_gs_in_range[src_gid]){
+                double distance_m = in_range.first + m_sat_to_gs_distance_m[in_range.second][dst_gid];
+                if(distance_m != std::numeric_limits<double>::infinity()){
+                    possibilities.push_back(std::make_pair(distance_m, in_range.second));
+                }
+            }
+            std::sort(possibilities.begin(), possibilities.end());
+
+            // we just need K candidates
+            for(size_t i = 0; i < possibilities.size() && i < m_num_candidates; ++i){
+                int32_t src_sat = possibilities[i].second;
+                next_hop_list[i] = std::make_tuple(src_sat, 1, m_gsl_interface[src_sat]);
+            }
+        }
+        m_forward_state[current_node_id][dst_gid] = next_hop_list;
+    }
+}
+
+void SatnetRoutingEngine::ParallelFor(size_t num_tasks, const std::function<void(size_t)>& task){
+    // Each thread takes every m_num_threads-th task, the tasks only write to their own part of the result
+    std::vector<std::thread> threads;
+    for(size_t t = 0; t < m_num_threads && t < num_tasks; ++t){
+        threads.push_back(std::thread([this, t, num_tasks, &task](){
+            for(size_t i = t; i < num_tasks; i += m_num_threads){
+                task(i);
+            }
+        }));
+    }
+    for(std::thread& thread : threads){
+        thread.join();
+    }
+}
+
+const std::vector<std::tuple<int32_t, int32_t, int32_t>>&
+SatnetRoutingEngine::GetForwardState(int32_t current_node_id, int32_t target_node_id){
+    NS_ABORT_MSG_IF(target_node_id < m_num_satellites || target_node_id >= m_num_satellites + m_num_groundstations,
+                    "Routing engine only calculates the forwarding state towards ground stations");
+    return m_forward_state.at(current_node_id).at(target_node_id - m_num_satellites);
+}
+
+}
@@ -0,0 +1,77 @@
+/**
+ * Author:  silent-rookie      2024
+*/
+
+#ifndef SATNET_ROUTING_ENGINE_H
+#define SATNET_ROUTING_ENGINE_H
+
+#include <tuple>
+#include <vector>
+#include <thread>
+#include <functional>
+#include "ns3/topology-satellite-network.h"
+#include "ns3/gsl-net-device.h"
+#include "ns3/point-to-point-laser-net-device.h"
+#include "ns3/next-hop-candidates.h"
+
+namespace ns3 {
+
+/**
+ * Computes the same forwarding state (K = num_next_hop_candidates candidates, by default 3,
+ * for each (node, ground station) pair)
+ * as satgen_GEO (algorithm_free_one_only_over_isls_ills), but from the current positions
+ * of the mobility models, such that no fstate files are needed (see GeoCoverageEngine
+ * for the ills state).
+ *
+ * The interfaces of the result already include the loop-back interface,
+ * i.e., they can directly be given to the arbiters.
+ */
+class SatnetRoutingEngine : public Object
+{
+public:
+    static TypeId GetTypeId (void);
+    SatnetRoutingEngine(Ptr<BasicSimulation> basicSimulation, Ptr<TopologySatelliteNetwork> topology);
+
+    // Recalculate the state for the current simulation time
+    void Calculate();
+
+    // Result of the last calculation
+    const std::vector<std::tuple<int32_t, int32_t, int32_t>>& GetForwardState(int32_t current_node_id, int32_t target_node_id);
+
+private:
+    void ReadInterfaces();
+    void CalculatePositions();
+    void CalculateShortestPaths(size_t source_index);
+    void CalculateSatelliteForwardState(int32_t current_node_id);
+    void CalculateGroundStationForwardState(int32_t current_node_id);
+    void ParallelFor(size_t num_tasks, const std::function<void(size_t)>& task);
+
+    Ptr<BasicSimulation> m_basicSimulation;
+    Ptr<TopologySatelliteNetwork> m_topology;
+    int64_t m_num_satellites;
+    int64_t m_num_groundstations;
+    size_t m_num_threads;
+    size_t m_num_candidates;
+
+    // Interfaces (fixed over time)
+    std::vector<std::vector<std::tuple<int32_t, int32_t, int32_t>>> m_isl_neighbors;    // per LEO: (neighbor, my if, neighbor if)
+    std::vector<int32_t> m_gsl_interface;                                               // per LEO: GSL interface
+
+    // Graph at the current time
+    std::vector<Vector> m_positions;                                    // per node
+    std::vector<std::vector<double>> m_isl_lengths_m;                   // per LEO: length of each ISL in m_isl_neighbors
+    std::vector<std::vector<std::pair<double, int32_t>>> m_gs_in_range; // per GS: (distance, LEO) in GSL range
+
+    // Shortest paths over the ISLs from each LEO which is in range of a ground station
+    std::vector<int32_t> m_source_index;                // per LEO: index in m_sources, -1 if it is not a source
+    std::vector<int32_t> m_sources;
+    std::vector<std::vector<double>> m_source_distances;
+
+    // Result
+    std::vector<std::vector<double>> m_sat_to_gs_distance_m;    // per LEO, per GS
+    std::vector<std::vector<std::vector<std::tuple<int32_t, int32_t, int32_t>>>> m_forward_state; // per LEO/GS, per GS
+};
+
+}
+
+#endif //SATNET_ROUTING_ENGINE_H
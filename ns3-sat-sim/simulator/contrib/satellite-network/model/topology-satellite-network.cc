@@ -24,6 +24,10 @@
 */
 
 #include "topology-satellite-network.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "traffic-class-queue.h"
+#include <limits>
+#include <thread>
 
 namespace ns3 {
 
@@ -41,15 +45,24 @@ namespace ns3 {
         m_basicSimulation = basicSimulation;
         ReadConfig();
         Build(ipv4RoutingHelper);
+        TrackQueuedPackets();
+        RegisterMonitoring();
     }
 
     void TopologySatelliteNetwork::ReadConfig() {
         m_satellite_network_dir = m_basicSimulation->GetRunDir() + "/" + m_basicSimulation->GetConfigParamOrFail("satellite_network_dir");
         m_satellite_network_routes_dir =  m_basicSimulation->GetRunDir() + "/" + m_basicSimulation->GetConfigParamOrFail("satellite_network_routes_dir");
         m_satellite_network_force_static = parse_boolean(m_basicSimulation->GetConfigParamOrDefault("satellite_network_force_static", "false"));
+        m_sgp4_init_num_threads = parse_positive_int64(m_basicSimulation->GetConfigParamOrDefault("sgp4_init_num_threads", "0"));
+        if (m_sgp4_init_num_threads == 0) {
+            m_sgp4_init_num_threads = std::max(1u, std::thread::hardware_concurrency());
+        }
 
         ReadDescription();
+        RequestArbiterConfig();
+    }
 
+    void TopologySatelliteNetwork::RequestArbiterConfig() {
         // Read some config key because basic-sim requires that all keys must be used
         // just read but do nothing
         std::string tmp = m_basicSimulation->GetConfigParamOrFail("receive_datarate_update_interval_ns");
@@ -60,6 +73,99 @@ namespace ns3 {
         tmp = m_basicSimulation->GetConfigParamOrFail("trafic_jam_update_interval_ns");
     }
 
+    void TopologySatelliteNetwork::SetBasicSimulation(Ptr<BasicSimulation> basicSimulation) {
+
+        // The nodes, devices and links are already built, so the
+        // new run must have been configured with the same topology
+        std::vector<std::string> topology_keys = {
+                "satellite_network_dir",
+                "satellite_network_routes_dir",
+                "satellite_network_force_static",
+                "isl_data_rate_megabit_per_s",
+                "gsl_data_rate_megabit_per_s",
+                "ill_data_rate_megabit_per_s",
+                "isl_max_queue_size_pkt",
+                "gsl_max_queue_size_pkt",
+                "ill_max_queue_size_pkt",
+                "isl_queue_scheduler",
+                "gsl_queue_scheduler",
+                "ill_queue_scheduler",
+                "isl_queue_drr_quanta_byte",
+                "gsl_queue_drr_quanta_byte",
+                "ill_queue_drr_quanta_byte",
+                "enable_isl_utilization_tracking",
+                "isl_utilization_tracking_interval_ns"
+        };
+        for (const std::string& key : topology_keys) {
+            if (m_basicSimulation->GetConfigParamOrDefault(key, "") != basicSimulation->GetConfigParamOrDefault(key, "")) {
+                throw std::runtime_error(format_string(
+                        "Config key \'%s\' of run %s differs from the one the topology was built with",
+                        key.c_str(), basicSimulation->GetRunDir().c_str()
+                ));
+            }
+        }
+
+        m_basicSimulation = basicSimulation;
+        RequestArbiterConfig();
+        RegisterMonitoring();
+
+        // The band statistics of the traffic class queues start again with the run
+        for (Ptr<Queue<Packet>> queue : GetDeviceQueues()) {
+            Ptr<TrafficClassQueue> traffic_class_queue = DynamicCast<TrafficClassQueue>(queue);
+            if (traffic_class_queue != 0) {
+                traffic_class_queue->ResetStatistics();
+            }
+        }
+    }
+
+    std::string TopologySatelliteNetwork::ReadQueueScheduler(std::string link) {
+        std::string scheduler = m_basicSimulation->GetConfigParamOrDefault(link + "_queue_scheduler", "fifo");
+        if (scheduler != "fifo" && scheduler != "strict_priority" && scheduler != "drr") {
+            throw std::invalid_argument(link + "_queue_scheduler must be fifo, strict_priority or drr: " + scheduler);
+        }
+        return scheduler;
+    }
+
+    std::string TopologySatelliteNetwork::ReadQueueDrrQuanta(std::string link, const std::string& scheduler) {
+        if (scheduler != "drr") {
+            return "";
+        }
+
+        // list(<class_A>,<class_B>,<class_default>,<class_C>), into the DrrQuanta attribute of the queue
+        std::vector<std::string> quanta = parse_list_string(m_basicSimulation->GetConfigParamOrDefault(
+                link + "_queue_drr_quanta_byte", "list(1500,1500,1500,1500)"
+        ));
+        if (quanta.size() != TrafficClassQueue::NUM_BANDS) {
+            throw std::invalid_argument(link + "_queue_drr_quanta_byte must have a quantum for class_A, class_B, class_default and class_C");
+        }
+        std::string drr_quanta;
+        for (size_t b = 0; b < quanta.size(); b++) {
+            if (parse_positive_int64(quanta[b]) == 0) {
+                throw std::invalid_argument(link + "_queue_drr_quanta_byte must be above 0: " + quanta[b]);
+            }
+            drr_quanta += (b == 0 ? "" : ",") + quanta[b];
+        }
+        return drr_quanta;
+    }
+
+    template <typename LinkHelper>
+    void TopologySatelliteNetwork::SetLinkQueue(LinkHelper& helper, int64_t max_queue_size_pkt,
+                                                const std::string& scheduler, const std::string& drr_quanta) {
+        std::string max_queue_size_str = format_string("%" PRId64 "p", max_queue_size_pkt);
+        if (scheduler == "fifo") {
+            helper.SetQueue("ns3::DropTailQueue<Packet>", "MaxSize", QueueSizeValue(QueueSize(max_queue_size_str)));
+            return;
+        }
+
+        // One band per traffic class, which share the max queue size
+        helper.SetQueue(
+                "ns3::TrafficClassQueue",
+                "MaxSize", QueueSizeValue(QueueSize(max_queue_size_str)),
+                "Scheduler", EnumValue(scheduler == "drr" ? TrafficClassQueue::DRR : TrafficClassQueue::STRICT_PRIORITY),
+                "DrrQuanta", StringValue(drr_quanta.empty() ? "1500,1500,1500,1500" : drr_quanta)
+        );
+    }
+
     void TopologySatelliteNetwork::ReadDescription(){
         // Filename
         std::ostringstream res;
@@ -109,14 +215,18 @@ namespace ns3 {
         // Initialize satellites
         ReadSatellites();
         std::cout << "  > Number of satellites........ " << m_satelliteNodes.GetN() << std::endl;
+        std::cout << "  > SGP4 init threads........... " << m_sgp4_init_num_threads << std::endl;
+        m_basicSimulation->RegisterTimestamp("Read satellites (TLEs, SGP4 and mobility models)");
 
         // Initialize ground stations
         ReadGroundStations();
         std::cout << "  > Number of ground stations... " << m_groundStationNodes.GetN() << std::endl;
+        m_basicSimulation->RegisterTimestamp("Read ground stations");
 
         // Initialize GEOsatellites
         ReadGEOSatellites();
         std::cout << "  > Number of GEOsatellites... " << m_GEOsatelliteNodes.GetN() << std::endl;
+        m_basicSimulation->RegisterTimestamp("Read GEO satellites (TLEs, SGP4 and mobility models)");
 
         // Only ground stations are valid endpoints
         for (uint32_t i = 0; i < m_groundStations.size(); i++) {
@@ -129,6 +239,16 @@ namespace ns3 {
         m_allNodes.Add(m_GEOsatelliteNodes);
         std::cout << "  > Number of nodes............. " << m_allNodes.GetN() << std::endl;
 
+        // Check that each node has an assignment to a system id if it is distributed
+        if (m_basicSimulation->IsDistributedEnabled()) {
+            size_t node_assignment_size = m_basicSimulation->GetDistributedNodeSystemIdAssignment().size();
+            if (node_assignment_size != m_allNodes.GetN()) {
+                throw std::invalid_argument(
+                        format_string("Incorrect amount of node-to-system-id assignments (must be %u but got %u)", m_allNodes.GetN(), (uint32_t) node_assignment_size)
+                );
+            }
+        }
+
         // Install internet stacks on all nodes
         InstallInternetStacks(ipv4RoutingHelper);
         std::cout << "  > Installed Internet stacks" << std::endl;
@@ -143,6 +263,12 @@ namespace ns3 {
         m_isl_max_queue_size_pkt = parse_positive_int64(m_basicSimulation->GetConfigParamOrFail("isl_max_queue_size_pkt"));
         m_gsl_max_queue_size_pkt = parse_positive_int64(m_basicSimulation->GetConfigParamOrFail("gsl_max_queue_size_pkt"));
         m_ill_max_queue_size_pkt = parse_positive_int64(m_basicSimulation->GetConfigParamOrFail("ill_max_queue_size_pkt"));
+        m_isl_queue_scheduler = ReadQueueScheduler("isl");
+        m_gsl_queue_scheduler = ReadQueueScheduler("gsl");
+        m_ill_queue_scheduler = ReadQueueScheduler("ill");
+        m_isl_queue_drr_quanta_byte = ReadQueueDrrQuanta("isl", m_isl_queue_scheduler);
+        m_gsl_queue_drr_quanta_byte = ReadQueueDrrQuanta("gsl", m_gsl_queue_scheduler);
+        m_ill_queue_drr_quanta_byte = ReadQueueDrrQuanta("ill", m_ill_queue_scheduler);
 
         // Utilization tracking settings
         m_enable_isl_utilization_tracking = parse_boolean(m_basicSimulation->GetConfigParamOrFail("enable_isl_utilization_tracking"));
@@ -162,6 +288,12 @@ namespace ns3 {
         std::cout << "  > Creating ILLs" << std::endl;
         CreateILLs();
 
+        // Lookahead of the distributed simulator
+        if (m_basicSimulation->IsDistributedEnabled()) {
+            std::cout << "  > Configuring distributed lookahead" << std::endl;
+            ConfigureDistributedLookahead();
+        }
+
         // ARP caches
         std::cout << "  > Populating ARP caches" << std::endl;
         PopulateArpCaches();
@@ -173,74 +305,100 @@ namespace ns3 {
     void
     TopologySatelliteNetwork::ReadSatellites()
     {
+        int64_t num_orbits;
+        int64_t satellites_per_orbit;
+        ReadSatelliteTles(m_satellite_network_dir + "/tles.txt", m_satelliteNodes, m_satellites, num_orbits, satellites_per_orbit);
+        m_num_orbits = num_orbits;
+        m_satellites_per_orbit = satellites_per_orbit;
+    }
+
+    void
+    TopologySatelliteNetwork::ReadSatelliteTles(
+            std::string filename,
+            NodeContainer& nodes,
+            std::vector<Ptr<Satellite>>& satellites,
+            int64_t& num_orbits,
+            int64_t& satellites_per_orbit
+    ) {
 
         // Open file
         std::ifstream fs;
-        fs.open(m_satellite_network_dir + "/tles.txt");
-        NS_ABORT_MSG_UNLESS(fs.is_open(), "File tles.txt could not be opened");
+        fs.open(filename);
+        NS_ABORT_MSG_UNLESS(fs.is_open(), "File " + filename + " could not be opened");
 
         // First line:
         // <orbits> <satellites per orbit>
         std::string orbits_and_n_sats_per_orbit;
         std::getline(fs, orbits_and_n_sats_per_orbit);
         std::vector<std::string> res = split_string(orbits_and_n_sats_per_orbit, " ", 2);
-        int64_t num_orbits = parse_positive_int64(res[0]);
-        int64_t satellites_per_orbit = parse_positive_int64(res[1]);
-
-        // Create the nodes
-        m_satelliteNodes.Create(num_orbits * satellites_per_orbit);
-
-        // Associate satellite mobility model with each node
-        int64_t counter = 0;
+        num_orbits = parse_positive_int64(res[0]);
+        satellites_per_orbit = parse_positive_int64(res[1]);
+
+        // Read all TLEs in one pass
+        // Format:
+        // <name>
+        // <TLE line 1>
+        // <TLE line 2>
+        std::vector<std::string> names;
+        std::vector<std::pair<std::string, std::string>> tles;
         std::string name, tle1, tle2;
         while (std::getline(fs, name)) {
             std::getline(fs, tle1);
             std::getline(fs, tle2);
+            names.push_back(name);
+            tles.push_back(std::make_pair(tle1, tle2));
+        }
+        fs.close();
 
-            // Format:
-            // <name>
-            // <TLE line 1>
-            // <TLE line 2>
+        // Check that exactly that number of satellites has been read in
+        if ((int64_t) names.size() != num_orbits * satellites_per_orbit) {
+            throw std::runtime_error("Number of satellites defined in the TLEs does not match");
+        }
 
-            // Create satellite
+        // Create the nodes and satellites (the object system is not thread-safe)
+        size_t first = satellites.size();
+        CreateNodes(nodes, names.size());
+        for (size_t i = 0; i < names.size(); i++) {
             Ptr<Satellite> satellite = CreateObject<Satellite>();
-            satellite->SetName(name);
-            satellite->SetTleInfo(tle1, tle2);
+            satellite->SetName(names[i]);
+            satellites.push_back(satellite);
+        }
 
-            // Decide the mobility model of the satellite
-            MobilityHelper mobility;
+        // Initialize the SGP4 records in parallel (each thread takes every num_threads-th satellite,
+        // and only writes to the record of its own satellites)
+        size_t num_threads = m_sgp4_init_num_threads;
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < num_threads && t < tles.size(); t++) {
+            threads.push_back(std::thread([&satellites, &tles, first, num_threads, t]() {
+                for (size_t i = t; i < tles.size(); i += num_threads) {
+                    satellites[first + i]->SetTleInfo(tles[i].first, tles[i].second);
+                }
+            }));
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        // Attach the mobility model of each satellite directly
+        for (size_t i = 0; i < names.size(); i++) {
+            Ptr<Satellite> satellite = satellites[first + i];
             if (m_satellite_network_force_static) {
 
                 // Static at the start of the epoch
-                mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
-                mobility.Install(m_satelliteNodes.Get(counter));
-                Ptr<MobilityModel> mobModel = m_satelliteNodes.Get(counter)->GetObject<MobilityModel>();
-                mobModel->SetPosition(satellite->GetPosition(satellite->GetTleEpoch()));
+                Ptr<ConstantPositionMobilityModel> mobility = CreateObject<ConstantPositionMobilityModel>();
+                mobility->SetPosition(satellite->GetPosition(satellite->GetTleEpoch()));
+                nodes.Get(first + i)->AggregateObject(mobility);
 
             } else {
 
                 // Dynamic
-                mobility.SetMobilityModel(
-                        "ns3::SatellitePositionMobilityModel",
-                        "SatellitePositionHelper",
-                        SatellitePositionHelperValue(SatellitePositionHelper(satellite))
-                );
-                mobility.Install(m_satelliteNodes.Get(counter));
+                Ptr<SatellitePositionMobilityModel> mobility = CreateObject<SatellitePositionMobilityModel>();
+                mobility->SetSatellite(satellite);
+                mobility->SetStartTime(satellite->GetTleEpoch());
+                nodes.Get(first + i)->AggregateObject(mobility);
 
             }
-
-            // Add to all satellites present
-            m_satellites.push_back(satellite);
-
-            counter++;
         }
-
-        // Check that exactly that number of satellites has been read in
-        if (counter != num_orbits * satellites_per_orbit) {
-            throw std::runtime_error("Number of satellites defined in the TLEs does not match");
-        }
-
-        fs.close();
     }
 
     void
@@ -276,7 +434,7 @@ namespace ns3 {
             m_groundStations.push_back(gs);
 
             // Create the node
-            m_groundStationNodes.Create(1);
+            CreateNodes(m_groundStationNodes, 1);
             if (m_groundStationNodes.GetN() != gid + 1) {
                 throw std::runtime_error("GID is not incremented each line");
             }
@@ -295,73 +453,32 @@ namespace ns3 {
 
     void 
     TopologySatelliteNetwork::ReadGEOSatellites(){
-        // Open file
-        std::ifstream fs;
-        fs.open(m_satellite_network_dir + "/tles_GEO.txt");
-        NS_ABORT_MSG_UNLESS(fs.is_open(), "File tles_GEO.txt could not be opened");
-
-        // First line:
-        // <orbits> <satellites per orbit>
-        std::string orbits_and_n_sats_per_orbit;
-        std::getline(fs, orbits_and_n_sats_per_orbit);
-        std::vector<std::string> res = split_string(orbits_and_n_sats_per_orbit, " ", 2);
-        int64_t num_orbits = parse_positive_int64(res[0]);
-        int64_t satellites_per_orbit = parse_positive_int64(res[1]);
-
-        // Create the nodes
-        m_GEOsatelliteNodes.Create(num_orbits * satellites_per_orbit);
-
-        // Associate satellite mobility model with each node
-        int64_t counter = 0;
-        std::string name, tle1, tle2;
-        while (std::getline(fs, name)) {
-            std::getline(fs, tle1);
-            std::getline(fs, tle2);
-
-            // Format:
-            // <name>
-            // <TLE line 1>
-            // <TLE line 2>
-
-            // Create satellite
-            Ptr<Satellite> satellite = CreateObject<Satellite>();
-            satellite->SetName(name);
-            satellite->SetTleInfo(tle1, tle2);
-
-            // Decide the mobility model of the satellite
-            MobilityHelper mobility;
-            if (m_satellite_network_force_static) {
+        int64_t num_orbits;
+        int64_t satellites_per_orbit;
+        ReadSatelliteTles(m_satellite_network_dir + "/tles_GEO.txt", m_GEOsatelliteNodes, m_GEOsatellites, num_orbits, satellites_per_orbit);
+    }
 
-                // Static at the start of the epoch
-                mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
-                mobility.Install(m_satelliteNodes.Get(counter));
-                Ptr<MobilityModel> mobModel = m_satelliteNodes.Get(counter)->GetObject<MobilityModel>();
-                mobModel->SetPosition(satellite->GetPosition(satellite->GetTleEpoch()));
+    void
+    TopologySatelliteNetwork::CreateNodes(NodeContainer& nodes, uint32_t num_nodes) {
 
-            } else {
+        // Not distributed: all nodes are in system 0
+        if (!m_basicSimulation->IsDistributedEnabled()) {
+            nodes.Create(num_nodes);
+            return;
+        }
 
-                // Dynamic
-                mobility.SetMobilityModel(
-                        "ns3::SatellitePositionMobilityModel",
-                        "SatellitePositionHelper",
-                        SatellitePositionHelperValue(SatellitePositionHelper(satellite))
+        // Distributed: each node is created in the system id assigned to its node id
+        // (node ids are given in order of creation: satellites, ground stations, GEO satellites)
+        const std::vector<int64_t> assignment = m_basicSimulation->GetDistributedNodeSystemIdAssignment();
+        for (uint32_t i = 0; i < num_nodes; i++) {
+            uint32_t node_id = NodeList::GetNNodes();
+            if (node_id >= assignment.size()) {
+                throw std::invalid_argument(
+                        format_string("Node %u has no node-to-system-id assignment (got only %u)", node_id, (uint32_t) assignment.size())
                 );
-                mobility.Install(m_GEOsatelliteNodes.Get(counter));
-
             }
-
-            // Add to all satellites present
-            m_GEOsatellites.push_back(satellite);
-
-            counter++;
+            nodes.Create(1, assignment[node_id]);
         }
-
-        // Check that exactly that number of satellites has been read in
-        if (counter != num_orbits * satellites_per_orbit) {
-            throw std::runtime_error("Number of satellites defined in the TLEs does not match");
-        }
-
-        fs.close();
     }
 
     void
@@ -371,17 +488,43 @@ namespace ns3 {
         internet.Install(m_allNodes);
     }
 
+    IslRole
+    TopologySatelliteNetwork::ClassifyIsl(int32_t sat_id, int32_t neighbor_sat_id) {
+        int64_t orbit = sat_id / m_satellites_per_orbit;
+        int64_t index = sat_id % m_satellites_per_orbit;
+        int64_t neighbor_orbit = neighbor_sat_id / m_satellites_per_orbit;
+        int64_t neighbor_index = neighbor_sat_id % m_satellites_per_orbit;
+        if (orbit == neighbor_orbit) {
+            if (neighbor_index == (index + 1) % m_satellites_per_orbit) {
+                return IslRole::intra_plane_fore;
+            } else if (neighbor_index == (index + m_satellites_per_orbit - 1) % m_satellites_per_orbit) {
+                return IslRole::intra_plane_aft;
+            }
+        } else if (index == neighbor_index) {
+            if (neighbor_orbit == (orbit + 1) % m_num_orbits) {
+                return IslRole::inter_plane_right;
+            } else if (neighbor_orbit == (orbit + m_num_orbits - 1) % m_num_orbits) {
+                return IslRole::inter_plane_left;
+            }
+        }
+        return IslRole::other;
+    }
+
     void
     TopologySatelliteNetwork::ReadISLs()
     {
 
         // Link helper
         PointToPointLaserHelper p2p_laser_helper;
-        std::string max_queue_size_str = format_string("%" PRId64 "p", m_isl_max_queue_size_pkt);
-        p2p_laser_helper.SetQueue("ns3::DropTailQueue<Packet>", "MaxSize", QueueSizeValue(QueueSize(max_queue_size_str)));
+        SetLinkQueue(p2p_laser_helper, m_isl_max_queue_size_pkt, m_isl_queue_scheduler, m_isl_queue_drr_quanta_byte);
         p2p_laser_helper.SetDeviceAttribute ("DataRate", DataRateValue (DataRate (std::to_string(m_isl_data_rate_megabit_per_s) + "Mbps")));
         std::cout << "    >> ISL data rate........ " << m_isl_data_rate_megabit_per_s << " Mbit/s" << std::endl;
         std::cout << "    >> ISL max queue size... " << m_isl_max_queue_size_pkt << " packet" << std::endl;
+        std::cout << "    >> ISL queue scheduler.. " << m_isl_queue_scheduler;
+        if (!m_isl_queue_drr_quanta_byte.empty()) {
+            std::cout << " (quanta " << m_isl_queue_drr_quanta_byte << " byte)";
+        }
+        std::cout << std::endl;
 
         // Traffic control helper
         TrafficControlHelper tch_isl;
@@ -392,6 +535,9 @@ namespace ns3 {
         fs.open(m_satellite_network_dir + "/isls.txt");
         NS_ABORT_MSG_UNLESS(fs.is_open(), "File isls.txt could not be opened");
 
+        // Neighbor table entries: per satellite, per interface
+        std::vector<std::vector<IslNeighbor>> neighbors(m_satellites.size());
+
         // Read ISL pair from each line
         std::string line;
         int counter = 0;
@@ -410,6 +556,15 @@ namespace ns3 {
             c.Add(m_satelliteNodes.Get(sat1_id));
             NetDeviceContainer netDevices = p2p_laser_helper.Install(c);
 
+            // Distributed: ISLs between two systems bound the lookahead
+            if (m_satelliteNodes.Get(sat0_id)->GetSystemId() != m_satelliteNodes.Get(sat1_id)->GetSystemId()) {
+                m_islCrossSystem.push_back(std::make_pair(sat0_id, sat1_id));
+            }
+            Ptr<PointToPointLaserRemoteChannel> remote_channel = netDevices.Get(0)->GetChannel()->GetObject<PointToPointLaserRemoteChannel>();
+            if (remote_channel != 0) {
+                m_islRemoteChannels.push_back(remote_channel);
+            }
+
             // Install traffic control helper
             tch_isl.Install(netDevices.Get(0));
             tch_isl.Install(netDevices.Get(1));
@@ -423,6 +578,14 @@ namespace ns3 {
             tch_uninstaller.Uninstall(netDevices.Get(0));
             tch_uninstaller.Uninstall(netDevices.Get(1));
 
+            // Neighbor table
+            int32_t if0 = m_satelliteNodes.Get(sat0_id)->GetObject<Ipv4>()->GetInterfaceForDevice(netDevices.Get(0));
+            int32_t if1 = m_satelliteNodes.Get(sat1_id)->GetObject<Ipv4>()->GetInterfaceForDevice(netDevices.Get(1));
+            neighbors[sat0_id].resize(std::max(neighbors[sat0_id].size(), (size_t) if0 + 1), m_no_isl_neighbor);
+            neighbors[sat1_id].resize(std::max(neighbors[sat1_id].size(), (size_t) if1 + 1), m_no_isl_neighbor);
+            neighbors[sat0_id][if0] = {sat1_id, if1, ClassifyIsl(sat0_id, sat1_id)};
+            neighbors[sat1_id][if1] = {sat0_id, if0, ClassifyIsl(sat1_id, sat0_id)};
+
             // Utilization tracking
             if (m_enable_isl_utilization_tracking) {
                 netDevices.Get(0)->GetObject<PointToPointLaserNetDevice>()->EnableUtilizationTracking(m_isl_utilization_tracking_interval_ns);
@@ -438,6 +601,17 @@ namespace ns3 {
         }
         fs.close();
 
+        // Dense neighbor table
+        m_isl_neighbor_stride = 0;
+        for (const std::vector<IslNeighbor>& sat_neighbors : neighbors) {
+            m_isl_neighbor_stride = std::max(m_isl_neighbor_stride, (uint32_t) sat_neighbors.size());
+        }
+        m_num_isl_neighbor_nodes = neighbors.size();
+        m_isl_neighbors = std::vector<IslNeighbor>(m_num_isl_neighbor_nodes * m_isl_neighbor_stride, m_no_isl_neighbor);
+        for (size_t sat = 0; sat < neighbors.size(); sat++) {
+            std::copy(neighbors[sat].begin(), neighbors[sat].end(), m_isl_neighbors.begin() + sat * m_isl_neighbor_stride);
+        }
+
         // Completed
         std::cout << "    >> Created " << std::to_string(counter) << " ISL(s)" << std::endl;
 
@@ -448,11 +622,15 @@ namespace ns3 {
 
         // Link helper
         GSLHelper gsl_helper;
-        std::string max_queue_size_str = format_string("%" PRId64 "p", m_gsl_max_queue_size_pkt);
-        gsl_helper.SetQueue("ns3::DropTailQueue<Packet>", "MaxSize", QueueSizeValue(QueueSize(max_queue_size_str)));
+        SetLinkQueue(gsl_helper, m_gsl_max_queue_size_pkt, m_gsl_queue_scheduler, m_gsl_queue_drr_quanta_byte);
         gsl_helper.SetDeviceAttribute ("DataRate", DataRateValue (DataRate (std::to_string(m_gsl_data_rate_megabit_per_s) + "Mbps")));
         std::cout << "    >> GSL data rate........ " << m_gsl_data_rate_megabit_per_s << " Mbit/s" << std::endl;
         std::cout << "    >> GSL max queue size... " << m_gsl_max_queue_size_pkt << " packet" << std::endl;
+        std::cout << "    >> GSL queue scheduler.. " << m_gsl_queue_scheduler;
+        if (!m_gsl_queue_drr_quanta_byte.empty()) {
+            std::cout << " (quanta " << m_gsl_queue_drr_quanta_byte << " byte)";
+        }
+        std::cout << std::endl;
 
         // Traffic control helper
         TrafficControlHelper tch_gsl;
@@ -492,6 +670,7 @@ namespace ns3 {
 
         // Create and install GSL network devices
         NetDeviceContainer devices = gsl_helper.Install(m_satelliteNodes, m_groundStationNodes, node_gsl_if_info);
+        m_gslChannel = devices.Get(0)->GetChannel();
         std::cout << "    >> Finished install GSL interfaces (interfaces, network devices, one shared channel)" << std::endl;
 
         // Install queueing disciplines
@@ -561,11 +740,15 @@ namespace ns3 {
 
         // Link helper
         ILLHelper ill_helper;
-        std::string max_queue_size_str = format_string("%" PRId64 "p", m_ill_max_queue_size_pkt);
-        ill_helper.SetQueue("ns3::DropTailQueue<Packet>", "MaxSize", QueueSizeValue(QueueSize(max_queue_size_str)));
+        SetLinkQueue(ill_helper, m_ill_max_queue_size_pkt, m_ill_queue_scheduler, m_ill_queue_drr_quanta_byte);
         ill_helper.SetDeviceAttribute ("DataRate", DataRateValue (DataRate (std::to_string(m_ill_data_rate_megabit_per_s) + "Mbps")));
         std::cout << "    >> ILL data rate........ " << m_ill_data_rate_megabit_per_s << " Mbit/s" << std::endl;
         std::cout << "    >> ILL max queue size... " << m_ill_max_queue_size_pkt << " packet" << std::endl;
+        std::cout << "    >> ILL queue scheduler.. " << m_ill_queue_scheduler;
+        if (!m_ill_queue_drr_quanta_byte.empty()) {
+            std::cout << " (quanta " << m_ill_queue_drr_quanta_byte << " byte)";
+        }
+        std::cout << std::endl;
 
         // Traffic control helper
         TrafficControlHelper tch_ill;
@@ -604,6 +787,7 @@ namespace ns3 {
 
         // Create and install ILL network devices
         NetDeviceContainer devices = ill_helper.Install(m_satelliteNodes, m_GEOsatelliteNodes, node_ill_if_info);
+        m_illChannel = devices.Get(0)->GetChannel();
         std::cout << "    >> Finished install ILL interfaces (interfaces, network devices, one shared channel)" << std::endl;
 
         // Install queueing disciplines
@@ -660,6 +844,89 @@ namespace ns3 {
         std::cout << "    >> ILL interfaces are setup" << std::endl;
     }
 
+    void
+    TopologySatelliteNetwork::ConfigureDistributedLookahead() {
+
+        // The null message simulator derives its lookahead per pair of neighboring systems from the
+        // point-to-point links, which misses the shared GSL and ILL channels, and the exchange of the
+        // arbiter state in an event requires all systems to be in the same granted time window
+        if (m_basicSimulation->GetConfigParamOrFail("distributed_simulator_implementation_type") != "default") {
+            throw std::runtime_error("The satellite network only supports distributed_simulator_implementation_type=default");
+        }
+
+        // The links move, so the delay of each is bounded from below by the smallest length sampled
+        // over the whole simulation, minus the distance the ends can close in between two samples
+        // (the two ends each move at most at the maximum satellite speed, 10% margin)
+        int64_t sample_interval_ns = parse_positive_int64(m_basicSimulation->GetConfigParamOrDefault("distributed_lookahead_sample_interval_ns", "1000000000"));
+        int64_t end_time_ns = m_basicSimulation->GetSimulationEndTimeNs();
+        double inf = std::numeric_limits<double>::infinity();
+        double min_leo_radius_m = inf;
+        double max_leo_radius_m = 0;
+        double min_geo_radius_m = inf;
+        double max_speed_m_per_s = 0;
+        double min_isl_length_m = inf;
+        for (int64_t t = 0; ; t = std::min(t + sample_interval_ns, end_time_ns)) {
+            int64_t epoch_offset_time_ns = m_satellite_network_force_static ? 0 : t;
+            std::vector<Vector> positions;
+            for (Ptr<Satellite> satellite : m_satellites) {
+                JulianDate jd = satellite->GetTleEpoch() + NanoSeconds(epoch_offset_time_ns);
+                Vector position = satellite->GetPosition(jd);
+                Vector velocity = satellite->GetVelocity(jd);
+                double radius_m = std::sqrt(position.x * position.x + position.y * position.y + position.z * position.z);
+                min_leo_radius_m = std::min(min_leo_radius_m, radius_m);
+                max_leo_radius_m = std::max(max_leo_radius_m, radius_m);
+                max_speed_m_per_s = std::max(max_speed_m_per_s, std::sqrt(velocity.x * velocity.x + velocity.y * velocity.y + velocity.z * velocity.z));
+                positions.push_back(position);
+            }
+            for (Ptr<Satellite> satellite : m_GEOsatellites) {
+                Vector position = satellite->GetPosition(satellite->GetTleEpoch() + NanoSeconds(epoch_offset_time_ns));
+                min_geo_radius_m = std::min(min_geo_radius_m, std::sqrt(position.x * position.x + position.y * position.y + position.z * position.z));
+            }
+            for (const std::pair<int32_t, int32_t>& isl : m_islCrossSystem) {
+                min_isl_length_m = std::min(min_isl_length_m, CalculateDistance(positions[isl.first], positions[isl.second]));
+            }
+            if (m_satellite_network_force_static || t >= end_time_ns) {
+                break;
+            }
+        }
+        double max_gs_radius_m = 0;
+        for (Ptr<GroundStation> gs : m_groundStations) {
+            Vector position = gs->GetCartesianPosition();
+            max_gs_radius_m = std::max(max_gs_radius_m, std::sqrt(position.x * position.x + position.y * position.y + position.z * position.z));
+        }
+        double margin_m = m_satellite_network_force_static ? 0 : 1.1 * max_speed_m_per_s * sample_interval_ns / 1e9;
+
+        // Lower bound of each type of link
+        double speed_of_light_m_per_s = 299792458.0;
+        Time gsl_lower_bound = Seconds((min_leo_radius_m - max_gs_radius_m - margin_m) / speed_of_light_m_per_s);
+        Time ill_lower_bound = Seconds((min_geo_radius_m - max_leo_radius_m - margin_m) / speed_of_light_m_per_s);
+        Time isl_lower_bound = Seconds((min_isl_length_m - margin_m) / speed_of_light_m_per_s);
+        if (m_basicSimulation->GetSystemsCount() > 1 && m_islCrossSystem.empty()) {
+            throw std::runtime_error("Distributed satellite network requires ISLs between the systems (assign the nodes by orbital plane)");
+        }
+        Time lookahead = m_islCrossSystem.empty() ? std::min(gsl_lower_bound, ill_lower_bound) : std::min(isl_lower_bound, std::min(gsl_lower_bound, ill_lower_bound));
+        if (lookahead <= Seconds(0)) {
+            throw std::runtime_error("Distributed lookahead must be positive (decrease distributed_lookahead_sample_interval_ns)");
+        }
+
+        // The distributed simulator takes the smallest "Delay" of the remote point-to-point channels of each
+        // system as its lookahead, and packets over the GSLs and ILLs can also cross systems, so all of the
+        // remote ISLs get the overall lower bound (as such it is the same on every system)
+        for (Ptr<PointToPointLaserRemoteChannel> channel : m_islRemoteChannels) {
+            channel->SetAttribute("Delay", TimeValue(lookahead));
+        }
+        m_gslChannel->SetAttribute("Delay", TimeValue(gsl_lower_bound));
+        m_illChannel->SetAttribute("Delay", TimeValue(ill_lower_bound));
+
+        std::cout << "    >> ISLs between systems... " << m_islCrossSystem.size() << std::endl;
+        std::cout << "    >> GSL lower bound........ " << gsl_lower_bound.GetNanoSeconds() << " ns" << std::endl;
+        std::cout << "    >> ILL lower bound........ " << ill_lower_bound.GetNanoSeconds() << " ns" << std::endl;
+        if (!m_islCrossSystem.empty()) {
+            std::cout << "    >> ISL lower bound........ " << isl_lower_bound.GetNanoSeconds() << " ns" << std::endl;
+        }
+        std::cout << "    >> Lookahead.............. " << lookahead.GetNanoSeconds() << " ns" << std::endl;
+    }
+
     void
     TopologySatelliteNetwork::PopulateArpCaches() {
 
@@ -691,15 +958,81 @@ namespace ns3 {
 
     }
 
+    void TopologySatelliteNetwork::RegisterMonitoring() {
+        m_basicSimulation->AddProgressStreamField("queued_packets", MakeCallback(&TopologySatelliteNetwork::GetNumQueuedPackets, this));
+        m_basicSimulation->AddMemoryReportEntry("Device queues: waiting packets", MakeCallback(&TopologySatelliteNetwork::EstimateQueueMemoryBytes, this));
+        m_basicSimulation->AddMemoryReportEntry("ISL utilization (m_utilization)", MakeCallback(&TopologySatelliteNetwork::EstimateUtilizationMemoryBytes, this));
+    }
+
+    std::vector<Ptr<Queue<Packet>>> TopologySatelliteNetwork::GetDeviceQueues() {
+        // The traffic control layer is uninstalled, as such the device queues hold all waiting packets
+        std::vector<Ptr<Queue<Packet>>> queues;
+        for (uint32_t i = 0; i < m_allNodes.GetN(); i++) {
+            Ptr<Node> node = m_allNodes.Get(i);
+            for (uint32_t j = 0; j < node->GetNDevices(); j++) {
+                Ptr<NetDevice> device = node->GetDevice(j);
+                Ptr<PointToPointLaserNetDevice> isl = DynamicCast<PointToPointLaserNetDevice>(device);
+                if (isl != 0) {
+                    queues.push_back(isl->GetQueue());
+                    continue;
+                }
+                Ptr<GSLNetDevice> gsl = DynamicCast<GSLNetDevice>(device);
+                if (gsl != 0) {
+                    queues.push_back(gsl->GetQueue());
+                }
+            }
+        }
+        return queues;
+    }
+
+    void TopologySatelliteNetwork::TrackQueuedPackets() {
+        // Once for the built topology, such that a progress stream sample does not walk all devices
+        for (Ptr<Queue<Packet>> queue : GetDeviceQueues()) {
+            queue->TraceConnectWithoutContext("PacketsInQueue", MakeCallback(&TopologySatelliteNetwork::QueuedPacketsChanged, this));
+        }
+    }
+
+    void TopologySatelliteNetwork::QueuedPacketsChanged(uint32_t old_num_packets, uint32_t new_num_packets) {
+        m_num_queued_packets += (int64_t) new_num_packets - (int64_t) old_num_packets;
+    }
+
+    double TopologySatelliteNetwork::GetNumQueuedPackets() {
+        return m_num_queued_packets;
+    }
+
+    uint64_t TopologySatelliteNetwork::EstimateQueueMemoryBytes() {
+        // Packet contents, and the packet object of each of them (their tags and metadata are not included)
+        uint64_t bytes = 0;
+        for (Ptr<Queue<Packet>> queue : GetDeviceQueues()) {
+            bytes += queue->GetNBytes() + queue->GetNPackets() * sizeof(Packet);
+        }
+        return bytes;
+    }
+
+    uint64_t TopologySatelliteNetwork::EstimateUtilizationMemoryBytes() {
+        uint64_t bytes = 0;
+        for (size_t i = 0; i < m_islNetDevices.GetN(); i++) {
+            bytes += m_islNetDevices.Get(i)->GetObject<PointToPointLaserNetDevice>()->EstimateUtilizationMemoryBytes();
+        }
+        return bytes;
+    }
+
     void TopologySatelliteNetwork::CollectUtilizationStatistics() {
         if (m_enable_isl_utilization_tracking) {
 
-            // Open CSV file
-            FILE* file_utilization_csv = fopen((m_basicSimulation->GetLogsDir() + "/isl_utilization.csv").c_str(), "w+");
+            // Open CSV file (distributed: each system writes the ISL network devices of its own nodes)
+            std::string filename = m_basicSimulation->GetLogsDir() + "/isl_utilization.csv";
+            if (m_basicSimulation->IsDistributedEnabled()) {
+                filename = m_basicSimulation->GetLogsDir() + "/system_" + std::to_string(m_basicSimulation->GetSystemId()) + "_isl_utilization.csv";
+            }
+            FILE* file_utilization_csv = fopen(filename.c_str(), "w+");
 
             // Go over every ISL network device
             for (size_t i = 0; i < m_islNetDevices.GetN(); i++) {
                 Ptr<PointToPointLaserNetDevice> dev = m_islNetDevices.Get(i)->GetObject<PointToPointLaserNetDevice>();
+                if (dev->GetNode()->GetSystemId() != m_basicSimulation->GetSystemId()) {
+                    continue;
+                }
                 const std::vector<double> utilization = dev->FinalizeUtilization();
                 std::pair<int32_t, int32_t> src_dst = m_islFromTo[i];
                 int64_t interval_left_side_ns = 0;
@@ -729,6 +1062,96 @@ namespace ns3 {
             fclose(file_utilization_csv);
 
         }
+
+        if (m_isl_queue_scheduler != "fifo" || m_gsl_queue_scheduler != "fifo" || m_ill_queue_scheduler != "fifo") {
+            WriteQueueBandStatistics();
+        }
+    }
+
+    void TopologySatelliteNetwork::WriteQueueBandStatistics() {
+        std::cout << "STORE QUEUE BAND STATISTICS" << std::endl;
+
+        // Sum of the bands over the traffic class queues of each link type (distributed: of the nodes of this system)
+        const std::vector<std::string> link_types = {"ISL", "GSL", "ILL"};
+        std::vector<std::vector<TrafficClassBandStatistics>> totals(
+                link_types.size(), std::vector<TrafficClassBandStatistics>(TrafficClassQueue::NUM_BANDS)
+        );
+        std::vector<uint64_t> num_queues(link_types.size(), 0);
+        for (uint32_t i = 0; i < m_allNodes.GetN(); i++) {
+            Ptr<Node> node = m_allNodes.Get(i);
+            if (node->GetSystemId() != m_basicSimulation->GetSystemId()) {
+                continue;
+            }
+            for (uint32_t j = 0; j < node->GetNDevices(); j++) {
+                Ptr<NetDevice> device = node->GetDevice(j);
+                Ptr<Queue<Packet>> queue;
+                size_t link_type;
+                Ptr<PointToPointLaserNetDevice> isl = DynamicCast<PointToPointLaserNetDevice>(device);
+                Ptr<GSLNetDevice> gsl = DynamicCast<GSLNetDevice>(device);
+                if (isl != 0) {
+                    queue = isl->GetQueue();
+                    link_type = 0;
+                } else if (gsl != 0) {
+                    queue = gsl->GetQueue();
+                    link_type = gsl->GetChannel() == m_illChannel ? 2 : 1;
+                } else {
+                    continue;
+                }
+                Ptr<TrafficClassQueue> traffic_class_queue = DynamicCast<TrafficClassQueue>(queue);
+                if (traffic_class_queue == 0) {
+                    continue;
+                }
+                num_queues[link_type] += 1;
+                for (size_t b = 0; b < TrafficClassQueue::NUM_BANDS; b++) {
+                    TrafficClassBandStatistics band = traffic_class_queue->GetBandStatistics(b);
+                    TrafficClassBandStatistics& total = totals[link_type][b];
+                    total.enqueued_packets += band.enqueued_packets;
+                    total.dropped_packets += band.dropped_packets;
+                    total.max_packets = std::max(total.max_packets, band.max_packets);
+                    total.occupancy_packet_ns += band.occupancy_packet_ns;
+                }
+            }
+        }
+
+        // queue_band_statistics.csv (line format: <ISL/GSL/ILL>,<traffic class>,<enqueued packets>,<dropped packets>,
+        // <drop rate>,<mean occupancy per queue (packets)>,<max occupancy of a queue (packets)>)
+        // in the performance output of the run, next to the one of the applications
+        std::string performance_dir = m_basicSimulation->GetRunDir() + "/algorithm_performance";
+        mkdir_if_not_exists(performance_dir);
+        std::string filename = performance_dir + "/queue_band_statistics.csv";
+        if (m_basicSimulation->IsDistributedEnabled()) {
+            filename = performance_dir + "/system_" + std::to_string(m_basicSimulation->GetSystemId()) + "_queue_band_statistics.csv";
+        }
+        FILE* file_csv = fopen(filename.c_str(), "w+");
+        double duration_ns = (double) m_basicSimulation->GetSimulationEndTimeNs();
+        for (size_t l = 0; l < link_types.size(); l++) {
+            if (num_queues[l] == 0) {
+                continue;
+            }
+            for (size_t b = 0; b < TrafficClassQueue::NUM_BANDS; b++) {
+                const TrafficClassBandStatistics& total = totals[l][b];
+                uint64_t arrived = total.enqueued_packets + total.dropped_packets;
+                double drop_rate = arrived == 0 ? 0.0 : (double) total.dropped_packets / arrived;
+                double mean_occupancy = total.occupancy_packet_ns / (num_queues[l] * duration_ns);
+                std::string traffic_class = TrafficClass2String(TrafficClassQueue::GetBandTrafficClass(b));
+                fprintf(file_csv,
+                        "%s,%s,%" PRIu64 ",%" PRIu64 ",%f,%f,%" PRIu64 "\n",
+                        link_types[l].c_str(),
+                        traffic_class.c_str(),
+                        total.enqueued_packets,
+                        total.dropped_packets,
+                        drop_rate,
+                        mean_occupancy,
+                        total.max_packets
+                );
+                std::cout << "  > " << link_types[l] << " class " << traffic_class << std::string(8 - traffic_class.size(), '.')
+                          << " dropped " << total.dropped_packets << " of " << arrived
+                          << ", mean occupancy " << mean_occupancy << " packet" << std::endl;
+            }
+        }
+        fclose(file_csv);
+        std::cout << "  > Written to: " << filename << std::endl;
+        std::cout << std::endl;
     }
 
     uint32_t TopologySatelliteNetwork::GetNumSatellites() {
@@ -743,6 +1166,14 @@ namespace ns3 {
         return m_GEOsatelliteNodes.GetN();
     }
 
+    uint32_t TopologySatelliteNetwork::GetNumOrbits() {
+        return m_num_orbits;
+    }
+
+    uint32_t TopologySatelliteNetwork::GetNumSatellitesPerOrbit() {
+        return m_satellites_per_orbit;
+    }
+
     int64_t TopologySatelliteNetwork::GetMaxISL_Length_M(){
         return max_isl_length_m;
     }
@@ -58,10 +58,29 @@
 #include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/wifi-net-device.h"
 #include "ns3/point-to-point-laser-net-device.h"
+#include "ns3/point-to-point-laser-remote-channel.h"
 #include "ns3/ipv4.h"
 
 namespace ns3 {
 
+    // Role of an ISL in a +Grid constellation (satellite id = orbit * satellites per orbit + index in orbit):
+    // to the next / previous satellite in the same orbit, or to the same satellite in the previous / next orbit
+    enum class IslRole : uint8_t {
+        none,                   // not an ISL interface
+        intra_plane_fore,
+        intra_plane_aft,
+        inter_plane_left,
+        inter_plane_right,
+        other                   // an ISL which is not +Grid
+    };
+
+    // The satellite (and its interface) across an ISL interface
+    struct IslNeighbor {
+        int32_t node_id;        // -1 if not an ISL interface
+        int32_t interface;      // Ipv4 interface index (the loop-back interface is 0)
+        IslRole role;
+    };
+
     class TopologySatelliteNetwork : public Topology
     {
     public:
@@ -92,25 +111,61 @@ namespace ns3 {
         bool IsSatelliteId(uint32_t node_id);
         bool IsGroundStationId(uint32_t node_id);
 
-        // Post-processing
+        // ISL neighbor table, built from isls.txt: the satellite across interface of node_id
+        // (node_id -1 for any interface which is not an ISL, or any node which is not a satellite)
+        const IslNeighbor& GetIslNeighbor(uint32_t node_id, uint32_t interface) const {
+            if (node_id >= m_num_isl_neighbor_nodes || interface >= m_isl_neighbor_stride) {
+                return m_no_isl_neighbor;
+            }
+            return m_isl_neighbors[node_id * m_isl_neighbor_stride + interface];
+        }
+        uint32_t GetNumOrbits();
+        uint32_t GetNumSatellitesPerOrbit();
+
+        // Monitoring: packets waiting in the queues of the ISL, GSL and ILL devices (progress stream),
+        // and the estimated memory of the queues and the utilization tracking (memory report)
+        double GetNumQueuedPackets();
+        uint64_t EstimateQueueMemoryBytes();
+        uint64_t EstimateUtilizationMemoryBytes();
+
+        // Post-processing (including the per band statistics of the traffic class queues)
         void CollectUtilizationStatistics();
 
+        // Re-use the built topology for another run (batch mode, after fork())
+        void SetBasicSimulation(Ptr<BasicSimulation> basicSimulation);
+
     private:
 
         // Build functions
         void ReadConfig();
+        void RequestArbiterConfig();
         void ReadDescription();
         void Build(const Ipv4RoutingHelper& ipv4RoutingHelper);
         void ReadGroundStations();
         void ReadSatellites();
         void ReadGEOSatellites();
+        void ReadSatelliteTles(std::string filename, NodeContainer& nodes, std::vector<Ptr<Satellite>>& satellites,
+                               int64_t& num_orbits, int64_t& satellites_per_orbit);
+        void CreateNodes(NodeContainer& nodes, uint32_t num_nodes);
         void InstallInternetStacks(const Ipv4RoutingHelper& ipv4RoutingHelper);
         void ReadISLs();
+        IslRole ClassifyIsl(int32_t sat_id, int32_t neighbor_sat_id);
         void CreateGSLs();
         void CreateILLs();
+        void ConfigureDistributedLookahead();
 
         // Helper
         void EnsureValidNodeId(uint32_t node_id);
+        void RegisterMonitoring();
+        void TrackQueuedPackets();
+        void QueuedPacketsChanged(uint32_t old_num_packets, uint32_t new_num_packets);
+        std::vector<Ptr<Queue<Packet>>> GetDeviceQueues();
+        std::string ReadQueueScheduler(std::string link);
+        std::string ReadQueueDrrQuanta(std::string link, const std::string& scheduler);
+        template <typename LinkHelper>
+        void SetLinkQueue(LinkHelper& helper, int64_t max_queue_size_pkt,
+                          const std::string& scheduler, const std::string& drr_quanta);
+        void WriteQueueBandStatistics();
 
         // Routing
         Ipv4AddressHelper m_ipv4_helper;
@@ -122,6 +177,8 @@ namespace ns3 {
         std::string m_satellite_network_routes_dir;   //<! Directory containing the routes over time of the network
         bool m_satellite_network_force_static;        //<! True to disable satellite movement and basically run
                                                       //   it static at t=0 (like a static network)
+        size_t m_sgp4_init_num_threads;               //<! Threads which initialize the SGP4 records of the satellites
+                                                      //   (sgp4_init_num_threads, default 0: one per hardware thread)
 
         // Generated state
         NodeContainer m_allNodes;                           //!< All nodes
@@ -137,6 +194,21 @@ namespace ns3 {
         NetDeviceContainer m_islNetDevices;
         std::vector<std::pair<int32_t, int32_t>> m_islFromTo;
 
+        // ISL neighbor table: per satellite, per interface (stride: 1 + the highest ISL interface)
+        std::vector<IslNeighbor> m_isl_neighbors;
+        uint32_t m_isl_neighbor_stride = 0;
+        uint32_t m_num_isl_neighbor_nodes = 0;
+        const IslNeighbor m_no_isl_neighbor = {-1, -1, IslRole::none};
+
+        // Packets in all device queues, kept up to date by their PacketsInQueue traces
+        int64_t m_num_queued_packets = 0;
+
+        // Channels (distributed mode: their "Delay" is the lower bound used as lookahead)
+        std::vector<Ptr<PointToPointLaserRemoteChannel>> m_islRemoteChannels;   //!< ISLs with an end on another system
+        std::vector<std::pair<int32_t, int32_t>> m_islCrossSystem;                //!< ISLs between two systems
+        Ptr<Channel> m_gslChannel;
+        Ptr<Channel> m_illChannel;
+
         // Values
         double m_isl_data_rate_megabit_per_s;
         double m_gsl_data_rate_megabit_per_s;
@@ -144,10 +216,18 @@ namespace ns3 {
         int64_t m_isl_max_queue_size_pkt;
         int64_t m_gsl_max_queue_size_pkt;
         int64_t m_ill_max_queue_size_pkt;
+        std::string m_isl_queue_scheduler;          //<! fifo, strict_priority or drr (TrafficClassQueue)
+        std::string m_gsl_queue_scheduler;
+        std::string m_ill_queue_scheduler;
+        std::string m_isl_queue_drr_quanta_byte;    //<! DRR quantum per band (drr only)
+        std::string m_gsl_queue_drr_quanta_byte;
+        std::string m_ill_queue_drr_quanta_byte;
         bool m_enable_isl_utilization_tracking;
         int64_t m_isl_utilization_tracking_interval_ns;
 
         // Description
+        int64_t m_num_orbits;
+        int64_t m_satellites_per_orbit;
         int64_t max_isl_length_m;
         int64_t max_gsl_length_m;
         int64_t max_ill_length_m;
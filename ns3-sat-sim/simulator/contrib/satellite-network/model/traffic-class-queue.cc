@@ -0,0 +1,241 @@
+/**
+ * Author:  silent-rookie      2024
+*/
+
+#include "traffic-class-queue.h"
+#include "ns3/enum.h"
+#include "ns3/string.h"
+#include "ns3/simulator.h"
+#include "ns3/exp-util.h"
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (TrafficClassQueue);
+
+TypeId TrafficClassQueue::GetTypeId (void)
+{
+    static TypeId tid = TypeId ("ns3::TrafficClassQueue<Packet>")
+            .SetParent<Queue<Packet> > ()
+            .SetGroupName("BasicSim")
+            .AddConstructor<TrafficClassQueue> ()
+            .AddAttribute ("MaxSize",
+                           "The max queue size (shared by the bands)",
+                           QueueSizeValue (QueueSize ("100p")),
+                           MakeQueueSizeAccessor (&QueueBase::SetMaxSize,
+                                                  &QueueBase::GetMaxSize),
+                           MakeQueueSizeChecker ())
+            .AddAttribute ("Scheduler",
+                           "Which band is dequeued: the first which is not empty, or deficit round robin",
+                           EnumValue (STRICT_PRIORITY),
+                           MakeEnumAccessor (&TrafficClassQueue::m_scheduler),
+                           MakeEnumChecker (STRICT_PRIORITY, "strict_priority",
+                                            DRR, "drr"))
+            .AddAttribute ("DrrQuanta",
+                           "DRR quantum (byte) of the bands class_A, class_B, class_default and class_C",
+                           StringValue ("1500,1500,1500,1500"),
+                           MakeStringAccessor (&TrafficClassQueue::SetDrrQuanta,
+                                               &TrafficClassQueue::GetDrrQuanta),
+                           MakeStringChecker ())
+    ;
+    return tid;
+}
+
+TrafficClassQueue::TrafficClassQueue () :
+    Queue<Packet> (),
+    m_scheduler (STRICT_PRIORITY),
+    m_drr_band (0),
+    m_drr_new_round (true),
+    m_last_change_ns (0)
+{
+    m_quanta.fill(1500);
+    m_band_packets.fill(0);
+    m_deficits.fill(0);
+}
+
+TrafficClassQueue::~TrafficClassQueue ()
+{
+
+}
+
+size_t TrafficClassQueue::GetBand (Ptr<const Packet> item)
+{
+    FlowTosTag tag;
+    if (!item->PeekPacketTag(tag)) {
+        return 2;
+    }
+    switch (Tos2TrafficClass(tag.GetTos())) {
+        case TrafficClass::class_A: return 0;
+        case TrafficClass::class_B: return 1;
+        case TrafficClass::class_C: return 3;
+        default: return 2;
+    }
+}
+
+TrafficClass TrafficClassQueue::GetBandTrafficClass (size_t band)
+{
+    static const TrafficClass classes[NUM_BANDS] = {
+            TrafficClass::class_A, TrafficClass::class_B, TrafficClass::class_default, TrafficClass::class_C
+    };
+    return classes[band];
+}
+
+bool TrafficClassQueue::Enqueue (Ptr<Packet> item)
+{
+    size_t band = GetBand(item);
+
+    // At the end of the band: before the head of the next band which has packets
+    ConstIterator pos = end ();
+    for (size_t b = band + 1; b < NUM_BANDS; b++) {
+        if (m_band_packets[b] > 0) {
+            pos = m_band_heads[b];
+            break;
+        }
+    }
+
+    IntegrateOccupancy();
+    if (!DoEnqueue (pos, item)) {
+        m_statistics[band].dropped_packets += 1;
+        return false;
+    }
+    if (m_band_packets[band] == 0) {
+        m_band_heads[band] = std::prev(pos);
+    }
+    m_band_packets[band] += 1;
+    m_statistics[band].enqueued_packets += 1;
+    m_statistics[band].max_packets = std::max<uint64_t>(m_statistics[band].max_packets, m_band_packets[band]);
+    return true;
+}
+
+Ptr<Packet> TrafficClassQueue::Dequeue (void)
+{
+    if (IsEmpty ()) {
+        return 0;
+    }
+    return RemoveHead(NextBand(), true);
+}
+
+Ptr<Packet> TrafficClassQueue::Remove (void)
+{
+    if (IsEmpty ()) {
+        return 0;
+    }
+
+    // The head of the band which is served next, counted as dropped after dequeue
+    return RemoveHead(PeekBand(), false);
+}
+
+Ptr<const Packet> TrafficClassQueue::Peek (void) const
+{
+    if (IsEmpty ()) {
+        return 0;
+    }
+    return DoPeek (m_band_heads[PeekBand()]);
+}
+
+size_t TrafficClassQueue::NextBand (void)
+{
+    return SelectBand(m_drr_band, m_drr_new_round, m_deficits);
+}
+
+size_t TrafficClassQueue::PeekBand (void) const
+{
+    size_t drr_band = m_drr_band;
+    bool drr_new_round = m_drr_new_round;
+    std::array<uint32_t, NUM_BANDS> deficits = m_deficits;
+    return SelectBand(drr_band, drr_new_round, deficits);
+}
+
+size_t TrafficClassQueue::SelectBand (size_t& drr_band, bool& drr_new_round, std::array<uint32_t, NUM_BANDS>& deficits) const
+{
+    if (m_scheduler == STRICT_PRIORITY) {
+        for (size_t b = 0; b < NUM_BANDS; b++) {
+            if (m_band_packets[b] > 0) {
+                return b;
+            }
+        }
+        NS_ABORT_MSG("No band has packets");
+    }
+
+    // Deficit round robin (the queue has packets, as such it ends within a few rounds)
+    while (true) {
+        size_t b = drr_band;
+        if (m_band_packets[b] == 0) {
+            drr_band = (b + 1) % NUM_BANDS;
+            drr_new_round = true;
+            continue;
+        }
+        if (drr_new_round) {
+            deficits[b] += m_quanta[b];
+            drr_new_round = false;
+        }
+        uint32_t size = (*m_band_heads[b])->GetSize();
+        if (size <= deficits[b]) {
+            deficits[b] -= size;
+            return b;
+        }
+        drr_band = (b + 1) % NUM_BANDS;
+        drr_new_round = true;
+    }
+}
+
+Ptr<Packet> TrafficClassQueue::RemoveHead (size_t band, bool dequeue)
+{
+    ConstIterator head = m_band_heads[band];
+    ConstIterator next = std::next(head);
+    IntegrateOccupancy();
+    Ptr<Packet> item = dequeue ? DoDequeue (head) : DoRemove (head);
+    m_band_packets[band] -= 1;
+    if (m_band_packets[band] > 0) {
+        m_band_heads[band] = next;
+    } else {
+        // An empty band keeps no credit for when it has packets again
+        m_deficits[band] = 0;
+    }
+    return item;
+}
+
+void TrafficClassQueue::IntegrateOccupancy (void)
+{
+    int64_t now_ns = Simulator::Now().GetTimeStep();
+    int64_t duration_ns = now_ns - m_last_change_ns;
+    if (duration_ns > 0) {
+        for (size_t b = 0; b < NUM_BANDS; b++) {
+            m_statistics[b].occupancy_packet_ns += (double) m_band_packets[b] * duration_ns;
+        }
+    }
+    m_last_change_ns = now_ns;
+}
+
+TrafficClassBandStatistics TrafficClassQueue::GetBandStatistics (size_t band)
+{
+    IntegrateOccupancy();
+    return m_statistics[band];
+}
+
+void TrafficClassQueue::ResetStatistics (void)
+{
+    m_statistics.fill(TrafficClassBandStatistics());
+    m_last_change_ns = Simulator::Now().GetTimeStep();
+}
+
+void TrafficClassQueue::SetDrrQuanta (std::string quanta)
+{
+    std::vector<std::string> values = split_string(quanta, ",");
+    NS_ABORT_MSG_IF(values.size() != NUM_BANDS, "DrrQuanta must have a quantum for each of the " + std::to_string(NUM_BANDS) + " bands: " + quanta);
+    for (size_t b = 0; b < NUM_BANDS; b++) {
+        int64_t quantum = parse_positive_int64(values[b]);
+        NS_ABORT_MSG_IF(quantum == 0, "DrrQuanta must be above 0: " + quanta);
+        m_quanta[b] = (uint32_t) quantum;
+    }
+}
+
+std::string TrafficClassQueue::GetDrrQuanta (void) const
+{
+    std::string quanta;
+    for (size_t b = 0; b < NUM_BANDS; b++) {
+        quanta += (b == 0 ? "" : ",") + std::to_string(m_quanta[b]);
+    }
+    return quanta;
+}
+
+}
@@ -0,0 +1,94 @@
+/**
+ * Author:  silent-rookie      2024
+*/
+
+#ifndef TRAFFIC_CLASS_QUEUE_H
+#define TRAFFIC_CLASS_QUEUE_H
+
+#include <array>
+#include <string>
+#include "ns3/queue.h"
+#include "ns3/packet.h"
+#include "ns3/flow-tos-tag.h"
+#include "ns3/traffic-classify-tos.h"
+
+namespace ns3 {
+
+/**
+ * Statistics of a band of a TrafficClassQueue since the start (or the last reset)
+ */
+struct TrafficClassBandStatistics
+{
+    uint64_t enqueued_packets = 0;
+    uint64_t dropped_packets = 0;                       // dropped before enqueue (the queue is full)
+    uint64_t max_packets = 0;                           // highest occupancy
+    double occupancy_packet_ns = 0;                     // occupancy integrated over time (the mean times the duration)
+};
+
+/**
+ * Device queue with one band per traffic class of the FlowTosTag of the packets (class_A,
+ * class_B, class_default which includes the packets without tag, class_C, in that order).
+ * The bands share the MaxSize of the queue (drop-tail); the band which is dequeued is chosen by:
+ *  - strict priority: the first band which is not empty
+ *  - DRR: deficit round robin over the bands, with the quantum of each band (DrrQuanta).
+ *    The deficit of a band is reset as soon as it is empty
+ *
+ * Peek returns the packet which Dequeue returns next. Remove drops that packet without
+ * charging it to the deficit of its band.
+ *
+ * The packets are kept in the list of the queue ordered by band, such that the packets of
+ * a band are consecutive (in their arrival order), and the head of each band is kept.
+ * As the helpers append the item type to the queue type, the TypeId is "ns3::TrafficClassQueue<Packet>".
+ */
+class TrafficClassQueue : public Queue<Packet>
+{
+public:
+    static TypeId GetTypeId (void);
+
+    static const size_t NUM_BANDS = 4;
+    enum Scheduler { STRICT_PRIORITY, DRR };
+
+    TrafficClassQueue ();
+    virtual ~TrafficClassQueue ();
+
+    virtual bool Enqueue (Ptr<Packet> item);
+    virtual Ptr<Packet> Dequeue (void);
+    virtual Ptr<Packet> Remove (void);
+    virtual Ptr<const Packet> Peek (void) const;
+
+    // Band of the packet, and the traffic class of a band
+    static size_t GetBand (Ptr<const Packet> item);
+    static TrafficClass GetBandTrafficClass (size_t band);
+
+    // Statistics of the band until now
+    TrafficClassBandStatistics GetBandStatistics (size_t band);
+    void ResetStatistics (void);
+
+private:
+    void SetDrrQuanta (std::string quanta);
+    std::string GetDrrQuanta (void) const;
+    size_t NextBand (void);
+    size_t PeekBand (void) const;
+    size_t SelectBand (size_t& drr_band, bool& drr_new_round, std::array<uint32_t, NUM_BANDS>& deficits) const;
+    Ptr<Packet> RemoveHead (size_t band, bool dequeue);
+    void IntegrateOccupancy (void);
+
+    Scheduler m_scheduler;
+    std::array<uint32_t, NUM_BANDS> m_quanta;           // DRR quantum of each band (byte)
+
+    // Packets of each band, and the first of them (valid if there is any)
+    std::array<uint32_t, NUM_BANDS> m_band_packets;
+    std::array<ConstIterator, NUM_BANDS> m_band_heads;
+
+    // DRR state
+    size_t m_drr_band;
+    bool m_drr_new_round;
+    std::array<uint32_t, NUM_BANDS> m_deficits;
+
+    std::array<TrafficClassBandStatistics, NUM_BANDS> m_statistics;
+    int64_t m_last_change_ns;
+};
+
+}
+
+#endif //TRAFFIC_CLASS_QUEUE_H
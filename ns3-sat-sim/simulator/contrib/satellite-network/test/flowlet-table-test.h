@@ -0,0 +1,118 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include <string>
+#include <vector>
+
+#include "ns3/basic-simulation.h"
+#include "ns3/flowlet-table.h"
+
+#include "ns3/test.h"
+#include "test-helpers.h"
+#include "satnet-test-run.h"
+
+using namespace ns3;
+
+////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A flow keeps its candidate until no packet of it came for more than the gap, then it is a
+ * flowlet boundary (-1). The entry of a flow is replaced by another flow of which the hash is
+ * in the same entry, or by the same flow to another target, which ends its flowlet early.
+ */
+class FlowletTableGapTestCase : public TestCase {
+public:
+    FlowletTableGapTestCase () : TestCase ("flowlet-table gap") {};
+
+    const int64_t gap_ns = 1000000;
+
+    void DoRun () {
+        const std::string run_dir = ".tmp-flowlet-table-test";
+        WalkerConstellationHelper walker(6, 8, 550000, 53, 12, 1, 10);
+        write_walker_test_run(run_dir, walker, 1000000000, {"flowlet_gap_ns=" + std::to_string(gap_ns), "flowlet_table_size=4"});
+        Ptr<BasicSimulation> basicSimulation = CreateObject<BasicSimulation>(run_dir);
+        FlowletTable::Initialize(basicSimulation);
+        ASSERT_TRUE(FlowletTable::IsEnabled());
+        ASSERT_EQUAL(FlowletTable::GetGapNs(), gap_ns);
+
+        // Empty table
+        FlowletTable table;
+        ASSERT_EQUAL(table.EstimateHeapBytes(), 0);
+        ASSERT_EQUAL(table.GetCandidate(5, 10, 0), -1);
+
+        // Within the gap of the last packet the candidate is kept, up to exactly the gap
+        table.SetCandidate(5, 10, 2, 0);
+        ASSERT_EQUAL(table.GetCandidate(5, 10, gap_ns / 2), 2);
+        table.SetCandidate(5, 10, 2, gap_ns / 2);
+        ASSERT_EQUAL(table.GetCandidate(5, 10, gap_ns / 2 + gap_ns), 2);
+
+        // After the gap a flowlet boundary
+        ASSERT_EQUAL(table.GetCandidate(5, 10, gap_ns / 2 + gap_ns + 1), -1);
+
+        // Another target in the same entry is not the flow
+        table.SetCandidate(5, 10, 1, 3 * gap_ns);
+        ASSERT_EQUAL(table.GetCandidate(5, 11, 3 * gap_ns), -1);
+        table.SetCandidate(5, 11, 0, 3 * gap_ns);
+        ASSERT_EQUAL(table.GetCandidate(5, 11, 3 * gap_ns), 0);
+        ASSERT_EQUAL(table.GetCandidate(5, 10, 3 * gap_ns), -1);
+
+        // A hash in the same entry (5 & 3 == 9 & 3) replaces the flow, one in another entry does not
+        table.SetCandidate(9, 11, 2, 3 * gap_ns);
+        ASSERT_EQUAL(table.GetCandidate(9, 11, 3 * gap_ns), 2);
+        ASSERT_EQUAL(table.GetCandidate(5, 11, 3 * gap_ns), -1);
+        table.SetCandidate(6, 11, 1, 3 * gap_ns);
+        ASSERT_EQUAL(table.GetCandidate(9, 11, 3 * gap_ns), 2);
+        ASSERT_EQUAL(table.GetCandidate(6, 11, 3 * gap_ns), 1);
+        ASSERT_TRUE(table.EstimateHeapBytes() > 0);
+
+        Simulator::Destroy();
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * The hash of a flow is the same at each hop (unlike ArbiterEcmp it has no node salt), from
+ * the headers as well as from the 5-tuple the fluid engine has. The default gap disables it,
+ * a table size which is not a power of two is invalid.
+ */
+class FlowletTableHashConfigTestCase : public TestCase {
+public:
+    FlowletTableHashConfigTestCase () : TestCase ("flowlet-table hash-config") {};
+
+    void DoRun () {
+        const std::string run_dir = ".tmp-flowlet-table-test";
+        WalkerConstellationHelper walker(6, 8, 550000, 53, 12, 1, 10);
+
+        // Hash
+        Ipv4Header header;
+        header.SetSource(Ipv4Address("10.0.0.1"));
+        header.SetDestination(Ipv4Address("10.0.1.1"));
+        header.SetProtocol(UDP_PROT_NUMBER);
+        UdpHeader udpHeader;
+        udpHeader.SetSourcePort(1026);
+        udpHeader.SetDestinationPort(1026);
+        Ptr<Packet> p = Create<Packet>(100);
+        p->AddHeader(udpHeader);
+        FlowletTable table_a;
+        FlowletTable table_b;
+        uint32_t hash = table_a.ComputeFiveTupleHash(header, p, false);
+        ASSERT_EQUAL(table_b.ComputeFiveTupleHash(header, p, false), hash);
+        ASSERT_EQUAL(table_b.ComputeFiveTupleHash(Ipv4Address("10.0.0.1").Get(), Ipv4Address("10.0.1.1").Get(), UDP_PROT_NUMBER, 1026, 1026), hash);
+        ASSERT_NOT_EQUAL(table_b.ComputeFiveTupleHash(Ipv4Address("10.0.0.1").Get(), Ipv4Address("10.0.1.1").Get(), UDP_PROT_NUMBER, 1026, 1027), hash);
+
+        // Disabled by default
+        write_walker_test_run(run_dir, walker, 1000000000, {});
+        Ptr<BasicSimulation> basicSimulation = CreateObject<BasicSimulation>(run_dir);
+        FlowletTable::Initialize(basicSimulation);
+        ASSERT_FALSE(FlowletTable::IsEnabled());
+        Simulator::Destroy();
+
+        // Table size
+        write_walker_test_run(run_dir, walker, 1000000000, {"flowlet_gap_ns=1000000", "flowlet_table_size=1000"});
+        basicSimulation = CreateObject<BasicSimulation>(run_dir);
+        ASSERT_EXCEPTION(FlowletTable::Initialize(basicSimulation));
+        Simulator::Destroy();
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////////////
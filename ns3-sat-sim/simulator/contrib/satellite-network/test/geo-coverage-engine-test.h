@@ -0,0 +1,196 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include <cmath>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "ns3/basic-simulation.h"
+#include "ns3/topology-satellite-network.h"
+#include "ns3/ipv4-arbiter-routing-helper.h"
+#include "ns3/geo-coverage-engine.h"
+
+#include "ns3/test.h"
+#include "test-helpers.h"
+#include "satnet-test-run.h"
+
+using namespace ns3;
+
+////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * The ILL assignment of the coverage engine against ills_<t>.txt files written as satgen_GEO
+ * (ills_calculation.py) writes them: the nearest GEO in ILL range over the positions at t,
+ * only the LEOs whose GEO changed. They are read back as the helper reads them.
+ *
+ * The engine fixes the direction of each GEO at the start, whereas the GEOs of the files move
+ * slightly (TLE eccentricity), as such a different GEO is only allowed if it is as near.
+ */
+class GeoCoverageEngineWalkerTestCase : public TestCase {
+public:
+    GeoCoverageEngineWalkerTestCase () : TestCase ("geo-coverage-engine walker") {};
+
+    const int64_t update_interval_ns = 10000000000;
+    const double geo_drift_tolerance_m = 200000;
+
+    void DoRun () {
+        m_run_dir = ".tmp-geo-coverage-engine-test";
+        WalkerConstellationHelper walker(6, 8, 550000, 53, 12, 3, 10);
+        write_walker_test_run(m_run_dir, walker, 600000000000, {});
+        mkdir_if_not_exists(m_run_dir + "/satellite_network/ills");
+
+        Ptr<BasicSimulation> basicSimulation = CreateObject<BasicSimulation>(m_run_dir);
+        m_topology = CreateObject<TopologySatelliteNetwork>(basicSimulation, Ipv4ArbiterRoutingHelper());
+        m_engine = CreateObject<GeoCoverageEngine>(basicSimulation, m_topology);
+        m_num_sats = m_topology->GetNumSatellites();
+        m_first_geo_node_id = m_num_sats + m_topology->GetNumGroundStations();
+        m_reference_geo = std::vector<int32_t>(m_num_sats, -1);
+        m_engine_geo = std::vector<int32_t>(m_num_sats, -1);
+        m_num_reference_handovers = 0;
+        m_num_engine_handovers = 0;
+        m_num_assignments = 0;
+        m_num_equal_assignments = 0;
+        m_failed = false;
+
+        for (int64_t t = 0; t < basicSimulation->GetSimulationEndTimeNs(); t += update_interval_ns) {
+            Simulator::Schedule(NanoSeconds(t), &GeoCoverageEngineWalkerTestCase::Update, this, t);
+        }
+        Simulator::Run();
+
+        ASSERT_FALSE(m_failed);
+        ASSERT_TRUE(m_num_reference_handovers > 0);
+        ASSERT_EQUAL(m_engine->GetNumHandovers(), m_num_engine_handovers);
+        ASSERT_TRUE(m_num_equal_assignments * 100 >= m_num_assignments * 95);
+
+        Simulator::Destroy();
+    }
+
+    void Update (int64_t t) {
+        NodeContainer nodes = m_topology->GetNodes();
+        int32_t num_geo = m_topology->GetNumGEOSatellites();
+        std::string filename = m_run_dir + "/satellite_network/ills/ills_" + std::to_string(t) + ".txt";
+
+        // ills_<t>.txt as satgen_GEO writes it
+        std::ofstream ills_file(filename);
+        for (int32_t sat = 0; sat < m_num_sats; sat++) {
+            double min_ill_distance_m = m_topology->GetMaxILL_Length_M();
+            int32_t target_geo = -1;
+            for (int32_t geo = 0; geo < num_geo; geo++) {
+                double ill_distance_m = Distance(nodes, sat, m_first_geo_node_id + geo);
+                if (ill_distance_m < min_ill_distance_m) {
+                    min_ill_distance_m = ill_distance_m;
+                    target_geo = geo;
+                }
+            }
+            m_failed = m_failed || target_geo == -1;
+            if (m_reference_geo[sat] != m_first_geo_node_id + target_geo) {
+                ills_file << sat << " " << target_geo << std::endl;
+            }
+        }
+        ills_file.close();
+
+        // Read back (line format: <sat> <GEO index>)
+        for (const std::string& line : read_file_direct(filename)) {
+            std::vector<std::string> space_split = split_string(line, " ", 2);
+            int64_t sat = parse_positive_int64(space_split[0]);
+            int64_t geo = parse_positive_int64(space_split[1]);
+            if (m_reference_geo.at(sat) != -1) {
+                m_num_reference_handovers++;
+            }
+            m_reference_geo.at(sat) = m_first_geo_node_id + geo;
+        }
+
+        // Exactly the changed LEOs are returned
+        std::vector<bool> changed(m_num_sats, false);
+        for (int32_t sat : m_engine->Update()) {
+            changed.at(sat) = true;
+        }
+        for (int32_t sat = 0; sat < m_num_sats; sat++) {
+            int32_t geo_node_id = m_engine->GetNextGEOID(sat);
+            m_failed = m_failed || changed[sat] != (geo_node_id != m_engine_geo[sat]);
+            if (changed[sat] && m_engine_geo[sat] != -1) {
+                m_num_engine_handovers++;
+            }
+            m_engine_geo[sat] = geo_node_id;
+
+            // In range, and the GEO of the file or one as near
+            double distance_m = Distance(nodes, sat, geo_node_id);
+            double reference_distance_m = Distance(nodes, sat, m_reference_geo[sat]);
+            m_failed = m_failed || distance_m >= m_topology->GetMaxILL_Length_M() + geo_drift_tolerance_m;
+            m_failed = m_failed || distance_m > reference_distance_m + geo_drift_tolerance_m;
+            m_num_assignments++;
+            if (geo_node_id == m_reference_geo[sat]) {
+                m_num_equal_assignments++;
+            }
+        }
+    }
+
+private:
+    static double Distance (NodeContainer& nodes, int32_t a, int32_t b) {
+        return nodes.Get(a)->GetObject<MobilityModel>()->GetDistanceFrom(nodes.Get(b)->GetObject<MobilityModel>());
+    }
+
+    std::string m_run_dir;
+    Ptr<TopologySatelliteNetwork> m_topology;
+    Ptr<GeoCoverageEngine> m_engine;
+    int32_t m_num_sats;
+    int32_t m_first_geo_node_id;
+    std::vector<int32_t> m_reference_geo;
+    std::vector<int32_t> m_engine_geo;
+    int64_t m_num_reference_handovers;
+    uint64_t m_num_engine_handovers;
+    int64_t m_num_assignments;
+    int64_t m_num_equal_assignments;
+    bool m_failed;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * With a hysteresis a LEO stays longer with its GEO: never more handovers than without,
+ * and the GEO is always in ILL range (up to the drift of the GEOs).
+ */
+class GeoCoverageEngineHysteresisTestCase : public TestCase {
+public:
+    GeoCoverageEngineHysteresisTestCase () : TestCase ("geo-coverage-engine hysteresis") {};
+
+    void DoRun () {
+        WalkerConstellationHelper walker(6, 8, 550000, 53, 12, 3, 10);
+        std::vector<uint64_t> num_handovers;
+        for (std::string hysteresis_m : {"0", "2000000"}) {
+            const std::string run_dir = ".tmp-geo-coverage-engine-hysteresis-test";
+            write_walker_test_run(run_dir, walker, 600000000000, {"ill_handover_hysteresis_m=" + hysteresis_m});
+            Ptr<BasicSimulation> basicSimulation = CreateObject<BasicSimulation>(run_dir);
+            m_topology = CreateObject<TopologySatelliteNetwork>(basicSimulation, Ipv4ArbiterRoutingHelper());
+            m_engine = CreateObject<GeoCoverageEngine>(basicSimulation, m_topology);
+            m_num_out_of_range = 0;
+            for (int64_t t = 0; t < basicSimulation->GetSimulationEndTimeNs(); t += 10000000000) {
+                Simulator::Schedule(NanoSeconds(t), &GeoCoverageEngineHysteresisTestCase::Update, this);
+            }
+            Simulator::Run();
+            ASSERT_EQUAL(m_num_out_of_range, 0);
+            num_handovers.push_back(m_engine->GetNumHandovers());
+            Simulator::Destroy();
+        }
+        ASSERT_TRUE(num_handovers[0] > 0);
+        ASSERT_TRUE(num_handovers[1] <= num_handovers[0]);
+    }
+
+    void Update () {
+        m_engine->Update();
+        NodeContainer nodes = m_topology->GetNodes();
+        for (uint32_t sat = 0; sat < m_topology->GetNumSatellites(); sat++) {
+            Ptr<MobilityModel> geo_mobility = nodes.Get(m_engine->GetNextGEOID(sat))->GetObject<MobilityModel>();
+            if (nodes.Get(sat)->GetObject<MobilityModel>()->GetDistanceFrom(geo_mobility) >= m_topology->GetMaxILL_Length_M() + 200000) {
+                m_num_out_of_range++;
+            }
+        }
+    }
+
+private:
+    Ptr<TopologySatelliteNetwork> m_topology;
+    Ptr<GeoCoverageEngine> m_engine;
+    int64_t m_num_out_of_range;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,152 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ns3/basic-simulation.h"
+#include "ns3/topology-satellite-network.h"
+#include "ns3/ipv4-arbiter-routing-helper.h"
+#include "ns3/jam-area-membership.h"
+
+#include "ns3/test.h"
+#include "test-helpers.h"
+#include "satnet-test-run.h"
+
+using namespace ns3;
+
+////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * The membership against the one calculated from the distance (brute force), as areas are
+ * added and removed: more areas than the bits of one mask word, areas added at the time
+ * of the positions (only their own bit is calculated) and after the LEOs moved. Removing an
+ * area and adding it again (into a freed slot) gives the same membership as before.
+ */
+class JamAreaMembershipAddRemoveTestCase : public TestCase {
+public:
+    JamAreaMembershipAddRemoveTestCase () : TestCase ("jam-area-membership add-remove") {};
+
+    const size_t num_areas = 70;
+    const double radius_m = 1500000;
+
+    void DoRun () {
+        const std::string run_dir = ".tmp-jam-area-membership-test";
+        WalkerConstellationHelper walker(6, 8, 550000, 53, 12, 1, 10);
+        write_walker_test_run(run_dir, walker, 600000000000, {});
+
+        Ptr<BasicSimulation> basicSimulation = CreateObject<BasicSimulation>(run_dir);
+        m_topology = CreateObject<TopologySatelliteNetwork>(basicSimulation, Ipv4ArbiterRoutingHelper());
+        m_membership = CreateObject<JamAreaMembership>(basicSimulation, m_topology);
+
+        // Areas around the LEOs at the start (each LEO is in at least one)
+        NodeContainer nodes = m_topology->GetNodes();
+        for (size_t i = 0; i < num_areas; i++) {
+            Vector position = nodes.Get(i % m_topology->GetNumSatellites())->GetObject<MobilityModel>()->GetPosition();
+            m_areas.push_back(std::make_shared<Vector>(position.x + (i / m_topology->GetNumSatellites()) * 500000.0, position.y, position.z));
+        }
+        m_added = std::vector<bool>(num_areas, false);
+        m_num_inside = 0;
+        m_failed = false;
+
+        Simulator::Schedule(NanoSeconds(0), &JamAreaMembershipAddRemoveTestCase::AddRemove, this);
+        Simulator::Schedule(NanoSeconds(200000000000), &JamAreaMembershipAddRemoveTestCase::AddRemove, this);
+        Simulator::Schedule(NanoSeconds(400000000000), &JamAreaMembershipAddRemoveTestCase::RemoveAll, this);
+        Simulator::Run();
+
+        ASSERT_FALSE(m_failed);
+        ASSERT_TRUE(m_num_inside > 0);
+
+        Simulator::Destroy();
+    }
+
+    void AddRemove () {
+
+        // All added (the first time into new slots, later into the freed ones)
+        for (size_t i = 0; i < num_areas; i++) {
+            if (!m_added[i]) {
+                m_membership->AddArea(m_areas[i]);
+                m_added[i] = true;
+            }
+        }
+        Check();
+        std::vector<std::vector<bool>> before = Membership();
+
+        // Every third removed, the others keep their membership
+        for (size_t i = 0; i < num_areas; i += 3) {
+            m_membership->RemoveArea(m_areas[i]);
+            m_added[i] = false;
+        }
+        Check();
+
+        // Added again, the same as before
+        for (size_t i = 0; i < num_areas; i += 3) {
+            m_membership->AddArea(m_areas[i]);
+            m_added[i] = true;
+        }
+        Check();
+        m_failed = m_failed || Membership() != before;
+
+        // Removed again, to be added after the LEOs moved
+        for (size_t i = 1; i < num_areas; i += 2) {
+            m_membership->RemoveArea(m_areas[i]);
+            m_added[i] = false;
+        }
+        Check();
+    }
+
+    void RemoveAll () {
+        for (size_t i = 0; i < num_areas; i++) {
+            if (m_added[i]) {
+                m_membership->RemoveArea(m_areas[i]);
+                m_added[i] = false;
+            }
+        }
+        for (uint32_t sat = 0; sat < m_topology->GetNumSatellites(); sat++) {
+            m_failed = m_failed || m_membership->IsInAnyArea(sat);
+        }
+
+        // An area added into an emptied mask
+        m_membership->AddArea(m_areas[0]);
+        m_added[0] = true;
+        Check();
+    }
+
+private:
+    std::vector<std::vector<bool>> Membership () {
+        std::vector<std::vector<bool>> membership(m_topology->GetNumSatellites(), std::vector<bool>(num_areas, false));
+        for (uint32_t sat = 0; sat < m_topology->GetNumSatellites(); sat++) {
+            for (size_t i = 0; i < num_areas; i++) {
+                membership[sat][i] = m_added[i] && m_membership->IsInArea(sat, m_areas[i]);
+            }
+        }
+        return membership;
+    }
+
+    void Check () {
+        NodeContainer nodes = m_topology->GetNodes();
+        for (uint32_t sat = 0; sat < m_topology->GetNumSatellites(); sat++) {
+            Vector position = nodes.Get(sat)->GetObject<MobilityModel>()->GetPosition();
+            bool in_any = false;
+            for (size_t i = 0; i < num_areas; i++) {
+                if (!m_added[i]) {
+                    continue;
+                }
+                bool inside = CalculateDistance(position, *m_areas[i]) < radius_m;
+                m_failed = m_failed || m_membership->IsInArea(sat, m_areas[i]) != inside;
+                in_any = in_any || inside;
+                m_num_inside += inside ? 1 : 0;
+            }
+            m_failed = m_failed || m_membership->IsInAnyArea(sat) != in_any;
+        }
+    }
+
+    Ptr<TopologySatelliteNetwork> m_topology;
+    Ptr<JamAreaMembership> m_membership;
+    std::vector<std::shared_ptr<Vector>> m_areas;
+    std::vector<bool> m_added;
+    int64_t m_num_inside;
+    bool m_failed;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,117 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ns3/basic-simulation.h"
+#include "ns3/topology-satellite-network.h"
+#include "ns3/ipv4-arbiter-routing-helper.h"
+#include "ns3/satellite-position-mobility-model.h"
+#include "ns3/jam-area-predictor.h"
+
+#include "ns3/test.h"
+#include "test-helpers.h"
+#include "satnet-test-run.h"
+
+using namespace ns3;
+
+////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * The membership of the predictor against the one calculated from the distance (brute force)
+ * every second. A predicted crossing is at most one resolution after the exact crossing, so:
+ *  - The membership is the one at t, or the one at t - resolution
+ *  - At the predicted time of entering the LEO is inside, one resolution before it is outside
+ * Halfway the area is removed again, after which no LEO is in it.
+ */
+class JamAreaPredictorWalkerTestCase : public TestCase {
+public:
+    JamAreaPredictorWalkerTestCase () : TestCase ("jam-area-predictor walker") {};
+
+    const int64_t resolution_ns = 1000000;
+    const int64_t sample_interval_ns = 1000000000;
+    const int64_t remove_area_ns = 400000000000;
+    const double radius_m = 1500000;
+
+    void DoRun () {
+        const std::string run_dir = ".tmp-jam-area-predictor-test";
+        WalkerConstellationHelper walker(6, 8, 550000, 53, 12, 1, 10);
+        write_walker_test_run(run_dir, walker, 600000000000, {"trafic_jam_prediction_resolution_ns=" + std::to_string(resolution_ns)});
+
+        Ptr<BasicSimulation> basicSimulation = CreateObject<BasicSimulation>(run_dir);
+        m_topology = CreateObject<TopologySatelliteNetwork>(basicSimulation, Ipv4ArbiterRoutingHelper());
+        m_predictor = CreateObject<JamAreaPredictor>(basicSimulation, m_topology);
+
+        // The area where LEO 0 starts, the LEOs after it in its orbit pass it later
+        m_area = std::make_shared<Vector>(Position(0, 0));
+        m_predictor->AddArea(m_area);
+        m_removed = false;
+        m_num_samples_inside = 0;
+        m_num_predicted_enters = 0;
+        m_failed = false;
+
+        for (int64_t t = sample_interval_ns / 2; t < basicSimulation->GetSimulationEndTimeNs(); t += sample_interval_ns) {
+            Simulator::Schedule(NanoSeconds(t), &JamAreaPredictorWalkerTestCase::Sample, this, t);
+        }
+        Simulator::Schedule(NanoSeconds(remove_area_ns), &JamAreaPredictorWalkerTestCase::RemoveArea, this);
+        Simulator::Run();
+
+        ASSERT_FALSE(m_failed);
+        ASSERT_TRUE(m_predictor->GetNumCrossings() > 0);
+        ASSERT_TRUE(m_num_samples_inside > 0);
+        ASSERT_TRUE(m_num_predicted_enters > 0);
+
+        Simulator::Destroy();
+    }
+
+    void Sample (int64_t t) {
+        for (uint32_t sat = 0; sat < m_topology->GetNumSatellites(); sat++) {
+            if (m_removed) {
+                m_failed = m_failed || m_predictor->IsInAnyArea(sat) || m_predictor->GetTimeUntilEnter(sat) != Time::Max();
+                continue;
+            }
+
+            // Membership
+            bool inside = m_predictor->IsInArea(sat, m_area);
+            m_failed = m_failed || inside != m_predictor->IsInAnyArea(sat);
+            m_failed = m_failed || (inside != IsInside(sat, t) && inside != IsInside(sat, t - resolution_ns));
+            m_num_samples_inside += inside ? 1 : 0;
+
+            // Predicted time of entering
+            Time until_enter = m_predictor->GetTimeUntilEnter(sat);
+            if (inside) {
+                m_failed = m_failed || !until_enter.IsZero();
+            } else if (until_enter != Time::Max()) {
+                int64_t enter_ns = t + until_enter.GetTimeStep();
+                m_failed = m_failed || !IsInside(sat, enter_ns) || IsInside(sat, enter_ns - resolution_ns);
+                m_num_predicted_enters++;
+            }
+        }
+    }
+
+    void RemoveArea () {
+        m_predictor->RemoveArea(m_area);
+        m_removed = true;
+    }
+
+private:
+    Vector Position (int32_t sat, int64_t t_ns) {
+        Ptr<SatellitePositionMobilityModel> mobility = m_topology->GetNodes().Get(sat)->GetObject<SatellitePositionMobilityModel>();
+        return mobility->GetSatellite()->GetPosition(mobility->GetStartTime() + NanoSeconds(t_ns));
+    }
+
+    bool IsInside (int32_t sat, int64_t t_ns) {
+        return CalculateDistance(Position(sat, t_ns), *m_area) < radius_m;
+    }
+
+    Ptr<TopologySatelliteNetwork> m_topology;
+    Ptr<JamAreaPredictor> m_predictor;
+    std::shared_ptr<Vector> m_area;
+    bool m_removed;
+    int64_t m_num_samples_inside;
+    int64_t m_num_predicted_enters;
+    bool m_failed;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////
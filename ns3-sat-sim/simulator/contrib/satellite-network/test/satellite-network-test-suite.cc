@@ -7,6 +7,13 @@
 #include "satellite-info-test.h"
 #include "ground-station-info-test.h"
 #include "end-to-end-special-test.h"
+#include "satnet-routing-engine-test.h"
+#include "geo-coverage-engine-test.h"
+#include "jam-area-predictor-test.h"
+#include "jam-area-membership-test.h"
+#include "flowlet-table-test.h"
+#include "traffic-class-queue-test.h"
+#include "walker-constellation-test.h"
 
 using namespace ns3;
 
@@ -31,6 +38,35 @@ public:
         AddTestCase(new SatelliteInfoTestCase, TestCase::QUICK);
         AddTestCase(new GroundStationInfoTestCase, TestCase::QUICK);
 
+        // In-simulator routing engine
+        AddTestCase(new SatnetRoutingEngineDropTestCase, TestCase::QUICK);
+        AddTestCase(new SatnetRoutingEngineWalkerTestCase, TestCase::QUICK);
+
+        // In-simulator ILL assignment
+        AddTestCase(new GeoCoverageEngineWalkerTestCase, TestCase::QUICK);
+        AddTestCase(new GeoCoverageEngineHysteresisTestCase, TestCase::QUICK);
+
+        // Predicted jam area crossings
+        AddTestCase(new JamAreaPredictorWalkerTestCase, TestCase::QUICK);
+
+        // Polled jam area membership
+        AddTestCase(new JamAreaMembershipAddRemoveTestCase, TestCase::QUICK);
+
+        // Flowlets of the LEO and GS arbiters
+        AddTestCase(new FlowletTableGapTestCase, TestCase::QUICK);
+        AddTestCase(new FlowletTableHashConfigTestCase, TestCase::QUICK);
+
+        // Device queue with a band per traffic class
+        AddTestCase(new TrafficClassQueueStrictPriorityTestCase, TestCase::QUICK);
+        AddTestCase(new TrafficClassQueueDrrTestCase, TestCase::QUICK);
+        AddTestCase(new TrafficClassQueueDropsTestCase, TestCase::QUICK);
+        AddTestCase(new TrafficClassQueuePeekTestCase, TestCase::QUICK);
+
+        // Synthetic Walker-delta constellations
+        AddTestCase(new WalkerConstellationFilesTestCase, TestCase::QUICK);
+        AddTestCase(new WalkerConstellationTopologyTestCase, TestCase::QUICK);
+        AddTestCase(new WalkerConstellationInvalidTestCase, TestCase::QUICK);
+
     }
 };
 static SatelliteNetworkTestSuite SatelliteNetworkTestSuite;
@@ -0,0 +1,212 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include <array>
+#include <string>
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+#include "ns3/basic-simulation.h"
+#include "ns3/topology-satellite-network.h"
+#include "ns3/ipv4-arbiter-routing-helper.h"
+#include "ns3/satnet-routing-engine.h"
+#include "ns3/next-hop-candidates.h"
+
+#include "ns3/test.h"
+#include "test-helpers.h"
+#include "satnet-test-run.h"
+
+using namespace ns3;
+
+////////////////////////////////////////////////////////////////////////////////////////
+
+class SatnetRoutingEngineDropTestCase : public TestCase {
+public:
+    SatnetRoutingEngineDropTestCase () : TestCase ("satnet-routing-engine drop") {};
+
+    void DoRun () {
+
+        // A drop of an fstate file is the drop of the routing engine
+        int64_t current_node_id;
+        int64_t target_node_id;
+        std::array<std::array<int64_t, 3>, 3> next_hops;
+        ParseFstateLine<3>("7,12,3,1,0,-1,-1,-1,-1,-1,-1", current_node_id, target_node_id, next_hops);
+        ASSERT_EQUAL(current_node_id, 7);
+        ASSERT_EQUAL(target_node_id, 12);
+        ASSERT_TRUE(FstateNextHop(next_hops[0][0], next_hops[0][1], next_hops[0][2]) == NextHop(3, 2, 1));
+        ASSERT_TRUE(FstateNextHop(next_hops[1][0], next_hops[1][1], next_hops[1][2]) == DROP_NEXT_HOP);
+        ASSERT_TRUE(FstateNextHop(next_hops[2][0], next_hops[2][1], next_hops[2][2]) == DROP_NEXT_HOP);
+
+        // Anything else than all three -1 is not a drop
+        ASSERT_TRUE(FstateNextHop(-1, 0, 0) != DROP_NEXT_HOP);
+
+    }
+
+};
+
+////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * The forwarding state of the routing engine against the one of satgen (algorithm_free_one_only_over_isls_ills),
+ * calculated here over the same positions, and read back as an fstate file.
+ */
+class SatnetRoutingEngineWalkerTestCase : public TestCase {
+public:
+    SatnetRoutingEngineWalkerTestCase () : TestCase ("satnet-routing-engine walker") {};
+
+    void DoRun () {
+        const std::string run_dir = ".tmp-satnet-routing-engine-test";
+        WalkerConstellationHelper walker(6, 8, 550000, 53, 12, 1, 10);
+        write_walker_test_run(run_dir, walker, 1000000000, {"routing_engine=in_simulator"});
+
+        Ptr<BasicSimulation> basicSimulation = CreateObject<BasicSimulation>(run_dir);
+        Ptr<TopologySatelliteNetwork> topology = CreateObject<TopologySatelliteNetwork>(basicSimulation, Ipv4ArbiterRoutingHelper());
+        Ptr<SatnetRoutingEngine> engine = CreateObject<SatnetRoutingEngine>(basicSimulation, topology);
+        engine->Calculate();
+
+        // Graph at t = 0
+        int32_t num_sats = topology->GetNumSatellites();
+        int32_t num_gs = topology->GetNumGroundStations();
+        NodeContainer nodes = topology->GetNodes();
+        std::vector<Vector> positions;
+        for (int32_t i = 0; i < num_sats + num_gs; i++) {
+            positions.push_back(nodes.Get(i)->GetObject<MobilityModel>()->GetPosition());
+        }
+        const double inf = std::numeric_limits<double>::infinity();
+        std::vector<std::vector<double>> isl_length_m(num_sats, std::vector<double>(num_sats, inf));
+        for (int32_t sat = 0; sat < num_sats; sat++) {
+            for (uint32_t i = 1; i <= 4; i++) {
+                const IslNeighbor& neighbor = topology->GetIslNeighbor(sat, i);
+                if (neighbor.node_id != -1) {
+                    isl_length_m[sat][neighbor.node_id] = CalculateDistance(positions[sat], positions[neighbor.node_id]);
+                }
+            }
+        }
+
+        // Shortest distance from each satellite (Dijkstra, each distance the sum along the path from
+        // the source as in the routing engine, such that equal distances are equal to the bit)
+        std::vector<std::vector<double>> dist_from(num_sats, std::vector<double>(num_sats, inf));
+        for (int32_t source = 0; source < num_sats; source++) {
+            std::vector<double>& dist = dist_from[source];
+            std::vector<bool> done(num_sats, false);
+            dist[source] = 0;
+            for (int32_t n = 0; n < num_sats; n++) {
+                int32_t u = -1;
+                for (int32_t v = 0; v < num_sats; v++) {
+                    if (!done[v] && dist[v] != inf && (u == -1 || dist[v] < dist[u])) {
+                        u = v;
+                    }
+                }
+                if (u == -1) {
+                    break;
+                }
+                done[u] = true;
+                for (int32_t v = 0; v < num_sats; v++) {
+                    if (isl_length_m[u][v] != inf && dist[u] + isl_length_m[u][v] < dist[v]) {
+                        dist[v] = dist[u] + isl_length_m[u][v];
+                    }
+                }
+            }
+        }
+        std::vector<std::vector<std::pair<double, int32_t>>> gs_in_range(num_gs);
+        for (int32_t gid = 0; gid < num_gs; gid++) {
+            for (int32_t sat = 0; sat < num_sats; sat++) {
+                double distance_m = CalculateDistance(positions[num_sats + gid], positions[sat]);
+                if (distance_m <= topology->GetMaxGSL_Length_M()) {
+                    gs_in_range[gid].push_back(std::make_pair(distance_m, sat));
+                }
+            }
+        }
+
+        // Forwarding state as satgen writes it (interfaces without the loop-back interface, -1 for drops)
+        std::vector<std::string> fstate_lines;
+        std::vector<std::vector<double>> sat_to_gs_distance_m(num_sats, std::vector<double>(num_gs, inf));
+        int64_t num_drops = 0;
+        for (int32_t curr = 0; curr < num_sats; curr++) {
+            for (int32_t dst_gid = 0; dst_gid < num_gs; dst_gid++) {
+                std::vector<std::array<int64_t, 3>> next_hop_lists(3, {-1, -1, -1});
+                std::vector<std::pair<double, int32_t>> possibilities;
+                for (const std::pair<double, int32_t>& b : gs_in_range[dst_gid]) {
+                    if (dist_from[b.second][curr] != inf) {
+                        possibilities.push_back(std::make_pair(dist_from[b.second][curr] + b.first, b.second));
+                    }
+                }
+                std::sort(possibilities.begin(), possibilities.end());
+                if (!possibilities.empty()) {
+                    int32_t dst_sat = possibilities[0].second;
+                    sat_to_gs_distance_m[curr][dst_gid] = possibilities[0].first;
+                    if (curr != dst_sat) {
+                        std::vector<std::tuple<double, int32_t, int32_t, int32_t>> candidates;
+                        for (uint32_t i = 1; i <= 4; i++) {
+                            const IslNeighbor& neighbor = topology->GetIslNeighbor(curr, i);
+                            if (neighbor.node_id != -1) {
+                                candidates.push_back(std::make_tuple(
+                                        isl_length_m[curr][neighbor.node_id] + dist_from[dst_sat][neighbor.node_id],
+                                        neighbor.node_id, i - 1, neighbor.interface - 1
+                                ));
+                            }
+                        }
+                        std::sort(candidates.begin(), candidates.end());
+                        for (size_t i = 0; i < candidates.size() && i < 3; i++) {
+                            next_hop_lists[i] = {std::get<1>(candidates[i]), std::get<2>(candidates[i]), std::get<3>(candidates[i])};
+                        }
+                    } else {
+                        next_hop_lists[0] = {num_sats + dst_gid, 4, 0};
+                    }
+                } else {
+                    num_drops++;
+                }
+                fstate_lines.push_back(FstateLine(curr, num_sats + dst_gid, next_hop_lists));
+            }
+        }
+        for (int32_t src_gid = 0; src_gid < num_gs; src_gid++) {
+            for (int32_t dst_gid = 0; dst_gid < num_gs; dst_gid++) {
+                if (src_gid == dst_gid) {
+                    continue;
+                }
+                std::vector<std::array<int64_t, 3>> next_hop_lists(3, {-1, -1, -1});
+                std::vector<std::pair<double, int32_t>> possibilities;
+                for (const std::pair<double, int32_t>& a : gs_in_range[src_gid]) {
+                    if (sat_to_gs_distance_m[a.second][dst_gid] != inf) {
+                        possibilities.push_back(std::make_pair(a.first + sat_to_gs_distance_m[a.second][dst_gid], a.second));
+                    }
+                }
+                std::sort(possibilities.begin(), possibilities.end());
+                for (size_t i = 0; i < possibilities.size() && i < 3; i++) {
+                    next_hop_lists[i] = {possibilities[i].second, 0, 4};
+                }
+                fstate_lines.push_back(FstateLine(num_sats + src_gid, num_sats + dst_gid, next_hop_lists));
+            }
+        }
+
+        // The coverage of this constellation has gaps, as such drops are compared as well
+        ASSERT_TRUE(num_drops > 0);
+
+        // Read back as the helper reads an fstate file, it must be exactly the state of the routing engine
+        for (const std::string& line : fstate_lines) {
+            int64_t current_node_id;
+            int64_t target_node_id;
+            std::array<std::array<int64_t, 3>, 3> next_hops;
+            ParseFstateLine<3>(line, current_node_id, target_node_id, next_hops);
+            const std::vector<NextHop>& engine_list = engine->GetForwardState(current_node_id, target_node_id);
+            ASSERT_EQUAL(engine_list.size(), 3);
+            for (size_t i = 0; i < 3; i++) {
+                ASSERT_TRUE(FstateNextHop(next_hops[i][0], next_hops[i][1], next_hops[i][2]) == engine_list[i]);
+            }
+        }
+
+        Simulator::Destroy();
+    }
+
+private:
+    static std::string FstateLine(int32_t current, int32_t target, const std::vector<std::array<int64_t, 3>>& next_hop_lists) {
+        std::string line = std::to_string(current) + "," + std::to_string(target);
+        for (const std::array<int64_t, 3>& next_hop : next_hop_lists) {
+            line += "," + std::to_string(next_hop[0]) + "," + std::to_string(next_hop[1]) + "," + std::to_string(next_hop[2]);
+        }
+        return line;
+    }
+
+};
+
+////////////////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,54 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef SATNET_TEST_RUN_H
+#define SATNET_TEST_RUN_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "ns3/basic-simulation.h"
+#include "ns3/walker-constellation-helper.h"
+
+using namespace ns3;
+
+/**
+ * Writes a run directory of a synthetic Walker-delta constellation (in <run_dir>/satellite_network,
+ * its routes calculated in the simulator) with the config of the satellite network, followed by
+ * the extra config lines.
+ */
+void write_walker_test_run(
+        const std::string& run_dir,
+        WalkerConstellationHelper& walker,
+        int64_t simulation_end_time_ns,
+        const std::vector<std::string>& extra_config
+) {
+    mkdir_if_not_exists(run_dir);
+    walker.Write(run_dir + "/satellite_network");
+
+    std::ofstream config_file(run_dir + "/config_ns3.properties");
+    config_file << "simulation_end_time_ns=" << simulation_end_time_ns << std::endl;
+    config_file << "simulation_seed=123456789" << std::endl;
+    config_file << "satellite_network_dir=\"satellite_network\"" << std::endl;
+    config_file << "satellite_network_routes_dir=\"satellite_network\"" << std::endl;
+    config_file << "dynamic_state_update_interval_ns=100000000" << std::endl;
+    config_file << "isl_data_rate_megabit_per_s=10.0" << std::endl;
+    config_file << "gsl_data_rate_megabit_per_s=10.0" << std::endl;
+    config_file << "ill_data_rate_megabit_per_s=10.0" << std::endl;
+    config_file << "isl_max_queue_size_pkt=100" << std::endl;
+    config_file << "gsl_max_queue_size_pkt=100" << std::endl;
+    config_file << "ill_max_queue_size_pkt=100" << std::endl;
+    config_file << "receive_datarate_update_interval_ns=20000000" << std::endl;
+    config_file << "trafic_judge_rate_non_jam=0.4" << std::endl;
+    config_file << "trafic_judge_rate_in_jam=0.3" << std::endl;
+    config_file << "trafic_judge_rate_jam_to_normal=0.6" << std::endl;
+    config_file << "trafic_jam_area_radius_m=1500000" << std::endl;
+    config_file << "trafic_jam_update_interval_ns=100000000" << std::endl;
+    config_file << "enable_isl_utilization_tracking=false" << std::endl;
+    for (const std::string& line : extra_config) {
+        config_file << line << std::endl;
+    }
+    config_file.close();
+}
+
+#endif //SATNET_TEST_RUN_H
@@ -0,0 +1,243 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "ns3/traffic-class-queue.h"
+#include "ns3/enum.h"
+#include "ns3/string.h"
+
+#include "ns3/test.h"
+#include "test-helpers.h"
+
+using namespace ns3;
+
+////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Queue with the given scheduler, of which each packet of a band (class_A, class_B,
+ * class_default without tag, class_C) is checked to be the one Peek returned before it.
+ */
+class TrafficClassQueueTestCase : public TestCase
+{
+public:
+    TrafficClassQueueTestCase (std::string name) : TestCase (name) {};
+
+    void Setup (std::string scheduler, std::string drr_quanta, std::string max_size) {
+        m_queue = CreateObject<TrafficClassQueue>();
+        m_queue->SetAttribute("Scheduler", EnumValue(scheduler == "drr" ? TrafficClassQueue::DRR : TrafficClassQueue::STRICT_PRIORITY));
+        m_queue->SetAttribute("DrrQuanta", StringValue(drr_quanta));
+        m_queue->SetAttribute("MaxSize", QueueSizeValue(QueueSize(max_size)));
+    }
+
+    Ptr<Packet> CreateBandPacket (size_t band, uint32_t size_byte) {
+        Ptr<Packet> p = Create<Packet>(size_byte);
+        if (band != 2) {
+            FlowTosTag tag;
+            tag.SetTos((uint8_t) TrafficClassQueue::GetBandTrafficClass(band));
+            p->AddPacketTag(tag);
+        }
+        return p;
+    }
+
+    bool Enqueue (size_t band, uint32_t size_byte) {
+        return m_queue->Enqueue(CreateBandPacket(band, size_byte));
+    }
+
+    // Band of the packet which Dequeue returns (it must be the one Peek returned)
+    size_t Dequeue () {
+        Ptr<const Packet> peeked = m_queue->Peek();
+        Ptr<Packet> p = m_queue->Dequeue();
+        NS_ABORT_MSG_IF(p == 0 || peeked == 0 || peeked->GetUid() != p->GetUid(), "Peek is not the packet of Dequeue");
+        m_last_size_byte = p->GetSize();
+        return TrafficClassQueue::GetBand(p);
+    }
+
+protected:
+    Ptr<TrafficClassQueue> m_queue;
+    uint32_t m_last_size_byte;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////
+
+class TrafficClassQueueStrictPriorityTestCase : public TrafficClassQueueTestCase
+{
+public:
+    TrafficClassQueueStrictPriorityTestCase () : TrafficClassQueueTestCase ("traffic-class-queue strict-priority") {};
+    void DoRun () {
+        Setup("strict_priority", "1500,1500,1500,1500", "100p");
+        ASSERT_EQUAL(TrafficClassQueue::GetBand(Create<Packet>(100)), 2);
+
+        // Interleaved arrivals: each band in its arrival order, the bands in priority order
+        std::vector<uint32_t> sizes[TrafficClassQueue::NUM_BANDS];
+        for (uint32_t i = 0; i < 40; i++) {
+            size_t band = (i * 3 + i / 4) % TrafficClassQueue::NUM_BANDS;
+            ASSERT_TRUE(Enqueue(band, 100 + i));
+            sizes[band].push_back(100 + i);
+        }
+        for (size_t band = 0; band < TrafficClassQueue::NUM_BANDS; band++) {
+            for (uint32_t size_byte : sizes[band]) {
+                ASSERT_EQUAL(Dequeue(), band);
+                ASSERT_EQUAL(m_last_size_byte, size_byte);
+            }
+        }
+        ASSERT_TRUE(m_queue->IsEmpty());
+        ASSERT_TRUE(m_queue->Dequeue() == 0);
+        ASSERT_TRUE(m_queue->Peek() == 0);
+
+        // A packet of a higher band arriving later is served first
+        ASSERT_TRUE(Enqueue(3, 100));
+        ASSERT_TRUE(Enqueue(2, 100));
+        ASSERT_EQUAL(Dequeue(), 2);
+        ASSERT_TRUE(Enqueue(0, 100));
+        ASSERT_TRUE(Enqueue(3, 100));
+        ASSERT_EQUAL(Dequeue(), 0);
+        ASSERT_EQUAL(Dequeue(), 3);
+        ASSERT_EQUAL(Dequeue(), 3);
+        ASSERT_TRUE(m_queue->IsEmpty());
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////////////
+
+class TrafficClassQueueDrrTestCase : public TrafficClassQueueTestCase
+{
+public:
+    TrafficClassQueueDrrTestCase () : TrafficClassQueueTestCase ("traffic-class-queue drr") {};
+    void DoRun () {
+
+        // Backlogged bands get bytes in proportion to their quantum, none is starved
+        Setup("drr", "3000,1500,1500,1000", "1000p");
+        std::mt19937_64 rng(123456789);
+        for (size_t band = 0; band < TrafficClassQueue::NUM_BANDS; band++) {
+            for (int i = 0; i < 200; i++) {
+                ASSERT_TRUE(Enqueue(band, 500 + rng() % 1001));
+            }
+        }
+        std::vector<uint64_t> bytes(TrafficClassQueue::NUM_BANDS, 0);
+        for (int i = 0; i < 300; i++) {
+            size_t band = Dequeue();
+            bytes[band] += m_last_size_byte;
+        }
+        for (size_t band = 0; band < TrafficClassQueue::NUM_BANDS; band++) {
+            ASSERT_TRUE(bytes[band] > 0);
+        }
+        // each band is within a packet (and a quantum) of its share
+        ASSERT_TRUE(std::abs((double) bytes[0] - 2.0 * bytes[1]) <= 2 * (1500 + 3000));
+        ASSERT_TRUE(std::abs((double) bytes[1] - bytes[2]) <= 1500 + 1500);
+        ASSERT_TRUE(std::abs(1.5 * bytes[3] - bytes[2]) <= 1.5 * (1500 + 1500));
+
+        // An empty band keeps no credit: class_A is empty after one small packet, and when it has
+        // packets again it gets no more than its quantum before the other band
+        Setup("drr", "3000,1500,1500,1500", "1000p");
+        ASSERT_TRUE(Enqueue(0, 100));
+        ASSERT_TRUE(Enqueue(3, 1500));
+        ASSERT_EQUAL(Dequeue(), 0);
+        for (int i = 0; i < 10; i++) {
+            ASSERT_TRUE(Enqueue(0, 1000));
+            ASSERT_TRUE(Enqueue(3, 1500));
+        }
+        ASSERT_EQUAL(Dequeue(), 3);
+        ASSERT_EQUAL(Dequeue(), 0);
+        ASSERT_EQUAL(Dequeue(), 0);
+        ASSERT_EQUAL(Dequeue(), 0);
+        ASSERT_EQUAL(Dequeue(), 3);
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////////////
+
+class TrafficClassQueueDropsTestCase : public TrafficClassQueueTestCase
+{
+public:
+    TrafficClassQueueDropsTestCase () : TrafficClassQueueTestCase ("traffic-class-queue drops") {};
+    void DoRun () {
+
+        // The bands share the max size: the arrivals of whichever band when full are dropped
+        Setup("strict_priority", "1500,1500,1500,1500", "5p");
+        for (int i = 0; i < 3; i++) {
+            ASSERT_TRUE(Enqueue(3, 1000));
+        }
+        ASSERT_TRUE(Enqueue(0, 1000));
+        ASSERT_TRUE(Enqueue(1, 1000));
+        ASSERT_FALSE(Enqueue(0, 1000));
+        ASSERT_FALSE(Enqueue(3, 1000));
+        ASSERT_FALSE(Enqueue(3, 1000));
+        ASSERT_EQUAL(Dequeue(), 0);
+        ASSERT_TRUE(Enqueue(2, 1000));
+
+        TrafficClassBandStatistics a = m_queue->GetBandStatistics(0);
+        TrafficClassBandStatistics b = m_queue->GetBandStatistics(1);
+        TrafficClassBandStatistics d = m_queue->GetBandStatistics(2);
+        TrafficClassBandStatistics c = m_queue->GetBandStatistics(3);
+        ASSERT_EQUAL(a.enqueued_packets, 1);
+        ASSERT_EQUAL(a.dropped_packets, 1);
+        ASSERT_EQUAL(b.enqueued_packets, 1);
+        ASSERT_EQUAL(b.dropped_packets, 0);
+        ASSERT_EQUAL(d.enqueued_packets, 1);
+        ASSERT_EQUAL(d.dropped_packets, 0);
+        ASSERT_EQUAL(c.enqueued_packets, 3);
+        ASSERT_EQUAL(c.dropped_packets, 2);
+        ASSERT_EQUAL(c.max_packets, 3);
+
+        // Reset
+        m_queue->ResetStatistics();
+        ASSERT_EQUAL(m_queue->GetBandStatistics(3).enqueued_packets, 0);
+        ASSERT_EQUAL(m_queue->GetBandStatistics(0).dropped_packets, 0);
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Peek does not change which packet is served: the same arrivals served with and without
+ * a Peek before each Dequeue give the same packets. Remove drops the packet Peek returns,
+ * and it is not charged to the deficit of its band.
+ */
+class TrafficClassQueuePeekTestCase : public TrafficClassQueueTestCase
+{
+public:
+    TrafficClassQueuePeekTestCase () : TrafficClassQueueTestCase ("traffic-class-queue peek") {};
+    void DoRun () {
+        for (std::string scheduler : {"strict_priority", "drr"}) {
+            std::vector<uint32_t> served[2];
+            for (int with_peek = 0; with_peek < 2; with_peek++) {
+                Setup(scheduler, "3000,1500,1500,1000", "1000p");
+                std::mt19937_64 rng(123456789);
+                for (int i = 0; i < 2000; i++) {
+                    if (rng() % 3 != 0) {
+                        m_queue->Enqueue(CreateBandPacket(rng() % TrafficClassQueue::NUM_BANDS, 100 + rng() % 1401));
+                    } else if (!m_queue->IsEmpty()) {
+                        if (with_peek) {
+                            m_queue->Peek();
+                            m_queue->Peek();
+                        }
+                        served[with_peek].push_back(m_queue->Dequeue()->GetSize());
+                    }
+                }
+            }
+            ASSERT_TRUE(served[0] == served[1]);
+        }
+
+        // Remove
+        Setup("drr", "1500,1500,1500,1500", "100p");
+        ASSERT_TRUE(Enqueue(0, 1500));
+        ASSERT_TRUE(Enqueue(0, 1500));
+        ASSERT_TRUE(Enqueue(3, 1500));
+        ASSERT_TRUE(Enqueue(3, 1500));
+        Ptr<const Packet> peeked = m_queue->Peek();
+        Ptr<Packet> removed = m_queue->Remove();
+        ASSERT_EQUAL(peeked->GetUid(), removed->GetUid());
+        ASSERT_EQUAL(TrafficClassQueue::GetBand(removed), 0);
+        // class_A still has its quantum of this round
+        ASSERT_EQUAL(Dequeue(), 0);
+        ASSERT_EQUAL(Dequeue(), 3);
+        ASSERT_EQUAL(Dequeue(), 3);
+        ASSERT_TRUE(m_queue->IsEmpty());
+        ASSERT_TRUE(m_queue->Remove() == 0);
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////////////
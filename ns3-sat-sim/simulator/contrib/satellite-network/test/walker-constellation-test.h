@@ -0,0 +1,145 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "ns3/basic-simulation.h"
+#include "ns3/topology-satellite-network.h"
+#include "ns3/ipv4-arbiter-routing-helper.h"
+#include "ns3/walker-constellation-helper.h"
+
+#include "ns3/test.h"
+#include "test-helpers.h"
+#include "satnet-test-run.h"
+
+using namespace ns3;
+
+////////////////////////////////////////////////////////////////////////////////////////
+
+class WalkerConstellationFilesTestCase : public TestCase {
+public:
+    WalkerConstellationFilesTestCase () : TestCase ("walker-constellation files") {};
+
+    void DoRun () {
+        const std::string satellite_network_dir = ".tmp-walker-constellation-files-test";
+        const int64_t num_orbits = 7;
+        const int64_t num_sats_per_orbit = 9;
+        WalkerConstellationHelper walker(num_orbits, num_sats_per_orbit, 630000, 51.9, 20, 3, 25);
+        walker.Write(satellite_network_dir);
+        ASSERT_EQUAL(walker.GetNumSatellites(), num_orbits * num_sats_per_orbit);
+
+        // TLEs: the header, then per satellite its name and two lines of 69 characters with a valid checksum
+        std::vector<std::string> tle_lines = read_file_direct(satellite_network_dir + "/tles.txt");
+        ASSERT_EQUAL((int64_t) tle_lines.size(), 1 + 3 * num_orbits * num_sats_per_orbit);
+        ASSERT_EQUAL(tle_lines[0], std::to_string(num_orbits) + " " + std::to_string(num_sats_per_orbit));
+        for (int64_t sat = 0; sat < num_orbits * num_sats_per_orbit; sat++) {
+            ASSERT_EQUAL(tle_lines[1 + 3 * sat], "Satellite " + std::to_string(sat));
+            for (int64_t i = 1; i <= 2; i++) {
+                const std::string& line = tle_lines[1 + 3 * sat + i];
+                ASSERT_EQUAL(line.size(), 69);
+                ASSERT_EQUAL(line.substr(0, 2), std::to_string(i) + " ");
+                ASSERT_EQUAL(parse_positive_int64(line.substr(2, 5)), sat + 1);
+                ASSERT_EQUAL(line[68] - '0', TleChecksum(line.substr(0, 68)));
+            }
+        }
+        std::vector<std::string> geo_tle_lines = read_file_direct(satellite_network_dir + "/tles_GEO.txt");
+        ASSERT_EQUAL(geo_tle_lines.size(), 1 + 3 * 3);
+        for (size_t i = 1; i < geo_tle_lines.size(); i++) {
+            if (i % 3 != 1) {
+                ASSERT_EQUAL(geo_tle_lines[i].size(), 69);
+                ASSERT_EQUAL(geo_tle_lines[i][68] - '0', TleChecksum(geo_tle_lines[i].substr(0, 68)));
+            }
+        }
+
+        // +Grid: 2 * N * M distinct ISLs, every satellite has four
+        std::vector<std::string> isl_lines = read_file_direct(satellite_network_dir + "/isls.txt");
+        ASSERT_EQUAL((int64_t) isl_lines.size(), 2 * num_orbits * num_sats_per_orbit);
+        std::set<std::pair<int64_t, int64_t>> isls;
+        std::vector<int64_t> num_isls(num_orbits * num_sats_per_orbit, 0);
+        for (const std::string& line : isl_lines) {
+            std::vector<std::string> space_split = split_string(line, " ", 2);
+            int64_t a = parse_positive_int64(space_split[0]);
+            int64_t b = parse_positive_int64(space_split[1]);
+            ASSERT_TRUE(a < b);
+            ASSERT_TRUE(b < num_orbits * num_sats_per_orbit);
+            isls.insert(std::make_pair(a, b));
+            num_isls[a]++;
+            num_isls[b]++;
+        }
+        ASSERT_EQUAL((int64_t) isls.size(), 2 * num_orbits * num_sats_per_orbit);
+        for (int64_t n : num_isls) {
+            ASSERT_EQUAL(n, 4);
+        }
+
+        ASSERT_EQUAL(read_file_direct(satellite_network_dir + "/ground_stations.txt").size(), 20);
+        ASSERT_EQUAL((int64_t) read_file_direct(satellite_network_dir + "/gsl_interfaces_info.txt").size(), num_orbits * num_sats_per_orbit + 20);
+        ASSERT_EQUAL((int64_t) read_file_direct(satellite_network_dir + "/ill_interfaces_info.txt").size(), num_orbits * num_sats_per_orbit + 3);
+    }
+
+private:
+    static int TleChecksum (const std::string& line) {
+        int sum = 0;
+        for (char c : line) {
+            sum += (c >= '0' && c <= '9') ? c - '0' : (c == '-' ? 1 : 0);
+        }
+        return sum % 10;
+    }
+
+};
+
+////////////////////////////////////////////////////////////////////////////////////////
+
+class WalkerConstellationTopologyTestCase : public TestCase {
+public:
+    WalkerConstellationTopologyTestCase () : TestCase ("walker-constellation topology") {};
+
+    void DoRun () {
+        const std::string run_dir = ".tmp-walker-constellation-topology-test";
+        WalkerConstellationHelper walker(6, 8, 550000, 53, 12, 1, 10);
+        write_walker_test_run(run_dir, walker, 1000000000, {});
+
+        // The topology reads it in, with all four ISLs of each satellite
+        Ptr<BasicSimulation> basicSimulation = CreateObject<BasicSimulation>(run_dir);
+        Ptr<TopologySatelliteNetwork> topology = CreateObject<TopologySatelliteNetwork>(basicSimulation, Ipv4ArbiterRoutingHelper());
+        ASSERT_EQUAL(topology->GetNumOrbits(), 6);
+        ASSERT_EQUAL(topology->GetNumSatellitesPerOrbit(), 8);
+        ASSERT_EQUAL(topology->GetNumSatellites(), 48);
+        ASSERT_EQUAL(topology->GetNumGroundStations(), 12);
+        ASSERT_EQUAL(topology->GetNumGEOSatellites(), 1);
+        int64_t num_isl_interfaces = 0;
+        for (uint32_t sat = 0; sat < topology->GetNumSatellites(); sat++) {
+            for (uint32_t i = 1; i <= 4; i++) {
+                const IslNeighbor& neighbor = topology->GetIslNeighbor(sat, i);
+                ASSERT_NOT_EQUAL(neighbor.node_id, -1);
+                ASSERT_EQUAL(topology->GetIslNeighbor(neighbor.node_id, neighbor.interface).node_id, (int32_t) sat);
+                num_isl_interfaces++;
+            }
+        }
+        ASSERT_EQUAL(num_isl_interfaces, 2 * 2 * 6 * 8);
+
+        Simulator::Destroy();
+    }
+
+};
+
+////////////////////////////////////////////////////////////////////////////////////////
+
+class WalkerConstellationInvalidTestCase : public TestCase {
+public:
+    WalkerConstellationInvalidTestCase () : TestCase ("walker-constellation invalid") {};
+
+    void DoRun () {
+        ASSERT_EXCEPTION(WalkerConstellationHelper(2, 8, 550000, 53, 12, 1, 10));
+        ASSERT_EXCEPTION(WalkerConstellationHelper(6, 2, 550000, 53, 12, 1, 10));
+        ASSERT_EXCEPTION(WalkerConstellationHelper(500, 200, 550000, 53, 12, 1, 10));
+        ASSERT_EXCEPTION(WalkerConstellationHelper(6, 8, 50000, 53, 12, 1, 10));
+        ASSERT_EXCEPTION(WalkerConstellationHelper(6, 8, 40000000, 53, 12, 1, 10));
+        ASSERT_EXCEPTION(WalkerConstellationHelper(6, 8, 550000, 181, 12, 1, 10));
+        ASSERT_EXCEPTION(WalkerConstellationHelper(6, 8, 550000, 53, -1, 1, 10));
+        ASSERT_EXCEPTION(WalkerConstellationHelper(6, 8, 550000, 53, 12, 1, 90));
+    }
+
+};
+
+////////////////////////////////////////////////////////////////////////////////////////
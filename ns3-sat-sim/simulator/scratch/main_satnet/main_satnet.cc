@@ -33,6 +33,9 @@
 #include <unistd.h>
 #include <chrono>
 #include <stdexcept>
+#include <sys/wait.h>
+#include <cerrno>
+#include <cstring>
 
 #include "ns3/basic-simulation.h"
 #include "ns3/tcp-flow-scheduler.h"
@@ -44,33 +47,11 @@
 #include "ns3/arbiter-leo-gs-geo-helper.h"
 #include "ns3/arbiter-single-forward-helper.h"
 #include "ns3/arbiter-traffic-classify-helper.h"
+#include "ns3/fluid-engine.h"
 
 using namespace ns3;
 
-int main(int argc, char *argv[]) {
-
-    // No buffering of printf
-    setbuf(stdout, nullptr);
-
-    // Retrieve run directory
-    CommandLine cmd;
-    std::string run_dir = "";
-    cmd.Usage("Usage: ./waf --run=\"main_satnet --run_dir='<path/to/run/directory>'\"");
-    cmd.AddValue("run_dir",  "Run directory", run_dir);
-    cmd.Parse(argc, argv);
-    if (run_dir.compare("") == 0) {
-        printf("Usage: ./waf --run=\"main_satnet --run_dir='<path/to/run/directory>'\"");
-        return 0;
-    }
-
-    // Load basic simulation environment
-    Ptr<BasicSimulation> basicSimulation = CreateObject<BasicSimulation>(run_dir);
-
-    // Setting socket type
-    Config::SetDefault ("ns3::TcpL4Protocol::SocketType", StringValue ("ns3::" + basicSimulation->GetConfigParamOrFail("tcp_socket_type")));
-
-    // Optimize TCP
-    TcpOptimizer::OptimizeBasic(basicSimulation);
+std::string ReadAlgorithm(Ptr<BasicSimulation> basicSimulation) {
 
     // Read algorighm
     std::string algorithm = basicSimulation->GetConfigParamOrFail("algorithm");
@@ -84,8 +65,21 @@ int main(int argc, char *argv[]) {
     std::cout << "////////////////////////////////////////" << std::endl;
     std::cout << std::endl;
 
-    // Read topology, and install routing arbiters
-    Ptr<TopologySatelliteNetwork> topology = CreateObject<TopologySatelliteNetwork>(basicSimulation, Ipv4ArbiterRoutingHelper());
+    return algorithm;
+}
+
+void ConfigureTcp(Ptr<BasicSimulation> basicSimulation) {
+
+    // Setting socket type
+    Config::SetDefault ("ns3::TcpL4Protocol::SocketType", StringValue ("ns3::" + basicSimulation->GetConfigParamOrFail("tcp_socket_type")));
+
+    // Optimize TCP
+    TcpOptimizer::OptimizeBasic(basicSimulation);
+}
+
+void RunOnTopology(Ptr<BasicSimulation> basicSimulation, Ptr<TopologySatelliteNetwork> topology, std::string algorithm) {
+
+    // Install routing arbiters
     Ptr<ArbiterHelper> arbiter_helper;
     if(algorithm == "SingleForward"){
         arbiter_helper = CreateObject<ArbiterSingleForwardHelper>(basicSimulation, topology);
@@ -98,6 +92,20 @@ int main(int argc, char *argv[]) {
     }
     arbiter_helper->Install();   // Install Arbiters for nodes
 
+    // Flow-level simulation of the UDP bursts instead of packets
+    std::string simulation_mode = basicSimulation->GetConfigParamOrDefault("simulation_mode", "packet");
+    NS_ABORT_MSG_IF(simulation_mode != "packet" && simulation_mode != "fluid" && simulation_mode != "hybrid",
+                    "invalid simulation_mode: " + simulation_mode);
+    if (simulation_mode == "fluid") {
+        Ptr<FluidEngine> fluidEngine = CreateObject<FluidEngine>(basicSimulation, topology, arbiter_helper, false);
+        basicSimulation->Run();
+        fluidEngine->WriteResults();
+        arbiter_helper->WriteResults();
+        topology->CollectUtilizationStatistics();
+        basicSimulation->Finalize();
+        return;
+    }
+
     // Schedule flows
     TcpFlowScheduler tcpFlowScheduler(basicSimulation, topology); // Requires enable_tcp_flow_scheduler=true
 
@@ -107,6 +115,12 @@ int main(int argc, char *argv[]) {
     // Schedule pings
     PingmeshScheduler pingmeshScheduler(basicSimulation, topology); // Requires enable_pingmesh_scheduler=true
 
+    // Fluid background of the UDP bursts marked fluid
+    Ptr<FluidEngine> fluidEngine;
+    if (simulation_mode == "hybrid") {
+        fluidEngine = CreateObject<FluidEngine>(basicSimulation, topology, arbiter_helper, true);
+    }
+
     // Run simulation
     basicSimulation->Run();
 
@@ -119,11 +133,172 @@ int main(int argc, char *argv[]) {
     // Write pingmesh results
     pingmeshScheduler.WriteResults();
 
+    // Write fluid background results
+    if (fluidEngine != 0) {
+        fluidEngine->WriteResults();
+    }
+
+    // Write arbiter results
+    arbiter_helper->WriteResults();
+
     // Collect utilization statistics
     topology->CollectUtilizationStatistics();
 
     // Finalize the simulation
     basicSimulation->Finalize();
+}
+
+int RunBatchChild(Ptr<BasicSimulation> setupSimulation, Ptr<TopologySatelliteNetwork> topology, std::string run_dir) {
+    try {
+
+        // Console output of the run goes to its own logs directory
+        mkdir_if_not_exists(run_dir + "/logs_ns3");
+        if (freopen((run_dir + "/logs_ns3/console.txt").c_str(), "w", stdout) == nullptr) {
+            throw std::runtime_error("Could not redirect the console output of run " + run_dir);
+        }
+        setbuf(stdout, nullptr);
+
+        // Load basic simulation environment of the run
+        Ptr<BasicSimulation> basicSimulation = CreateObject<BasicSimulation>(run_dir);
+
+        // The scheduled simulation stop, the random number streams and the TCP
+        // stack are inherited from the setup run, so they must be the same
+        for (std::string key : {"simulation_end_time_ns", "simulation_seed", "tcp_socket_type"}) {
+            if (setupSimulation->GetConfigParamOrFail(key) != basicSimulation->GetConfigParamOrFail(key)) {
+                throw std::runtime_error(format_string("Config key \'%s\' must be the same for all runs of a batch", key.c_str()));
+            }
+        }
+        ConfigureTcp(basicSimulation);
+
+        // Take over the topology built before the fork
+        topology->SetBasicSimulation(basicSimulation);
+        RunOnTopology(basicSimulation, topology, ReadAlgorithm(basicSimulation));
+        return 0;
+
+    } catch (const std::exception& e) {
+        std::cout << "Run " << run_dir << " failed: " << e.what() << std::endl;
+        return 1;
+    }
+}
+
+std::string WriteBatchSetupDir(std::string first_run_dir) {
+
+    // The setup run has its own directory (inside the first run directory) such that its
+    // logs and finished.txt do not end up in the ones of the first run
+    std::string setup_dir = first_run_dir + "/batch_setup";
+    mkdir_if_not_exists(setup_dir);
+
+    // Same configuration as the first run, with the paths (relative to the run directory)
+    // pointing to the ones of the first run
+    std::ofstream config_file(setup_dir + "/config_ns3.properties");
+    for (std::string line : read_file_direct(first_run_dir + "/config_ns3.properties")) {
+        if (!trim(line).empty() && line.c_str()[0] != '#') {
+            std::vector<std::string> equals_split = split_string(line, "=", 2);
+            std::string key = trim(equals_split[0]);
+            if (ends_with(key, "_dir") || ends_with(key, "_filename")) {
+                std::string value = remove_start_end_double_quote_if_present(trim(equals_split[1]));
+                line = key + "=\"../" + value + "\"";
+            }
+        }
+        config_file << line << std::endl;
+    }
+    config_file.close();
+
+    return setup_dir;
+}
+
+int RunBatch(std::vector<std::string> run_dirs, int64_t max_parallel) {
+
+    // Build the topology once, with the configuration of the first run
+    Ptr<BasicSimulation> setupSimulation = CreateObject<BasicSimulation>(WriteBatchSetupDir(run_dirs[0]));
+    NS_ABORT_MSG_IF(setupSimulation->IsDistributedEnabled(), "Batch mode does not support distributed simulation");
+    ConfigureTcp(setupSimulation);
+    Ptr<TopologySatelliteNetwork> topology = CreateObject<TopologySatelliteNetwork>(setupSimulation, Ipv4ArbiterRoutingHelper());
+    setupSimulation->RegisterTimestamp("Build shared topology");
+
+    // Each run is a child process which shares the built topology (copy-on-write)
+    std::cout << "BATCH" << std::endl;
+    std::cout << "  > Runs..................... " << run_dirs.size() << std::endl;
+    std::cout << "  > Max. runs in parallel.... " << max_parallel << std::endl;
+    std::map<pid_t, std::string> running;
+    size_t next_run = 0;
+    int num_failed = 0;
+    while (next_run < run_dirs.size() || !running.empty()) {
+        if (next_run < run_dirs.size() && (int64_t) running.size() < max_parallel) {
+            pid_t pid = fork();
+            if (pid < 0) {
+                throw std::runtime_error("Could not fork for run " + run_dirs[next_run]);
+            }
+            if (pid == 0) {
+                exit(RunBatchChild(setupSimulation, topology, run_dirs[next_run]));
+            }
+            std::cout << "  > Started run " << (next_run + 1) << " out of " << run_dirs.size() << ": " << run_dirs[next_run] << std::endl;
+            running[pid] = run_dirs[next_run];
+            next_run++;
+        } else {
+            int status;
+            pid_t pid = wait(&status);
+            if (pid < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::runtime_error(format_string("Could not wait for the runs: %s", strerror(errno)));
+            }
+            bool success = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+            if (success) {
+                std::cout << "  > Finished run: " << running.at(pid) << std::endl;
+            } else if (WIFEXITED(status)) {
+                std::cout << "  > FAILED run (exit status " << WEXITSTATUS(status) << "): " << running.at(pid) << std::endl;
+            } else {
+                std::cout << "  > FAILED run (signal " << (WIFSIGNALED(status) ? WTERMSIG(status) : -1) << "): " << running.at(pid) << std::endl;
+            }
+            num_failed += success ? 0 : 1;
+            running.erase(pid);
+        }
+    }
+    std::cout << "  > Failed runs.............. " << num_failed << std::endl;
+    std::cout << std::endl;
+
+    return num_failed == 0 ? 0 : 1;
+}
+
+int main(int argc, char *argv[]) {
+
+    // No buffering of printf
+    setbuf(stdout, nullptr);
+
+    // Retrieve run directory (or the run directories of a batch)
+    CommandLine cmd;
+    std::string run_dir = "";
+    std::string batch_run_dirs = "";
+    int64_t batch_max_parallel = sysconf(_SC_NPROCESSORS_ONLN);
+    cmd.Usage("Usage: ./waf --run=\"main_satnet --run_dir='<path/to/run/directory>'\"\n"
+              "   or: ./waf --run=\"main_satnet --batch_run_dirs='<run directory>,<run directory>,...' [--batch_max_parallel=<n>]\"");
+    cmd.AddValue("run_dir",  "Run directory", run_dir);
+    cmd.AddValue("batch_run_dirs",  "Comma-separated run directories which share the same topology", batch_run_dirs);
+    cmd.AddValue("batch_max_parallel",  "Maximum number of runs of the batch in parallel", batch_max_parallel);
+    cmd.Parse(argc, argv);
+    if (batch_run_dirs.compare("") != 0) {
+        NS_ABORT_MSG_IF(batch_max_parallel < 1, "batch_max_parallel must be at least 1");
+        return RunBatch(split_string(batch_run_dirs, ","), batch_max_parallel);
+    }
+    if (run_dir.compare("") == 0) {
+        printf("Usage: ./waf --run=\"main_satnet --run_dir='<path/to/run/directory>'\"");
+        return 0;
+    }
+
+    // Load basic simulation environment
+    Ptr<BasicSimulation> basicSimulation = CreateObject<BasicSimulation>(run_dir);
+
+    // TCP
+    ConfigureTcp(basicSimulation);
+
+    // Read algorighm
+    std::string algorithm = ReadAlgorithm(basicSimulation);
+
+    // Read topology, and run
+    Ptr<TopologySatelliteNetwork> topology = CreateObject<TopologySatelliteNetwork>(basicSimulation, Ipv4ArbiterRoutingHelper());
+    RunOnTopology(basicSimulation, topology, algorithm);
 
     return 0;
 
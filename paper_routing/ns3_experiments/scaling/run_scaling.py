@@ -0,0 +1,155 @@
+# Author: silent-rookie     2024
+
+import exputil
+import random
+import re
+import sys
+import time
+
+local_shell = exputil.LocalShell()
+
+# Constellation sizes (orbits x satellites per orbit), from 100 to 10,000 satellites
+constellations = [
+    (10, 10),
+    (20, 25),
+    (40, 25),
+    (72, 22),
+    (50, 40),
+    (100, 50),
+    (100, 100),
+]
+
+num_ground_stations = 100
+num_geo = 3
+num_udp_bursts = 100
+udp_burst_rate_megabit_per_s = 1
+duration_s = 10
+algorithm = "DetourTrafficClassify"
+
+config_template = """simulation_end_time_ns=%d
+simulation_seed=123456789
+
+satellite_network_dir="satellite_network"
+satellite_network_routes_dir="satellite_network"
+dynamic_state_update_interval_ns=1000000000
+routing_engine=in_simulator
+
+isl_data_rate_megabit_per_s=10
+gsl_data_rate_megabit_per_s=20
+ill_data_rate_megabit_per_s=100
+isl_max_queue_size_pkt=100
+gsl_max_queue_size_pkt=100
+ill_max_queue_size_pkt=1000
+
+receive_datarate_update_interval_ns=20000000
+trafic_judge_rate_non_jam=0.9
+trafic_judge_rate_in_jam=0.8
+trafic_judge_rate_jam_to_normal=0.5
+trafic_jam_area_radius_m=1500000
+trafic_jam_update_interval_ns=300000000000
+
+enable_isl_utilization_tracking=false
+
+tcp_socket_type=TcpNewReno
+
+enable_udp_burst_scheduler=true
+udp_burst_schedule_filename="udp_burst_schedule.csv"
+udp_burst_enable_logging_for_udp_burst_ids=set()
+
+class_A_rate=0.03
+class_B_rate=0.20
+class_C_rate=0.77
+
+algorithm=%s
+"""
+
+
+def run_name(num_orbits, num_sats_per_orbit):
+    return "run_%d_sats_%dx%d" % (num_orbits * num_sats_per_orbit, num_orbits, num_sats_per_orbit)
+
+
+def generate_run(num_orbits, num_sats_per_orbit):
+    run_dir = "runs/" + run_name(num_orbits, num_sats_per_orbit)
+    local_shell.remove_force_recursive(run_dir)
+    local_shell.make_full_dir(run_dir + "/logs_ns3")
+
+    # Satellite network
+    local_shell.perfect_exec(
+        "cd ../../../ns3-sat-sim/simulator; "
+        "./waf --run=\"satnet-generate "
+        "--satellite_network_dir='../../paper_routing/ns3_experiments/scaling/" + run_dir + "/satellite_network' "
+        "--num_orbits=%d --num_sats_per_orbit=%d --num_ground_stations=%d --num_geo=%d\""
+        % (num_orbits, num_sats_per_orbit, num_ground_stations, num_geo)
+    )
+
+    # Configuration
+    local_shell.write_file(run_dir + "/config_ns3.properties", config_template % (duration_s * 1000 * 1000 * 1000, algorithm))
+
+    # UDP bursts between random pairs of ground stations (node ids after the satellites)
+    num_satellites = num_orbits * num_sats_per_orbit
+    random.seed(123456789)
+    lines = []
+    for i in range(num_udp_bursts):
+        from_gs, to_gs = random.sample(range(num_ground_stations), 2)
+        lines.append("%d,%d,%d,%f,0,%d,," % (
+            i, num_satellites + from_gs, num_satellites + to_gs,
+            udp_burst_rate_megabit_per_s, duration_s * 1000 * 1000 * 1000
+        ))
+    local_shell.write_file(run_dir + "/udp_burst_schedule.csv", "\n".join(lines) + "\n")
+    return run_dir
+
+
+def run(run_dir):
+    start = time.time()
+    local_shell.perfect_exec(
+        "cd ../../../ns3-sat-sim/simulator; "
+        "./waf --run=\"main_satnet --run_dir='../../paper_routing/ns3_experiments/scaling/" + run_dir + "'\" "
+        "> '../../paper_routing/ns3_experiments/scaling/" + run_dir + "/logs_ns3/console.txt' 2>&1"
+    )
+    process_wall_time_s = time.time() - start
+
+    # The simulator prints the wall time of the simulation itself, the events and the peak memory
+    with open(run_dir + "/logs_ns3/console.txt", "r") as f_in:
+        console = f_in.read()
+    simulation = re.search(r"took in wallclock time ([0-9.]+) seconds", console)
+    events = re.search(r"Executed ([0-9]+) events \(([0-9.]+) events per wallclock second\), "
+                       r"peak resident set size ([0-9.]+) MB", console)
+    if simulation is None or events is None:
+        raise ValueError("Run %s did not finish, see its logs_ns3/console.txt" % run_dir)
+    return {
+        "process_wall_time_s": process_wall_time_s,
+        "simulation_wall_time_s": float(simulation.group(1)),
+        "num_events": int(events.group(1)),
+        "events_per_s": float(events.group(2)),
+        "peak_rss_mb": float(events.group(3)),
+    }
+
+
+def main():
+    only_generate = len(sys.argv) > 1 and sys.argv[1] == "--only_generate"
+    local_shell.make_full_dir("data")
+    results = []
+    for (num_orbits, num_sats_per_orbit) in constellations:
+        print("Constellation of %d x %d satellites" % (num_orbits, num_sats_per_orbit))
+        run_dir = generate_run(num_orbits, num_sats_per_orbit)
+        if not only_generate:
+            results.append((num_orbits, num_sats_per_orbit, run(run_dir)))
+
+    # data/scaling.csv (line format: num_satellites,num_orbits,num_sats_per_orbit,process_wall_time_s,
+    #                   simulation_wall_time_s,num_events,events_per_s,peak_rss_mb)
+    with open("data/scaling.csv", "w+") as f_out:
+        for (num_orbits, num_sats_per_orbit, r) in results:
+            f_out.write("%d,%d,%d,%.3f,%.3f,%d,%.1f,%.1f\n" % (
+                num_orbits * num_sats_per_orbit, num_orbits, num_sats_per_orbit,
+                r["process_wall_time_s"], r["simulation_wall_time_s"], r["num_events"], r["events_per_s"], r["peak_rss_mb"]
+            ))
+    print("%-12s %-16s %-16s %-14s %-14s %-12s" % ("Satellites", "Wall time (s)", "Sim. wall (s)", "Events", "Events/s", "Peak RSS (MB)"))
+    for (num_orbits, num_sats_per_orbit, r) in results:
+        print("%-12d %-16.1f %-16.1f %-14d %-14.0f %-12.1f" % (
+            num_orbits * num_sats_per_orbit, r["process_wall_time_s"], r["simulation_wall_time_s"],
+            r["num_events"], r["events_per_s"], r["peak_rss_mb"]
+        ))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,95 @@
+# Author: silent-rookie     2024
+
+import exputil
+import re
+import sys
+
+local_shell = exputil.LocalShell()
+
+# Event schedulers to compare (scheduler_type in config_ns3.properties)
+scheduler_types = ["map", "heap", "calendar", "ladder"]
+
+
+def run_main_satnet(run_dir):
+    local_shell.perfect_exec(
+        "cd ../../../ns3-sat-sim/simulator; "
+        "./waf --run=\"main_satnet "
+        "--run_dir='../../paper_routing/ns3_experiments/traffic_matrix/" + run_dir + "'\" "
+        "> '../../paper_routing/ns3_experiments/traffic_matrix/" + run_dir + "/logs_ns3/console.txt' 2>&1"
+    )
+
+    # The simulator prints the wall time of the simulation itself, the events and the peak memory
+    with open(run_dir + "/logs_ns3/console.txt", "r") as f_in:
+        console = f_in.read()
+    simulation = re.search(r"took in wallclock time ([0-9.]+) seconds", console)
+    events = re.search(r"Executed ([0-9]+) events \(([0-9.]+) events per wallclock second\), "
+                       r"peak resident set size ([0-9.]+) MB", console)
+    if simulation is None or events is None:
+        raise ValueError("Run %s did not finish, see its logs_ns3/console.txt" % run_dir)
+    return {
+        "simulation_wall_time_s": float(simulation.group(1)),
+        "num_events": int(events.group(1)),
+        "events_per_s": float(events.group(2)),
+        "peak_rss_mb": float(events.group(3)),
+    }
+
+
+def read_lines(filename):
+    lines = []
+    with open(filename, "r") as f_in:
+        for line in f_in:
+            lines.append(line.strip())
+    return lines
+
+
+def compare_schedulers(run_name):
+    base_run_dir = "runs/" + run_name
+    local_shell.make_full_dir("data")
+
+    results = []
+    for scheduler_type in scheduler_types:
+        print("Scheduler type: %s" % scheduler_type)
+
+        # Run directory with the same configuration, except for the scheduler
+        run_dir = "runs/" + run_name + "_scheduler_" + scheduler_type
+        local_shell.remove_force_recursive(run_dir)
+        local_shell.make_full_dir(run_dir + "/logs_ns3")
+        local_shell.copy_file(base_run_dir + "/config_ns3.properties", run_dir + "/config_ns3.properties")
+        local_shell.copy_file(base_run_dir + "/udp_burst_schedule.csv", run_dir + "/udp_burst_schedule.csv")
+        with open(run_dir + "/config_ns3.properties", "a") as f_out:
+            f_out.write("\n")
+            f_out.write("scheduler_type=%s\n" % scheduler_type)
+        results.append((scheduler_type, run_main_satnet(run_dir)))
+
+        # The scheduler must not change the outcome
+        first_run_dir = "runs/" + run_name + "_scheduler_" + scheduler_types[0]
+        for f in ["udp_bursts_outgoing.csv", "udp_bursts_incoming.csv", "detour_state_flips.csv"]:
+            if read_lines(run_dir + "/logs_ns3/" + f) != read_lines(first_run_dir + "/logs_ns3/" + f):
+                raise ValueError("%s of scheduler %s is different from that of scheduler %s"
+                                 % (f, scheduler_type, scheduler_types[0]))
+
+    # data/scheduler_comparison.csv (line format: scheduler_type,simulation_wall_time_s,num_events,events_per_s,peak_rss_mb)
+    with open("data/scheduler_comparison.csv", "w+") as f_out:
+        for (scheduler_type, r) in results:
+            f_out.write("%s,%.3f,%d,%.1f,%.1f\n" % (
+                scheduler_type, r["simulation_wall_time_s"], r["num_events"], r["events_per_s"], r["peak_rss_mb"]
+            ))
+    print("%-12s %-16s %-14s %-14s %-12s" % ("Scheduler", "Sim. wall (s)", "Events", "Events/s", "Peak RSS (MB)"))
+    for (scheduler_type, r) in results:
+        print("%-12s %-16.1f %-14d %-14.0f %-12.1f" % (
+            scheduler_type, r["simulation_wall_time_s"], r["num_events"], r["events_per_s"], r["peak_rss_mb"]
+        ))
+
+
+def main():
+    args = sys.argv[1:]
+    if len(args) != 1:
+        print("Must supply exactly one argument")
+        print("Usage: python3 compare_schedulers.py [run_name]")
+        exit(1)
+    else:
+        compare_schedulers(args[0])
+
+
+if __name__ == "__main__":
+    main()
@@ -9,6 +9,10 @@ local_shell = exputil.LocalShell()
 # Get workload identifier from argument
 max_num_thread = 1
 
+# Batch mode: build the topology once, and fork one process per run (at most max_num_thread in parallel).
+# All runs must share the same topology configuration (data rates, queue sizes, satellite network).
+use_batch_mode = False
+
 # Clear old runs
 # local_shell.perfect_exec("rm -rf runs/*/logs_ns3")
 
@@ -21,7 +25,24 @@ if local_shell.count_screens() != 0:
 # Generate the commands
 commands_to_run = []
 
-for run in get_run_list():
+if use_batch_mode:
+    run_dirs = []
+    for run in get_run_list():
+        logs_ns3_dir = "runs/" + run["name"] + "/logs_ns3"
+        local_shell.remove_force_recursive(logs_ns3_dir)
+        local_shell.make_full_dir(logs_ns3_dir)
+        run_dirs.append("../../paper_routing/ns3_experiments/traffic_matrix/runs/" + run["name"])
+    local_shell.make_full_dir("runs/logs_batch")
+    commands_to_run.append(
+        "cd ../../../ns3-sat-sim/simulator; "
+        "./waf --run=\"main_satnet "
+        "--batch_run_dirs='" + ",".join(run_dirs) + "' "
+        "--batch_max_parallel=" + str(max_num_thread) + "\" "
+        "2>&1 | tee '../../paper_routing/ns3_experiments/traffic_matrix/runs/logs_batch/console.txt'"
+    )
+    max_num_thread = 1
+
+for run in ([] if use_batch_mode else get_run_list()):
     logs_ns3_dir = "runs/" + run["name"] + "/logs_ns3"
     local_shell.remove_force_recursive(logs_ns3_dir)
     local_shell.make_full_dir(logs_ns3_dir)
@@ -0,0 +1,138 @@
+# Author: silent-rookie     2024
+
+import exputil
+import sys
+
+local_shell = exputil.LocalShell()
+
+
+def read_config(config_filename):
+    config = {}
+    with open(config_filename, "r") as f_in:
+        for line in f_in:
+            if "=" in line:
+                key, value = line.strip().split("=", 1)
+                config[key.strip()] = value.strip().strip("\"")
+    return config
+
+
+def generate_node_system_id_assignment(satellite_network_dir, num_systems):
+
+    # Satellites: by orbital plane, such that most ISLs stay within one system
+    with open(satellite_network_dir + "/tles.txt", "r") as f_in:
+        num_orbits, num_sats_per_orbit = map(int, f_in.readline().split())
+    assignment = []
+    for sat in range(num_orbits * num_sats_per_orbit):
+        assignment.append((sat // num_sats_per_orbit) * num_systems // num_orbits)
+
+    # Ground stations and GEO satellites: round-robin
+    with open(satellite_network_dir + "/ground_stations.txt", "r") as f_in:
+        num_ground_stations = len([line for line in f_in if line.strip() != ""])
+    for gid in range(num_ground_stations):
+        assignment.append(gid % num_systems)
+    with open(satellite_network_dir + "/tles_GEO.txt", "r") as f_in:
+        num_geo_orbits, num_geo_sats_per_orbit = map(int, f_in.readline().split())
+    for geo in range(num_geo_orbits * num_geo_sats_per_orbit):
+        assignment.append(geo % num_systems)
+
+    return assignment
+
+
+def run_main_satnet(run_dir, num_systems):
+    command = (
+        "cd ../../../ns3-sat-sim/simulator; "
+        "./waf --run=\"main_satnet "
+        "--run_dir='../../paper_routing/ns3_experiments/traffic_matrix/" + run_dir + "'\" "
+    )
+    if num_systems > 1:
+        command += "--command-template=\"mpirun -np " + str(num_systems) + " %s\" "
+    command += "2>&1 | tee '../../paper_routing/ns3_experiments/traffic_matrix/" + run_dir + "/logs_ns3/console.txt'"
+    local_shell.perfect_exec(command)
+
+
+def read_lines(filename):
+    lines = []
+    with open(filename, "r") as f_in:
+        for line in f_in:
+            lines.append(line.strip())
+    return lines
+
+
+def test_distributed_exactly_equal(run_name, num_systems):
+    base_run_dir = "runs/" + run_name
+    distributed_run_dir = "runs/" + run_name + "_distributed_" + str(num_systems) + "_systems"
+
+    # Distributed run directory with the same configuration
+    local_shell.remove_force_recursive(distributed_run_dir)
+    local_shell.make_full_dir(distributed_run_dir + "/logs_ns3")
+    local_shell.copy_file(base_run_dir + "/config_ns3.properties", distributed_run_dir + "/config_ns3.properties")
+    local_shell.copy_file(base_run_dir + "/udp_burst_schedule.csv", distributed_run_dir + "/udp_burst_schedule.csv")
+    config = read_config(base_run_dir + "/config_ns3.properties")
+    assignment = generate_node_system_id_assignment(
+        base_run_dir + "/" + config["satellite_network_dir"],
+        num_systems
+    )
+    with open(distributed_run_dir + "/config_ns3.properties", "a") as f_out:
+        f_out.write("\n")
+        f_out.write("enable_distributed=true\n")
+        f_out.write("distributed_simulator_implementation_type=default\n")
+        f_out.write("distributed_systems_count=%d\n" % num_systems)
+        f_out.write("distributed_node_system_id_assignment=list(%s)\n" % ",".join(map(str, assignment)))
+
+    # Run both
+    if not local_shell.file_exists(base_run_dir + "/logs_ns3/finished.txt"):
+        local_shell.make_full_dir(base_run_dir + "/logs_ns3")
+        run_main_satnet(base_run_dir, 1)
+    run_main_satnet(distributed_run_dir, num_systems)
+
+    # Results are split over the systems
+    for f in [
+        "udp_bursts_outgoing.csv",
+        "udp_bursts_incoming.csv",
+        "isl_utilization.csv",
+    ]:
+        base_lines = read_lines("%s/logs_ns3/%s" % (base_run_dir, f))
+
+        # The merged lines from the various systems
+        merged_lines = []
+        for i in range(num_systems):
+            merged_lines += read_lines("%s/logs_ns3/system_%d_%s" % (distributed_run_dir, i, f))
+
+        # Sort both by the first three comma-separated integers
+        # (the ISL utilization is written in ISL device order, not sorted)
+        def first_three_numbers_in_tuple(csv_line):
+            spl = csv_line.split(",")
+            return int(spl[0]), int(spl[1]), int(spl[2])
+        base_lines = sorted(base_lines, key=first_three_numbers_in_tuple)
+        merged_lines = sorted(merged_lines, key=first_three_numbers_in_tuple)
+
+        if len(base_lines) != len(merged_lines):
+            raise ValueError("%s: line numbers do not match up" % f)
+        for i in range(len(base_lines)):
+            if base_lines[i] != merged_lines[i]:
+                raise ValueError("%s\n\n... is different from...\n\n%s" % (base_lines[i], merged_lines[i]))
+
+    # The detour state is the same on every system
+    base_lines = read_lines("%s/logs_ns3/detour_state_flips.csv" % base_run_dir)
+    for i in range(num_systems):
+        if read_lines("%s/logs_ns3/system_%d_detour_state_flips.csv" % (distributed_run_dir, i)) != base_lines:
+            raise ValueError("detour_state_flips.csv of system %d is different" % i)
+
+    print("Success: distributed run with %d systems is exactly equal" % num_systems)
+
+
+def main():
+    args = sys.argv[1:]
+    if len(args) != 2:
+        print("Must supply exactly two arguments")
+        print("Usage: python3 test_distributed_exactly_equal.py [run_name] [num_systems]")
+        exit(1)
+    else:
+        test_distributed_exactly_equal(
+            args[0],
+            int(args[1])
+        )
+
+
+if __name__ == "__main__":
+    main()